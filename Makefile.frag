@@ -0,0 +1,5 @@
+# Benchmarks against the freshly built module: make bench BENCH_ARGS="--format=text"
+bench: all
+	$(PHP_EXECUTABLE) -n -d extension_dir=$(top_builddir)/modules -d extension=signalforge_container $(top_srcdir)/bench/run.php $(BENCH_ARGS)
+
+.PHONY: bench
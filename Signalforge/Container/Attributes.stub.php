@@ -0,0 +1,61 @@
+<?php
+/**
+ * Signalforge Container Extension
+ * Attributes.stub.php - IDE stubs for container attributes
+ *
+ * The container reads these from the class itself when it first builds the
+ * class's metadata; nothing needs to instantiate them.
+ *
+ * @package Signalforge\Container
+ */
+
+namespace Signalforge\Container\Attributes;
+
+use Attribute;
+
+/**
+ * Resolve the class as a singleton.
+ *
+ * The first make() of the unbound class registers it as singleton() would.
+ * Combined with #[Bind], the binding it registers is a singleton.
+ */
+#[Attribute(Attribute::TARGET_CLASS)]
+final class Singleton {}
+
+/**
+ * Resolve the interface (or class) to an implementation.
+ *
+ * The first make() of the unbound name registers it as bind() would.
+ */
+#[Attribute(Attribute::TARGET_CLASS)]
+final class Bind
+{
+    /**
+     * @param string $concrete Class the name resolves to
+     */
+    public function __construct(public readonly string $concrete) {}
+}
+
+/**
+ * Resolve a constructor parameter by container key instead of by its type.
+ */
+#[Attribute(Attribute::TARGET_PARAMETER)]
+final class Inject
+{
+    /**
+     * @param string $id Container key (abstract, alias or class name)
+     */
+    public function __construct(public readonly string $id) {}
+}
+
+/**
+ * Add the class to a tag, as tag() would, once the class is declared.
+ */
+#[Attribute(Attribute::TARGET_CLASS | Attribute::IS_REPEATABLE)]
+final class Tag
+{
+    /**
+     * @param string $name Tag name
+     */
+    public function __construct(public readonly string $name) {}
+}
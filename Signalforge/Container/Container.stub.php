@@ -38,8 +38,21 @@ final class Container
      */
     public static function singleton(string $abstract, mixed $concrete = null): void {}
 
+    /**
+     * Register a scoped binding with the container.
+     * One instance is cached per scope (see beginScope()) and released when
+     * the scope ends. Resolving it with no scope open throws.
+     *
+     * @param string $abstract The abstract type
+     * @param mixed $concrete The concrete implementation
+     * @return void
+     */
+    public static function scoped(string $abstract, mixed $concrete = null): void {}
+
     /**
      * Register an existing instance as a singleton.
+     * Inside a scope, an instance for a scoped binding only overrides it
+     * until that scope ends.
      *
      * @param string $abstract The abstract type
      * @param object $instance The object instance
@@ -47,6 +60,19 @@ final class Container
      */
     public static function instance(string $abstract, object $instance): void {}
 
+    /**
+     * Register a lazy singleton.
+     *
+     * make() returns a proxy immediately; the concrete class and its
+     * dependencies are only constructed when the proxy is first used.
+     * Classes that can't be proxied are resolved eagerly.
+     *
+     * @param string $abstract The abstract type
+     * @param string|null $concrete The class to instantiate (defaults to $abstract)
+     * @return void
+     */
+    public static function lazy(string $abstract, ?string $concrete = null): void {}
+
     /**
      * Resolve a type from the container.
      *
@@ -58,6 +84,19 @@ final class Container
      */
     public static function make(string $abstract, array $parameters = []): mixed {}
 
+    /**
+     * Resolve several types in one call.
+     *
+     * Keys are preserved, so ['db' => Database::class] resolves to
+     * ['db' => <Database>]. Nothing is returned if any of them fails.
+     *
+     * @param array<array-key, string> $abstracts The abstract types to resolve
+     * @return array The resolved instances
+     * @throws NotFoundException If a type cannot be resolved
+     * @throws CircularDependencyException If a circular dependency is detected
+     */
+    public static function makeMany(array $abstracts): array {}
+
     /**
      * Resolve a type from the container (PSR-11 compatible).
      *
@@ -112,11 +151,23 @@ final class Container
     /**
      * Resolve all bindings for a given tag.
      *
+     * When every member is a singleton or instance, the resolved array is
+     * kept and returned again until the bindings change.
+     *
      * @param string $tag The tag name
      * @return array Array of resolved instances
+     * @throws NotFoundException If a tagged type cannot be resolved
      */
     public static function tagged(string $tag): array {}
 
+    /**
+     * Iterate a tag, resolving each member only when it is reached.
+     *
+     * @param string $tag The tag name
+     * @return TaggedIterator
+     */
+    public static function lazyTagged(string $tag): TaggedIterator {}
+
     /**
      * Define a contextual binding.
      *
@@ -132,6 +183,34 @@ final class Container
      */
     public static function when(string $concrete): ContextualBuilder {}
 
+    /**
+     * Register a whole bindings manifest in one call.
+     *
+     * Sections are named after the methods they stand for - 'bind',
+     * 'singleton', 'scoped', 'lazy', 'alias' (alias => abstract), 'tag'
+     * (tag => abstracts) and 'when' (requester => [dependency => implementation])
+     * - and apply in the order they appear. A list entry or a null concrete
+     * binds a class to itself. Nothing is registered if any entry is invalid.
+     *
+     * @param array $manifest The manifest
+     * @return void
+     * @throws ContainerException If a section or entry is invalid
+     */
+    public static function register(array $manifest): void {}
+
+    /**
+     * Register the manifest returned by a PHP file.
+     *
+     * The file is included like any other (so opcache caches it) and must
+     * return a manifest array, which is applied by register() without being
+     * copied.
+     *
+     * @param string $path File returning the manifest
+     * @return void
+     * @throws ContainerException If the file is missing, doesn't return an array, or the manifest is invalid
+     */
+    public static function loadManifest(string $path): void {}
+
     /**
      * Flush all bindings and resolved instances.
      *
@@ -154,6 +233,24 @@ final class Container
      */
     public static function forgetInstances(): void {}
 
+    /**
+     * Open a child scope, e.g. for one request in a long-running worker.
+     * Bindings, metadata, compiled plans and singletons are shared with the
+     * scope; scoped services get their own instances in it. Scopes nest, and
+     * a nested scope sees the scoped instances of the scopes around it.
+     *
+     * @return void
+     */
+    public static function beginScope(): void {}
+
+    /**
+     * Close the innermost scope and release its scoped instances.
+     *
+     * @return void
+     * @throws ContainerException If no scope is open
+     */
+    public static function endScope(): void {}
+
     /**
      * Compile all registered bindings for faster resolution.
      *
@@ -178,45 +275,126 @@ final class Container
      */
     public static function clearCompiled(): void {}
 
+    /**
+     * Build reflection metadata and plans before the first make().
+     *
+     * Called from an opcache.preload script, what it builds is kept for the
+     * life of the server and every request's container starts with it.
+     * Elsewhere it only warms the current container.
+     *
+     * @param array|string $classes List of class names, or a prefix (e.g. 'App\\')
+     *                              matching every user class loaded so far
+     * @return int Number of classes warmed
+     * @throws NotFoundException If a listed class does not exist
+     */
+    public static function warmup(array|string $classes): int {}
+
     /**
      * Get all registered bindings for code generation.
      *
      * Returns an array of binding metadata including abstract, concrete, scope.
      * Used by ContainerDumper to generate optimized PHP code.
      *
-     * @return array<string, array{abstract: string, concrete: mixed, scope: string, resolved: bool}>
+     * @return array<string, array{abstract: string, concrete: mixed, scope: string, lazy: bool, resolved: bool}>
      */
     public static function getBindings(): array {}
 
     /**
      * Get reflection metadata for a class.
      *
-     * Returns constructor parameter information for code generation.
+     * Returns constructor parameter information for code generation, and the
+     * container attributes (#[Singleton], #[Bind], #[Inject]) read from the class.
      *
      * @param string $className The fully qualified class name
-     * @return array{class: string, instantiable: bool, paramCount: int, params: array}|null
+     * @return array{class: string, instantiable: bool, paramCount: int, singleton: bool, bind: ?string, params: array}|null
      */
     public static function getMetadata(string $className): ?array {}
 
+    /**
+     * Get resolution statistics for the current request.
+     *
+     * Counts which path each resolution took (call-site slot, singleton store,
+     * compiled plan, contextual binding, instance, lazy proxy, closure or
+     * autowiring), singleton store probing, metadata builds, constructors
+     * called or elided, and plans built on the fly (tiered compilation),
+     * rebuilt after a graph change or found unplannable. `bindings` lists how
+     * often each binding had to be resolved without a fast path. Timing is only collected with
+     * signalforge_container.stats_timing=1.
+     *
+     * @return array{make: int, failures: int, paths: array<string, int>, callSiteMisses: int, lookup: array<string, int>, metadataBuilds: int, constructors: array{called: int, elided: int}, plans: array{promoted: int, rebuilt: int, failed: int}, timing: array{enabled: bool, resolutions: int, totalNs: int, maxNs: int}, bindings: array<string, int>}
+     */
+    public static function stats(): array {}
+
+    /**
+     * Reset resolution statistics.
+     *
+     * Counters start at zero every request; this zeroes them mid-request.
+     */
+    public static function resetStats(): void {}
+
+    /**
+     * Get the resolutions recorded this request, in the Chrome trace event format.
+     *
+     * Needs signalforge_container.trace=1. Each make() that reaches the container
+     * is one complete ("X") event: `name` is what was resolved, `cat` the path it
+     * took (as in stats()['paths']), `ts` and `dur` are microseconds, and `args`
+     * holds the resolution depth, the requesting class and whether it failed.
+     * Events are listed as resolutions finished; only the latest
+     * signalforge_container.trace_size are kept. json_encode() the result to load
+     * it in Perfetto, chrome://tracing or speedscope.
+     *
+     * @return array{traceEvents: list<array{name: string, cat: string, ph: string, ts: float, dur: float, pid: int, tid: int, args: array{depth: int, requester: ?string, failed: bool}}>, displayTimeUnit: string, otherData: array{enabled: bool, capacity: int, dropped: int}}
+     */
+    public static function trace(): array {}
+
+    /**
+     * Drop the recorded resolutions.
+     *
+     * The trace starts empty every request; this empties it mid-request.
+     */
+    public static function resetTrace(): void {}
+
+    /**
+     * Get the static dependency graph.
+     *
+     * Nodes are every binding, every class with cached metadata or contextual
+     * rules, and everything they depend on through their binding or constructor,
+     * as make() would resolve it. Nothing is built. A node's scope is null when
+     * nothing can build it (an unbound interface, a missing class); closure
+     * factories are leaves. Edges without a parameter go from a binding to its
+     * concrete class.
+     *
+     * @param string $format 'array', or 'dot' for Graphviz
+     * @return array{nodes: array<string, array{scope: ?string, bound: bool, lazy: bool, closure: bool, fanIn: int, fanOut: int}>, edges: list<array{from: string, to: string, param: ?string, contextual: bool}>}|string
+     * @throws ContainerException For an unknown format
+     */
+    public static function graph(string $format = 'array'): array|string {}
+
     /**
      * Generate a compiled container PHP file.
      *
-     * Creates an optimized PHP class with factory methods for all registered
-     * bindings. The generated code is cached by OPcache for maximum performance.
+     * Writes a final class with one method per class binding, built from the
+     * same plans as compile(): constructor arguments are inlined, aliases and
+     * contextual class bindings resolved, and singletons kept in typed
+     * properties. Closures, instances and scoped services are still resolved
+     * through Container::make(). The file returns the class name, so it can
+     * be loaded without knowing it.
      *
      * @param string $path File path to save the generated container
      * @param string $className Name of the generated class (default: CompiledContainer)
      * @param string $namespace Namespace for the generated class (default: none)
-     * @param bool $eager Enable eager singleton pre-resolution for maximum performance (default: false)
+     * @param bool $eager Build every singleton when the container is loaded (default: false)
      * @return bool True on success
+     * @throws ContainerException If the name is invalid or the file can't be written
      */
     public static function dump(string $path, string $className = 'CompiledContainer', string $namespace = '', bool $eager = false): bool {}
 
     /**
-     * Load and activate a compiled container.
+     * Load a compiled container written by dump().
      *
-     * Once loaded, Container::make() will delegate to the compiled container
-     * for services it knows about, falling back to native resolution for others.
+     * Its methods are bound directly as closure factories for the services it
+     * contains; everything else keeps resolving natively. make() parameters
+     * are not passed to the generated methods.
      *
      * @param string $path Path to the compiled container PHP file
      * @return bool True on success
@@ -224,9 +402,10 @@ final class Container
     public static function loadCompiled(string $path): bool {}
 
     /**
-     * Unload and deactivate the compiled container.
+     * Unload the compiled container.
      *
-     * After calling this, Container::make() will use native resolution.
+     * Services it bound get their class bindings back, unless they were
+     * rebound since.
      *
      * @return void
      */
@@ -240,23 +419,72 @@ final class Container
     public static function hasCompiled(): bool {}
 
     /**
-     * Clear the binary cache file.
+     * Check whether this request inherited its bindings from a previous one.
+     *
+     * Only possible with signalforge_container.persistent=1. Bootstrap code can
+     * skip re-registering class bindings when this returns true. Closure and
+     * instance bindings are request-scoped and must still be registered.
      *
-     * Deletes the cached singleton instances from disk. The cache will be
-     * regenerated on the next request when singletons are resolved.
+     * @return bool True if the binding graph was carried over
+     */
+    public static function isWarm(): bool {}
+
+    /**
+     * Delete the snapshot at the default cache path.
      *
      * @return bool True on success, false on failure
      */
     public static function clearCache(): bool {}
 
     /**
-     * Get the path to the binary cache file.
+     * Get the default snapshot path.
      *
-     * Returns the filesystem path where singleton instances are cached.
-     * The path is based on a hash of the registered bindings.
+     * The file name is a SHA-1 of the registered graph (bindings, scopes,
+     * aliases, contextual bindings and tags, in order) and the extension
+     * and PHP versions.
      *
      * @return string The cache file path
      */
     public static function getCachePath(): string {}
+
+    /**
+     * Write a snapshot of the container.
+     *
+     * Stores class bindings, aliases, tags, contextual bindings, constructor
+     * metadata and compiled plans (call compile() first to include them).
+     * Closures and instances are not stored.
+     *
+     * The file is written under a temporary name and renamed into place.
+     * Returns false immediately if another process is saving the same file.
+     *
+     * @param string|null $path Snapshot file (defaults to getCachePath())
+     * @return bool True on success
+     */
+    public static function saveSnapshot(?string $path = null): bool {}
+
+    /**
+     * Import a snapshot written by saveSnapshot().
+     *
+     * Returns false without changing the container when the file is
+     * missing, was written by another PHP or format version, or any class
+     * file changed since it was written.
+     *
+     * @param string|null $path Snapshot file (defaults to getCachePath())
+     * @return bool True if the snapshot was imported
+     */
+    public static function loadSnapshot(?string $path = null): bool {}
+
+    /**
+     * Save a snapshot at request shutdown instead of now.
+     *
+     * Nothing is written if a current snapshot already exists at that
+     * point, so only the first worker after a change regenerates it. Under
+     * FPM, call fastcgi_finish_request() first to keep the write off the
+     * response.
+     *
+     * @param string|null $path Snapshot file (defaults to getCachePath())
+     * @return void
+     */
+    public static function deferSnapshot(?string $path = null): void {}
 }
 
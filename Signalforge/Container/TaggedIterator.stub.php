@@ -0,0 +1,63 @@
+<?php
+/**
+ * Signalforge Container Extension
+ * TaggedIterator.stub.php - IDE stub for TaggedIterator class
+ *
+ * @package Signalforge\Container
+ */
+
+namespace Signalforge\Container;
+
+/**
+ * Lazy iterator over a tag, returned by Container::lazyTagged().
+ *
+ * Each member is resolved when the loop reaches it, so breaking out early
+ * leaves the remaining services unbuilt.
+ *
+ * @final
+ */
+final class TaggedIterator implements \Iterator, \Countable
+{
+    /**
+     * Resolve and return the member at the current position.
+     *
+     * @return mixed The resolved service (null past the end)
+     * @throws NotFoundException If the member cannot be resolved
+     */
+    public function current(): mixed {}
+
+    /**
+     * Position of the current member.
+     *
+     * @return mixed Integer position (null past the end)
+     */
+    public function key(): mixed {}
+
+    /**
+     * Move to the next member.
+     *
+     * @return void
+     */
+    public function next(): void {}
+
+    /**
+     * Move back to the first member.
+     *
+     * @return void
+     */
+    public function rewind(): void {}
+
+    /**
+     * Check if there is a member at the current position.
+     *
+     * @return bool
+     */
+    public function valid(): bool {}
+
+    /**
+     * Number of tagged members, without resolving any.
+     *
+     * @return int
+     */
+    public function count(): int {}
+}
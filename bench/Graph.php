@@ -0,0 +1,211 @@
+<?php
+/**
+ * Synthetic service graphs for the Signalforge Container benchmarks.
+ *
+ * A graph is `depth` layers of `width` classes. Layer 0 classes have no
+ * dependencies; every class above takes `fanout` constructor dependencies
+ * drawn from the layer below, so resolving a top-layer class (a root)
+ * touches the whole height of the graph.
+ *
+ * Everything is bound explicitly, the way a framework bootstrap would:
+ * - a share of the classes (singletonRatio) as singletons, the rest transient
+ * - `closures` layer-0 classes through closure factories
+ * - `contextual` roots take a LoggerInterface that a contextual binding
+ *   swaps for NullLogger
+ *
+ * Roots are always transient so every make() of one does real work. The
+ * graph is drawn from a seeded generator, so the same configuration always
+ * produces the same classes.
+ */
+
+namespace Signalforge\Container\Bench;
+
+use Signalforge\Container\Container;
+
+final class Graph
+{
+    /** Namespace the generated classes live in */
+    public readonly string $namespace;
+
+    /** @var list<list<string>> Fully qualified class names by layer (0 = leaves) */
+    public array $layers = [];
+
+    /** @var array<string, list<string>> Constructor dependencies by class */
+    private array $dependencies = [];
+
+    /** @var array<string, true> */
+    private array $singletons = [];
+
+    /** @var array<string, true> */
+    private array $closures = [];
+
+    /** @var array<string, true> */
+    private array $contextual = [];
+
+    /** Generated source file while the classes are loaded */
+    private ?string $file = null;
+
+    public function __construct(
+        public readonly string $name,
+        public readonly int $width,
+        public readonly int $depth,
+        public readonly float $singletonRatio = 0.5,
+        public readonly int $contextualCount = 0,
+        public readonly int $closureCount = 0,
+        public readonly int $fanout = 3,
+        int $seed = 1,
+    ) {
+        if ($width < 1 || $depth < 1) {
+            throw new \InvalidArgumentException('Graph width and depth must be at least 1');
+        }
+
+        $this->namespace = 'SignalforgeBench\\' . ucfirst(preg_replace('/\W/', '', $name));
+        $this->plan($seed);
+    }
+
+    private function plan(int $seed): void
+    {
+        mt_srand($seed);
+        $fanout = min($this->fanout, $this->width);
+
+        for ($layer = 0; $layer < $this->depth; $layer++) {
+            $classes = [];
+            for ($i = 0; $i < $this->width; $i++) {
+                $class = $this->namespace . "\\S{$layer}_{$i}";
+                $classes[] = $class;
+
+                $deps = [];
+                if ($layer > 0) {
+                    foreach ((array) array_rand($this->layers[$layer - 1], $fanout) as $index) {
+                        $deps[] = $this->layers[$layer - 1][$index];
+                    }
+                }
+                $this->dependencies[$class] = $deps;
+
+                $top = $layer === $this->depth - 1;
+                if (!$top && mt_rand() / mt_getrandmax() < $this->singletonRatio) {
+                    $this->singletons[$class] = true;
+                }
+            }
+            $this->layers[] = $classes;
+        }
+
+        foreach (array_slice($this->layers[0], 0, $this->closureCount) as $class) {
+            $this->closures[$class] = true;
+            unset($this->singletons[$class]);
+        }
+        foreach (array_slice($this->roots(), 0, $this->contextualCount) as $class) {
+            $this->contextual[$class] = true;
+        }
+    }
+
+    /** Number of generated services (loggers not included) */
+    public function count(): int
+    {
+        return $this->width * $this->depth;
+    }
+
+    /** @return list<string> Top-layer classes */
+    public function roots(): array
+    {
+        return $this->layers[$this->depth - 1];
+    }
+
+    /** @return list<string> */
+    public function singletons(): array
+    {
+        return array_keys($this->singletons);
+    }
+
+    /** @return list<string> */
+    public function closures(): array
+    {
+        return array_keys($this->closures);
+    }
+
+    /** @return list<string> Roots with a contextual logger */
+    public function contextual(): array
+    {
+        return array_keys($this->contextual);
+    }
+
+    /** PHP source declaring every class of the graph */
+    public function source(): string
+    {
+        $code = "<?php\nnamespace {$this->namespace};\n\n"
+            . "interface LoggerInterface {}\n"
+            . "final class FileLogger implements LoggerInterface {}\n"
+            . "final class NullLogger implements LoggerInterface {}\n\n";
+
+        foreach ($this->dependencies as $class => $deps) {
+            $params = [];
+            foreach ($deps as $i => $dep) {
+                $params[] = "public \\{$dep} \$d{$i}";
+            }
+            if (isset($this->contextual[$class])) {
+                $params[] = 'public LoggerInterface $logger';
+            }
+
+            $short = substr($class, strlen($this->namespace) + 1);
+            $code .= "final class {$short} { public function __construct(" . implode(', ', $params) . ") {} }\n";
+        }
+
+        return $code;
+    }
+
+    /**
+     * Declare the classes. They come from a real file so metadata snapshots
+     * can validate them; the file is removed by unload().
+     */
+    public function load(): void
+    {
+        $this->file = tempnam(sys_get_temp_dir(), 'sf_bench_') . '.php';
+        file_put_contents($this->file, $this->source());
+        require $this->file;
+    }
+
+    public function unload(): void
+    {
+        if ($this->file !== null) {
+            @unlink($this->file);
+            @unlink(substr($this->file, 0, -4));
+            $this->file = null;
+        }
+    }
+
+    /** Register every binding - the bootstrap being measured */
+    public function register(): void
+    {
+        $logger = $this->namespace . '\\LoggerInterface';
+        Container::singleton($logger, $this->namespace . '\\FileLogger');
+
+        foreach ($this->dependencies as $class => $deps) {
+            if (isset($this->closures[$class])) {
+                Container::bind($class, static fn () => new $class());
+            } elseif (isset($this->singletons[$class])) {
+                Container::singleton($class);
+            } else {
+                Container::bind($class);
+            }
+        }
+
+        foreach ($this->contextual as $class => $_) {
+            Container::when($class)->needs($logger)->give($this->namespace . '\\NullLogger');
+        }
+    }
+
+    /** @return array<string, int|float> Shape of the graph for the report */
+    public function describe(): array
+    {
+        return [
+            'services' => $this->count(),
+            'width' => $this->width,
+            'depth' => $this->depth,
+            'fanout' => min($this->fanout, $this->width),
+            'singletons' => count($this->singletons),
+            'singletonRatio' => $this->singletonRatio,
+            'closures' => count($this->closures),
+            'contextual' => count($this->contextual),
+        ];
+    }
+}
@@ -0,0 +1,305 @@
+<?php
+/**
+ * Signalforge Container benchmark suite
+ *
+ * Builds synthetic service graphs (see Graph.php) and measures, per graph:
+ * - bootstrap: declaring the classes, registering bindings, compile()
+ * - make() latency per resolution path: autowiring (cold and warm),
+ *   compiled plans, singleton store hits, call-site slots, closures and
+ *   contextual bindings
+ * - metadata snapshot save/load time and size
+ * - peak memory
+ *
+ * Results are printed as JSON (default) or a text table. Pass a previous
+ * JSON report with --compare to flag regressions.
+ *
+ * Usage:
+ *   php bench/run.php [options]
+ *
+ *   --scenario=LIST     small, medium, framework or all (default: all)
+ *   --width=N --depth=N --singletons=RATIO --contextual=N --closures=N --fanout=N
+ *                       run a single custom graph instead
+ *   --iterations=N      make() calls per measurement (default: 20000)
+ *   --format=json|text  output format (default: json)
+ *   --output=FILE       write the report to FILE instead of stdout
+ *   --compare=FILE      compare against an earlier JSON report
+ *   --threshold=PCT     slowdown that counts as a regression (default: 10)
+ */
+
+use Signalforge\Container\Bench\Graph;
+use Signalforge\Container\Container;
+
+require __DIR__ . '/Graph.php';
+
+const SCENARIOS = [
+    'small' => ['width' => 5, 'depth' => 3, 'singletons' => 0.5, 'contextual' => 1, 'closures' => 1, 'fanout' => 2],
+    'medium' => ['width' => 20, 'depth' => 5, 'singletons' => 0.5, 'contextual' => 5, 'closures' => 5, 'fanout' => 3],
+    'framework' => ['width' => 200, 'depth' => 10, 'singletons' => 0.6, 'contextual' => 50, 'closures' => 100, 'fanout' => 3],
+];
+
+if (!extension_loaded('signalforge_container')) {
+    fwrite(STDERR, "The signalforge_container extension is not loaded\n");
+    exit(2);
+}
+
+$options = getopt('', [
+    'scenario:', 'width:', 'depth:', 'singletons:', 'contextual:', 'closures:', 'fanout:',
+    'iterations:', 'format:', 'output:', 'compare:', 'threshold:', 'help',
+]);
+
+if (isset($options['help'])) {
+    $doc = file_get_contents(__FILE__);
+    preg_match('~/\*\*(.*?)\*/~s', $doc, $m);
+    echo preg_replace('/^\s*\* ?/m', '', trim($m[1])), "\n";
+    exit(0);
+}
+
+$iterations = max(1, (int) ($options['iterations'] ?? 20000));
+$format = $options['format'] ?? 'json';
+
+/* Which graphs to run */
+$custom = array_intersect_key($options, array_flip(['width', 'depth', 'singletons', 'contextual', 'closures', 'fanout']));
+if ($custom) {
+    $scenarios = ['custom' => array_merge(SCENARIOS['medium'], array_map('floatval', $custom))];
+} else {
+    $names = $options['scenario'] ?? 'all';
+    $names = $names === 'all' ? array_keys(SCENARIOS) : explode(',', $names);
+    $scenarios = [];
+    foreach ($names as $name) {
+        if (!isset(SCENARIOS[$name])) {
+            fwrite(STDERR, "Unknown scenario '$name' (expected: " . implode(', ', array_keys(SCENARIOS)) . ", all)\n");
+            exit(2);
+        }
+        $scenarios[$name] = SCENARIOS[$name];
+    }
+}
+
+/* ============================================================================
+ * Measurement
+ * ============================================================================ */
+
+/**
+ * Average nanoseconds per make() of $abstracts, taken round-robin.
+ * $params forces the regular make() path instead of the caller's call-site slot.
+ */
+function bench_make(array $abstracts, int $calls, ?array $params = null): ?float
+{
+    if (!$abstracts) {
+        return null;
+    }
+
+    $count = count($abstracts);
+    $start = hrtime(true);
+    if ($params === null) {
+        for ($i = 0; $i < $calls; $i++) {
+            Container::make($abstracts[$i % $count]);
+        }
+    } else {
+        for ($i = 0; $i < $calls; $i++) {
+            Container::make($abstracts[$i % $count], $params);
+        }
+    }
+    return (hrtime(true) - $start) / $calls;
+}
+
+/* Average nanoseconds per get() from a single call site asking for one service */
+function bench_call_site(?string $abstract, int $calls): ?float
+{
+    if ($abstract === null) {
+        return null;
+    }
+
+    $start = hrtime(true);
+    for ($i = 0; $i < $calls; $i++) {
+        Container::get($abstract);
+    }
+    return (hrtime(true) - $start) / $calls;
+}
+
+/* Wall time of $fn in milliseconds */
+function bench_ms(callable $fn): float
+{
+    $start = hrtime(true);
+    $fn();
+    return (hrtime(true) - $start) / 1e6;
+}
+
+function bench_scenario(string $name, array $config, int $iterations): array
+{
+    Container::flush();
+    gc_collect_cycles();
+    memory_reset_peak_usage();
+    $baseline = memory_get_usage();
+
+    $graph = new Graph(
+        $name,
+        (int) $config['width'],
+        (int) $config['depth'],
+        (float) $config['singletons'],
+        (int) $config['contextual'],
+        (int) $config['closures'],
+        (int) $config['fanout'],
+    );
+    $roots = $graph->roots();
+    $singletons = $graph->singletons();
+
+    $bootstrap = [
+        'declareMs' => bench_ms(fn () => $graph->load()),
+        'registerMs' => bench_ms(fn () => $graph->register()),
+    ];
+
+    Container::resetStats();
+
+    /* Interpreted resolution: first make() builds reflection metadata */
+    $start = hrtime(true);
+    foreach ($roots as $root) {
+        Container::make($root);
+    }
+    $make = ['autowireColdNs' => (hrtime(true) - $start) / count($roots)];
+    $make['autowireNs'] = bench_make($roots, $iterations);
+
+    /* Singletons no root depends on are built here - the store hit, then the call-site slot on top */
+    bench_make($singletons, count($singletons), ['bench' => true]);
+    $make['singletonNs'] = bench_make($singletons, $iterations, ['bench' => true]);
+    $make['callSiteNs'] = bench_call_site($singletons[0] ?? null, $iterations);
+    $make['closureNs'] = bench_make($graph->closures(), $iterations);
+    $make['contextualNs'] = bench_make($graph->contextual(), $iterations);
+
+    /* Compiled plans, round-robin and repeated from one call site */
+    $bootstrap['compileMs'] = bench_ms(fn () => Container::compile());
+    bench_make($roots, count($roots));
+    $make['compiledNs'] = bench_make($roots, $iterations);
+    $make['compiledCallSiteNs'] = bench_call_site($roots[0], $iterations);
+    $make['compiledSpeedup'] = $make['compiledNs'] > 0 ? $make['autowireNs'] / $make['compiledNs'] : null;
+
+    $stats = Container::stats();
+
+    /* Metadata snapshot: what a cold worker pays instead of bootstrap + compile */
+    $file = tempnam(sys_get_temp_dir(), 'sf_bench_snapshot_');
+    $snapshot = ['saveMs' => bench_ms(fn () => Container::saveSnapshot($file))];
+    clearstatcache();
+    $snapshot['bytes'] = filesize($file);
+    Container::flush();
+    $loaded = false;
+    $snapshot['loadMs'] = bench_ms(function () use ($file, &$loaded) {
+        $loaded = Container::loadSnapshot($file);
+    });
+    $snapshot['loaded'] = $loaded;
+    $start = hrtime(true);
+    Container::make($roots[0]);
+    $snapshot['firstMakeNs'] = hrtime(true) - $start;
+    @unlink($file);
+    @unlink($file . '.lock');
+
+    $memory = [
+        'peakBytes' => memory_get_peak_usage() - $baseline,
+        'retainedBytes' => memory_get_usage() - $baseline,
+    ];
+
+    Container::flush();
+    $graph->unload();
+
+    return [
+        'graph' => $graph->describe(),
+        'bootstrap' => $bootstrap,
+        'make' => $make,
+        'snapshot' => $snapshot,
+        'memory' => $memory,
+        'paths' => $stats['paths'],
+    ];
+}
+
+/* ============================================================================
+ * Report
+ * ============================================================================ */
+
+$report = [
+    'suite' => 'signalforge_container',
+    'version' => phpversion('signalforge_container'),
+    'php' => PHP_VERSION,
+    'zts' => (bool) PHP_ZTS,
+    'os' => PHP_OS_FAMILY,
+    'opcache' => function_exists('opcache_get_status') && opcache_get_status(false) !== false,
+    'persistent' => (bool) ini_get('signalforge_container.persistent'),
+    'iterations' => $iterations,
+    'timestamp' => gmdate('c'),
+    'scenarios' => [],
+];
+
+foreach ($scenarios as $name => $config) {
+    $report['scenarios'][$name] = bench_scenario($name, $config, $iterations);
+}
+
+function bench_format_text(array $report): string
+{
+    $out = sprintf("Signalforge Container %s - PHP %s%s, %d iterations\n",
+        $report['version'], $report['php'], $report['zts'] ? ' ZTS' : '', $report['iterations']);
+
+    foreach ($report['scenarios'] as $name => $result) {
+        $g = $result['graph'];
+        $out .= sprintf("\n%s: %d services (%dx%d, fanout %d), %d singletons, %d closures, %d contextual\n",
+            $name, $g['services'], $g['width'], $g['depth'], $g['fanout'], $g['singletons'], $g['closures'], $g['contextual']);
+
+        foreach (['bootstrap', 'make', 'snapshot', 'memory'] as $group) {
+            foreach ($result[$group] as $metric => $value) {
+                $shown = match (true) {
+                    $value === null => '-',
+                    is_bool($value) => $value ? 'yes' : 'no',
+                    is_float($value) => number_format($value, 2),
+                    default => number_format($value),
+                };
+                $out .= sprintf("  %-10s %-20s %14s\n", $group, $metric, $shown);
+            }
+        }
+    }
+
+    return $out;
+}
+
+/*
+ * Compare timing, size and memory metrics against an earlier report.
+ * All of them are lower-is-better; returns true when one regressed.
+ */
+function bench_compare(array $report, array $previous, float $threshold): bool
+{
+    $regressed = false;
+    fprintf(STDERR, "Compared with %s (PHP %s, %s):\n", $previous['version'] ?? '?', $previous['php'] ?? '?', $previous['timestamp'] ?? '?');
+
+    foreach ($report['scenarios'] as $name => $result) {
+        foreach (['bootstrap', 'make', 'snapshot', 'memory'] as $group) {
+            foreach ($result[$group] as $metric => $value) {
+                $before = $previous['scenarios'][$name][$group][$metric] ?? null;
+                if (!is_int($value) && !is_float($value) || !is_int($before) && !is_float($before) || $before <= 0
+                    || $metric === 'compiledSpeedup') {
+                    continue;
+                }
+
+                $change = ($value - $before) / $before * 100;
+                $flag = $change > $threshold ? '  REGRESSION' : '';
+                $regressed = $regressed || $flag !== '';
+                fprintf(STDERR, "  %-10s %-10s %-20s %+8.1f%%%s\n", $name, $group, $metric, $change, $flag);
+            }
+        }
+    }
+
+    return $regressed;
+}
+
+$output = $format === 'text'
+    ? bench_format_text($report)
+    : json_encode($report, JSON_PRETTY_PRINT | JSON_UNESCAPED_SLASHES | JSON_PRESERVE_ZERO_FRACTION) . "\n";
+
+if (isset($options['output'])) {
+    file_put_contents($options['output'], $output);
+} else {
+    echo $output;
+}
+
+if (isset($options['compare'])) {
+    $previous = json_decode((string) @file_get_contents($options['compare']), true);
+    if (!is_array($previous)) {
+        fwrite(STDERR, "Unable to read report '{$options['compare']}'\n");
+        exit(2);
+    }
+    exit(bench_compare($report, $previous, (float) ($options['threshold'] ?? 10)) ? 1 : 0);
+}
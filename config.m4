@@ -28,9 +28,21 @@ if test "$PHP_SIGNALFORGE_CONTAINER" != "no"; then
     src/reflection_cache.c \
     src/factory.c \
     src/compiler.c \
-    src/pool.c \
     src/fast_lookup.c \
-    src/cache_file.c,
+    src/cache_file.c \
+    src/lazy.c \
+    src/call_site.c \
+    src/tag.c \
+    src/stats.c \
+    src/scope.c \
+    src/shared_strings.c \
+    src/dumper.c \
+    src/manifest.c \
+    src/preload.c \
+    src/trace.c \
+    src/graph.c \
+    src/simd.c \
+    src/arena.c,
     $ext_shared,, -DZEND_ENABLE_STATIC_TSRMLS_CACHE=1)
 
   dnl Add header files
@@ -39,8 +51,11 @@ if test "$PHP_SIGNALFORGE_CONTAINER" != "no"; then
   PHP_ADD_INCLUDE($ext_srcdir)
   PHP_ADD_INCLUDE($ext_srcdir/src)
 
+  dnl make bench (see bench/run.php)
+  PHP_ADD_MAKEFILE_FRAGMENT
+
   dnl Install headers for potential use by other extensions
-  PHP_INSTALL_HEADERS([ext/signalforge_container], [php_signalforge_container.h src/container.h src/binding.h src/autowire.h src/reflection_cache.h src/factory.h src/compiler.h src/simd.h src/pool.h src/fast_lookup.h src/cache_file.h])
+  PHP_INSTALL_HEADERS([ext/signalforge_container], [php_signalforge_container.h src/container.h src/binding.h src/autowire.h src/reflection_cache.h src/factory.h src/compiler.h src/simd.h src/fast_lookup.h src/cache_file.h src/lazy.h src/call_site.h src/tag.h src/stats.h src/scope.h src/shared_strings.h src/arena.h src/dumper.h src/manifest.h src/preload.h src/trace.h src/graph.h])
 
 fi
 
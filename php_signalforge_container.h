@@ -55,20 +55,37 @@ extern zend_module_entry signalforge_container_module_entry;
 typedef struct _sf_container sf_container;
 typedef struct _sf_binding sf_binding;
 typedef struct _sf_class_meta sf_class_meta;
-typedef struct _sf_param_info sf_param_info;
 typedef struct _sf_resolution_context sf_resolution_context;
 typedef struct _sf_contextual_binding sf_contextual_binding;
 typedef struct _sf_factory sf_factory;
+typedef struct _sf_arena sf_arena;
+
+#include "src/stats.h"
+#include "src/trace.h"
+#include "src/shared_strings.h"
 
 /* ============================================================================
  * Module Globals
  *
  * Per-request storage for the global container. ZTS builds use thread-local
- * storage, non-ZTS uses a simple global.
+ * storage, non-ZTS uses a simple global. Everything a thread mutates while
+ * resolving lives here (or in its container); only immutable strings are
+ * shared between threads (see src/shared_strings.h).
  * ============================================================================ */
 
 ZEND_BEGIN_MODULE_GLOBALS(signalforge_container)
     sf_container *global_container;  /* Lazily created on first use */
+    zend_bool persistent;            /* INI: keep the binding graph across requests */
+    zend_bool stats_timing;          /* INI: time cold resolutions in stats() */
+    zend_bool tracing;               /* INI: record resolution events for trace() */
+    zend_long trace_size;            /* INI: events the trace ring buffer keeps */
+    zend_bool has_autoload;          /* INI: let has() autoload unbound class names */
+    zend_long compile_threshold;     /* INI: regular-path resolutions before a service is compiled (0 = off) */
+    char *simd;                      /* INI: widest SIMD kernel set MINIT may select ("auto" = whatever the CPU has) */
+    uint32_t autoload_epoch;         /* Bumped by spl_autoload_register()/unregister() */
+    sf_stats stats;                  /* Resolution counters for the current request */
+    sf_trace trace;                  /* Resolution events for the current request */
+    zval compiled_container;         /* Container::loadCompiled() instance (UNDEF = none) */
 ZEND_END_MODULE_GLOBALS(signalforge_container)
 
 /* Accessor macro - use this instead of accessing globals directly */
@@ -86,10 +103,16 @@ extern zend_class_entry *sf_container_exception_ce;
 extern zend_class_entry *sf_not_found_exception_ce;
 extern zend_class_entry *sf_circular_dependency_exception_ce;
 extern zend_class_entry *sf_contextual_builder_ce;
+extern zend_class_entry *sf_tagged_iterator_ce;
+extern zend_class_entry *sf_singleton_attribute_ce;
+extern zend_class_entry *sf_bind_attribute_ce;
+extern zend_class_entry *sf_inject_attribute_ce;
+extern zend_class_entry *sf_tag_attribute_ce;
 
 /* Custom object handlers */
 extern zend_object_handlers sf_container_object_handlers;
 extern zend_object_handlers sf_contextual_builder_object_handlers;
+extern zend_object_handlers sf_tagged_iterator_object_handlers;
 
 /* ============================================================================
  * Binding Scope Constants
@@ -98,11 +121,65 @@ extern zend_object_handlers sf_contextual_builder_object_handlers;
  * - TRANSIENT: new instance every make() call
  * - SINGLETON: cached after first resolution
  * - INSTANCE: user-provided object, returned as-is
+ * - SCOPED: cached per Container::beginScope() scope
  * ============================================================================ */
 
 #define SF_SCOPE_TRANSIENT 0
 #define SF_SCOPE_SINGLETON 1
 #define SF_SCOPE_INSTANCE  2
+#define SF_SCOPE_SCOPED    3
+
+/* ============================================================================
+ * Persistent Strings
+ *
+ * In persistent mode the binding graph outlives the request, so every string
+ * stored in it must live in process memory. Request strings and opcache's
+ * interned strings (freed at request end or on opcache reset) are replaced
+ * by their process-wide shared copy (src/shared_strings.c), which every graph
+ * - one per thread under ZTS - uses instead of its own. Strings that are
+ * already persistent are kept. The hash is computed up front so lookups never
+ * have to write to a shared copy.
+ * ============================================================================ */
+
+static zend_always_inline zend_string *sf_string_copy_ex(zend_string *s, zend_bool persistent)
+{
+    if (EXPECTED(!persistent) || (GC_FLAGS(s) & IS_STR_PERSISTENT)) {
+        return zend_string_copy(s);
+    }
+    
+    return sf_string_share(ZSTR_VAL(s), ZSTR_LEN(s));
+}
+
+/*
+ * Copy of a name the container is keyed by (binding abstracts, aliases, class
+ * metadata, plans, singletons). Request graphs keep the interned copy: class
+ * name literals are interned by the compiler, so make(Foo::class) then finds
+ * the key by pointer before any bytes are compared. Shared strings are
+ * already unique per name.
+ */
+static zend_always_inline zend_string *sf_string_intern_ex(zend_string *s, zend_bool persistent)
+{
+    if (UNEXPECTED(persistent)) {
+        return sf_string_copy_ex(s, 1);
+    }
+    if (ZSTR_IS_INTERNED(s)) {
+        return s;
+    }
+    return zend_new_interned_string(zend_string_copy(s));
+}
+
+/*
+ * Hand a container-owned string back to userland. Persistent strings must never
+ * end up in a request zval: the engine would efree() them when the last
+ * userland reference goes away.
+ */
+static zend_always_inline zend_string *sf_string_export(zend_string *s)
+{
+    if (UNEXPECTED(!ZSTR_IS_INTERNED(s) && (GC_FLAGS(s) & IS_STR_PERSISTENT))) {
+        return zend_string_init(ZSTR_VAL(s), ZSTR_LEN(s), 0);
+    }
+    return zend_string_copy(s);
+}
 
 /* ============================================================================
  * PHP Object Wrappers
@@ -123,16 +200,27 @@ typedef struct {
     zend_object std;         /* Must be last! */
 } sf_contextual_builder_object;
 
+typedef struct {
+    sf_container *container; /* Container members are resolved in */
+    struct _sf_tag *tag;     /* Tag being iterated (NULL = unknown tag, empty) */
+    uint32_t position;       /* Current member */
+    zval current;            /* Member at position once resolved (UNDEF = not yet) */
+    zend_object std;         /* Must be last! */
+} sf_tagged_iterator_object;
+
 /*
  * Macros to extract our struct from a zval or zend_object.
  * XtOffsetOf calculates the byte offset from std back to our struct.
  */
 #define Z_CONTAINER_OBJ_P(zv) \
     ((sf_container_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(sf_container_object, std)))
-
+    
 #define Z_CONTEXTUAL_BUILDER_OBJ_P(zv) \
     ((sf_contextual_builder_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(sf_contextual_builder_object, std)))
-
+    
+#define Z_TAGGED_ITERATOR_OBJ_P(zv) \
+    ((sf_tagged_iterator_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(sf_tagged_iterator_object, std)))
+    
 /* Module lifecycle functions */
 PHP_MINIT_FUNCTION(signalforge_container);
 PHP_MSHUTDOWN_FUNCTION(signalforge_container);
@@ -144,5 +232,7 @@ PHP_MINFO_FUNCTION(signalforge_container);
 void sf_register_container_class(void);
 void sf_register_exception_classes(void);
 void sf_register_contextual_builder_class(void);
+void sf_register_tagged_iterator_class(void);
+void sf_register_attribute_classes(void);
 
 #endif /* PHP_SIGNALFORGE_CONTAINER_H */
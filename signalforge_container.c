@@ -15,6 +15,13 @@
 #include "src/reflection_cache.h"
 #include "src/autowire.h"
 #include "src/compiler.h"
+#include "src/lazy.h"
+#include "src/tag.h"
+#include "src/dumper.h"
+#include "src/manifest.h"
+#include "src/preload.h"
+#include "src/graph.h"
+#include "src/simd.h"
 
 #include <unistd.h>  /* For access() */
 
@@ -31,14 +38,16 @@ zend_class_entry *sf_container_exception_ce = NULL;
 zend_class_entry *sf_not_found_exception_ce = NULL;
 zend_class_entry *sf_circular_dependency_exception_ce = NULL;
 zend_class_entry *sf_contextual_builder_ce = NULL;
+zend_class_entry *sf_tagged_iterator_ce = NULL;
+zend_class_entry *sf_singleton_attribute_ce = NULL;
+zend_class_entry *sf_bind_attribute_ce = NULL;
+zend_class_entry *sf_inject_attribute_ce = NULL;
+zend_class_entry *sf_tag_attribute_ce = NULL;
 
 /* Custom object handlers let us hook into object lifecycle (create/destroy) */
 zend_object_handlers sf_container_object_handlers;
 zend_object_handlers sf_contextual_builder_object_handlers;
-
-/* Compiled container reference (PHP object) */
-static zval sf_compiled_container;
-static zend_bool sf_compiled_container_active = 0;
+zend_object_handlers sf_tagged_iterator_object_handlers;
 
 /* ============================================================================
  * Object Lifecycle
@@ -117,17 +126,56 @@ static void sf_contextual_builder_object_free(zend_object *obj)
     zend_object_std_dtor(&intern->std);
 }
 
+/*
+ * TaggedIterator walks a tag lazily: Container::lazyTagged('listeners')
+ * resolves each member only when the loop reaches it.
+ */
+static zend_object *sf_tagged_iterator_object_create(zend_class_entry *ce)
+{
+    sf_tagged_iterator_object *intern = zend_object_alloc(sizeof(sf_tagged_iterator_object), ce);
+    
+    zend_object_std_init(&intern->std, ce);
+    object_properties_init(&intern->std, ce);
+    
+    intern->container = NULL;
+    intern->tag = NULL;
+    intern->position = 0;
+    ZVAL_UNDEF(&intern->current);
+    intern->std.handlers = &sf_tagged_iterator_object_handlers;
+    
+    return &intern->std;
+}
+
+static void sf_tagged_iterator_object_free(zend_object *obj)
+{
+    sf_tagged_iterator_object *intern = (sf_tagged_iterator_object *)((char *)obj - XtOffsetOf(sf_tagged_iterator_object, std));
+    
+    zval_ptr_dtor(&intern->current);
+    if (intern->tag) {
+        sf_tag_release(intern->tag);
+    }
+    if (intern->container) {
+        sf_container_release(intern->container);
+    }
+    
+    zend_object_std_dtor(&intern->std);
+}
+
 /* ============================================================================
  * Global Container Access
  * 
  * The container is created lazily on first access. This avoids allocating
  * memory if the extension is loaded but not used.
+ *
+ * With signalforge_container.persistent=1 the container is created once per
+ * worker and its binding graph is reused by every following request.
  * ============================================================================ */
 
 static inline sf_container *sf_get_global_container(void)
 {
     if (!SF_CONTAINER_G(global_container)) {
-        SF_CONTAINER_G(global_container) = sf_container_create();
+        SF_CONTAINER_G(global_container) = sf_container_create_ex(SF_CONTAINER_G(persistent));
+        sf_preload_seed(SF_CONTAINER_G(global_container));
     }
     return SF_CONTAINER_G(global_container);
 }
@@ -151,11 +199,25 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_singleton, 0, 1, IS_VO
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, concrete, IS_MIXED, 0, "null")
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_scoped, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, abstract, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, concrete, IS_MIXED, 0, "null")
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_instance, 0, 2, IS_VOID, 0)
     ZEND_ARG_TYPE_INFO(0, abstract, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO(0, instance, IS_OBJECT, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_lazy, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, abstract, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, concrete, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_resolve_lazy, 0, 1, IS_OBJECT, 0)
+    ZEND_ARG_TYPE_MASK(0, target, MAY_BE_OBJECT|MAY_BE_STRING, NULL)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_make, 0, 1, IS_MIXED, 0)
     ZEND_ARG_TYPE_INFO(0, abstract, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, parameters, IS_ARRAY, 0, "[]")
@@ -191,10 +253,26 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_tagged, 0, 1, IS_ARRAY
     ZEND_ARG_TYPE_INFO(0, tag, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(arginfo_container_lazy_tagged, 0, 1, Signalforge\\Container\\TaggedIterator, 0)
+    ZEND_ARG_TYPE_INFO(0, tag, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_make_many, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, abstracts, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(arginfo_container_when, 0, 1, Signalforge\\Container\\ContextualBuilder, 0)
     ZEND_ARG_TYPE_INFO(0, concrete, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_register, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, manifest, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_load_manifest, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, path, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_flush, 0, 0, IS_VOID, 0)
 ZEND_END_ARG_INFO()
 
@@ -205,6 +283,11 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_forget_instances, 0, 0, IS_VOID, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_begin_scope, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_container_end_scope arginfo_container_begin_scope
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_compile, 0, 0, IS_LONG, 0)
 ZEND_END_ARG_INFO()
 
@@ -214,6 +297,10 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_clear_compiled, 0, 0, IS_VOID, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_warmup, 0, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_MASK(0, classes, MAY_BE_ARRAY|MAY_BE_STRING, NULL)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_get_bindings, 0, 0, IS_ARRAY, 0)
 ZEND_END_ARG_INFO()
 
@@ -221,10 +308,27 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_get_metadata, 0, 1, IS
     ZEND_ARG_TYPE_INFO(0, className, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_stats, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_reset_stats, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_trace, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_reset_trace, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_container_graph, 0, 0, MAY_BE_ARRAY|MAY_BE_STRING)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, format, IS_STRING, 0, "\"array\"")
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_dump, 0, 1, _IS_BOOL, 0)
     ZEND_ARG_TYPE_INFO(0, path, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, className, IS_STRING, 0, "\"CompiledContainer\"")
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, namespace, IS_STRING, 0, "\"\"")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, eager, _IS_BOOL, 0, "false")
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_load_compiled, 0, 1, _IS_BOOL, 0)
@@ -237,12 +341,23 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_has_compiled, 0, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_is_warm, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_clear_cache, 0, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_get_cache_path, 0, 0, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_snapshot, 0, 0, _IS_BOOL, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, path, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_container_defer_snapshot, 0, 0, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, path, IS_STRING, 1, "null")
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(arginfo_contextual_builder_needs, 0, 1, Signalforge\\Container\\ContextualBuilder, 0)
     ZEND_ARG_TYPE_INFO(0, abstract, IS_STRING, 0)
 ZEND_END_ARG_INFO()
@@ -251,12 +366,41 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_contextual_builder_give, 0, 1, I
     ZEND_ARG_TYPE_INFO(0, implementation, IS_MIXED, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_tagged_iterator_current, 0, 0, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_tagged_iterator_key arginfo_tagged_iterator_current
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_tagged_iterator_next, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_tagged_iterator_rewind arginfo_tagged_iterator_next
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_tagged_iterator_valid, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_tagged_iterator_count, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+/* Attribute constructors */
+ZEND_BEGIN_ARG_INFO_EX(arginfo_attribute_bind_construct, 0, 0, 1)
+    ZEND_ARG_TYPE_INFO(0, concrete, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_attribute_inject_construct, 0, 0, 1)
+    ZEND_ARG_TYPE_INFO(0, id, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_attribute_tag_construct, 0, 0, 1)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
 /* ============================================================================
  * Container Methods
  * ============================================================================ */
 
 /*
- * Shared implementation for bind() and singleton() - they only differ by scope.
+ * Shared implementation for bind(), singleton() and scoped() - they only differ by scope.
  * Using INTERNAL_FUNCTION_PARAM_PASSTHRU avoids duplicating parameter parsing.
  */
 static void sf_do_bind(INTERNAL_FUNCTION_PARAMETERS, uint8_t scope)
@@ -304,6 +448,12 @@ PHP_METHOD(Container, singleton)
     sf_do_bind(INTERNAL_FUNCTION_PARAM_PASSTHRU, SF_SCOPE_SINGLETON);
 }
 
+/* Container::scoped() - one instance per beginScope()/endScope() scope */
+PHP_METHOD(Container, scoped)
+{
+    sf_do_bind(INTERNAL_FUNCTION_PARAM_PASSTHRU, SF_SCOPE_SCOPED);
+}
+
 /* Container::instance() - store an already-constructed object */
 PHP_METHOD(Container, instance)
 {
@@ -318,6 +468,38 @@ PHP_METHOD(Container, instance)
     sf_container_instance(sf_get_global_container(), abstract, instance);
 }
 
+/* Container::lazy() - singleton that is only built when first used */
+PHP_METHOD(Container, lazy)
+{
+    zend_string *abstract;
+    zend_string *concrete = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_STR(abstract)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_STR_OR_NULL(concrete)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_container_lazy(sf_get_global_container(), abstract, concrete ? concrete : abstract);
+}
+
+/*
+ * Container::resolveLazy() - private initializer behind lazy proxies.
+ * Only ever called through the closure the proxies hold (see lazy.c).
+ */
+PHP_METHOD(Container, resolveLazy)
+{
+    zval *target;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ZVAL(target)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (sf_lazy_initialize(sf_get_global_container(), target, return_value) == FAILURE && !EG(exception)) {
+        zend_throw_exception(sf_container_exception_ce, "Unable to initialize lazy service", 0);
+    }
+}
+
 /*
  * Container::make() - the core resolution method.
  * Resolves an abstract to a concrete instance, autowiring dependencies.
@@ -333,6 +515,14 @@ PHP_METHOD(Container, make)
         Z_PARAM_ARRAY_HT(parameters)
     ZEND_PARSE_PARAMETERS_END();
     
+    /* Without parameters, repeat calls are served from the call site's slot */
+    if (EXPECTED(!parameters) || zend_hash_num_elements(parameters) == 0) {
+        if (sf_call_site_make(sf_get_global_container(), execute_data, abstract, return_value) == FAILURE) {
+            RETURN_NULL();
+        }
+        return;
+    }
+    
     if (sf_container_make(sf_get_global_container(), abstract, parameters, return_value, NULL) == FAILURE) {
         RETURN_NULL();
     }
@@ -347,7 +537,7 @@ PHP_METHOD(Container, get)
         Z_PARAM_STR(id)
     ZEND_PARSE_PARAMETERS_END();
     
-    if (sf_container_make(sf_get_global_container(), id, NULL, return_value, NULL) == FAILURE) {
+    if (sf_call_site_make(sf_get_global_container(), execute_data, id, return_value) == FAILURE) {
         RETURN_NULL();
     }
 }
@@ -424,7 +614,44 @@ PHP_METHOD(Container, tagged)
         Z_PARAM_STR(tag)
     ZEND_PARSE_PARAMETERS_END();
     
-    sf_container_tagged(sf_get_global_container(), tag, return_value);
+    if (sf_container_tagged(sf_get_global_container(), tag, return_value) == FAILURE) {
+        RETURN_NULL();
+    }
+}
+
+/* Container::lazyTagged() - iterate a tag, resolving each member when reached */
+PHP_METHOD(Container, lazyTagged)
+{
+    zend_string *tag;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(tag)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_container *c = sf_get_global_container();
+    
+    object_init_ex(return_value, sf_tagged_iterator_ce);
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(return_value);
+    
+    /* The iterator keeps the tag alive, so flush() mid-loop can't free it */
+    iterator->tag = sf_container_find_tag(c, tag);
+    sf_tag_addref(iterator->tag);
+    iterator->container = c;
+    sf_container_addref(c);
+}
+
+/* Container::makeMany() - resolve a list of abstracts in one call, keeping keys */
+PHP_METHOD(Container, makeMany)
+{
+    HashTable *abstracts;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY_HT(abstracts)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (sf_container_make_many(sf_get_global_container(), abstracts, return_value) == FAILURE) {
+        RETURN_NULL();
+    }
 }
 
 /*
@@ -449,6 +676,79 @@ PHP_METHOD(Container, when)
     sf_container_addref(builder->container);
 }
 
+/*
+ * Compile and run a PHP file like include, leaving its return value in
+ * `result`. With opcache the script comes from shared memory, and a returned
+ * array literal is the immutable cached array itself. Returns FAILURE if the
+ * file can't be compiled or throws (`result` is UNDEF then).
+ */
+static int sf_include_file(zend_string *path, zval *result)
+{
+    zend_file_handle file_handle;
+    zend_stream_init_filename(&file_handle, ZSTR_VAL(path));
+    
+    zend_op_array *op_array = zend_compile_file(&file_handle, ZEND_INCLUDE);
+    zend_destroy_file_handle(&file_handle);
+    
+    ZVAL_UNDEF(result);
+    if (!op_array) {
+        return FAILURE;
+    }
+    
+    zend_execute(op_array, result);
+    destroy_op_array(op_array);
+    efree(op_array);
+    
+    if (EG(exception)) {
+        zval_ptr_dtor(result);
+        ZVAL_UNDEF(result);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* Container::register() - apply a whole bindings manifest in one call */
+PHP_METHOD(Container, register)
+{
+    HashTable *manifest;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY_HT(manifest)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_manifest_register(sf_get_global_container(), manifest);
+}
+
+/* Container::loadManifest() - register() the array a PHP file returns */
+PHP_METHOD(Container, loadManifest)
+{
+    zend_string *path;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_PATH_STR(path)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (access(ZSTR_VAL(path), F_OK) != 0) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0, "Manifest file not found: %s", ZSTR_VAL(path));
+        return;
+    }
+    
+    zval result;
+    if (sf_include_file(path, &result) == FAILURE) {
+        if (!EG(exception)) {
+            zend_throw_exception_ex(sf_container_exception_ce, 0, "Failed to compile manifest file: %s", ZSTR_VAL(path));
+        }
+        return;
+    }
+    
+    if (Z_TYPE(result) != IS_ARRAY) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0, "%s does not return a manifest array", ZSTR_VAL(path));
+    } else {
+        sf_manifest_register(sf_get_global_container(), Z_ARRVAL(result));
+    }
+    zval_ptr_dtor(&result);
+}
+
 /* Container::flush() - clear all bindings and cached instances */
 PHP_METHOD(Container, flush)
 {
@@ -475,6 +775,20 @@ PHP_METHOD(Container, forgetInstances)
     sf_container_forget_instances(sf_get_global_container());
 }
 
+/* Container::beginScope() - open a child scope for scoped services */
+PHP_METHOD(Container, beginScope)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_container_begin_scope(sf_get_global_container());
+}
+
+/* Container::endScope() - close the innermost scope, releasing its instances */
+PHP_METHOD(Container, endScope)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_container_end_scope(sf_get_global_container());
+}
+
 /* Container::compile() - compile all bindings for faster resolution */
 PHP_METHOD(Container, compile)
 {
@@ -498,6 +812,27 @@ PHP_METHOD(Container, clearCompiled)
     sf_container_clear_compiled(sf_get_global_container());
 }
 
+/*
+ * Container::warmup() - build metadata and plans before the first make()
+ * Takes a list of class names, or a prefix every loaded user class under it
+ * matches. From an opcache.preload script, the result outlives the request.
+ */
+PHP_METHOD(Container, warmup)
+{
+    HashTable *classes;
+    zend_string *prefix;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY_HT_OR_STR(classes, prefix)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    zend_long warmed = sf_preload_warmup(sf_get_global_container(), classes, prefix);
+    if (warmed < 0) {
+        RETURN_NULL();
+    }
+    RETURN_LONG(warmed);
+}
+
 /* Container::getBindings() - export all bindings for code generation */
 PHP_METHOD(Container, getBindings)
 {
@@ -516,24 +851,30 @@ PHP_METHOD(Container, getBindings)
         array_init(&binding_info);
         
         /* abstract */
-        add_assoc_str(&binding_info, "abstract", zend_string_copy(binding->abstract));
+        add_assoc_str(&binding_info, "abstract", sf_string_export(binding->abstract));
         
         /* concrete - could be string, closure, or object */
-        zval concrete_copy;
-        ZVAL_COPY(&concrete_copy, &binding->concrete);
-        add_assoc_zval(&binding_info, "concrete", &concrete_copy);
+        if (Z_TYPE(binding->concrete) == IS_STRING) {
+            add_assoc_str(&binding_info, "concrete", sf_string_export(Z_STR(binding->concrete)));
+        } else {
+            zval concrete_copy;
+            ZVAL_COPY(&concrete_copy, &binding->concrete);
+            add_assoc_zval(&binding_info, "concrete", &concrete_copy);
+        }
         
         /* scope */
         const char *scope_str;
         switch (binding->scope) {
             case SF_SCOPE_SINGLETON: scope_str = "singleton"; break;
             case SF_SCOPE_INSTANCE: scope_str = "instance"; break;
+            case SF_SCOPE_SCOPED: scope_str = "scoped"; break;
             default: scope_str = "transient"; break;
         }
         add_assoc_string(&binding_info, "scope", scope_str);
+        add_assoc_bool(&binding_info, "lazy", binding->lazy);
         
         /* resolved */
-        add_assoc_bool(&binding_info, "resolved", binding->resolved);
+        add_assoc_bool(&binding_info, "resolved", sf_container_resolved(c, key));
         
         add_assoc_zval(return_value, ZSTR_VAL(key), &binding_info);
     } ZEND_HASH_FOREACH_END();
@@ -557,13 +898,7 @@ PHP_METHOD(Container, getMetadata)
     }
     
     /* Get or build metadata */
-    sf_class_meta *meta = sf_cache_get(class_name, &c->reflection_cache);
-    if (!meta) {
-        meta = sf_cache_build(class_name, ce);
-        if (meta) {
-            sf_cache_put(class_name, meta, &c->reflection_cache);
-        }
-    }
+    sf_class_meta *meta = sf_container_get_meta(c, class_name, ce);
     
     if (!meta) {
         RETURN_NULL();
@@ -571,36 +906,41 @@ PHP_METHOD(Container, getMetadata)
     
     array_init(return_value);
     
-    add_assoc_str(return_value, "class", zend_string_copy(meta->class_name));
+    add_assoc_str(return_value, "class", sf_string_export(meta->class_name));
     add_assoc_bool(return_value, "instantiable", meta->is_instantiable);
     add_assoc_long(return_value, "paramCount", meta->param_count);
+    add_assoc_bool(return_value, "singleton", (meta->attributes & SF_ATTR_SINGLETON) != 0);
+    if (meta->bind_to) {
+        add_assoc_str(return_value, "bind", sf_string_export(meta->bind_to));
+    } else {
+        add_assoc_null(return_value, "bind");
+    }
     
     /* Parameters */
     zval params_arr;
     array_init(&params_arr);
     
     for (uint32_t i = 0; i < meta->param_count; i++) {
-        sf_param_info *param = &meta->params[i];
+        uint8_t flags = meta->param_flags[i];
         
         zval param_info;
         array_init(&param_info);
         
-        add_assoc_str(&param_info, "name", zend_string_copy(param->name));
+        add_assoc_str(&param_info, "name", sf_string_export(meta->param_names[i]));
         
-        if (param->type_hint) {
-            add_assoc_str(&param_info, "type", zend_string_copy(param->type_hint));
+        if (meta->param_types[i]) {
+            add_assoc_str(&param_info, "type", sf_string_export(meta->param_types[i]));
         } else {
             add_assoc_null(&param_info, "type");
         }
         
-        add_assoc_bool(&param_info, "nullable", param->is_nullable);
-        add_assoc_bool(&param_info, "hasDefault", param->has_default);
-        add_assoc_bool(&param_info, "variadic", param->is_variadic);
-        
-        if (param->has_default) {
-            zval default_copy;
-            ZVAL_COPY(&default_copy, &param->default_value);
-            add_assoc_zval(&param_info, "default", &default_copy);
+        add_assoc_bool(&param_info, "nullable", (flags & SF_PARAM_NULLABLE) != 0);
+        add_assoc_bool(&param_info, "hasDefault", (flags & SF_PARAM_DEFAULT) != 0);
+        add_assoc_bool(&param_info, "variadic", (flags & SF_PARAM_VARIADIC) != 0);
+        if (meta->param_injects && meta->param_injects[i]) {
+            add_assoc_str(&param_info, "inject", sf_string_export(meta->param_injects[i]));
+        } else {
+            add_assoc_null(&param_info, "inject");
         }
         
         add_next_index_zval(&params_arr, &param_info);
@@ -609,7 +949,65 @@ PHP_METHOD(Container, getMetadata)
     add_assoc_zval(return_value, "params", &params_arr);
 }
 
-/* Container::dump() - generate compiled container PHP file */
+/* Container::stats() - resolution counters for the current request */
+PHP_METHOD(Container, stats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_stats_export(sf_get_global_container(), return_value);
+}
+
+/* Container::resetStats() - zero the counters (they also start at zero every request) */
+PHP_METHOD(Container, resetStats)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_stats_reset(sf_get_global_container());
+}
+
+/* Container::trace() - recorded resolutions as Chrome trace events (see src/trace.c) */
+PHP_METHOD(Container, trace)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_trace_export(return_value);
+}
+
+/* Container::resetTrace() - drop the recorded resolutions (they also start empty every request) */
+PHP_METHOD(Container, resetTrace)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    sf_trace_reset();
+}
+
+/* Container::graph() - static dependency graph as an array or Graphviz DOT (see src/graph.c) */
+PHP_METHOD(Container, graph)
+{
+    zend_string *format = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_STR(format)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    zend_bool dot = format && zend_string_equals_literal_ci(format, "dot");
+    if (format && !dot && !zend_string_equals_literal_ci(format, "array")) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "Unknown graph format '%s' (expected 'array' or 'dot')", ZSTR_VAL(format));
+        RETURN_NULL();
+    }
+    
+    zval graph;
+    if (sf_graph_export(sf_get_global_container(), &graph) == FAILURE) {
+        RETURN_NULL();
+    }
+    
+    if (dot) {
+        RETVAL_STR(sf_graph_dot(&graph));
+        zval_ptr_dtor(&graph);
+        return;
+    }
+    RETURN_COPY_VALUE(&graph);
+}
+
+/* Container::dump() - write the graph as a compiled PHP container (see src/dumper.c) */
 PHP_METHOD(Container, dump)
 {
     zend_string *path;
@@ -618,84 +1016,33 @@ PHP_METHOD(Container, dump)
     zend_bool eager = 0;
     
     ZEND_PARSE_PARAMETERS_START(1, 4)
-        Z_PARAM_STR(path)
+        Z_PARAM_PATH_STR(path)
         Z_PARAM_OPTIONAL
         Z_PARAM_STR(class_name)
         Z_PARAM_STR(namespace)
         Z_PARAM_BOOL(eager)
     ZEND_PARSE_PARAMETERS_END();
     
-    /* Default values */
     if (!class_name) {
         class_name = zend_string_init("CompiledContainer", sizeof("CompiledContainer") - 1, 0);
     } else {
         zend_string_addref(class_name);
     }
-    if (!namespace) {
-        namespace = zend_string_init("", 0, 0);
-    } else {
-        zend_string_addref(namespace);
-    }
-    
-    /* Look up ContainerDumper class */
-    zend_string *dumper_class_name = zend_string_init("Signalforge\\Container\\ContainerDumper", sizeof("Signalforge\\Container\\ContainerDumper") - 1, 0);
-    zend_class_entry *dumper_ce = zend_lookup_class(dumper_class_name);
-    zend_string_release(dumper_class_name);
-    
-    if (!dumper_ce) {
-        zend_string_release(class_name);
-        zend_string_release(namespace);
-        zend_throw_exception(sf_container_exception_ce, "ContainerDumper class not found. Make sure to include the container-php package.", 0);
-        RETURN_FALSE;
-    }
     
-    /* Create dumper instance */
-    zval dumper;
-    object_init_ex(&dumper, dumper_ce);
-    
-    /* Call dumpToFile method using zend_call_function */
-    zval retval;
-    zval args[4];
-    ZVAL_STR(&args[0], path);
-    ZVAL_STR(&args[1], class_name);
-    ZVAL_STR(&args[2], namespace);
-    ZVAL_BOOL(&args[3], eager);
-    
-    zend_fcall_info fci = {0};
-    zend_fcall_info_cache fcc = {0};
-    
-    fci.size = sizeof(fci);
-    ZVAL_STRING(&fci.function_name, "dumpToFile");
-    fci.object = Z_OBJ(dumper);
-    fci.retval = &retval;
-    fci.params = args;
-    fci.param_count = 4;
-    
-    fcc.function_handler = zend_hash_str_find_ptr(&dumper_ce->function_table, "dumptofile", sizeof("dumptofile") - 1);
-    fcc.called_scope = dumper_ce;
-    fcc.object = Z_OBJ(dumper);
-    
-    zend_call_function(&fci, &fcc);
-    
-    zval_ptr_dtor(&fci.function_name);
-    zval_ptr_dtor(&dumper);
+    int count = sf_dumper_dump(sf_get_global_container(), ZSTR_VAL(path), class_name,
+        namespace ? namespace : ZSTR_EMPTY_ALLOC(), eager);
     zend_string_release(class_name);
-    zend_string_release(namespace);
-    
-    if (EG(exception)) {
-        RETURN_FALSE;
-    }
     
-    RETURN_BOOL(Z_TYPE(retval) == IS_TRUE || (Z_TYPE(retval) == IS_LONG && Z_LVAL(retval)));
+    RETURN_BOOL(count >= 0);
 }
 
-/* Container::loadCompiled() - load and activate a compiled container */
+/* Container::loadCompiled() - bind the services of a dumped container */
 PHP_METHOD(Container, loadCompiled)
 {
     zend_string *path;
     
     ZEND_PARSE_PARAMETERS_START(1, 1)
-        Z_PARAM_STR(path)
+        Z_PARAM_PATH_STR(path)
     ZEND_PARSE_PARAMETERS_END();
     
     /* Check if file exists */
@@ -704,97 +1051,58 @@ PHP_METHOD(Container, loadCompiled)
         RETURN_FALSE;
     }
     
-    /* Include the file to load the class */
-    zend_file_handle file_handle;
-    zend_stream_init_filename(&file_handle, ZSTR_VAL(path));
-    
-    zend_op_array *op_array = zend_compile_file(&file_handle, ZEND_INCLUDE);
-    zend_destroy_file_handle(&file_handle);
-    
-    if (!op_array) {
-        zend_throw_exception_ex(sf_container_exception_ce, 0, "Failed to compile container file: %s", ZSTR_VAL(path));
+    /* Include the file to load the class - a dumped container returns its class name */
+    zval result;
+    if (sf_include_file(path, &result) == FAILURE) {
+        if (!EG(exception)) {
+            zend_throw_exception_ex(sf_container_exception_ce, 0, "Failed to compile container file: %s", ZSTR_VAL(path));
+        }
         RETURN_FALSE;
     }
     
-    /* Execute the included file */
-    zval result;
-    ZVAL_UNDEF(&result);
-    zend_execute(op_array, &result);
+    zend_class_entry *compiled_ce = Z_TYPE(result) == IS_STRING
+        ? zend_lookup_class_ex(Z_STR(result), NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD) : NULL;
     zval_ptr_dtor(&result);
-    destroy_op_array(op_array);
-    efree(op_array);
     
-    if (EG(exception)) {
+    if (!compiled_ce) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "%s does not return the name of a compiled container class", ZSTR_VAL(path));
         RETURN_FALSE;
     }
     
-    /* Look for CompiledContainer class (or namespaced version) */
-    zend_class_entry *compiled_ce = NULL;
-    
-    /* Try common names */
-    const char *class_names[] = {
-        "CompiledContainer",
-        "Signalforge\\Container\\CompiledContainer",
-        NULL
-    };
-    
-    for (int i = 0; class_names[i] != NULL; i++) {
-        zend_string *cn = zend_string_init(class_names[i], strlen(class_names[i]), 0);
-        compiled_ce = zend_lookup_class(cn);
-        zend_string_release(cn);
-        
-        if (compiled_ce) {
-            /* Make sure it's not the base class */
-            zend_string *base_name = zend_string_init("Signalforge\\Container\\CompiledContainer", sizeof("Signalforge\\Container\\CompiledContainer") - 1, 0);
-            zend_class_entry *base_ce = zend_lookup_class(base_name);
-            zend_string_release(base_name);
-            
-            if (compiled_ce != base_ce) {
-                break;
-            }
-            compiled_ce = NULL;
-        }
+    /* Clean up previous compiled container if any */
+    sf_container *c = sf_get_global_container();
+    zval *compiled = &SF_CONTAINER_G(compiled_container);
+    if (!Z_ISUNDEF_P(compiled)) {
+        sf_dumper_unload(c, compiled);
+        zval_ptr_dtor(compiled);
+        ZVAL_UNDEF(compiled);
     }
     
-    if (!compiled_ce) {
-        zend_throw_exception(sf_container_exception_ce, "No CompiledContainer class found in the loaded file", 0);
+    /* Bind its methods, then construct it (eager dumps build their singletons there) */
+    object_init_ex(compiled, compiled_ce);
+    if (sf_dumper_load(c, compiled) == FAILURE) {
+        zval_ptr_dtor(compiled);
+        ZVAL_UNDEF(compiled);
         RETURN_FALSE;
     }
-    
-    /* Clean up previous compiled container if any */
-    if (sf_compiled_container_active) {
-        zval_ptr_dtor(&sf_compiled_container);
-        sf_compiled_container_active = 0;
+    if (compiled_ce->constructor) {
+        zend_call_known_instance_method_with_0_params(compiled_ce->constructor, Z_OBJ_P(compiled), NULL);
     }
     
-    /* Create instance of compiled container */
-    object_init_ex(&sf_compiled_container, compiled_ce);
-    
-    /* Call activate() method */
-    zval activate_ret;
-    zend_call_method_with_0_params(Z_OBJ(sf_compiled_container), compiled_ce, NULL, "activate", &activate_ret);
-    zval_ptr_dtor(&activate_ret);
-    
-    sf_compiled_container_active = 1;
-    
-    RETURN_TRUE;
+    RETURN_BOOL(!EG(exception));
 }
 
-/* Container::unloadCompiled() - deactivate and unload compiled container */
+/* Container::unloadCompiled() - give the compiled services their class bindings back */
 PHP_METHOD(Container, unloadCompiled)
 {
     ZEND_PARSE_PARAMETERS_NONE();
     
-    if (sf_compiled_container_active) {
-        /* Call deactivate() method */
-        zend_class_entry *ce = Z_OBJCE(sf_compiled_container);
-        zval deactivate_ret;
-        zend_call_method_with_0_params(Z_OBJ(sf_compiled_container), ce, NULL, "deactivate", &deactivate_ret);
-        zval_ptr_dtor(&deactivate_ret);
-        
-        zval_ptr_dtor(&sf_compiled_container);
-        ZVAL_UNDEF(&sf_compiled_container);
-        sf_compiled_container_active = 0;
+    zval *compiled = &SF_CONTAINER_G(compiled_container);
+    if (!Z_ISUNDEF_P(compiled)) {
+        sf_dumper_unload(sf_get_global_container(), compiled);
+        zval_ptr_dtor(compiled);
+        ZVAL_UNDEF(compiled);
     }
 }
 
@@ -802,7 +1110,14 @@ PHP_METHOD(Container, unloadCompiled)
 PHP_METHOD(Container, hasCompiled)
 {
     ZEND_PARSE_PARAMETERS_NONE();
-    RETURN_BOOL(sf_compiled_container_active);
+    RETURN_BOOL(!Z_ISUNDEF(SF_CONTAINER_G(compiled_container)));
+}
+
+/* Container::isWarm() - did this request inherit bindings from a previous one? */
+PHP_METHOD(Container, isWarm)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    RETURN_BOOL(sf_get_global_container()->warm);
 }
 
 PHP_METHOD(Container, clearCache)
@@ -823,6 +1138,45 @@ PHP_METHOD(Container, getCachePath)
     RETURN_STR(path);
 }
 
+/* Container::saveSnapshot() - write bindings, metadata and compiled plans to a file */
+PHP_METHOD(Container, saveSnapshot)
+{
+    zend_string *path = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_PATH_STR_OR_NULL(path)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    RETURN_BOOL(sf_container_save_cache(sf_get_global_container(), path ? ZSTR_VAL(path) : NULL) == SUCCESS);
+}
+
+/* Container::loadSnapshot() - import a snapshot; false if it's missing or stale */
+PHP_METHOD(Container, loadSnapshot)
+{
+    zend_string *path = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_PATH_STR_OR_NULL(path)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    RETURN_BOOL(sf_container_load_cache(sf_get_global_container(), path ? ZSTR_VAL(path) : NULL) == SUCCESS);
+}
+
+/* Container::deferSnapshot() - save at request shutdown unless a current snapshot exists */
+PHP_METHOD(Container, deferSnapshot)
+{
+    zend_string *path = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_PATH_STR_OR_NULL(path)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_container_defer_cache(sf_get_global_container(), path ? ZSTR_VAL(path) : NULL);
+}
+
 /* ============================================================================
  * ContextualBuilder Methods
  * 
@@ -872,6 +1226,137 @@ PHP_METHOD(ContextualBuilder, give)
     sf_container_add_contextual_binding(builder->container, builder->concrete, builder->abstract, implementation);
 }
 
+/* ============================================================================
+ * TaggedIterator Methods
+ *
+ * Iterator + Countable over a tag's members. Each member is resolved the
+ * first time current() reaches it; breaking out of the loop early leaves
+ * the rest unbuilt.
+ * ============================================================================ */
+
+static zend_always_inline zend_bool sf_tagged_iterator_valid(sf_tagged_iterator_object *iterator)
+{
+    return iterator->tag && iterator->position < iterator->tag->count;
+}
+
+/* TaggedIterator::current() - the member at the current position */
+PHP_METHOD(TaggedIterator, current)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS);
+    if (!sf_tagged_iterator_valid(iterator)) {
+        RETURN_NULL();
+    }
+    
+    if (Z_ISUNDEF(iterator->current)
+        && sf_tag_make(iterator->container, iterator->tag, iterator->position, &iterator->current) == FAILURE) {
+        ZVAL_UNDEF(&iterator->current);
+        RETURN_NULL();
+    }
+    
+    RETURN_COPY(&iterator->current);
+}
+
+/* TaggedIterator::key() - position of the current member */
+PHP_METHOD(TaggedIterator, key)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS);
+    if (!sf_tagged_iterator_valid(iterator)) {
+        RETURN_NULL();
+    }
+    RETURN_LONG(iterator->position);
+}
+
+/* TaggedIterator::next() - move to the next member */
+PHP_METHOD(TaggedIterator, next)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS);
+    zval_ptr_dtor(&iterator->current);
+    ZVAL_UNDEF(&iterator->current);
+    iterator->position++;
+}
+
+/* TaggedIterator::rewind() - back to the first member */
+PHP_METHOD(TaggedIterator, rewind)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS);
+    zval_ptr_dtor(&iterator->current);
+    ZVAL_UNDEF(&iterator->current);
+    iterator->position = 0;
+}
+
+/* TaggedIterator::valid() - is there a member at the current position? */
+PHP_METHOD(TaggedIterator, valid)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    RETURN_BOOL(sf_tagged_iterator_valid(Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS)));
+}
+
+/* TaggedIterator::count() - number of members, without resolving any */
+PHP_METHOD(TaggedIterator, count)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+    
+    sf_tagged_iterator_object *iterator = Z_TAGGED_ITERATOR_OBJ_P(ZEND_THIS);
+    RETURN_LONG(iterator->tag ? iterator->tag->count : 0);
+}
+
+/* ============================================================================
+ * Attribute Methods
+ *
+ * The container reads its attributes straight from the class entry (see
+ * src/reflection_cache.c); these constructors only serve Reflection's
+ * newInstance(). Each stores its argument in the class's readonly property.
+ * ============================================================================ */
+
+static void sf_attribute_store(zval *object, const char *property, size_t len, zend_string *value)
+{
+    zend_update_property_str(Z_OBJCE_P(object), Z_OBJ_P(object), property, len, value);
+}
+
+/* Bind::__construct() - the implementation the class or interface resolves to */
+PHP_METHOD(Bind, __construct)
+{
+    zend_string *concrete;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(concrete)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_attribute_store(ZEND_THIS, ZEND_STRL("concrete"), concrete);
+}
+
+/* Inject::__construct() - the container key the parameter is resolved by */
+PHP_METHOD(Inject, __construct)
+{
+    zend_string *id;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(id)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_attribute_store(ZEND_THIS, ZEND_STRL("id"), id);
+}
+
+/* Tag::__construct() - the tag the class is a member of */
+PHP_METHOD(Tag, __construct)
+{
+    zend_string *name;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    sf_attribute_store(ZEND_THIS, ZEND_STRL("name"), name);
+}
+
 /* ============================================================================
  * Method Registration Tables
  * 
@@ -882,8 +1367,11 @@ PHP_METHOD(ContextualBuilder, give)
 static const zend_function_entry sf_container_methods[] = {
     PHP_ME(Container, bind, arginfo_container_bind, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, singleton, arginfo_container_singleton, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, scoped, arginfo_container_scoped, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, instance, arginfo_container_instance, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, lazy, arginfo_container_lazy, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, make, arginfo_container_make, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, makeMany, arginfo_container_make_many, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, get, arginfo_container_get, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, has, arginfo_container_has, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, bound, arginfo_container_bound, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
@@ -891,21 +1379,37 @@ static const zend_function_entry sf_container_methods[] = {
     PHP_ME(Container, alias, arginfo_container_alias, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, tag, arginfo_container_tag, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, tagged, arginfo_container_tagged, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, lazyTagged, arginfo_container_lazy_tagged, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, when, arginfo_container_when, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, register, arginfo_container_register, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, loadManifest, arginfo_container_load_manifest, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, flush, arginfo_container_flush, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, forgetInstance, arginfo_container_forget_instance, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, forgetInstances, arginfo_container_forget_instances, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, beginScope, arginfo_container_begin_scope, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, endScope, arginfo_container_end_scope, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, compile, arginfo_container_compile, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, isCompiled, arginfo_container_is_compiled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, clearCompiled, arginfo_container_clear_compiled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, warmup, arginfo_container_warmup, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, getBindings, arginfo_container_get_bindings, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, getMetadata, arginfo_container_get_metadata, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, stats, arginfo_container_stats, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, resetStats, arginfo_container_reset_stats, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, trace, arginfo_container_trace, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, resetTrace, arginfo_container_reset_trace, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, graph, arginfo_container_graph, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, dump, arginfo_container_dump, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, loadCompiled, arginfo_container_load_compiled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, unloadCompiled, arginfo_container_unload_compiled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, hasCompiled, arginfo_container_has_compiled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, isWarm, arginfo_container_is_warm, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, clearCache, arginfo_container_clear_cache, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Container, getCachePath, arginfo_container_get_cache_path, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, saveSnapshot, arginfo_container_snapshot, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, loadSnapshot, arginfo_container_snapshot, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, deferSnapshot, arginfo_container_defer_snapshot, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Container, resolveLazy, arginfo_container_resolve_lazy, ZEND_ACC_PRIVATE | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
@@ -915,12 +1419,38 @@ static const zend_function_entry sf_contextual_builder_methods[] = {
     PHP_FE_END
 };
 
+static const zend_function_entry sf_tagged_iterator_methods[] = {
+    PHP_ME(TaggedIterator, current, arginfo_tagged_iterator_current, ZEND_ACC_PUBLIC)
+    PHP_ME(TaggedIterator, key, arginfo_tagged_iterator_key, ZEND_ACC_PUBLIC)
+    PHP_ME(TaggedIterator, next, arginfo_tagged_iterator_next, ZEND_ACC_PUBLIC)
+    PHP_ME(TaggedIterator, rewind, arginfo_tagged_iterator_rewind, ZEND_ACC_PUBLIC)
+    PHP_ME(TaggedIterator, valid, arginfo_tagged_iterator_valid, ZEND_ACC_PUBLIC)
+    PHP_ME(TaggedIterator, count, arginfo_tagged_iterator_count, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+static const zend_function_entry sf_bind_attribute_methods[] = {
+    PHP_ME(Bind, __construct, arginfo_attribute_bind_construct, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+static const zend_function_entry sf_inject_attribute_methods[] = {
+    PHP_ME(Inject, __construct, arginfo_attribute_inject_construct, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+static const zend_function_entry sf_tag_attribute_methods[] = {
+    PHP_ME(Tag, __construct, arginfo_attribute_tag_construct, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
 /* ============================================================================
  * Class Registration
  * 
  * Called once at module init to register our classes with PHP.
  * Exception hierarchy: ContainerException -> NotFoundException
  *                                         -> CircularDependencyException
+ * Attributes: Signalforge\Container\Attributes\{Singleton, Bind, Inject, Tag}
  * ============================================================================ */
 
 void sf_register_exception_classes(void)
@@ -966,6 +1496,116 @@ void sf_register_contextual_builder_class(void)
     sf_contextual_builder_object_handlers.free_obj = sf_contextual_builder_object_free;
 }
 
+/*
+ * A final attribute class for `targets`, with one readonly string property
+ * (NULL = none) set by its constructor.
+ */
+static zend_class_entry *sf_register_attribute_class(zend_class_entry *ce, uint32_t targets, const char *property)
+{
+    zend_class_entry *class_entry = zend_register_internal_class(ce);
+    class_entry->ce_flags |= ZEND_ACC_FINAL;
+    
+    /* #[Attribute(targets)] */
+    zend_string *attribute_name = zend_string_init_interned("Attribute", sizeof("Attribute") - 1, 1);
+    zend_attribute *attribute = zend_add_class_attribute(class_entry, attribute_name, 1);
+    zend_string_release(attribute_name);
+    ZVAL_LONG(&attribute->args[0].value, targets);
+    zend_mark_internal_attribute(class_entry);
+    
+    if (property) {
+        zval undef;
+        ZVAL_UNDEF(&undef);
+        zend_string *name = zend_string_init_interned(property, strlen(property), 1);
+        zend_declare_typed_property(class_entry, name, &undef, ZEND_ACC_PUBLIC | ZEND_ACC_READONLY, NULL,
+            (zend_type) ZEND_TYPE_INIT_MASK(MAY_BE_STRING));
+        zend_string_release(name);
+    }
+    return class_entry;
+}
+
+void sf_register_attribute_classes(void)
+{
+    zend_class_entry ce;
+    
+    INIT_CLASS_ENTRY(ce, "Signalforge\\Container\\Attributes\\Singleton", NULL);
+    sf_singleton_attribute_ce = sf_register_attribute_class(&ce, ZEND_ATTRIBUTE_TARGET_CLASS, NULL);
+    
+    INIT_CLASS_ENTRY(ce, "Signalforge\\Container\\Attributes\\Bind", sf_bind_attribute_methods);
+    sf_bind_attribute_ce = sf_register_attribute_class(&ce, ZEND_ATTRIBUTE_TARGET_CLASS, "concrete");
+    
+    INIT_CLASS_ENTRY(ce, "Signalforge\\Container\\Attributes\\Inject", sf_inject_attribute_methods);
+    sf_inject_attribute_ce = sf_register_attribute_class(&ce, ZEND_ATTRIBUTE_TARGET_PARAMETER, "id");
+    
+    INIT_CLASS_ENTRY(ce, "Signalforge\\Container\\Attributes\\Tag", sf_tag_attribute_methods);
+    sf_tag_attribute_ce = sf_register_attribute_class(&ce, ZEND_ATTRIBUTE_TARGET_CLASS | ZEND_ATTRIBUTE_IS_REPEATABLE, "name");
+}
+
+void sf_register_tagged_iterator_class(void)
+{
+    zend_class_entry ce;
+    
+    INIT_CLASS_ENTRY(ce, "Signalforge\\Container\\TaggedIterator", sf_tagged_iterator_methods);
+    sf_tagged_iterator_ce = zend_register_internal_class(&ce);
+    sf_tagged_iterator_ce->ce_flags |= ZEND_ACC_FINAL | ZEND_ACC_NOT_SERIALIZABLE;
+    sf_tagged_iterator_ce->create_object = sf_tagged_iterator_object_create;
+    zend_class_implements(sf_tagged_iterator_ce, 2, zend_ce_iterator, zend_ce_countable);
+    
+    memcpy(&sf_tagged_iterator_object_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+    sf_tagged_iterator_object_handlers.offset = XtOffsetOf(sf_tagged_iterator_object, std);
+    sf_tagged_iterator_object_handlers.free_obj = sf_tagged_iterator_object_free;
+    sf_tagged_iterator_object_handlers.clone_obj = NULL;
+}
+
+/* ============================================================================
+ * INI Settings
+ *
+ * signalforge_container.persistent - keep bindings, aliases, tags, reflection
+ * metadata and compiled factories in worker memory between requests. Only
+ * singleton instances and the resolution stack are reset per request.
+ * System-level only: it decides where the container's memory comes from.
+ *
+ * signalforge_container.stats_timing - measure the wall time of resolutions
+ * that miss the singleton store and report it in Container::stats(). Off by
+ * default; counters are kept either way.
+ *
+ * signalforge_container.trace - record every make() that reaches the
+ * container (path, depth, requester, duration) for Container::trace(). Off by
+ * default; when off it costs one flag check per make().
+ *
+ * signalforge_container.trace_size - events the trace keeps; older ones are
+ * overwritten. Read when the first event of a request is recorded.
+ *
+ * signalforge_container.has_autoload - whether has() may autoload a name that
+ * is not bound. With 0 it answers from bindings, cached metadata and classes
+ * already declared, and never runs an autoloader.
+ *
+ * signalforge_container.compile_threshold - after this many resolutions
+ * through the regular path, a binding or autowired class gets a compiled plan
+ * as if compile() had been called for it. 0 leaves compilation to compile().
+ *
+ * signalforge_container.simd - cap on the lookup kernels picked at startup:
+ * "auto" (default) takes the widest the CPU supports, "avx512", "avx2", "sse2"
+ * (or "neon") and "scalar" stop there. System-level only: the singleton store
+ * is laid out for the kernel chosen at MINIT.
+ * ============================================================================ */
+
+PHP_INI_BEGIN()
+    STD_PHP_INI_BOOLEAN("signalforge_container.persistent", "0", PHP_INI_SYSTEM, OnUpdateBool,
+        persistent, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_BOOLEAN("signalforge_container.stats_timing", "0", PHP_INI_ALL, OnUpdateBool,
+        stats_timing, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_BOOLEAN("signalforge_container.trace", "0", PHP_INI_ALL, OnUpdateBool,
+        tracing, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_ENTRY("signalforge_container.trace_size", "4096", PHP_INI_ALL, OnUpdateLong,
+        trace_size, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_BOOLEAN("signalforge_container.has_autoload", "1", PHP_INI_ALL, OnUpdateBool,
+        has_autoload, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_ENTRY("signalforge_container.compile_threshold", "8", PHP_INI_ALL, OnUpdateLong,
+        compile_threshold, zend_signalforge_container_globals, signalforge_container_globals)
+    STD_PHP_INI_ENTRY("signalforge_container.simd", "auto", PHP_INI_SYSTEM, OnUpdateString,
+        simd, zend_signalforge_container_globals, signalforge_container_globals)
+PHP_INI_END()
+
 /* ============================================================================
  * Module Lifecycle Hooks
  * 
@@ -984,14 +1624,30 @@ static PHP_GINIT_FUNCTION(signalforge_container)
     ZEND_TSRMLS_CACHE_UPDATE();
 #endif
     signalforge_container_globals->global_container = NULL;
+    signalforge_container_globals->persistent = 0;
+    signalforge_container_globals->stats_timing = 0;
+    signalforge_container_globals->tracing = 0;
+    signalforge_container_globals->trace_size = 4096;
+    signalforge_container_globals->has_autoload = 1;
+    signalforge_container_globals->compile_threshold = 8;
+    signalforge_container_globals->simd = NULL;
+    signalforge_container_globals->autoload_epoch = 0;
+    memset(&signalforge_container_globals->stats, 0, sizeof(sf_stats));
+    memset(&signalforge_container_globals->trace, 0, sizeof(sf_trace));
+    ZVAL_UNDEF(&signalforge_container_globals->compiled_container);
+    sf_strings_acquire();
 }
 
 static PHP_GSHUTDOWN_FUNCTION(signalforge_container)
 {
+    /* Only a persistent container is still alive at this point */
     if (signalforge_container_globals->global_container) {
         sf_container_release(signalforge_container_globals->global_container);
         signalforge_container_globals->global_container = NULL;
     }
+    
+    /* Last: the graph released above may still hold shared strings */
+    sf_strings_release();
 }
 
 PHP_MINIT_FUNCTION(signalforge_container)
@@ -999,17 +1655,30 @@ PHP_MINIT_FUNCTION(signalforge_container)
 #if defined(ZTS) && defined(COMPILE_DL_SIGNALFORGE_CONTAINER)
     ZEND_TSRMLS_CACHE_UPDATE();
 #endif
-
+    
+    REGISTER_INI_ENTRIES();
+    
+    /* Before anything allocates a fast lookup table */
+    sf_simd_startup(SF_CONTAINER_G(simd));
+    
     /* Exception classes must be registered first (base before derived) */
     sf_register_exception_classes();
     sf_register_container_class();
     sf_register_contextual_builder_class();
+    sf_register_tagged_iterator_class();
+    sf_register_attribute_classes();
+    sf_lazy_startup();
+    sf_container_fiber_startup();
+    sf_container_autoload_startup();
     
     return SUCCESS;
 }
 
 PHP_MSHUTDOWN_FUNCTION(signalforge_container)
 {
+    /* Before GSHUTDOWN frees the shared strings it holds */
+    sf_preload_shutdown();
+    UNREGISTER_INI_ENTRIES();
     return SUCCESS;
 }
 
@@ -1020,7 +1689,14 @@ PHP_RINIT_FUNCTION(signalforge_container)
     ZEND_TSRMLS_CACHE_UPDATE();
 #endif
     
-    SF_CONTAINER_G(global_container) = NULL;  /* Will be created lazily */
+    if (SF_CONTAINER_G(global_container)) {
+        /* Persistent container from a previous request - give it fresh request state */
+        sf_container_request_startup(SF_CONTAINER_G(global_container));
+    }
+    /* Otherwise it will be created lazily */
+    
+    /* Statistics describe one request */
+    sf_stats_reset(SF_CONTAINER_G(global_container));
     
     return SUCCESS;
 }
@@ -1028,11 +1704,25 @@ PHP_RINIT_FUNCTION(signalforge_container)
 /* Called at end of each request - cleanup */
 PHP_RSHUTDOWN_FUNCTION(signalforge_container)
 {
-    if (SF_CONTAINER_G(global_container)) {
-        sf_container_release(SF_CONTAINER_G(global_container));
+    sf_container *c = SF_CONTAINER_G(global_container);
+    
+    /* The compiled container is a request object */
+    if (!Z_ISUNDEF(SF_CONTAINER_G(compiled_container))) {
+        zval_ptr_dtor(&SF_CONTAINER_G(compiled_container));
+        ZVAL_UNDEF(&SF_CONTAINER_G(compiled_container));
+    }
+    
+    if (c && c->persistent) {
+        /* Keep the graph, drop instances and anything bound to this request */
+        sf_container_request_shutdown(c);
+    } else if (c) {
+        sf_container_release(c);
         SF_CONTAINER_G(global_container) = NULL;
     }
     
+    /* Events hold request strings */
+    sf_trace_shutdown();
+    
     return SUCCESS;
 }
 
@@ -1041,12 +1731,36 @@ PHP_MINFO_FUNCTION(signalforge_container)
     php_info_print_table_start();
     php_info_print_table_header(2, "signalforge_container support", "enabled");
     php_info_print_table_row(2, "Version", PHP_SIGNALFORGE_CONTAINER_VERSION);
+    php_info_print_table_row(2, "Persistent mode", SF_CONTAINER_G(persistent) ? "enabled" : "disabled");
+#ifdef ZTS
+    php_info_print_table_row(2, "Thread safety", "enabled (per-thread graphs, shared strings)");
+#else
+    php_info_print_table_row(2, "Thread safety", "disabled");
+#endif
+    char shared[32];
+    snprintf(shared, sizeof(shared), "%u", sf_strings_count());
+    php_info_print_table_row(2, "Shared strings", shared);
+    char simd[48];
+    snprintf(simd, sizeof(simd), "%s (%u-slot groups)", sf_simd_active.name, sf_simd_active.group_size);
+    php_info_print_table_row(2, "SIMD kernels", simd);
     php_info_print_table_end();
+    
+    sf_stats_info();
+    
+    DISPLAY_INI_ENTRIES();
 }
 
+/* spl must be started first - MINIT wraps its autoloader registration functions */
+static const zend_module_dep signalforge_container_deps[] = {
+    ZEND_MOD_REQUIRED("spl")
+    ZEND_MOD_END
+};
+
 /* Module entry - tells PHP everything about this extension */
 zend_module_entry signalforge_container_module_entry = {
-    STANDARD_MODULE_HEADER,
+    STANDARD_MODULE_HEADER_EX,
+    NULL,
+    signalforge_container_deps,
     PHP_SIGNALFORGE_CONTAINER_EXTNAME,
     NULL,                                      /* No global functions */
     PHP_MINIT(signalforge_container),
@@ -0,0 +1,88 @@
+/*
+ * Signalforge Container Extension
+ * src/arena.c - Per-container arena for graph structures
+ *
+ * A bump allocator over fixed-size chunks with a free list per 8-byte size
+ * class. Allocation is a free-list pop or a pointer bump; there is no per-block
+ * header, so callers pass the size back when freeing. Chunks are allocated on
+ * first use - a container that never binds anything costs nothing.
+ */
+
+#include "../php_signalforge_container.h"
+#include "arena.h"
+
+static zend_always_inline size_t sf_arena_round(size_t size)
+{
+    return size ? (size + SF_ARENA_ALIGN - 1) & ~(size_t)(SF_ARENA_ALIGN - 1) : SF_ARENA_ALIGN;
+}
+
+void sf_arena_init(sf_arena *arena, zend_bool persistent)
+{
+    memset(arena, 0, sizeof(sf_arena));
+    arena->persistent = persistent;
+}
+
+void sf_arena_reset(sf_arena *arena)
+{
+    sf_arena_chunk *chunk = arena->chunks;
+    while (chunk) {
+        sf_arena_chunk *next = chunk->next;
+        pefree(chunk, arena->persistent);
+        chunk = next;
+    }
+    sf_arena_init(arena, arena->persistent);
+}
+
+void sf_arena_destroy(sf_arena *arena)
+{
+    sf_arena_reset(arena);
+}
+
+static void *sf_arena_grow(sf_arena *arena, size_t size)
+{
+    sf_arena_chunk *chunk = pemalloc(sizeof(sf_arena_chunk) + SF_ARENA_CHUNK_SIZE, arena->persistent);
+    
+    /* The tail of the old chunk is dropped - at most one block's worth */
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->pos = chunk->data + size;
+    arena->end = chunk->data + SF_ARENA_CHUNK_SIZE;
+    return chunk->data;
+}
+
+void *sf_arena_alloc(sf_arena *arena, size_t size)
+{
+    size = sf_arena_round(size);
+    if (UNEXPECTED(size > SF_ARENA_MAX_BLOCK)) {
+        return pemalloc(size, arena->persistent);
+    }
+    
+    void **head = &arena->free[size / SF_ARENA_ALIGN - 1];
+    void *block = *head;
+    if (block) {
+        *head = *(void **)block;
+        return block;
+    }
+    
+    if (UNEXPECTED((size_t)(arena->end - arena->pos) < size)) {
+        return sf_arena_grow(arena, size);
+    }
+    block = arena->pos;
+    arena->pos += size;
+    return block;
+}
+
+void sf_arena_free(sf_arena *arena, void *block, size_t size)
+{
+    if (!block) return;
+    
+    size = sf_arena_round(size);
+    if (UNEXPECTED(size > SF_ARENA_MAX_BLOCK)) {
+        pefree(block, arena->persistent);
+        return;
+    }
+    
+    void **head = &arena->free[size / SF_ARENA_ALIGN - 1];
+    *(void **)block = *head;
+    *head = block;
+}
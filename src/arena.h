@@ -0,0 +1,56 @@
+/*
+ * Signalforge Container Extension
+ * src/arena.h - Per-container arena for graph structures
+ *
+ * Bindings, contextual bindings and class metadata are small, numerous and
+ * share the container's lifetime. Instead of one malloc each they are carved
+ * out of large chunks that are released together when the container is
+ * flushed or destroyed. Freed blocks go to per-size free lists, so rebinding
+ * in a long-lived (persistent) container reuses slots instead of growing.
+ */
+
+#ifndef SF_ARENA_H
+#define SF_ARENA_H
+
+#include "php.h"
+
+/* Block granularity - enough for zvals and pointers */
+#define SF_ARENA_ALIGN 8
+
+/* Larger blocks are not worth a size class - they go to the allocator */
+#define SF_ARENA_MAX_BLOCK 256
+
+/* Chunk payload size */
+#define SF_ARENA_CHUNK_SIZE 16384
+
+#define SF_ARENA_CLASSES (SF_ARENA_MAX_BLOCK / SF_ARENA_ALIGN)
+
+typedef struct _sf_arena_chunk {
+    struct _sf_arena_chunk *next;     /* Older chunk */
+    char data[];
+} sf_arena_chunk;
+
+struct _sf_arena {
+    char *pos;                        /* Next free byte of the newest chunk */
+    char *end;                        /* End of the newest chunk */
+    void *free[SF_ARENA_CLASSES];     /* Freed blocks per size class (linked through their first word) */
+    sf_arena_chunk *chunks;           /* Newest first */
+    zend_bool persistent;             /* Chunks live in process memory */
+};
+
+void sf_arena_init(sf_arena *arena, zend_bool persistent);
+
+/* Release every chunk at once. Blocks handed out before are gone. */
+void sf_arena_reset(sf_arena *arena);
+void sf_arena_destroy(sf_arena *arena);
+
+/* Allocate and free blocks. `size` must match between the two calls. */
+void *sf_arena_alloc(sf_arena *arena, size_t size);
+void sf_arena_free(sf_arena *arena, void *block, size_t size);
+
+static zend_always_inline void *sf_arena_calloc(sf_arena *arena, size_t size)
+{
+    return memset(sf_arena_alloc(arena, size), 0, size);
+}
+
+#endif /* SF_ARENA_H */
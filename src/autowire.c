@@ -23,16 +23,118 @@
 #include "reflection_cache.h"
 #include "compiler.h"
 #include "factory.h"
-#include "pool.h"
+
+#include "zend_observer.h"
 
 extern zend_class_entry *sf_not_found_exception_ce;
 
+/* ============================================================================
+ * Constructor Frames
+ *
+ * zend_call_function() takes an argument array and copies it into the frame
+ * it pushes, and the caller then releases its own array. Constructors called
+ * here skip that round trip: the frame is pushed before the dependencies are
+ * resolved (like the engine's own `new Foo(...)`), the arguments are built in
+ * its slots, and the frame owns them from then on. Nested resolutions push
+ * their frames above ours, which is fine - the VM stack is a stack.
+ *
+ * The call itself is what zend_call_function() does for a known function.
+ * ============================================================================ */
+
+zend_execute_data *sf_ctor_frame_push(zend_object *object, uint32_t max_args)
+{
+    /* Sized for every parameter - fewer may be passed (see sf_ctor_frame_call) */
+    return zend_vm_stack_push_call_frame(ZEND_CALL_TOP_FUNCTION | ZEND_CALL_DYNAMIC | ZEND_CALL_HAS_THIS,
+        object->ce->constructor, max_args, object);
+}
+
+/* By-reference parameters and reference values - as zend_call_function() sends them */
+static zend_never_inline int sf_ctor_frame_send_refs(zend_execute_data *call, uint32_t arg_count)
+{
+    zend_function *func = call->func;
+    
+    for (uint32_t i = 0; i < arg_count; i++) {
+        zval *arg = ZEND_CALL_ARG(call, i + 1);
+        
+        if (ARG_SHOULD_BE_SENT_BY_REF(func, i + 1)) {
+            if (!Z_ISREF_P(arg) && !ARG_MAY_BE_SENT_BY_REF(func, i + 1)) {
+                zend_param_must_be_ref(func, i + 1);
+                if (UNEXPECTED(EG(exception))) {
+                    return FAILURE;
+                }
+                ZVAL_NEW_REF(arg, arg);
+            }
+        } else if (Z_ISREF_P(arg)) {
+            zval value;
+            ZVAL_COPY(&value, Z_REFVAL_P(arg));
+            zval_ptr_dtor(arg);
+            ZVAL_COPY_VALUE(arg, &value);
+        }
+    }
+    return SUCCESS;
+}
+
+ZEND_HOT int sf_ctor_frame_call(zend_execute_data *call, uint32_t arg_count)
+{
+    zend_function *func = call->func;
+    zval retval;
+    
+    ZEND_CALL_NUM_ARGS(call) = arg_count;
+    SF_STAT(ctor_calls);
+    
+    if (UNEXPECTED(func->common.fn_flags & ZEND_ACC_DEPRECATED)) {
+        zend_deprecated_function(func);
+    }
+    if (UNEXPECTED(EG(exception)) || UNEXPECTED(sf_ctor_frame_send_refs(call, arg_count) == FAILURE)) {
+        zend_vm_stack_free_args(call);
+        zend_vm_stack_free_call_frame(call);
+        return FAILURE;
+    }
+    
+    if (EXPECTED(func->type == ZEND_USER_FUNCTION)) {
+        uint32_t orig_jit_trace_num = EG(jit_trace_num);
+        
+        /* Links the frame and receives the arguments - they are the callee's CVs now */
+        zend_init_func_execute_data(call, &func->op_array, &retval);
+        ZEND_OBSERVER_FCALL_BEGIN(call);
+        zend_execute_ex(call);
+        EG(jit_trace_num) = orig_jit_trace_num;
+    } else {
+        ZVAL_NULL(&retval);
+        call->prev_execute_data = EG(current_execute_data);
+        EG(current_execute_data) = call;
+        ZEND_OBSERVER_FCALL_BEGIN(call);
+        if (EXPECTED(zend_execute_internal == NULL)) {
+            func->internal_function.handler(call, &retval);
+        } else {
+            zend_execute_internal(call, &retval);
+        }
+        ZEND_OBSERVER_FCALL_END(call, &retval);
+        EG(current_execute_data) = call->prev_execute_data;
+        zend_vm_stack_free_args(call);
+    }
+    
+    zend_vm_stack_free_call_frame(call);
+    zval_ptr_dtor(&retval);
+    
+    if (UNEXPECTED(EG(exception))) {
+        /* Re-raise in the calling user frame, as zend_call_function() does */
+        if (UNEXPECTED(!EG(current_execute_data))) {
+            zend_throw_exception_internal(NULL);
+        } else if (EG(current_execute_data)->func && ZEND_USER_CODE(EG(current_execute_data)->func->common.type)) {
+            zend_rethrow_exception(EG(current_execute_data));
+        }
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
 /*
  * Build the argument list for a constructor directly into a zval buffer.
  *
  * For each parameter, we try (in order):
  * 1. Explicit parameter passed by user (Container::make(X, ['param' => value]))
- * 2. Type-hinted class? Resolve it from the container
+ * 2. #[Inject] key or type-hinted class? Resolve it from the container
  * 3. Has default value? Stop here - PHP will use its own defaults for remaining params
  * 4. Is nullable? Use null
  * 5. None of the above? Throw exception
@@ -52,12 +154,13 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
     uint32_t actual_count = 0;
     
     for (uint32_t i = 0; i < meta->param_count; i++) {
-        sf_param_info *p = &meta->params[i];
+        zend_string *dep = sf_class_meta_dep(meta, i);
+        uint8_t flags = meta->param_flags[i];
         zval *arg = &arg_buffer[actual_count];
         
         /* 1. Check user-provided parameters first (uncommon) */
         if (UNEXPECTED(params)) {
-            zval *provided = zend_hash_find(params, p->name);
+            zval *provided = zend_hash_find(params, meta->param_names[i]);
             if (UNEXPECTED(provided)) {
                 ZVAL_COPY(arg, provided);
                 actual_count++;
@@ -65,9 +168,9 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
             }
         }
         
-        /* 2. Type hint? Try to resolve from container (common path) */
-        if (EXPECTED(p->type_hint)) {
-            if (EXPECTED(sf_container_make(c, p->type_hint, NULL, arg, requester) == SUCCESS)) {
+        /* 2. Type hint or #[Inject] key? Try to resolve from container (common path) */
+        if (EXPECTED(dep)) {
+            if (EXPECTED(sf_container_make(c, dep, NULL, arg, requester) == SUCCESS)) {
                 actual_count++;
                 continue;
             }
@@ -86,7 +189,7 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
             }
             
             /* Resolution failed - check fallbacks (uncommon) */
-            if (UNEXPECTED(p->is_nullable)) {
+            if (UNEXPECTED(flags & SF_PARAM_NULLABLE)) {
                 ZVAL_NULL(arg);
                 actual_count++;
                 continue;
@@ -96,7 +199,7 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
              * Has default? Stop building args here - PHP will use defaults
              * for this and all remaining optional parameters.
              */
-            if (EXPECTED(p->has_default)) {
+            if (EXPECTED(flags & SF_PARAM_DEFAULT)) {
                 break;
             }
             
@@ -106,7 +209,7 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
             }
             zend_throw_exception_ex(sf_not_found_exception_ce, 0,
                 "Unable to resolve dependency '%s' for parameter '%s' of class '%s'",
-                ZSTR_VAL(p->type_hint), ZSTR_VAL(p->name), ZSTR_VAL(meta->class_name));
+                ZSTR_VAL(dep), ZSTR_VAL(meta->param_names[i]), ZSTR_VAL(meta->class_name));
             return -1;
         }
         
@@ -114,12 +217,12 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
          * 3. No type hint - if it has a default, stop building args.
          * PHP will use default values for remaining optional parameters.
          */
-        if (p->has_default) {
+        if (flags & SF_PARAM_DEFAULT) {
             break;
         }
         
         /* Variadic with nothing to fill - stop here */
-        if (p->is_variadic) {
+        if (flags & SF_PARAM_VARIADIC) {
             break;
         }
         
@@ -129,13 +232,68 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
         }
         zend_throw_exception_ex(sf_not_found_exception_ce, 0,
             "Unable to resolve parameter '%s' of class '%s' (no type hint or default value)",
-            ZSTR_VAL(p->name), ZSTR_VAL(meta->class_name));
+            ZSTR_VAL(meta->param_names[i]), ZSTR_VAL(meta->class_name));
         return -1;
     }
     
     return actual_count;
 }
 
+/*
+ * Can the constructor call be skipped for these arguments?
+ *
+ * Only for constructors that just assign promoted properties (see
+ * reflection_cache.c), with no user parameters (they may need coercion),
+ * no promoted parameter left to its default, and every argument passing
+ * the parameter's class type - the checks the skipped RECVs would do.
+ */
+static zend_bool sf_autowire_can_elide(sf_class_meta *meta, zval *args, int arg_count, HashTable *params)
+{
+    if (EXPECTED(!meta->ctor_elidable) || UNEXPECTED(params && zend_hash_num_elements(params) > 0)) {
+        return 0;
+    }
+    
+    for (uint32_t i = arg_count; i < meta->param_count; i++) {
+        if (meta->prop_nums[i] != SF_PROP_NONE) {
+            return 0;
+        }
+    }
+    
+    for (int i = 0; i < arg_count; i++) {
+        zend_string *type_hint = meta->param_types[i];
+        
+        if (Z_TYPE(args[i]) == IS_NULL && (meta->param_flags[i] & SF_PARAM_NULLABLE)) {
+            continue;
+        }
+        /* An untyped #[Inject] parameter leaves nothing to check against - call the constructor */
+        if (UNEXPECTED(Z_TYPE(args[i]) != IS_OBJECT) || UNEXPECTED(!type_hint)) {
+            return 0;
+        }
+        
+        /* Exact class is the common case; interfaces need the type's class entry */
+        zend_class_entry *arg_ce = Z_OBJCE(args[i]);
+        if (EXPECTED(zend_string_equals_ci(arg_ce->name, type_hint))) {
+            continue;
+        }
+        zend_class_entry *type_ce = zend_lookup_class_ex(type_hint, NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD);
+        if (!type_ce || !instanceof_function(arg_ce, type_ce)) {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/* Compile `class_name` for next time in compilation mode, or once it is hot enough */
+static zend_always_inline int sf_autowire_finish(sf_container *c, zend_string *class_name, sf_class_meta *meta)
+{
+    if (UNEXPECTED(c->compilation_enabled) || UNEXPECTED(sf_compile_due(++meta->resolutions))) {
+        sf_compiler_promote(c, class_name);
+    }
+    
+    return SUCCESS;
+}
+
 /*
  * Resolve a class by autowiring its constructor.
  *
@@ -145,8 +303,8 @@ static ZEND_HOT int sf_autowire_build_args_direct(sf_class_meta *meta, zval *arg
  */
 ZEND_HOT int sf_autowire_resolve(zend_string *class_name, zval *result, HashTable *params, sf_container *c)
 {
-    /* Look up the class entry */
-    zend_class_entry *ce = zend_lookup_class(class_name);
+    /* Look up the class entry (misses are remembered until a class or autoloader is added) */
+    zend_class_entry *ce = sf_container_lookup_class(c, class_name);
     if (UNEXPECTED(!ce)) {
         zend_throw_exception_ex(sf_not_found_exception_ce, 0,
             "Class '%s' not found", ZSTR_VAL(class_name));
@@ -161,15 +319,14 @@ ZEND_HOT int sf_autowire_resolve(zend_string *class_name, zval *result, HashTabl
     }
     
     /* Get or build cached metadata - pass ce to avoid duplicate lookup */
-    sf_class_meta *meta = sf_cache_get(class_name, &c->reflection_cache);
+    sf_class_meta *meta = sf_container_get_meta(c, class_name, ce);
     if (UNEXPECTED(!meta)) {
-        meta = sf_cache_build(class_name, ce);
-        if (UNEXPECTED(!meta)) {
+        /* An attribute argument that threw says more */
+        if (!EG(exception)) {
             zend_throw_exception_ex(sf_not_found_exception_ce, 0,
                 "Unable to build metadata for class '%s'", ZSTR_VAL(class_name));
-            return FAILURE;
         }
-        sf_cache_put(class_name, meta, &c->reflection_cache);
+        return FAILURE;
     }
     
     if (UNEXPECTED(!meta->is_instantiable)) {
@@ -178,104 +335,52 @@ ZEND_HOT int sf_autowire_resolve(zend_string *class_name, zval *result, HashTabl
         return FAILURE;
     }
     
-    /* Build constructor arguments - try pool first, then stack, then heap */
-    zval args_stack[8];
-    zval *args_buffer = NULL;
-    zend_bool from_pool = 0;
-    
-    if (meta->param_count > 8) {
-        /* Try to get from pool for larger sizes */
-        sf_pool_manager *pool = sf_pool_get_manager();
-        args_buffer = sf_pool_acquire(pool, meta->param_count);
-        if (args_buffer) {
-            from_pool = 1;
-        } else {
-            /* Pool exhausted, fall back to heap */
-            args_buffer = emalloc(sizeof(zval) * meta->param_count);
-        }
-    } else {
-        /* Small size: use stack buffer */
-        args_buffer = args_stack;
+    /* Create the object first - the constructor frame needs it (should almost always succeed) */
+    if (UNEXPECTED(object_init_ex(result, ce) != SUCCESS)) {
+        zend_throw_exception_ex(sf_not_found_exception_ce, 0,
+            "Unable to instantiate class '%s'", ZSTR_VAL(class_name));
+        return FAILURE;
     }
     
-    int arg_count = sf_autowire_build_args_direct(meta, args_buffer, params, c, class_name);
-    if (arg_count < 0) {
-        if (from_pool) {
-            sf_pool_release(sf_pool_get_manager(), args_buffer, meta->param_count);
-        } else if (args_buffer != args_stack) {
-            efree(args_buffer);
-        }
-        return FAILURE;
+    /* No constructor - nothing to pass (leaf services) */
+    if (!ce->constructor) {
+        return sf_autowire_finish(c, class_name, meta);
     }
     
-    /* Create the object (should almost always succeed) */
-    if (UNEXPECTED(object_init_ex(result, ce) != SUCCESS)) {
-        for (int i = 0; i < arg_count; i++) {
-            zval_ptr_dtor(&args_buffer[i]);
-        }
-        if (from_pool) {
-            sf_pool_release(sf_pool_get_manager(), args_buffer, meta->param_count);
-        } else if (args_buffer != args_stack) {
-            efree(args_buffer);
-        }
-        zend_throw_exception_ex(sf_not_found_exception_ce, 0,
-            "Unable to instantiate class '%s'", ZSTR_VAL(class_name));
+    /* Dependencies are resolved straight into the constructor's argument slots */
+    zend_execute_data *call = sf_ctor_frame_push(Z_OBJ_P(result), meta->param_count);
+    zval *args = SF_CTOR_FRAME_ARGS(call);
+    
+    int arg_count = sf_autowire_build_args_direct(meta, args, params, c, class_name);
+    if (UNEXPECTED(arg_count < 0)) {
+        zend_vm_stack_free_call_frame(call);
+        zend_object_store_ctor_failed(Z_OBJ_P(result));
+        zval_ptr_dtor(result);
         return FAILURE;
     }
     
-    /* Call constructor if one exists (common for DI classes) */
-    if (EXPECTED(ce->constructor)) {
-        zval retval;
-        zend_fcall_info fci = {0};
-        zend_fcall_info_cache fcc = {0};
-        
-        fci.size = sizeof(fci);
-        fci.retval = &retval;
-        fci.object = Z_OBJ_P(result);
-        ZVAL_UNDEF(&fci.function_name);  /* Not needed when fcc.function_handler is set */
-        fci.params = args_buffer;
-        fci.param_count = arg_count;
-        
-        fcc.function_handler = ce->constructor;
-        fcc.called_scope = ce;
-        fcc.object = Z_OBJ_P(result);
-        
-        int call_ret = zend_call_function(&fci, &fcc);
+    /* Constructor only assigns promoted properties - write them directly */
+    if (sf_autowire_can_elide(meta, args, arg_count, params)) {
+        zend_object *obj = Z_OBJ_P(result);
         
-        /* Cleanup params */
+        /* The properties take over the argument references */
         for (int i = 0; i < arg_count; i++) {
-            zval_ptr_dtor(&args_buffer[i]);
-        }
-        if (from_pool) {
-            sf_pool_release(sf_pool_get_manager(), args_buffer, meta->param_count);
-        } else if (args_buffer != args_stack) {
-            efree(args_buffer);
-        }
-        zval_ptr_dtor(&retval);
-        
-        if (UNEXPECTED(call_ret == FAILURE)) {
-            zval_ptr_dtor(result);
-            return FAILURE;
-        }
-    } else {
-        /* No constructor - cleanup args */
-        for (int i = 0; i < arg_count; i++) {
-            zval_ptr_dtor(&args_buffer[i]);
-        }
-        if (from_pool) {
-            sf_pool_release(sf_pool_get_manager(), args_buffer, meta->param_count);
-        } else if (args_buffer != args_stack) {
-            efree(args_buffer);
+            if (meta->prop_nums[i] != SF_PROP_NONE) {
+                ZVAL_COPY_VALUE(OBJ_PROP_NUM(obj, meta->prop_nums[i]), &args[i]);
+            } else {
+                zval_ptr_dtor(&args[i]);
+            }
         }
+        zend_vm_stack_free_call_frame(call);
+        SF_STAT(ctor_elided);
+        return sf_autowire_finish(c, class_name, meta);
     }
     
-    /* JIT compile for next time if compilation mode is enabled (optional optimization) */
-    if (EXPECTED(c->compilation_enabled) && EXPECTED(!zend_hash_exists(&c->compiled_factories, class_name))) {
-        sf_factory *factory = sf_compiler_compile_class(meta, ce, 0);
-        if (factory) {
-            zend_hash_update_ptr(&c->compiled_factories, class_name, factory);
-        }
+    /* The frame owns the arguments - the constructor releases them */
+    if (UNEXPECTED(sf_ctor_frame_call(call, arg_count) == FAILURE)) {
+        zval_ptr_dtor(result);
+        return FAILURE;
     }
     
-    return SUCCESS;
+    return sf_autowire_finish(c, class_name, meta);
 }
@@ -13,6 +13,14 @@ typedef struct _sf_container sf_container;
 /* Resolve a class by analyzing its constructor and injecting dependencies */
 int sf_autowire_resolve(zend_string *class_name, zval *result, HashTable *parameters, sf_container *container);
 
+/* Constructor calls without an argument copy: push the constructor's frame for
+ * `object`, build up to `max_args` arguments in SF_CTOR_FRAME_ARGS(call), then
+ * run it with sf_ctor_frame_call() (releases the frame and arguments, FAILURE
+ * if the constructor threw) or drop it with zend_vm_stack_free_call_frame(). */
+#define SF_CTOR_FRAME_ARGS(call) ZEND_CALL_ARG(call, 1)
+zend_execute_data *sf_ctor_frame_push(zend_object *object, uint32_t max_args);
+int sf_ctor_frame_call(zend_execute_data *call, uint32_t arg_count);
+
 /* Build constructor arguments from cached metadata (internal) */
 int sf_autowire_build_args(sf_class_meta *meta, zval *args, HashTable *parameters, sf_container *container, zend_string *requesting_class);
 
@@ -9,28 +9,94 @@
  * - TRANSIENT: Fresh instance every Container::make() call
  * - SINGLETON: First call creates, subsequent calls return cached
  * - INSTANCE: User-provided object, stored as-is
+ * - SCOPED: One instance per open scope (Container::beginScope)
  *
  * We use reference counting so bindings can be safely shared and cleaned up
  * when no longer needed.
+ *
+ * Bindings are allocated from the container's arena. In persistent mode that
+ * arena lives in process memory and bindings survive the request.
+ * Class-name concretes are copied into persistent strings; closures and objects
+ * still belong to the request that registered them, so the container drops
+ * those bindings at request shutdown (see sf_binding_is_request_bound).
  */
 
 #include "../php_signalforge_container.h"
 #include "binding.h"
 
+/* Copy a concrete value into a binding. Only strings can be made persistent. */
+static inline void sf_binding_value_copy(zval *dst, zval *src, zend_bool persistent)
+{
+    if (Z_TYPE_P(src) == IS_STRING) {
+        ZVAL_STR(dst, sf_string_copy_ex(Z_STR_P(src), persistent));
+    } else {
+        ZVAL_COPY(dst, src);
+    }
+}
+
+/* zval_ptr_dtor() can't be used on persistent strings - release them directly */
+static inline void sf_binding_value_dtor(zval *zv)
+{
+    if (Z_TYPE_P(zv) == IS_STRING) {
+        zend_string_release(Z_STR_P(zv));
+    } else {
+        zval_ptr_dtor(zv);
+    }
+}
+
+/*
+ * Resolve a closure's call cache once, when it is bound. Closures made from
+ * __call()/__callStatic() get a fresh trampoline per call, so those are left
+ * to the uncached path.
+ */
+static sf_closure_cache *sf_closure_cache_create(zval *concrete, sf_arena *arena)
+{
+    if (Z_TYPE_P(concrete) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(concrete), zend_ce_closure)) {
+        return NULL;
+    }
+    
+    zend_fcall_info fci;
+    zend_fcall_info_cache fcc;
+    if (zend_fcall_info_init(concrete, 0, &fci, &fcc, NULL, NULL) == FAILURE
+        || (fcc.function_handler->common.fn_flags & ZEND_ACC_CALL_VIA_TRAMPOLINE)) {
+        return NULL;
+    }
+    
+    /* Arguments past the declared ones would only be visible to func_get_args() */
+    const zend_function *fn = fcc.function_handler;
+    sf_closure_cache *cache = sf_arena_alloc(arena, sizeof(sf_closure_cache));
+    cache->fcc = fcc;
+    cache->arity = (fn->common.fn_flags & ZEND_ACC_VARIADIC) ? 2 : MIN(fn->common.num_args, 2);
+    return cache;
+}
+
+static inline void sf_closure_cache_destroy(sf_closure_cache *cache, sf_arena *arena)
+{
+    if (cache) {
+        sf_arena_free(arena, cache, sizeof(sf_closure_cache));
+    }
+}
+
 /* ============================================================================
  * Regular Bindings
  * ============================================================================ */
 
-sf_binding *sf_binding_create(zend_string *abstract, zval *concrete, uint8_t scope)
+sf_binding *sf_binding_create(zend_string *abstract, zval *concrete, uint8_t scope, sf_arena *arena)
 {
-    sf_binding *b = emalloc(sizeof(sf_binding));
+    zend_bool persistent = arena->persistent;
+    sf_binding *b = sf_arena_alloc(arena, sizeof(sf_binding));
     
-    b->abstract = zend_string_copy(abstract);
-    ZVAL_COPY(&b->concrete, concrete);
+    b->abstract = sf_string_intern_ex(abstract, persistent);
+    sf_binding_value_copy(&b->concrete, concrete, persistent);
+    b->closure = sf_closure_cache_create(&b->concrete, arena);
     b->scope = scope;
-    b->resolved = 0;
+    b->arena = arena;
+    b->lazy = 0;
     ZVAL_UNDEF(&b->instance);
     b->refcount = 1;
+    b->resolving = 0;
+    b->resolutions = 0;
+    b->hotness = 0;
     
     return b;
 }
@@ -40,13 +106,14 @@ void sf_binding_destroy(sf_binding *b)
     if (!b) return;
     
     zend_string_release(b->abstract);
-    zval_ptr_dtor(&b->concrete);
+    sf_closure_cache_destroy(b->closure, b->arena);
+    sf_binding_value_dtor(&b->concrete);
     
     if (!Z_ISUNDEF(b->instance)) {
         zval_ptr_dtor(&b->instance);
     }
     
-    efree(b);
+    sf_arena_free(b->arena, b, sizeof(sf_binding));
 }
 
 void sf_binding_addref(sf_binding *b)
@@ -61,6 +128,12 @@ void sf_binding_release(sf_binding *b)
     }
 }
 
+/* Closure and object bindings can't outlive the request that created them */
+zend_bool sf_binding_is_request_bound(sf_binding *b)
+{
+    return Z_TYPE(b->concrete) != IS_STRING || !Z_ISUNDEF(b->instance);
+}
+
 /* ============================================================================
  * Contextual Bindings
  *
@@ -71,13 +144,16 @@ void sf_binding_release(sf_binding *b)
  *          When AdminController needs Logger, give DatabaseLogger
  * ============================================================================ */
 
-sf_contextual_binding *sf_contextual_binding_create(zend_string *concrete, zend_string *abstract, zval *impl)
+sf_contextual_binding *sf_contextual_binding_create(zend_string *concrete, zend_string *abstract, zval *impl, sf_arena *arena)
 {
-    sf_contextual_binding *b = emalloc(sizeof(sf_contextual_binding));
+    zend_bool persistent = arena->persistent;
+    sf_contextual_binding *b = sf_arena_alloc(arena, sizeof(sf_contextual_binding));
     
-    b->concrete = zend_string_copy(concrete);    /* The class that has the dependency */
-    b->abstract = zend_string_copy(abstract);    /* The dependency type */
-    ZVAL_COPY(&b->implementation, impl);         /* What to inject instead */
+    b->concrete = sf_string_copy_ex(concrete, persistent);    /* The class that has the dependency */
+    b->abstract = sf_string_copy_ex(abstract, persistent);    /* The dependency type */
+    sf_binding_value_copy(&b->implementation, impl, persistent);  /* What to inject instead */
+    b->closure = sf_closure_cache_create(&b->implementation, arena);
+    b->arena = arena;
     b->refcount = 1;
     
     return b;
@@ -89,9 +165,10 @@ void sf_contextual_binding_destroy(sf_contextual_binding *b)
     
     zend_string_release(b->concrete);
     zend_string_release(b->abstract);
-    zval_ptr_dtor(&b->implementation);
+    sf_closure_cache_destroy(b->closure, b->arena);
+    sf_binding_value_dtor(&b->implementation);
     
-    efree(b);
+    sf_arena_free(b->arena, b, sizeof(sf_contextual_binding));
 }
 
 void sf_contextual_binding_addref(sf_contextual_binding *b)
@@ -105,3 +182,8 @@ void sf_contextual_binding_release(sf_contextual_binding *b)
         sf_contextual_binding_destroy(b);
     }
 }
+
+zend_bool sf_contextual_binding_is_request_bound(sf_contextual_binding *b)
+{
+    return Z_TYPE(b->implementation) != IS_STRING;
+}
@@ -6,44 +6,61 @@
 #ifndef SF_BINDING_H
 #define SF_BINDING_H
 
+#include "arena.h"
+
+/* A closure concrete, ready to call: its call cache (the closure is kept alive
+ * by the binding holding it) and how many of ($container, $params) it declares */
+typedef struct _sf_closure_cache {
+    zend_fcall_info_cache fcc;
+    uint32_t arity;
+} sf_closure_cache;
+
 /* Maps an abstract (interface/class name) to a concrete implementation
- * Layout optimized for cache line alignment (hot fields first) */
+ * Allocated from the container's arena (hot fields first) */
 struct _sf_binding {
     /* Hot fields (accessed during resolution) - first cache line */
     zend_string *abstract;  /* What you ask for */
     zval concrete;          /* What you get (class name, closure, or object) */
     zval instance;          /* Cached instance for singleton scope */
+    sf_closure_cache *closure;  /* Closure concrete's call cache (NULL = not a closure) */
     
     /* Cold fields (accessed less frequently) */
     uint32_t refcount;
-    uint8_t scope;          /* SF_SCOPE_TRANSIENT, _SINGLETON, or _INSTANCE */
-    zend_bool resolved;     /* Has been resolved at least once (for singletons) */
-    uint8_t _padding[2];    /* Align to 8 bytes */
-} __attribute__((aligned(64)));
+    uint32_t resolving;     /* Resolution stack depth + 1 when last entered (cycle detection) */
+    uint32_t resolutions;   /* Interpreted resolutions this request (stats - fast paths skip it) */
+    uint32_t hotness;       /* Interpreted resolutions ever (tiered compilation - stats resets leave it) */
+    uint8_t scope;          /* SF_SCOPE_TRANSIENT, _SINGLETON, _INSTANCE or _SCOPED */
+    zend_bool lazy;         /* Singleton handed out as a lazy proxy (Container::lazy) */
+    uint8_t _padding[6];    /* Align to 8 bytes */
+    sf_arena *arena;        /* Owning container's arena (persistent in persistent mode) */
+};
 
 /* Context-specific binding: when A needs B, give C instead of default B
- * Layout optimized for cache line alignment */
+ * Allocated from the container's arena */
 struct _sf_contextual_binding {
     /* Hot fields */
     zend_string *concrete;  /* The class that has the dependency (A) */
     zend_string *abstract;  /* The dependency it needs (B) */
     zval implementation;    /* What to give it (C) */
+    sf_closure_cache *closure;  /* Closure implementation's call cache (NULL = not a closure) */
     
     /* Cold fields */
     uint32_t refcount;
-    uint8_t _padding[4];    /* Align to 8 bytes */
-} __attribute__((aligned(64)));
+    sf_arena *arena;        /* Owning container's arena */
+};
 
 /* Regular binding lifecycle */
-sf_binding *sf_binding_create(zend_string *abstract, zval *concrete, uint8_t scope);
+sf_binding *sf_binding_create(zend_string *abstract, zval *concrete, uint8_t scope, sf_arena *arena);
 void sf_binding_destroy(sf_binding *binding);
 void sf_binding_addref(sf_binding *binding);
 void sf_binding_release(sf_binding *binding);
+zend_bool sf_binding_is_request_bound(sf_binding *binding);
 
 /* Contextual binding lifecycle */
-sf_contextual_binding *sf_contextual_binding_create(zend_string *concrete, zend_string *abstract, zval *implementation);
+sf_contextual_binding *sf_contextual_binding_create(zend_string *concrete, zend_string *abstract, zval *implementation, sf_arena *arena);
 void sf_contextual_binding_destroy(sf_contextual_binding *binding);
 void sf_contextual_binding_addref(sf_contextual_binding *binding);
 void sf_contextual_binding_release(sf_contextual_binding *binding);
+zend_bool sf_contextual_binding_is_request_bound(sf_contextual_binding *binding);
 
 #endif /* SF_BINDING_H */
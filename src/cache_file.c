@@ -1,72 +1,176 @@
 /*
- * Binary cache file implementation for pre-resolved singleton services.
+ * Metadata snapshot implementation.
+ *
+ * Writing serializes the container's tables into per-section buffers and
+ * puts them behind one header. Reading maps the file, checks every offset,
+ * string id and plan slot before touching the container (a truncated or
+ * corrupt file is rejected as a whole, never half-imported), compares class
+ * file mtimes, and only then replays the records through the regular
+ * registration functions.
+ *
+ * Imported metadata and plans start out unvalidated (epoch 0), so the first
+ * use in a request still compares them against the live class entries - the
+ * mtime check just catches a stale snapshot before anything is imported.
  */
 
+#include "../php_signalforge_container.h"
 #include "cache_file.h"
-#include "php.h"
-#include "ext/standard/php_var.h"
-#include "ext/standard/php_string.h"
+#include "container.h"
+#include "binding.h"
+#include "factory.h"
+#include "compiler.h"
+#include "reflection_cache.h"
+#include "tag.h"
+#include "SAPI.h"
 #include "Zend/zend_hash.h"
 #include "Zend/zend_smart_str.h"
+#include "ext/standard/sha1.h"
+#include "ext/standard/flock_compat.h"
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
 
 #ifdef _WIN32
+    #include <windows.h>
     #include <io.h>
     #include <direct.h>
+    #include <process.h>
     #define access _access
-    #define chmod _chmod
-    #define S_IRUSR _S_IREAD
-    #define S_IWUSR _S_IWRITE
+    #define fdopen _fdopen
+    #define O_NOFOLLOW 0
 #else
     #include <unistd.h>
+    #include <sys/mman.h>
 #endif
 
-/**
- * Cleanup helper for save operations.
- */
-static inline void sf_cache_save_cleanup(FILE *fp, smart_str *buf)
+/* Record size per section (string data is counted in bytes) */
+static const size_t sf_snapshot_record_size[SF_SNAP_SECTIONS] = {
+    sizeof(uint32_t),                 /* SF_SNAP_STRINGS */
+    1,                                /* SF_SNAP_STRING_DATA */
+    sizeof(sf_snapshot_binding),
+    sizeof(sf_snapshot_alias),
+    sizeof(sf_snapshot_tag),
+    sizeof(uint32_t),                 /* SF_SNAP_TAG_ITEMS */
+    sizeof(sf_snapshot_contextual),
+    sizeof(sf_snapshot_class),
+    sizeof(sf_snapshot_param),
+    sizeof(sf_snapshot_plan),
+    sizeof(sf_snapshot_step),
+    sizeof(sf_snapshot_arg),
+};
+
+/* Sections start on 8-byte boundaries so records can be read in place */
+#define SF_SNAPSHOT_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/* ============================================================================
+ * Cache Keys
+ *
+ * The default snapshot is named after a SHA-1 of the graph it describes:
+ * every binding, alias, contextual binding and tag in registration order,
+ * each field length-prefixed so no two graphs produce the same byte stream,
+ * plus the extension, PHP and format versions. Closures and instances only
+ * contribute their kind, so the key is stable across requests.
+ * ============================================================================ */
+
+static void sf_cache_hash_str(PHP_SHA1_CTX *ctx, zend_string *s)
 {
-    if (buf && buf->s) {
-        smart_str_free(buf);
-    }
-    if (fp) {
-        fclose(fp);
+    uint32_t len = (uint32_t)ZSTR_LEN(s);
+    PHP_SHA1Update(ctx, (const unsigned char *)&len, sizeof(len));
+    PHP_SHA1Update(ctx, (const unsigned char *)ZSTR_VAL(s), ZSTR_LEN(s));
+}
+
+static void sf_cache_hash_byte(PHP_SHA1_CTX *ctx, uint8_t b)
+{
+    PHP_SHA1Update(ctx, &b, 1);
+}
+
+static void sf_cache_hash_concrete(PHP_SHA1_CTX *ctx, zval *concrete)
+{
+    if (Z_TYPE_P(concrete) == IS_STRING) {
+        sf_cache_hash_byte(ctx, 's');
+        sf_cache_hash_str(ctx, Z_STR_P(concrete));
+    } else {
+        sf_cache_hash_byte(ctx, Z_TYPE_P(concrete) == IS_OBJECT ? 'o' : '?');
     }
 }
 
-/**
- * Cleanup helper for load operations.
- */
-static inline void sf_cache_load_cleanup(FILE *fp, char *key_buf, char *val_buf)
+/* Tables are delimited by a tag byte and their size */
+static void sf_cache_hash_count(PHP_SHA1_CTX *ctx, uint8_t tag, uint32_t count)
+{
+    sf_cache_hash_byte(ctx, tag);
+    PHP_SHA1Update(ctx, (const unsigned char *)&count, sizeof(count));
+}
+
+static void sf_cache_hash_table(PHP_SHA1_CTX *ctx, uint8_t tag, HashTable *table)
 {
-    if (key_buf) efree(key_buf);
-    if (val_buf) efree(val_buf);
-    if (fp) fclose(fp);
+    sf_cache_hash_count(ctx, tag, zend_hash_num_elements(table));
 }
 
 /**
- * Generate cache file path based on bindings hash.
+ * Generate the default snapshot path from a content hash of the graph.
  */
-zend_string *sf_cache_get_path(HashTable *bindings)
+zend_string *sf_cache_get_path(sf_container *c)
 {
-    if (!bindings) {
+    if (!c) {
         return NULL;
     }
     
-    /* Generate hash of all binding keys */
-    zend_ulong hash = 0;
+    PHP_SHA1_CTX ctx;
+    PHP_SHA1Init(&ctx);
+    
+    uint32_t versions[2] = { PHP_VERSION_ID, SF_CACHE_VERSION };
+    PHP_SHA1Update(&ctx, (const unsigned char *)PHP_SIGNALFORGE_CONTAINER_VERSION, sizeof(PHP_SIGNALFORGE_CONTAINER_VERSION));
+    PHP_SHA1Update(&ctx, (const unsigned char *)versions, sizeof(versions));
+    
     zend_string *key;
     zval *val;
     
-    ZEND_HASH_FOREACH_STR_KEY_VAL(bindings, key, val) {
-        if (key) {
-            hash = zend_inline_hash_func(ZSTR_VAL(key), ZSTR_LEN(key)) ^ hash;
+    sf_cache_hash_table(&ctx, 'B', &c->bindings);
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->bindings, key, val) {
+        sf_binding *binding = (sf_binding *)Z_PTR_P(val);
+        sf_cache_hash_str(&ctx, key);
+        sf_cache_hash_concrete(&ctx, &binding->concrete);
+        sf_cache_hash_byte(&ctx, binding->scope);
+        sf_cache_hash_byte(&ctx, binding->lazy);
+    } ZEND_HASH_FOREACH_END();
+    
+    sf_cache_hash_table(&ctx, 'A', &c->aliases);
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->aliases, key, val) {
+        sf_cache_hash_str(&ctx, key);
+        sf_cache_hash_str(&ctx, Z_STR_P(val));
+    } ZEND_HASH_FOREACH_END();
+    
+    sf_cache_hash_table(&ctx, 'C', &c->contextual_bindings);
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->contextual_bindings, key, val) {
+        HashTable *rules = (HashTable *)Z_PTR_P(val);
+        zval *rule;
+        
+        sf_cache_hash_str(&ctx, key);
+        sf_cache_hash_table(&ctx, 'N', rules);
+        ZEND_HASH_FOREACH_VAL(rules, rule) {
+            sf_contextual_binding *binding = (sf_contextual_binding *)Z_PTR_P(rule);
+            sf_cache_hash_str(&ctx, binding->abstract);
+            sf_cache_hash_concrete(&ctx, &binding->implementation);
+        } ZEND_HASH_FOREACH_END();
+    } ZEND_HASH_FOREACH_END();
+    
+    sf_cache_hash_table(&ctx, 'T', &c->tags);
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->tags, key, val) {
+        sf_tag *tag = (sf_tag *)Z_PTR_P(val);
+        
+        sf_cache_hash_str(&ctx, key);
+        sf_cache_hash_count(&ctx, 'L', tag->count);
+        for (uint32_t i = 0; i < tag->count; i++) {
+            sf_cache_hash_str(&ctx, tag->members[i].abstract);
         }
     } ZEND_HASH_FOREACH_END();
     
+    unsigned char digest[20];
+    char hex[41];
+    PHP_SHA1Final(digest, &ctx);
+    make_sha1_digest(hex, digest);
+    
     /* Use system temp directory - platform-specific */
     const char *tmpdir;
     
@@ -74,23 +178,15 @@ zend_string *sf_cache_get_path(HashTable *bindings)
     tmpdir = getenv("TEMP");
     if (!tmpdir) tmpdir = getenv("TMP");
     if (!tmpdir) tmpdir = "C:\\Windows\\Temp";
+    const char *sep = "\\";
 #else
     tmpdir = getenv("TMPDIR");
     if (!tmpdir) tmpdir = "/tmp";
+    const char *sep = "/";
 #endif
     
-    /* Format: {tmpdir}/signalforge_cache_<hash>.bin */
-    char path[512];
-    snprintf(path, sizeof(path), "%s%ssignalforge_cache_%016lx.bin", 
-             tmpdir, 
-#ifdef _WIN32
-             "\\",
-#else
-             "/",
-#endif
-             hash);
-    
-    return zend_string_init(path, strlen(path), 0);
+    /* Format: {tmpdir}/signalforge_cache_<sha1>.bin */
+    return strpprintf(0, "%s%ssignalforge_cache_%s.bin", tmpdir, sep, hex);
 }
 
 /**
@@ -108,14 +204,15 @@ int sf_cache_exists(const char *path)
         return 0;
     }
     
-    /* Try to open and verify magic number */
+    /* Try to open and verify the header */
     FILE *fp = fopen(path, "rb");
     if (!fp) {
         return 0;
     }
     
-    uint32_t magic = 0;
-    if (fread(&magic, sizeof(magic), 1, fp) != 1 || magic != SF_CACHE_MAGIC) {
+    uint32_t magic = 0, version = 0;
+    if (fread(&magic, sizeof(magic), 1, fp) != 1 || magic != SF_CACHE_MAGIC
+        || fread(&version, sizeof(version), 1, fp) != 1 || version != SF_CACHE_VERSION) {
         fclose(fp);
         return 0;
     }
@@ -124,231 +221,913 @@ int sf_cache_exists(const char *path)
     return 1;
 }
 
-/**
- * Save singleton instances to binary cache file.
- */
-int sf_cache_save(const char *path, HashTable *instances)
+/* ============================================================================
+ * Writing
+ *
+ * Every section is collected in its own buffer; strings are deduplicated
+ * through a name => id table as records reference them.
+ * ============================================================================ */
+
+typedef struct {
+    smart_str sections[SF_SNAP_SECTIONS];
+    uint32_t counts[SF_SNAP_SECTIONS];
+    HashTable ids;                    /* string => id */
+} sf_snapshot_writer;
+
+static uint32_t sf_snapshot_string(sf_snapshot_writer *w, zend_string *s)
 {
-    if (!path || !instances) {
-        return FAILURE;
+    if (!s) {
+        return 0;
     }
     
-    /* Don't save if hash table is empty or corrupted */
-    if (zend_hash_num_elements(instances) == 0) {
-        return SUCCESS;
+    zval *known = zend_hash_find(&w->ids, s);
+    if (known) {
+        return (uint32_t)Z_LVAL_P(known);
     }
     
-    FILE *fp = fopen(path, "wb");
-    if (!fp) {
-        php_error_docref(NULL, E_WARNING, 
-            "Failed to open cache file for writing: %s (error: %s)", 
-            path, strerror(errno));
-        return FAILURE;
-    }
+    smart_str *data = &w->sections[SF_SNAP_STRING_DATA];
+    uint32_t offset = data->s ? (uint32_t)ZSTR_LEN(data->s) : 0;
+    uint32_t len = (uint32_t)ZSTR_LEN(s);
+    
+    smart_str_appendl(&w->sections[SF_SNAP_STRINGS], (const char *)&offset, sizeof(offset));
+    smart_str_appendl(data, (const char *)&len, sizeof(len));
+    smart_str_appendl(data, ZSTR_VAL(s), len);
+    smart_str_appendc(data, '\0');
     
-    /* Count objects only */
-    uint32_t count = 0;
+    uint32_t id = w->counts[SF_SNAP_STRINGS]++;
+    zval zid;
+    ZVAL_LONG(&zid, id);
+    zend_hash_add_new(&w->ids, s, &zid);
+    return id;
+}
+
+static zend_always_inline void sf_snapshot_emit(sf_snapshot_writer *w, int section, const void *record)
+{
+    smart_str_appendl(&w->sections[section], (const char *)record, sf_snapshot_record_size[section]);
+    w->counts[section]++;
+}
+
+static void sf_snapshot_write_bindings(sf_snapshot_writer *w, sf_container *c)
+{
     zend_string *key;
     zval *val;
-    ZEND_HASH_FOREACH_STR_KEY_VAL(instances, key, val) {
-        if (key && val && Z_TYPE_P(val) == IS_OBJECT) {
-            count++;
+    
+    /* Class bindings only - closures and objects die with the request */
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->bindings, key, val) {
+        sf_binding *binding = (sf_binding *)Z_PTR_P(val);
+        if (Z_TYPE(binding->concrete) != IS_STRING || binding->scope == SF_SCOPE_INSTANCE) {
+            continue;
         }
+        
+        sf_snapshot_binding rec = {0};
+        rec.abstract = sf_snapshot_string(w, key);
+        rec.concrete = sf_snapshot_string(w, Z_STR(binding->concrete));
+        rec.scope = binding->scope;
+        rec.lazy = binding->lazy;
+        sf_snapshot_emit(w, SF_SNAP_BINDINGS, &rec);
     } ZEND_HASH_FOREACH_END();
     
-    /* Write header */
-    uint32_t magic = SF_CACHE_MAGIC;
-    uint32_t version = SF_CACHE_VERSION;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->aliases, key, val) {
+        sf_snapshot_alias rec = {0};
+        rec.alias = sf_snapshot_string(w, key);
+        rec.target = sf_snapshot_string(w, Z_STR_P(val));
+        sf_snapshot_emit(w, SF_SNAP_ALIASES, &rec);
+    } ZEND_HASH_FOREACH_END();
     
-    if (fwrite(&magic, sizeof(magic), 1, fp) != 1 ||
-        fwrite(&version, sizeof(version), 1, fp) != 1 ||
-        fwrite(&count, sizeof(count), 1, fp) != 1) {
-        php_error_docref(NULL, E_WARNING, 
-            "Failed to write cache header to: %s", path);
-        sf_cache_save_cleanup(fp, NULL);
-        return FAILURE;
-    }
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->tags, key, val) {
+        sf_tag *tag = (sf_tag *)Z_PTR_P(val);
+        sf_snapshot_tag rec = {0};
+        
+        rec.name = sf_snapshot_string(w, key);
+        rec.item_start = w->counts[SF_SNAP_TAG_ITEMS];
+        for (uint32_t i = 0; i < tag->count; i++) {
+            uint32_t id = sf_snapshot_string(w, tag->members[i].abstract);
+            sf_snapshot_emit(w, SF_SNAP_TAG_ITEMS, &id);
+        }
+        rec.item_count = tag->count;
+        sf_snapshot_emit(w, SF_SNAP_TAGS, &rec);
+    } ZEND_HASH_FOREACH_END();
+    
+    ZEND_HASH_FOREACH_VAL(&c->contextual_bindings, val) {
+        zval *rule;
+        ZEND_HASH_FOREACH_VAL((HashTable *)Z_PTR_P(val), rule) {
+            sf_contextual_binding *binding = (sf_contextual_binding *)Z_PTR_P(rule);
+            if (Z_TYPE(binding->implementation) != IS_STRING) {
+                continue;
+            }
+            
+            sf_snapshot_contextual rec = {0};
+            rec.concrete = sf_snapshot_string(w, binding->concrete);
+            rec.abstract = sf_snapshot_string(w, binding->abstract);
+            rec.implementation = sf_snapshot_string(w, Z_STR(binding->implementation));
+            sf_snapshot_emit(w, SF_SNAP_CONTEXTUAL, &rec);
+        } ZEND_HASH_FOREACH_END();
+    } ZEND_HASH_FOREACH_END();
+}
+
+static void sf_snapshot_write_classes(sf_snapshot_writer *w, sf_container *c)
+{
+    zval *val;
     
-    /* Write each service */
-    ZEND_HASH_FOREACH_STR_KEY_VAL(instances, key, val) {
-        if (!key || !val) continue;
+    ZEND_HASH_FOREACH_VAL(&c->reflection_cache, val) {
+        sf_class_meta *meta = (sf_class_meta *)Z_PTR_P(val);
+        zend_class_entry *ce = zend_lookup_class_ex(meta->class_name, NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD);
         
-        /* Skip if value is not an object (safety check) */
-        if (Z_TYPE_P(val) != IS_OBJECT) {
+        /* Only metadata known to describe the class as it is now */
+        if (!ce || (meta->epoch != c->epoch && !sf_cache_matches(meta, ce))) {
             continue;
         }
         
-        /* Write key */
-        uint32_t key_len = ZSTR_LEN(key);
-        if (fwrite(&key_len, sizeof(key_len), 1, fp) != 1 ||
-            fwrite(ZSTR_VAL(key), key_len, 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to write service key to cache: %s", ZSTR_VAL(key));
-            sf_cache_save_cleanup(fp, NULL);
-            return FAILURE;
-        }
+        sf_snapshot_class rec = {0};
+        rec.name = sf_snapshot_string(w, meta->class_name);
+        rec.param_start = w->counts[SF_SNAP_PARAMS];
+        rec.param_count = meta->param_count;
+        rec.is_instantiable = meta->is_instantiable;
+        rec.ctor_elidable = meta->ctor_elidable;
+        rec.attributes = meta->attributes;
+        rec.bind_to = sf_snapshot_string(w, meta->bind_to);
         
-        /* Serialize value using PHP's serialize() */
-        php_serialize_data_t var_hash;
-        smart_str buf = {0};
+        /* Eval'd classes have no file to compare against */
+        struct stat st;
+        if (ce->type == ZEND_USER_CLASS && ce->info.user.filename
+            && stat(ZSTR_VAL(ce->info.user.filename), &st) == 0) {
+            rec.file = sf_snapshot_string(w, ce->info.user.filename);
+            rec.mtime = (int64_t)st.st_mtime;
+        }
         
-        PHP_VAR_SERIALIZE_INIT(var_hash);
-        php_var_serialize(&buf, val, &var_hash);
-        PHP_VAR_SERIALIZE_DESTROY(var_hash);
+        for (uint32_t i = 0; i < meta->param_count; i++) {
+            uint8_t flags = meta->param_flags[i];
+            sf_snapshot_param param = {0};
+            
+            param.name = sf_snapshot_string(w, meta->param_names[i]);
+            param.type_hint = sf_snapshot_string(w, meta->param_types[i]);
+            param.inject = sf_snapshot_string(w, meta->param_injects ? meta->param_injects[i] : NULL);
+            param.prop_num = meta->prop_nums ? meta->prop_nums[i] : SF_PROP_NONE;
+            param.is_nullable = (flags & SF_PARAM_NULLABLE) != 0;
+            param.has_default = (flags & SF_PARAM_DEFAULT) != 0;
+            param.is_variadic = (flags & SF_PARAM_VARIADIC) != 0;
+            sf_snapshot_emit(w, SF_SNAP_PARAMS, &param);
+        }
+        sf_snapshot_emit(w, SF_SNAP_CLASSES, &rec);
+    } ZEND_HASH_FOREACH_END();
+}
+
+static void sf_snapshot_write_plans(sf_snapshot_writer *w, sf_container *c)
+{
+    zval *val;
+    
+    ZEND_HASH_FOREACH_VAL(&c->compiled_factories, val) {
+        sf_factory *factory = (sf_factory *)Z_PTR_P(val);
         
-        if (!buf.s || ZSTR_LEN(buf.s) == 0) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to serialize service: %s", ZSTR_VAL(key));
-            sf_cache_save_cleanup(fp, &buf);
-            return FAILURE;
+        if (factory->epoch != c->epoch || factory->generation != c->generation) {
+            sf_compiler_revalidate(c, factory);
+        }
+        if (!factory->steps) {
+            continue;
         }
         
-        /* Write serialized value */
-        uint32_t val_len = ZSTR_LEN(buf.s);
-        if (fwrite(&val_len, sizeof(val_len), 1, fp) != 1 ||
-            fwrite(ZSTR_VAL(buf.s), val_len, 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to write serialized service to cache: %s", ZSTR_VAL(key));
-            sf_cache_save_cleanup(fp, &buf);
-            return FAILURE;
+        sf_snapshot_plan rec = {0};
+        rec.abstract = sf_snapshot_string(w, factory->abstract);
+        rec.class_name = sf_snapshot_string(w, factory->class_name);
+        rec.step_start = w->counts[SF_SNAP_STEPS];
+        rec.step_count = factory->step_count;
+        rec.arg_start = w->counts[SF_SNAP_ARGS];
+        rec.arg_count = factory->arg_slot_count;
+        rec.is_singleton = factory->is_singleton;
+        
+        for (uint32_t i = 0; i < factory->step_count; i++) {
+            sf_plan_step *step = &factory->steps[i];
+            sf_snapshot_step out = {0};
+            
+            out.key = sf_snapshot_string(w, step->key);
+            out.class_name = sf_snapshot_string(w, step->class_name);
+            out.requester = sf_snapshot_string(w, step->requester);
+            out.arg_start = step->arg_start;
+            out.arg_count = step->arg_count;
+            out.op = step->op;
+            out.is_singleton = step->is_singleton;
+            out.has_constructor = step->has_constructor;
+            out.elide_constructor = step->elide_constructor;
+            sf_snapshot_emit(w, SF_SNAP_STEPS, &out);
         }
         
-        smart_str_free(&buf);
+        for (uint32_t i = 0; i < factory->arg_slot_count; i++) {
+            sf_snapshot_arg arg;
+            arg.slot = factory->arg_slots[i];
+            arg.prop = factory->arg_props[i];
+            sf_snapshot_emit(w, SF_SNAP_ARGS, &arg);
+        }
+        sf_snapshot_emit(w, SF_SNAP_PLANS, &rec);
     } ZEND_HASH_FOREACH_END();
+}
+
+/* Write a complete snapshot to `fp` (the temporary file of a save, closed here) */
+static int sf_snapshot_write(FILE *fp, const char *path, sf_container *c)
+{
+    sf_snapshot_writer w;
+    memset(&w, 0, sizeof(w));
+    zend_hash_init(&w.ids, 64, NULL, NULL, 0);
     
-    fclose(fp);
+    /* String id 0 is "no string" */
+    uint32_t none_offset = 0, none_len = 0;
+    smart_str_appendl(&w.sections[SF_SNAP_STRINGS], (const char *)&none_offset, sizeof(none_offset));
+    smart_str_appendl(&w.sections[SF_SNAP_STRING_DATA], (const char *)&none_len, sizeof(none_len));
+    smart_str_appendc(&w.sections[SF_SNAP_STRING_DATA], '\0');
+    w.counts[SF_SNAP_STRINGS] = 1;
+    
+    sf_snapshot_write_bindings(&w, c);
+    sf_snapshot_write_classes(&w, c);
+    sf_snapshot_write_plans(&w, c);
+    
+    /* Lay the sections out behind the header */
+    sf_snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SF_CACHE_MAGIC;
+    header.version = SF_CACHE_VERSION;
+    header.php_version = PHP_VERSION_ID;
+    
+    size_t offset = SF_SNAPSHOT_ALIGN(sizeof(header));
+    w.counts[SF_SNAP_STRING_DATA] = (uint32_t)ZSTR_LEN(w.sections[SF_SNAP_STRING_DATA].s);
+    for (int i = 0; i < SF_SNAP_SECTIONS; i++) {
+        size_t len = w.sections[i].s ? ZSTR_LEN(w.sections[i].s) : 0;
+        header.sections[i].offset = (uint32_t)offset;
+        header.sections[i].count = w.counts[i];
+        offset = SF_SNAPSHOT_ALIGN(offset + len);
+    }
+    header.size = (uint32_t)offset;
+    
+    int ret = FAILURE;
+    
+    if (offset > UINT32_MAX) {
+        php_error_docref(NULL, E_WARNING, "Snapshot too large: %s", path);
+        fclose(fp);
+        goto cleanup;
+    }
+    
+    static const char zeros[8] = {0};
+    size_t written = sizeof(header);
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+        goto write_error;
+    }
+    for (int i = 0; i < SF_SNAP_SECTIONS; i++) {
+        size_t pad = header.sections[i].offset - written;
+        if (pad && fwrite(zeros, pad, 1, fp) != 1) {
+            goto write_error;
+        }
+        written += pad;
+        
+        if (w.sections[i].s && ZSTR_LEN(w.sections[i].s)) {
+            if (fwrite(ZSTR_VAL(w.sections[i].s), ZSTR_LEN(w.sections[i].s), 1, fp) != 1) {
+                goto write_error;
+            }
+            written += ZSTR_LEN(w.sections[i].s);
+        }
+    }
+    if (header.size > written && fwrite(zeros, header.size - written, 1, fp) != 1) {
+        goto write_error;
+    }
+    
+    ret = SUCCESS;
+    
+write_error:
+    if (fclose(fp) != 0 || ret != SUCCESS) {
+        php_error_docref(NULL, E_WARNING, "Failed to write snapshot to: %s", path);
+        ret = FAILURE;
+    }
+    
+cleanup:
+    for (int i = 0; i < SF_SNAP_SECTIONS; i++) {
+        smart_str_free(&w.sections[i]);
+    }
+    zend_hash_destroy(&w.ids);
+    return ret;
+}
+
+/* ============================================================================
+ * Reading
+ * ============================================================================ */
+
+typedef struct {
+    const char *base;                 /* Mapped file */
+    size_t size;
+    const sf_snapshot_header *header;
+    zend_string **strings;            /* Materialised on first use, by id */
+    uint32_t string_count;
+    zend_bool persistent;             /* Strings go into a persistent container */
+} sf_snapshot_reader;
+
+#define SF_SNAPSHOT_RECORDS(r, type, section) \
+    ((const type *)((r)->base + (r)->header->sections[section].offset))
+    
+#define SF_SNAPSHOT_COUNT(r, section) ((r)->header->sections[section].count)
+
+static const char *sf_snapshot_map(const char *path, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size < sizeof(sf_snapshot_header)) {
+        close(fd);
+        return NULL;
+    }
+#ifndef _WIN32
+    /* Plans are executed as they are - only trust files nobody else could have written */
+    if (st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        close(fd);
+        return NULL;
+    }
+#endif
+    *size = (size_t)st.st_size;
     
-    /* Set permissions to 0600 (owner read/write only) */
 #ifdef _WIN32
-    /* On Windows, use _chmod with _S_IREAD | _S_IWRITE */
-    if (chmod(path, S_IRUSR | S_IWUSR) != 0) {
-        php_error_docref(NULL, E_WARNING, 
-            "Failed to set cache file permissions: %s", path);
+    char *base = emalloc(*size);
+    if (read(fd, base, (unsigned int)*size) != (int)*size) {
+        efree(base);
+        base = NULL;
     }
 #else
-    /* On Unix-like systems, use chmod with 0600 */
-    if (chmod(path, 0600) != 0) {
-        php_error_docref(NULL, E_WARNING, 
-            "Failed to set cache file permissions: %s", path);
+    char *base = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        base = NULL;
     }
 #endif
     
-    return SUCCESS;
+    close(fd);
+    return base;
 }
 
-/**
- * Load singleton instances from binary cache file.
+static void sf_snapshot_unmap(const char *base, size_t size)
+{
+#ifdef _WIN32
+    efree((char *)base);
+#else
+    munmap((void *)base, size);
+#endif
+}
+
+static zend_always_inline zend_bool sf_snapshot_id_ok(sf_snapshot_reader *r, uint32_t id, zend_bool required)
+{
+    return id < r->string_count && (id != 0 || !required);
+}
+
+static zend_string *sf_snapshot_get_string(sf_snapshot_reader *r, uint32_t id)
+{
+    if (id == 0) {
+        return NULL;
+    }
+    
+    if (!r->strings[id]) {
+        const char *data = r->base + r->header->sections[SF_SNAP_STRING_DATA].offset;
+        uint32_t offset = SF_SNAPSHOT_RECORDS(r, uint32_t, SF_SNAP_STRINGS)[id];
+        uint32_t len;
+        
+        memcpy(&len, data + offset, sizeof(len));
+        if (r->persistent) {
+            r->strings[id] = sf_string_share(data + offset + sizeof(len), len);
+        } else {
+            r->strings[id] = zend_string_init(data + offset + sizeof(len), len, 0);
+            zend_string_hash_val(r->strings[id]);
+        }
+    }
+    return r->strings[id];
+}
+
+/*
+ * Check the whole file before anything is imported. Every offset, count,
+ * string id and cross-section range is bounds-checked, and plan steps may only
+ * read slots of earlier steps - the executor relies on that.
  */
-int sf_cache_load(const char *path, HashTable *instances)
+static zend_bool sf_snapshot_verify(sf_snapshot_reader *r)
 {
-    FILE *fp = fopen(path, "rb");
-    if (!fp) {
-        php_error_docref(NULL, E_WARNING, 
-            "Failed to open cache file for reading: %s (error: %s)", 
-            path, strerror(errno));
-        return FAILURE;
+    const sf_snapshot_header *h = r->header;
+    
+    if (h->magic != SF_CACHE_MAGIC || h->version != SF_CACHE_VERSION
+        || h->php_version != PHP_VERSION_ID || h->size != r->size) {
+        return 0;
+    }
+    
+    for (int i = 0; i < SF_SNAP_SECTIONS; i++) {
+        uint64_t end = (uint64_t)h->sections[i].offset + (uint64_t)h->sections[i].count * sf_snapshot_record_size[i];
+        if ((h->sections[i].offset & 7) || h->sections[i].offset < sizeof(*h) || end > r->size) {
+            return 0;
+        }
     }
     
-    /* Read and verify header */
-    uint32_t magic, version, count;
+    /* Strings: length-prefixed and NUL-terminated inside the data section */
+    const char *data = r->base + h->sections[SF_SNAP_STRING_DATA].offset;
+    uint32_t data_size = h->sections[SF_SNAP_STRING_DATA].count;
+    const uint32_t *offsets = SF_SNAPSHOT_RECORDS(r, uint32_t, SF_SNAP_STRINGS);
     
-    if (fread(&magic, sizeof(magic), 1, fp) != 1) {
-        php_error_docref(NULL, E_WARNING, "Failed to read cache magic number");
-        sf_cache_load_cleanup(fp, NULL, NULL);
-        return FAILURE;
+    r->string_count = SF_SNAPSHOT_COUNT(r, SF_SNAP_STRINGS);
+    if (r->string_count == 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < r->string_count; i++) {
+        uint32_t len;
+        if ((uint64_t)offsets[i] + sizeof(len) > data_size) {
+            return 0;
+        }
+        memcpy(&len, data + offsets[i], sizeof(len));
+        if ((uint64_t)offsets[i] + sizeof(len) + len + 1 > data_size || data[offsets[i] + sizeof(len) + len] != '\0') {
+            return 0;
+        }
     }
     
-    if (magic != SF_CACHE_MAGIC) {
-        php_error_docref(NULL, E_WARNING, 
-            "Invalid cache file magic number: 0x%08x (expected 0x%08x)", 
-            magic, SF_CACHE_MAGIC);
-        sf_cache_load_cleanup(fp, NULL, NULL);
-        return FAILURE;
+    const sf_snapshot_binding *bindings = SF_SNAPSHOT_RECORDS(r, sf_snapshot_binding, SF_SNAP_BINDINGS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_BINDINGS); i++) {
+        if (!sf_snapshot_id_ok(r, bindings[i].abstract, 1) || !sf_snapshot_id_ok(r, bindings[i].concrete, 1)
+            || (bindings[i].scope != SF_SCOPE_TRANSIENT && bindings[i].scope != SF_SCOPE_SINGLETON
+                && bindings[i].scope != SF_SCOPE_SCOPED)) {
+            return 0;
+        }
     }
     
-    if (fread(&version, sizeof(version), 1, fp) != 1) {
-        php_error_docref(NULL, E_WARNING, "Failed to read cache version");
-        sf_cache_load_cleanup(fp, NULL, NULL);
-        return FAILURE;
+    const sf_snapshot_alias *aliases = SF_SNAPSHOT_RECORDS(r, sf_snapshot_alias, SF_SNAP_ALIASES);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_ALIASES); i++) {
+        if (!sf_snapshot_id_ok(r, aliases[i].alias, 1) || !sf_snapshot_id_ok(r, aliases[i].target, 1)) {
+            return 0;
+        }
     }
     
-    if (version != SF_CACHE_VERSION) {
-        php_error_docref(NULL, E_WARNING, 
-            "Incompatible cache version: %u (expected %u)", 
-            version, SF_CACHE_VERSION);
-        sf_cache_load_cleanup(fp, NULL, NULL);
-        return FAILURE;
+    const sf_snapshot_tag *tags = SF_SNAPSHOT_RECORDS(r, sf_snapshot_tag, SF_SNAP_TAGS);
+    const uint32_t *tag_items = SF_SNAPSHOT_RECORDS(r, uint32_t, SF_SNAP_TAG_ITEMS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_TAGS); i++) {
+        if (!sf_snapshot_id_ok(r, tags[i].name, 1)
+            || (uint64_t)tags[i].item_start + tags[i].item_count > SF_SNAPSHOT_COUNT(r, SF_SNAP_TAG_ITEMS)) {
+            return 0;
+        }
+    }
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_TAG_ITEMS); i++) {
+        if (!sf_snapshot_id_ok(r, tag_items[i], 1)) {
+            return 0;
+        }
     }
     
-    if (fread(&count, sizeof(count), 1, fp) != 1) {
-        php_error_docref(NULL, E_WARNING, "Failed to read service count");
-        sf_cache_load_cleanup(fp, NULL, NULL);
-        return FAILURE;
+    const sf_snapshot_contextual *contextual = SF_SNAPSHOT_RECORDS(r, sf_snapshot_contextual, SF_SNAP_CONTEXTUAL);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_CONTEXTUAL); i++) {
+        if (!sf_snapshot_id_ok(r, contextual[i].concrete, 1) || !sf_snapshot_id_ok(r, contextual[i].abstract, 1)
+            || !sf_snapshot_id_ok(r, contextual[i].implementation, 1)) {
+            return 0;
+        }
+    }
+    
+    const sf_snapshot_class *classes = SF_SNAPSHOT_RECORDS(r, sf_snapshot_class, SF_SNAP_CLASSES);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_CLASSES); i++) {
+        if (!sf_snapshot_id_ok(r, classes[i].name, 1) || !sf_snapshot_id_ok(r, classes[i].file, 0)
+            || (uint64_t)classes[i].param_start + classes[i].param_count > SF_SNAPSHOT_COUNT(r, SF_SNAP_PARAMS)) {
+            return 0;
+        }
     }
     
-    /* Read each service */
-    for (uint32_t i = 0; i < count; i++) {
-        uint32_t key_len;
-        if (fread(&key_len, sizeof(key_len), 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to read key length for service %u", i);
-            sf_cache_load_cleanup(fp, NULL, NULL);
-            return FAILURE;
+    const sf_snapshot_param *params = SF_SNAPSHOT_RECORDS(r, sf_snapshot_param, SF_SNAP_PARAMS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_PARAMS); i++) {
+        if (!sf_snapshot_id_ok(r, params[i].name, 1) || !sf_snapshot_id_ok(r, params[i].type_hint, 0)) {
+            return 0;
         }
+    }
+    
+    const sf_snapshot_plan *plans = SF_SNAPSHOT_RECORDS(r, sf_snapshot_plan, SF_SNAP_PLANS);
+    const sf_snapshot_step *steps = SF_SNAPSHOT_RECORDS(r, sf_snapshot_step, SF_SNAP_STEPS);
+    const sf_snapshot_arg *args = SF_SNAPSHOT_RECORDS(r, sf_snapshot_arg, SF_SNAP_ARGS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_PLANS); i++) {
+        const sf_snapshot_plan *plan = &plans[i];
         
-        /* Read key */
-        char *key_buf = emalloc(key_len + 1);
-        if (fread(key_buf, key_len, 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to read key data for service %u", i);
-            sf_cache_load_cleanup(fp, key_buf, NULL);
-            return FAILURE;
-        }
-        key_buf[key_len] = '\0';
+        if (!sf_snapshot_id_ok(r, plan->abstract, 1) || !sf_snapshot_id_ok(r, plan->class_name, 1)
+            || plan->step_count == 0
+            || (uint64_t)plan->step_start + plan->step_count > SF_SNAPSHOT_COUNT(r, SF_SNAP_STEPS)
+            || (uint64_t)plan->arg_start + plan->arg_count > SF_SNAPSHOT_COUNT(r, SF_SNAP_ARGS)
+            || steps[plan->step_start + plan->step_count - 1].op != SF_PLAN_CONSTRUCT) {
+            return 0;
+        }
         
-        /* Read serialized value length */
-        uint32_t val_len;
-        if (fread(&val_len, sizeof(val_len), 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to read value length for service: %s", key_buf);
-            sf_cache_load_cleanup(fp, key_buf, NULL);
-            return FAILURE;
+        for (uint32_t s = 0; s < plan->step_count; s++) {
+            const sf_snapshot_step *step = &steps[plan->step_start + s];
+            
+            if (!sf_snapshot_id_ok(r, step->key, 1) || !sf_snapshot_id_ok(r, step->requester, 0)
+                || !sf_snapshot_id_ok(r, step->class_name, step->op == SF_PLAN_CONSTRUCT)
+                || step->op > SF_PLAN_MAKE
+                || (uint64_t)step->arg_start + step->arg_count > plan->arg_count) {
+                return 0;
+            }
+            for (uint32_t a = 0; a < step->arg_count; a++) {
+                if (args[plan->arg_start + step->arg_start + a].slot >= s) {
+                    return 0;
+                }
+            }
+        }
+    }
+    
+    return 1;
+}
+
+/*
+ * With opcache not re-checking timestamps, files on disk don't reflect the
+ * code that runs, so comparing mtimes would only reject good snapshots.
+ */
+static zend_bool sf_snapshot_trusts_files(void)
+{
+    bool exists = 0;
+    const char *enable = strcmp(sapi_module.name, "cli") == 0 ? "opcache.enable_cli" : "opcache.enable";
+    char *enabled = zend_ini_string_ex(enable, strlen(enable), 0, &exists);
+    
+    if (!exists || !enabled || atoi(enabled) == 0) {
+        return 0;
+    }
+    
+    char *validate = zend_ini_string_ex("opcache.validate_timestamps", sizeof("opcache.validate_timestamps") - 1, 0, &exists);
+    return exists && validate && atoi(validate) == 0;
+}
+
+/* Has any class file changed since the snapshot was written? */
+static zend_bool sf_snapshot_is_stale(sf_snapshot_reader *r)
+{
+    if (sf_snapshot_trusts_files()) {
+        return 0;
+    }
+    
+    const sf_snapshot_class *classes = SF_SNAPSHOT_RECORDS(r, sf_snapshot_class, SF_SNAP_CLASSES);
+    const char *data = r->base + r->header->sections[SF_SNAP_STRING_DATA].offset;
+    const uint32_t *offsets = SF_SNAPSHOT_RECORDS(r, uint32_t, SF_SNAP_STRINGS);
+    uint32_t last_file = 0;
+    
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_CLASSES); i++) {
+        /* Classes of one file are usually adjacent - stat it once */
+        if (classes[i].file == 0 || classes[i].file == last_file) {
+            continue;
         }
         
-        /* Read serialized value */
-        char *val_buf = emalloc(val_len + 1);
-        if (fread(val_buf, val_len, 1, fp) != 1) {
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to read value data for service: %s", key_buf);
-            sf_cache_load_cleanup(fp, key_buf, val_buf);
-            return FAILURE;
-        }
-        val_buf[val_len] = '\0';
+        struct stat st;
+        const char *file = data + offsets[classes[i].file] + sizeof(uint32_t);
+        if (stat(file, &st) != 0 || (int64_t)st.st_mtime != classes[i].mtime) {
+            return 1;
+        }
+        last_file = classes[i].file;
+    }
+    
+    return 0;
+}
+
+static void sf_snapshot_import_bindings(sf_snapshot_reader *r, sf_container *c)
+{
+    const sf_snapshot_binding *bindings = SF_SNAPSHOT_RECORDS(r, sf_snapshot_binding, SF_SNAP_BINDINGS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_BINDINGS); i++) {
+        zend_string *abstract = sf_snapshot_get_string(r, bindings[i].abstract);
+        zend_string *concrete = sf_snapshot_get_string(r, bindings[i].concrete);
         
-        /* Unserialize value */
-        zval unserialized;
-        php_unserialize_data_t var_hash;
-        const unsigned char *p = (const unsigned char *)val_buf;
+        if (bindings[i].lazy) {
+            sf_container_lazy(c, abstract, concrete);
+        } else {
+            zval zv;
+            ZVAL_STR(&zv, concrete);
+            sf_container_bind(c, abstract, &zv, bindings[i].scope);
+        }
+    }
+    
+    const sf_snapshot_alias *aliases = SF_SNAPSHOT_RECORDS(r, sf_snapshot_alias, SF_SNAP_ALIASES);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_ALIASES); i++) {
+        sf_container_alias(c, sf_snapshot_get_string(r, aliases[i].target), sf_snapshot_get_string(r, aliases[i].alias));
+    }
+    
+    /* Tag lists append, so tags the application registered already are left alone */
+    const sf_snapshot_tag *tags = SF_SNAPSHOT_RECORDS(r, sf_snapshot_tag, SF_SNAP_TAGS);
+    const uint32_t *tag_items = SF_SNAPSHOT_RECORDS(r, uint32_t, SF_SNAP_TAG_ITEMS);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_TAGS); i++) {
+        zend_string *name = sf_snapshot_get_string(r, tags[i].name);
+        if (zend_hash_exists(&c->tags, name)) {
+            continue;
+        }
         
-        PHP_VAR_UNSERIALIZE_INIT(var_hash);
-        if (!php_var_unserialize(&unserialized, &p, p + val_len, &var_hash)) {
-            PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
-            php_error_docref(NULL, E_WARNING, 
-                "Failed to unserialize service: %s", key_buf);
-            sf_cache_load_cleanup(fp, key_buf, val_buf);
-            return FAILURE;
-        }
-        PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
+        sf_tag *tag = sf_tag_create(c->persistent);
+        for (uint32_t t = 0; t < tags[i].item_count; t++) {
+            sf_tag_append(tag, sf_snapshot_get_string(r, tag_items[tags[i].item_start + t]));
+        }
+        
+        zend_string *key = sf_string_copy_ex(name, c->persistent);
+        zend_hash_update_ptr(&c->tags, key, tag);
+        zend_string_release(key);
+    }
+    
+    const sf_snapshot_contextual *contextual = SF_SNAPSHOT_RECORDS(r, sf_snapshot_contextual, SF_SNAP_CONTEXTUAL);
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_CONTEXTUAL); i++) {
+        zval impl;
+        ZVAL_STR(&impl, sf_snapshot_get_string(r, contextual[i].implementation));
+        sf_container_add_contextual_binding(c, sf_snapshot_get_string(r, contextual[i].concrete),
+            sf_snapshot_get_string(r, contextual[i].abstract), &impl);
+    }
+}
+
+static void sf_snapshot_import_classes(sf_snapshot_reader *r, sf_container *c)
+{
+    const sf_snapshot_class *classes = SF_SNAPSHOT_RECORDS(r, sf_snapshot_class, SF_SNAP_CLASSES);
+    const sf_snapshot_param *params = SF_SNAPSHOT_RECORDS(r, sf_snapshot_param, SF_SNAP_PARAMS);
+    
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_CLASSES); i++) {
+        const sf_snapshot_class *rec = &classes[i];
+        zend_string *name = sf_snapshot_get_string(r, rec->name);
+        
+        /* Metadata built this process is at least as fresh */
+        if (sf_cache_get(name, &c->reflection_cache)) {
+            continue;
+        }
+        
+        sf_class_meta *meta = sf_class_meta_create(name, &c->arena);
+        meta->is_instantiable = rec->is_instantiable;
+        meta->ctor_elidable = rec->ctor_elidable;
+        meta->attributes = rec->attributes;
+        if (rec->bind_to) {
+            meta->bind_to = sf_string_copy_ex(sf_snapshot_get_string(r, rec->bind_to), c->persistent);
+        }
+        sf_class_meta_alloc_params(meta, rec->param_count);
+        if (!rec->ctor_elidable) {
+            meta->prop_nums = NULL;
+        }
         
-        /* Add to instances hash table */
-        zend_string *key_str = zend_string_init(key_buf, key_len, 0);
-        zend_hash_add(instances, key_str, &unserialized);
-        zend_string_release(key_str);
+        for (uint32_t p = 0; p < rec->param_count; p++) {
+            const sf_snapshot_param *param = &params[rec->param_start + p];
+            zend_string *type_hint = sf_snapshot_get_string(r, param->type_hint);
+            
+            meta->param_names[p] = sf_string_copy_ex(sf_snapshot_get_string(r, param->name), c->persistent);
+            meta->param_types[p] = type_hint ? sf_string_copy_ex(type_hint, c->persistent) : NULL;
+            meta->param_flags[p] = (param->is_nullable ? SF_PARAM_NULLABLE : 0)
+                | (param->has_default ? SF_PARAM_DEFAULT : 0)
+                | (param->is_variadic ? SF_PARAM_VARIADIC : 0);
+            if (meta->prop_nums) {
+                meta->prop_nums[p] = param->prop_num;
+            }
+            if (UNEXPECTED(param->inject)) {
+                if (!meta->param_injects) {
+                    sf_class_meta_alloc_injects(meta);
+                }
+                meta->param_injects[p] = sf_string_copy_ex(sf_snapshot_get_string(r, param->inject), c->persistent);
+            }
+        }
         
-        efree(key_buf);
-        efree(val_buf);
+        /* Epoch 0: compared against the live class on first use */
+        sf_cache_put(meta->class_name, meta, &c->reflection_cache);
+        sf_class_meta_release(meta);
     }
+}
+
+static uint32_t sf_snapshot_import_plans(sf_snapshot_reader *r, sf_container *c)
+{
+    const sf_snapshot_plan *plans = SF_SNAPSHOT_RECORDS(r, sf_snapshot_plan, SF_SNAP_PLANS);
+    const sf_snapshot_step *steps = SF_SNAPSHOT_RECORDS(r, sf_snapshot_step, SF_SNAP_STEPS);
+    const sf_snapshot_arg *args = SF_SNAPSHOT_RECORDS(r, sf_snapshot_arg, SF_SNAP_ARGS);
+    uint32_t imported = 0;
+    
+    for (uint32_t i = 0; i < SF_SNAPSHOT_COUNT(r, SF_SNAP_PLANS); i++) {
+        const sf_snapshot_plan *plan = &plans[i];
+        zend_string *abstract = sf_snapshot_get_string(r, plan->abstract);
+        zend_string *class_name = sf_snapshot_get_string(r, plan->class_name);
+        
+        /* make() parameter names come from the root's metadata */
+        sf_class_meta *meta = sf_cache_get(class_name, &c->reflection_cache);
+        if (!meta) {
+            continue;
+        }
+        
+        /* Steps borrow the reader's strings; sf_factory_set_plan() copies them */
+        sf_plan_step *plan_steps = ecalloc(plan->step_count, sizeof(sf_plan_step));
+        uint32_t *slots = plan->arg_count ? emalloc(sizeof(uint32_t) * plan->arg_count) : NULL;
+        uint32_t *props = plan->arg_count ? emalloc(sizeof(uint32_t) * plan->arg_count) : NULL;
+        
+        for (uint32_t s = 0; s < plan->step_count; s++) {
+            const sf_snapshot_step *rec = &steps[plan->step_start + s];
+            sf_plan_step *step = &plan_steps[s];
+            
+            step->key = sf_snapshot_get_string(r, rec->key);
+            step->class_name = sf_snapshot_get_string(r, rec->class_name);
+            step->requester = sf_snapshot_get_string(r, rec->requester);
+            step->ce = NULL;
+            step->arg_start = rec->arg_start;
+            step->arg_count = rec->arg_count;
+            step->op = rec->op;
+            step->is_singleton = rec->is_singleton;
+            step->has_constructor = rec->has_constructor;
+            step->elide_constructor = rec->elide_constructor;
+        }
+        for (uint32_t a = 0; a < plan->arg_count; a++) {
+            slots[a] = args[plan->arg_start + a].slot;
+            props[a] = args[plan->arg_start + a].prop;
+        }
+        
+        sf_factory *factory = sf_factory_create(abstract, class_name, NULL, c->persistent);
+        sf_factory_set_plan(factory, plan_steps, plan->step_count, slots, props, plan->arg_count);
+        sf_factory_set_params(factory, meta);
+        factory->is_singleton = plan->is_singleton;
+        factory->epoch = 0;  /* Class entries are looked up on first use */
+        
+        efree(plan_steps);
+        if (slots) {
+            efree(slots);
+            efree(props);
+        }
+        
+        sf_factory *old = zend_hash_find_ptr(&c->compiled_factories, factory->abstract);
+        if (old) {
+            sf_factory_release(old);
+        }
+        zend_hash_update_ptr(&c->compiled_factories, factory->abstract, factory);
+        imported++;
+    }
+    
+    /* The plans describe the graph just imported */
+    zval *val;
+    ZEND_HASH_FOREACH_VAL(&c->compiled_factories, val) {
+        sf_factory *factory = (sf_factory *)Z_PTR_P(val);
+        if (factory->epoch == 0) {
+            factory->generation = c->generation;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    return imported;
+}
+
+/*
+ * Map `path` and check that it can be imported. On failure nothing stays
+ * mapped; a corrupt file warns only if `warn` is set.
+ */
+static zend_bool sf_snapshot_open(sf_snapshot_reader *r, const char *path, zend_bool warn)
+{
+    memset(r, 0, sizeof(*r));
+    
+    r->base = sf_snapshot_map(path, &r->size);
+    if (!r->base) {
+        return 0;  /* Missing - the caller builds the graph itself */
+    }
+    r->header = (const sf_snapshot_header *)r->base;
+    
+    if (!sf_snapshot_verify(r)) {
+        if (warn) {
+            php_error_docref(NULL, E_WARNING, "Invalid or incompatible snapshot: %s", path);
+        }
+        sf_snapshot_unmap(r->base, r->size);
+        return 0;
+    }
+    
+    if (sf_snapshot_is_stale(r)) {
+        sf_snapshot_unmap(r->base, r->size);
+        return 0;
+    }
+    
+    return 1;
+}
+
+/**
+ * Map a snapshot file and import it into the container.
+ */
+int sf_cache_load(const char *path, sf_container *c)
+{
+    sf_snapshot_reader r;
+    
+    if (!sf_snapshot_open(&r, path, 1)) {
+        return FAILURE;
+    }
+    r.persistent = c->persistent;
+    r.strings = ecalloc(r.string_count, sizeof(zend_string *));
+    
+    /* Order matters: plans need the class metadata and the final generation */
+    sf_snapshot_import_bindings(&r, c);
+    sf_snapshot_import_classes(&r, c);
+    if (sf_snapshot_import_plans(&r, c) > 0) {
+        c->compilation_enabled = 1;
+    }
+    
+    for (uint32_t i = 0; i < r.string_count; i++) {
+        if (r.strings[i]) {
+            zend_string_release(r.strings[i]);
+        }
+    }
+    efree(r.strings);
+    sf_snapshot_unmap(r.base, r.size);
     
-    fclose(fp);
     return SUCCESS;
 }
+
+/* ============================================================================
+ * Saving
+ *
+ * Workers of one pool share the snapshot path, so saves are serialized by a
+ * non-blocking lock on "<path>.lock": whoever holds it writes, everyone else
+ * skips instead of waiting. The snapshot is written to a private temporary
+ * file and renamed over the old one, so readers only ever map a complete
+ * file.
+ * ============================================================================ */
+
+static int sf_snapshot_rename(const char *from, const char *to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(from, to);
+#endif
+}
+
+/**
+ * Check if a snapshot exists, is valid and no class file changed since.
+ */
+int sf_cache_is_current(const char *path)
+{
+    sf_snapshot_reader r;
+    
+    if (!sf_snapshot_open(&r, path, 0)) {
+        return 0;
+    }
+    sf_snapshot_unmap(r.base, r.size);
+    return 1;
+}
+
+/*
+ * Create the temporary file a save writes to. It sits next to `path` so the
+ * rename stays on one filesystem, gets a name nobody can predict, and is
+ * created exclusively with mode 0600 - a file or symlink planted there
+ * beforehand makes the open fail instead of being written through.
+ */
+static FILE *sf_snapshot_create_temp(const char *path, char **tmp_path)
+{
+    int fd;
+    
+    spprintf(tmp_path, 0, "%s.XXXXXX", path);
+#ifdef _WIN32
+    fd = _mktemp_s(*tmp_path, strlen(*tmp_path) + 1) == 0
+        ? _open(*tmp_path, _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE)
+        : -1;
+#else
+    fd = mkstemp(*tmp_path);
+#endif
+    
+    FILE *fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!fp) {
+        php_error_docref(NULL, E_WARNING,
+            "Failed to create snapshot file for: %s (error: %s)", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(*tmp_path);
+        }
+        efree(*tmp_path);
+        *tmp_path = NULL;
+    }
+    return fp;
+}
+
+/**
+ * Save a snapshot of the container, atomically and by one process at a time.
+ */
+int sf_cache_save(const char *path, sf_container *c, zend_bool if_stale)
+{
+    if (!path || !c) {
+        return FAILURE;
+    }
+    
+    /* Cheap check first - the common case for deferred saves */
+    if (if_stale && sf_cache_is_current(path)) {
+        return SUCCESS;
+    }
+    
+    char *lock_path;
+    spprintf(&lock_path, 0, "%s.lock", path);
+    int lock_fd = open(lock_path, O_WRONLY | O_CREAT | O_NOFOLLOW, 0600);
+    efree(lock_path);
+    
+    if (lock_fd < 0) {
+        php_error_docref(NULL, E_WARNING,
+            "Failed to open snapshot lock for: %s (error: %s)", path, strerror(errno));
+        return FAILURE;
+    }
+    
+    /* Another worker is writing it right now */
+    if (php_flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(lock_fd);
+        return FAILURE;
+    }
+    
+    int ret = SUCCESS;
+    
+    /* It may have finished just before we got the lock */
+    if (!if_stale || !sf_cache_is_current(path)) {
+        char *tmp_path;
+        FILE *fp = sf_snapshot_create_temp(path, &tmp_path);
+        
+        if (!fp) {
+            ret = FAILURE;
+        } else {
+            ret = sf_snapshot_write(fp, tmp_path, c);
+            if (ret == SUCCESS && sf_snapshot_rename(tmp_path, path) != 0) {
+                php_error_docref(NULL, E_WARNING,
+                    "Failed to move snapshot into place: %s (error: %s)", path, strerror(errno));
+                ret = FAILURE;
+            }
+            if (ret != SUCCESS) {
+                unlink(tmp_path);
+            }
+            efree(tmp_path);
+        }
+    }
+    
+    php_flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    return ret;
+}
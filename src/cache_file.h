@@ -1,19 +1,24 @@
 /*
- * Binary cache file format for pre-resolved singleton services.
- * 
- * This provides instant loading of warmed-up services without serialization overhead.
- * The cache is automatically generated on first request and loaded on subsequent requests.
- * 
- * File format:
- * - Magic number (4 bytes): "SFCN" (SignalForge Container)
- * - Version (4 bytes): Cache format version
- * - Service count (4 bytes): Number of cached services
- * - For each service:
- *   - Key length (4 bytes)
- *   - Key data (variable)
- *   - Serialized zval (PHP serialize format)
- *   - Value length (4 bytes)
- *   - Value data (variable)
+ * Metadata snapshot file format.
+ *
+ * A snapshot holds everything the container works out at boot - the binding
+ * graph, per-class constructor metadata, contextual bindings and compiled
+ * plans - so a cold worker can skip rebuilding it. Live objects are never
+ * stored; closures and instances must still be registered by the
+ * application.
+ *
+ * The file is a flat image meant to be mmap()'d read-only and read in place:
+ * fixed-size records grouped in sections, with every string referenced by its
+ * index in a shared string table. Loading walks the records directly in the
+ * mapping; each distinct string is materialised once.
+ *
+ * File format (native byte order - a snapshot is only read on the machine
+ * that wrote it):
+ * - Header: magic "SFSN", format version, PHP_VERSION_ID, file size and an
+ *   (offset, count) pair per section
+ * - Sections: string offsets, string data, bindings, aliases, tags, tag items,
+ *   contextual bindings, classes, parameters, plans, plan steps, plan args
+ * - String data entries: length (4 bytes), bytes, NUL. String id 0 = none.
  */
 
 #ifndef SF_CACHE_FILE_H
@@ -21,41 +26,166 @@
 
 #include "php.h"
 
-#define SF_CACHE_MAGIC 0x4E434653  /* "SFCN" in little-endian */
-#define SF_CACHE_VERSION 1
+/* Forward declarations */
+struct _sf_container;
+
+#define SF_CACHE_MAGIC 0x4E534653  /* "SFSN" in little-endian */
+#define SF_CACHE_VERSION 3
+
+/* Section indices in the header */
+#define SF_SNAP_STRINGS     0   /* uint32_t offset into STRING_DATA per string id */
+#define SF_SNAP_STRING_DATA 1   /* count = size in bytes */
+#define SF_SNAP_BINDINGS    2
+#define SF_SNAP_ALIASES     3
+#define SF_SNAP_TAGS        4
+#define SF_SNAP_TAG_ITEMS   5   /* uint32_t string ids */
+#define SF_SNAP_CONTEXTUAL  6
+#define SF_SNAP_CLASSES     7
+#define SF_SNAP_PARAMS      8
+#define SF_SNAP_PLANS       9
+#define SF_SNAP_STEPS       10
+#define SF_SNAP_ARGS        11
+#define SF_SNAP_SECTIONS    12
+
+typedef struct _sf_snapshot_section {
+    uint32_t offset;                  /* From the start of the file */
+    uint32_t count;                   /* Number of records */
+} sf_snapshot_section;
+
+typedef struct _sf_snapshot_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t php_version;             /* PHP_VERSION_ID of the writer */
+    uint32_t size;                    /* Total file size */
+    sf_snapshot_section sections[SF_SNAP_SECTIONS];
+} sf_snapshot_header;
+
+typedef struct _sf_snapshot_binding {
+    uint32_t abstract;
+    uint32_t concrete;                /* Class name */
+    uint8_t scope;
+    uint8_t lazy;
+    uint8_t _padding[2];
+} sf_snapshot_binding;
+
+typedef struct _sf_snapshot_alias {
+    uint32_t alias;
+    uint32_t target;
+} sf_snapshot_alias;
+
+typedef struct _sf_snapshot_tag {
+    uint32_t name;
+    uint32_t item_start;              /* First entry in TAG_ITEMS */
+    uint32_t item_count;
+} sf_snapshot_tag;
+
+typedef struct _sf_snapshot_contextual {
+    uint32_t concrete;
+    uint32_t abstract;
+    uint32_t implementation;          /* Class name */
+} sf_snapshot_contextual;
+
+typedef struct _sf_snapshot_class {
+    int64_t mtime;                    /* Modification time of file when written */
+    uint32_t name;
+    uint32_t file;                    /* Declaring file (0 = internal class) */
+    uint32_t param_start;             /* First entry in PARAMS */
+    uint32_t param_count;
+    uint32_t bind_to;                 /* #[Bind] implementation (0 = none) */
+    uint8_t is_instantiable;
+    uint8_t ctor_elidable;
+    uint8_t attributes;               /* SF_ATTR_* */
+    uint8_t _padding;
+} sf_snapshot_class;
+
+typedef struct _sf_snapshot_param {
+    uint32_t name;
+    uint32_t type_hint;
+    uint32_t inject;                  /* #[Inject] key (0 = by type) */
+    uint32_t prop_num;                /* Elidable constructors only */
+    uint8_t is_nullable;
+    uint8_t has_default;
+    uint8_t is_variadic;
+    uint8_t _padding;
+} sf_snapshot_param;
+
+typedef struct _sf_snapshot_plan {
+    uint32_t abstract;
+    uint32_t class_name;
+    uint32_t step_start;              /* First entry in STEPS */
+    uint32_t step_count;
+    uint32_t arg_start;               /* First entry in ARGS */
+    uint32_t arg_count;
+    uint8_t is_singleton;
+    uint8_t _padding[3];
+} sf_snapshot_plan;
+
+typedef struct _sf_snapshot_step {
+    uint32_t key;
+    uint32_t class_name;
+    uint32_t requester;
+    uint32_t arg_start;               /* Relative to the plan's first arg */
+    uint32_t arg_count;
+    uint8_t op;
+    uint8_t is_singleton;
+    uint8_t has_constructor;
+    uint8_t elide_constructor;
+} sf_snapshot_step;
+
+typedef struct _sf_snapshot_arg {
+    uint32_t slot;
+    uint32_t prop;
+} sf_snapshot_arg;
 
 /**
- * Save singleton instances to binary cache file.
- * 
- * @param path Cache file path
- * @param instances HashTable of singleton instances
+ * Write a snapshot of the container's graph, metadata and compiled plans.
+ *
+ * The file is written to a temporary name and renamed into place, under a
+ * non-blocking lock: if another process is already writing it, this fails
+ * right away without a warning.
+ *
+ * @param path Snapshot file path
+ * @param container Container to snapshot
+ * @param if_stale Skip the write if a current snapshot is already there
  * @return SUCCESS or FAILURE
  */
-int sf_cache_save(const char *path, HashTable *instances);
+int sf_cache_save(const char *path, struct _sf_container *container, zend_bool if_stale);
 
 /**
- * Load singleton instances from binary cache file.
- * 
- * @param path Cache file path
- * @param instances HashTable to populate with loaded instances
+ * Map a snapshot and import it into the container.
+ *
+ * Fails without a warning when the file is missing or stale (a class file
+ * changed since it was written), with one when it is corrupt.
+ *
+ * @param path Snapshot file path
+ * @param container Container to populate
  * @return SUCCESS or FAILURE
  */
-int sf_cache_load(const char *path, HashTable *instances);
+int sf_cache_load(const char *path, struct _sf_container *container);
 
 /**
- * Check if cache file exists and is valid.
- * 
- * @param path Cache file path
+ * Check if a snapshot file exists and has a valid header.
+ *
+ * @param path Snapshot file path
  * @return 1 if valid, 0 otherwise
  */
 int sf_cache_exists(const char *path);
 
 /**
- * Generate cache file path based on bindings hash.
- * 
- * @param bindings HashTable of bindings
+ * Check if a snapshot exists, is valid and no class file changed since.
+ *
+ * @param path Snapshot file path
+ * @return 1 if current, 0 otherwise
+ */
+int sf_cache_is_current(const char *path);
+
+/**
+ * Generate the default snapshot path from a content hash of the graph
+ * (bindings, aliases, contextual bindings, tags and versions, in order).
+ *
+ * @param container Container whose graph names the file
  * @return zend_string* with cache file path (caller must release)
  */
-zend_string *sf_cache_get_path(HashTable *bindings);
+zend_string *sf_cache_get_path(struct _sf_container *container);
 
 #endif /* SF_CACHE_FILE_H */
@@ -0,0 +1,124 @@
+/*
+ * Signalforge Container Extension
+ * src/call_site.c - Per-call-site inline caches
+ *
+ * A slot is picked by the address of the opline that called get()/make()
+ * and remembers the exact zend_string it passed. Class name literals are
+ * interned, so a repeat call from the same site matches on two pointer
+ * compares and hands back the singleton with a refcount bump, or runs the
+ * compiled plan directly. The slot holds a reference to the string, so a
+ * match can never be a different name that reused the address.
+ *
+ * What a slot remembers is only valid as long as the container's
+ * site_generation hasn't moved: anything that can change what a call
+ * resolves to (bind(), alias(), contextual bindings, forgetInstance(),
+ * flush()) bumps it, and every slot goes stale at once. Singletons are
+ * borrowed from the singleton store - which only drops them through those
+ * same operations - so a cached slot never delays a destructor.
+ *
+ * The slots are request state, allocated on the first call and freed at
+ * request shutdown.
+ */
+
+#include "../php_signalforge_container.h"
+#include "call_site.h"
+#include "container.h"
+#include "factory.h"
+
+static zend_always_inline sf_call_site *sf_call_site_slot(sf_container *c, const zend_op *opline)
+{
+    return &c->sites[((uintptr_t)opline / sizeof(zend_op)) & (SF_CALL_SITES - 1)];
+}
+
+static void sf_call_site_clear(sf_call_site *site)
+{
+    if (site->abstract) {
+        zend_string_release(site->abstract);
+    }
+    if (site->factory) {
+        sf_factory_release(site->factory);
+    }
+    memset(site, 0, sizeof(sf_call_site));
+}
+
+/*
+ * Remember what `abstract` just resolved to: the singleton now in the store,
+ * or the compiled plan that built it. Anything else (closures, autowiring
+ * without a plan) goes through make() every time.
+ */
+static void sf_call_site_fill(sf_container *c, sf_call_site *site, const zend_op *opline, zend_string *abstract, zval *result)
+{
+    zend_string *key = sf_container_resolve_alias(c, abstract);
+    zend_object *instance = NULL;
+    sf_factory *factory = NULL;
+    
+    zval *cached = sf_fast_lookup_find(c->instances, key);
+    if (cached) {
+        /* Closure singletons may return scalars - those take the regular path */
+        if (Z_TYPE_P(cached) != IS_OBJECT || Z_TYPE_P(result) != IS_OBJECT || Z_OBJ_P(cached) != Z_OBJ_P(result)) {
+            return;
+        }
+        instance = Z_OBJ_P(cached);
+    } else if (zend_hash_num_elements(&c->compiled_factories)) {
+        factory = zend_hash_find_ptr(&c->compiled_factories, key);
+        if (!factory || !factory->steps || factory->epoch != c->epoch || factory->generation != c->generation) {
+            return;
+        }
+        sf_factory_addref(factory);
+    } else {
+        return;
+    }
+    
+    sf_call_site_clear(site);
+    site->opline = opline;
+    site->abstract = zend_string_copy(abstract);
+    site->instance = instance;
+    site->factory = factory;
+    site->generation = c->site_generation;
+}
+
+ZEND_HOT int sf_call_site_make(sf_container *c, zend_execute_data *execute_data, zend_string *abstract, zval *result)
+{
+    /* Only calls straight from PHP code have a stable opline (uncommon otherwise) */
+    zend_execute_data *caller = EX(prev_execute_data);
+    if (UNEXPECTED(!caller) || UNEXPECTED(!caller->func) || UNEXPECTED(!ZEND_USER_CODE(caller->func->type))) {
+        return sf_container_make(c, abstract, NULL, result, NULL);
+    }
+    
+    const zend_op *opline = caller->opline;
+    if (UNEXPECTED(!c->sites)) {
+        c->sites = ecalloc(SF_CALL_SITES, sizeof(sf_call_site));
+    }
+    
+    sf_call_site *site = sf_call_site_slot(c, opline);
+    if (EXPECTED(site->opline == opline) && EXPECTED(site->abstract == abstract)
+        && EXPECTED(site->generation == c->site_generation)) {
+        SF_STAT(site_hits);
+        if (EXPECTED(site->instance)) {
+            ZVAL_OBJ_COPY(result, site->instance);
+            return SUCCESS;
+        }
+        return sf_factory_call(site->factory, c, NULL, result);
+    }
+    
+    SF_STAT(site_misses);
+    if (UNEXPECTED(sf_container_make(c, abstract, NULL, result, NULL) == FAILURE)) {
+        return FAILURE;
+    }
+    
+    sf_call_site_fill(c, site, opline, abstract, result);
+    return SUCCESS;
+}
+
+void sf_call_sites_destroy(sf_container *c)
+{
+    if (!c->sites) return;
+    
+    for (uint32_t i = 0; i < SF_CALL_SITES; i++) {
+        if (c->sites[i].opline) {
+            sf_call_site_clear(&c->sites[i]);
+        }
+    }
+    efree(c->sites);
+    c->sites = NULL;
+}
@@ -0,0 +1,38 @@
+/*
+ * Signalforge Container Extension
+ * src/call_site.h - Per-call-site inline caches
+ *
+ * Most Container::get()/make() call sites always ask for the same literal
+ * class name. Each site gets a slot - keyed by the calling opline, like the
+ * engine's runtime cache for static calls - remembering what it resolved
+ * to, so a repeat call skips alias, singleton store and plan lookups.
+ */
+
+#ifndef SF_CALL_SITE_H
+#define SF_CALL_SITE_H
+
+/* Forward declarations */
+struct _sf_container;
+struct _sf_factory;
+
+/* Slots per request (direct-mapped by opline address, power of two) */
+#define SF_CALL_SITES 256
+
+typedef struct _sf_call_site {
+    const zend_op *opline;            /* Calling opline (NULL = empty slot) */
+    zend_string *abstract;            /* Exact string the site passed (owned) */
+    zend_object *instance;            /* Singleton it resolved to (borrowed from the singleton store) */
+    struct _sf_factory *factory;      /* Or: compiled plan it runs (owned reference) */
+    uint32_t generation;              /* Container site generation the slot was filled in */
+} sf_call_site;
+
+/*
+ * Container::get()/make() without parameters, through the caller's slot.
+ * Falls back to sf_container_make() (and fills the slot) on a miss.
+ */
+int sf_call_site_make(struct _sf_container *container, zend_execute_data *execute_data, zend_string *abstract, zval *result);
+
+/* Drop every slot (request shutdown) */
+void sf_call_sites_destroy(struct _sf_container *container);
+
+#endif /* SF_CALL_SITE_H */
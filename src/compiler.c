@@ -2,9 +2,10 @@
  * Signalforge Container Extension
  * src/compiler.c - Factory compilation implementation
  *
- * This implements template-based factory generation. Instead of JIT compiling
- * machine code, we use pre-written C template functions that are parameterized
- * with the class metadata. This approach is:
+ * This flattens the dependency graph of a service into a resolution plan.
+ * Instead of JIT compiling machine code or recursing through make() at
+ * runtime, we walk the graph once at compile time and emit a linear array of
+ * "construct class K from slots [a, b, c]" steps (see factory.h). This approach is:
  * - Portable across all platforms
  * - Simple to maintain
  * - Still achieves ~3x speedup over full autowiring
@@ -14,8 +15,12 @@
  * 2. Building intermediate arrays
  * 3. Circular dependency checking
  *
- * By pre-computing dependencies and using direct resolution, we eliminate
- * most of this overhead while keeping the code simple.
+ * A plan pays for binding lookups, alias resolution, contextual bindings and
+ * cycle checks once, at compile time. Anything the compiler cannot see
+ * through (closures, instances, cycles) becomes a MAKE step that defers to
+ * the regular resolution path, so semantics never change. A plan without
+ * MAKE steps is proven acyclic and runs without touching the resolution
+ * stack at all.
  */
 
 #include "../php_signalforge_container.h"
@@ -25,264 +30,385 @@
 #include "binding.h"
 #include "reflection_cache.h"
 
-/* Maximum number of dependencies we can compile (covers 99%+ of classes) */
-#define SF_MAX_COMPILED_DEPS 8
+/* Past this many steps, remaining dependencies resolve through make() */
+#define SF_PLAN_MAX_STEPS 1024
+
+/* Past this depth, remaining dependencies resolve through make() */
+#define SF_PLAN_MAX_DEPTH 64
+
+/* Constructor argument lists up to this size are collected on the stack */
+#define SF_PLAN_INLINE_ARGS 8
 
 /* ============================================================================
- * Helper: Resolve a single dependency fast
+ * Plan Builder
  *
- * This is the hot path for compiled factories. It checks:
- * 1. Singleton cache (fastest)
- * 2. Compiled factory (if available)
- * 3. Falls back to full make() (slowest)
+ * Post-order DFS over the binding graph. Steps borrow their strings from
+ * bindings and class metadata; sf_factory_set_plan() takes copies.
  * ============================================================================ */
 
-static inline int sf_resolve_dep_fast(sf_container *c, zend_string *dep_name, zval *result)
+typedef struct {
+    sf_container *c;
+    sf_plan_step *steps;
+    uint32_t step_count;
+    uint32_t step_capacity;
+    uint32_t *arg_slots;
+    uint32_t *arg_props;
+    uint32_t arg_slot_count;
+    uint32_t arg_slot_capacity;
+    HashTable singletons;  /* key => step index, so shared singletons get one step */
+    HashTable visiting;    /* keys on the current DFS path (cycle detection) */
+    HashTable consulted;   /* names whose binding, alias or contextual rules shaped the plan */
+} sf_plan_builder;
+
+static int sf_plan_build_dep(sf_plan_builder *b, zend_string *requester, zend_string *name, uint32_t depth);
+
+static void sf_plan_builder_init(sf_plan_builder *b, sf_container *c)
 {
-    /* Fast path: check singleton cache first */
-    zval *cached = zend_hash_find(&c->instances, dep_name);
-    if (cached) {
-        ZVAL_COPY(result, cached);
-        return SUCCESS;
-    }
-    
-    /* Check for compiled factory */
-    sf_factory *dep_factory = zend_hash_find_ptr(&c->compiled_factories, dep_name);
-    if (dep_factory && dep_factory->factory_fn) {
-        return sf_factory_call(dep_factory, c, NULL, result);
+    b->c = c;
+    b->step_capacity = 8;
+    b->step_count = 0;
+    b->steps = emalloc(sizeof(sf_plan_step) * b->step_capacity);
+    b->arg_slot_capacity = 16;
+    b->arg_slot_count = 0;
+    b->arg_slots = emalloc(sizeof(uint32_t) * b->arg_slot_capacity);
+    b->arg_props = emalloc(sizeof(uint32_t) * b->arg_slot_capacity);
+    zend_hash_init(&b->singletons, 8, NULL, NULL, 0);
+    zend_hash_init(&b->visiting, 8, NULL, NULL, 0);
+    zend_hash_init(&b->consulted, 8, NULL, NULL, 0);
+}
+
+static void sf_plan_builder_destroy(sf_plan_builder *b)
+{
+    efree(b->steps);
+    efree(b->arg_slots);
+    efree(b->arg_props);
+    zend_hash_destroy(&b->singletons);
+    zend_hash_destroy(&b->visiting);
+    zend_hash_destroy(&b->consulted);
+}
+
+static uint32_t sf_plan_emit(sf_plan_builder *b, sf_plan_step *step)
+{
+    if (b->step_count >= b->step_capacity) {
+        b->step_capacity *= 2;
+        b->steps = erealloc(b->steps, sizeof(sf_plan_step) * b->step_capacity);
     }
-    
-    /* Fall back to full resolution */
-    return sf_container_make(c, dep_name, NULL, result, NULL);
+    b->steps[b->step_count] = *step;
+    return b->step_count++;
 }
 
-/* ============================================================================
- * Template Factories
- *
- * These are the actual factory functions. Each handles a specific number
- * of dependencies. The factory_data parameter points to the sf_factory
- * struct which contains all the metadata needed.
- * ============================================================================ */
+/* Defer this dependency to sf_container_make() at runtime */
+static uint32_t sf_plan_emit_make(sf_plan_builder *b, zend_string *key, zend_string *requester)
+{
+    sf_plan_step step = {0};
+    step.op = SF_PLAN_MAKE;
+    step.key = key;
+    step.requester = requester;
+    return sf_plan_emit(b, &step);
+}
 
-/* Factory for classes with 0 dependencies */
-static int factory_template_0deps(sf_container *c, HashTable *params, zval *result, void *factory_data)
+/*
+ * Can a step constructing `meta`'s class from `deps` skip the constructor?
+ * Every argument must come from a CONSTRUCT step whose class satisfies the
+ * parameter type (so the skipped RECV checks could not have failed), and
+ * parameters left to their defaults must not be promoted.
+ */
+static zend_bool sf_plan_can_elide(const sf_plan_step *steps, const uint32_t *deps, uint32_t dep_count, sf_class_meta *meta)
 {
-    sf_factory *factory = (sf_factory *)factory_data;
-    
-    /* Create the object */
-    if (object_init_ex(result, factory->ce) != SUCCESS) {
-        return FAILURE;
+    if (!meta->ctor_elidable) {
+        return 0;
     }
     
-    /* Call constructor if exists (no params) */
-    if (factory->has_constructor) {
-        zval retval;
-        zend_call_method_with_0_params(Z_OBJ_P(result), factory->ce, &factory->ce->constructor, "__construct", &retval);
-        zval_ptr_dtor(&retval);
-        
-        if (EG(exception)) {
-            zval_ptr_dtor(result);
-            return FAILURE;
+    for (uint32_t i = dep_count; i < meta->param_count; i++) {
+        if (meta->prop_nums[i] != SF_PROP_NONE) {
+            return 0;
         }
     }
     
-    /* Cache if singleton */
-    if (factory->is_singleton) {
-        zval copy;
-        ZVAL_COPY(&copy, result);
-        zend_hash_update(&c->instances, factory->class_name, &copy);
+    for (uint32_t i = 0; i < dep_count; i++) {
+        const sf_plan_step *dep = &steps[deps[i]];
+        if (dep->op != SF_PLAN_CONSTRUCT) {
+            return 0;
+        }
+        /* An untyped #[Inject] parameter has no class to check. An unloaded type
+         * can't be a parent of a loaded class, so there's nothing to autoload */
+        zend_class_entry *type_ce = meta->param_types[i]
+            ? zend_lookup_class_ex(meta->param_types[i], NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD)
+            : NULL;
+        if (!type_ce || !instanceof_function(dep->ce, type_ce)) {
+            return 0;
+        }
     }
     
-    return SUCCESS;
+    return 1;
 }
 
-/* Factory for classes with 1 dependency */
-static int factory_template_1dep(sf_container *c, HashTable *params, zval *result, void *factory_data)
+/*
+ * Emit the steps that construct `class_name` for service `key`.
+ * Returns the step index, or -1 if the constructor can't be planned (the
+ * caller then falls back to a MAKE step or gives up on the plan).
+ */
+static int sf_plan_build_class(sf_plan_builder *b, zend_string *key, zend_string *class_name, zend_class_entry *ce, uint8_t is_singleton, uint32_t depth)
 {
-    sf_factory *factory = (sf_factory *)factory_data;
-    zval dep;
-    
-    /* Resolve dependency */
-    if (sf_resolve_dep_fast(c, factory->dep_names[0], &dep) != SUCCESS) {
-        return FAILURE;
+    sf_class_meta *meta = sf_container_get_meta(b->c, class_name, ce);
+    if (!sf_compiler_can_compile(meta)) {
+        return -1;
     }
     
-    /* Create the object */
-    if (object_init_ex(result, factory->ce) != SUCCESS) {
-        zval_ptr_dtor(&dep);
-        return FAILURE;
+    uint32_t deps_inline[SF_PLAN_INLINE_ARGS];
+    uint32_t *deps = deps_inline;
+    uint32_t dep_count = 0;
+    int ret = -1;
+    
+    if (meta->param_count > SF_PLAN_INLINE_ARGS) {
+        deps = emalloc(sizeof(uint32_t) * meta->param_count);
     }
     
-    /* Call constructor */
-    if (factory->has_constructor) {
-        zval retval;
-        zend_fcall_info fci = {0};
-        zend_fcall_info_cache fcc = {0};
-        
-        fci.size = sizeof(fci);
-        fci.retval = &retval;
-        fci.object = Z_OBJ_P(result);
-        ZVAL_UNDEF(&fci.function_name);
-        fci.params = &dep;
-        fci.param_count = 1;
-        
-        fcc.function_handler = factory->ce->constructor;
-        fcc.called_scope = factory->ce;
-        fcc.object = Z_OBJ_P(result);
+    zend_hash_add_empty_element(&b->visiting, key);
+    
+    /* Type-hinted and #[Inject] parameters in order, stopping at the first untyped default (PHP fills the rest) */
+    for (uint32_t i = 0; i < meta->param_count; i++) {
+        zend_string *name = sf_class_meta_dep(meta, i);
         
-        int call_ret = zend_call_function(&fci, &fcc);
-        zval_ptr_dtor(&retval);
-        zval_ptr_dtor(&dep);
+        if (!name) {
+            if (!(meta->param_flags[i] & SF_PARAM_DEFAULT)) {
+                goto done;
+            }
+            break;
+        }
         
-        if (call_ret == FAILURE || EG(exception)) {
-            zval_ptr_dtor(result);
-            return FAILURE;
+        int dep = sf_plan_build_dep(b, meta->class_name, name, depth + 1);
+        if (dep < 0) {
+            /* Unresolvable type - autowiring's null/default fallbacks decide (uncommon) */
+            goto done;
         }
-    } else {
-        zval_ptr_dtor(&dep);
+        deps[dep_count++] = (uint32_t)dep;
     }
     
-    /* Cache if singleton */
-    if (factory->is_singleton) {
-        zval copy;
-        ZVAL_COPY(&copy, result);
-        zend_hash_update(&c->instances, factory->class_name, &copy);
+    /* Arguments of one step are contiguous in arg_slots */
+    if (b->arg_slot_count + dep_count > b->arg_slot_capacity) {
+        while (b->arg_slot_count + dep_count > b->arg_slot_capacity) {
+            b->arg_slot_capacity *= 2;
+        }
+        b->arg_slots = erealloc(b->arg_slots, sizeof(uint32_t) * b->arg_slot_capacity);
+        b->arg_props = erealloc(b->arg_props, sizeof(uint32_t) * b->arg_slot_capacity);
     }
     
-    return SUCCESS;
+    sf_plan_step step = {0};
+    step.op = SF_PLAN_CONSTRUCT;
+    step.key = key;
+    step.class_name = meta->class_name;
+    step.ce = ce;
+    step.is_singleton = is_singleton;
+    step.has_constructor = ce->constructor ? 1 : 0;
+    step.elide_constructor = step.has_constructor && sf_plan_can_elide(b->steps, deps, dep_count, meta);
+    step.arg_start = b->arg_slot_count;
+    step.arg_count = dep_count;
+    
+    memcpy(&b->arg_slots[b->arg_slot_count], deps, sizeof(uint32_t) * dep_count);
+    for (uint32_t i = 0; i < dep_count; i++) {
+        b->arg_props[b->arg_slot_count + i] = meta->prop_nums ? meta->prop_nums[i] : SF_PROP_NONE;
+    }
+    b->arg_slot_count += dep_count;
+    
+    ret = (int)sf_plan_emit(b, &step);
+    
+    if (is_singleton) {
+        zval idx;
+        ZVAL_LONG(&idx, ret);
+        zend_hash_update(&b->singletons, key, &idx);
+    }
+    
+done:
+    zend_hash_del(&b->visiting, key);
+    if (deps != deps_inline) {
+        efree(deps);
+    }
+    return ret;
 }
 
-/* Factory for classes with 2 dependencies */
-static int factory_template_2deps(sf_container *c, HashTable *params, zval *result, void *factory_data)
+/* Look up an instantiable class entry, or NULL */
+static zend_class_entry *sf_plan_lookup_class(zend_string *class_name)
 {
-    sf_factory *factory = (sf_factory *)factory_data;
-    zval deps[2];
+    zend_class_entry *ce = zend_lookup_class(class_name);
+    if (!ce || (ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT))) {
+        return NULL;
+    }
+    return ce;
+}
+
+/*
+ * Emit the steps for a contextual binding of `key` inside `requester`.
+ *
+ * make() resolves a class implementation by autowiring it directly (a
+ * transient, whatever the implementation's own binding says), so the plan
+ * constructs it in place. The contextual binding does not apply once `key`
+ * itself is a stored singleton, and closures need the runtime path, so
+ * those defer to make().
+ */
+static int sf_plan_build_contextual(sf_plan_builder *b, zend_string *requester, zend_string *key, sf_contextual_binding *ctx, sf_binding *binding, uint32_t depth)
+{
+    if (Z_TYPE(ctx->implementation) != IS_STRING
+        || (binding && binding->scope != SF_SCOPE_TRANSIENT)) {
+        return (int)sf_plan_emit_make(b, key, requester);
+    }
     
-    /* Resolve dependencies */
-    if (sf_resolve_dep_fast(c, factory->dep_names[0], &deps[0]) != SUCCESS) {
-        return FAILURE;
+    zend_string *class_name = Z_STR(ctx->implementation);
+    zend_class_entry *ce = sf_plan_lookup_class(class_name);
+    int step = ce ? sf_plan_build_class(b, key, class_name, ce, 0, depth) : -1;
+    
+    /* Let make() produce the proper error */
+    return step >= 0 ? step : (int)sf_plan_emit_make(b, key, requester);
+}
+
+/*
+ * Consult `name` and every alias its chain passes through, so re-pointing
+ * any hop (not only the first or last) rebuilds the plan.
+ */
+static void sf_plan_consult_aliases(sf_plan_builder *b, zend_string *name)
+{
+    HashTable *aliases = &b->c->aliases;
+    uint32_t limit = zend_hash_num_elements(aliases);
+    zval *next;
+    
+    zend_hash_add_empty_element(&b->consulted, name);
+    
+    /* A loop gives up once it has taken every alias, as flattening does */
+    for (uint32_t hops = 0; hops < limit && (next = zend_hash_find(aliases, name)); hops++) {
+        name = Z_STR_P(next);
+        zend_hash_add_empty_element(&b->consulted, name);
     }
-    if (sf_resolve_dep_fast(c, factory->dep_names[1], &deps[1]) != SUCCESS) {
-        zval_ptr_dtor(&deps[0]);
-        return FAILURE;
+}
+
+/*
+ * Emit the steps for dependency `name` of class `requester`, mirroring what
+ * sf_container_make() would do for it. Returns the step index, or -1 when the
+ * dependency isn't resolvable at all (the requester then falls back to make()).
+ */
+static int sf_plan_build_dep(sf_plan_builder *b, zend_string *requester, zend_string *name, uint32_t depth)
+{
+    sf_container *c = b->c;
+    zend_string *key = sf_container_resolve_alias(c, name);
+    
+    sf_plan_consult_aliases(b, name);
+    
+    /* Cycle, or a graph too large to flatten - make() reports/handles it */
+    if (zend_hash_exists(&b->visiting, key)
+        || depth > SF_PLAN_MAX_DEPTH || b->step_count >= SF_PLAN_MAX_STEPS) {
+        return (int)sf_plan_emit_make(b, key, requester);
     }
     
-    /* Create the object */
-    if (object_init_ex(result, factory->ce) != SUCCESS) {
-        zval_ptr_dtor(&deps[0]);
-        zval_ptr_dtor(&deps[1]);
-        return FAILURE;
+    sf_binding *binding = zend_hash_find_ptr(&c->bindings, key);
+    
+    /* Contextual binding for this requester - bake its implementation into the slot (uncommon) */
+    if (UNEXPECTED(zend_hash_num_elements(&c->contextual_bindings) > 0)) {
+        sf_contextual_binding *ctx = sf_container_get_contextual_binding(c, requester, key);
+        if (ctx) {
+            return sf_plan_build_contextual(b, requester, key, ctx, binding, depth);
+        }
     }
     
-    /* Call constructor */
-    if (factory->has_constructor) {
-        zval retval;
-        zend_fcall_info fci = {0};
-        zend_fcall_info_cache fcc = {0};
-        
-        fci.size = sizeof(fci);
-        fci.retval = &retval;
-        fci.object = Z_OBJ_P(result);
-        ZVAL_UNDEF(&fci.function_name);
-        fci.params = deps;
-        fci.param_count = 2;
-        
-        fcc.function_handler = factory->ce->constructor;
-        fcc.called_scope = factory->ce;
-        fcc.object = Z_OBJ_P(result);
+    /* A closure pruned at the end of a request may be bound again without a reshape */
+    if (UNEXPECTED(sf_container_pruned(c, requester, key))) {
+        return (int)sf_plan_emit_make(b, key, requester);
+    }
+    
+    /* Singletons are built once per plan and shared */
+    zval *shared = zend_hash_find(&b->singletons, key);
+    if (shared) {
+        return (int)Z_LVAL_P(shared);
+    }
+    
+    if (binding) {
+        /* Closures, instances, scoped services and lazy proxies are resolved dynamically */
+        if (Z_TYPE(binding->concrete) != IS_STRING || binding->scope >= SF_SCOPE_INSTANCE || binding->lazy) {
+            return (int)sf_plan_emit_make(b, key, requester);
+        }
         
-        int call_ret = zend_call_function(&fci, &fcc);
-        zval_ptr_dtor(&retval);
-        zval_ptr_dtor(&deps[0]);
-        zval_ptr_dtor(&deps[1]);
+        zend_string *class_name = Z_STR(binding->concrete);
+        zend_class_entry *ce = sf_plan_lookup_class(class_name);
+        int step = ce ? sf_plan_build_class(b, key, class_name, ce, binding->scope == SF_SCOPE_SINGLETON, depth) : -1;
         
-        if (call_ret == FAILURE || EG(exception)) {
-            zval_ptr_dtor(result);
-            return FAILURE;
+        /* Let make() produce the proper error or fallback */
+        return step >= 0 ? step : (int)sf_plan_emit_make(b, key, requester);
+    }
+    
+    /* Unbound with #[Singleton] or #[Bind] - make() registers the binding on first use */
+    zend_class_entry *ce = zend_lookup_class(key);
+    if (ce && UNEXPECTED(ce->attributes)) {
+        sf_class_meta *meta = sf_container_get_meta(c, key, ce);
+        if (meta && sf_class_meta_binds(meta)) {
+            return (int)sf_plan_emit_make(b, key, requester);
         }
-    } else {
-        zval_ptr_dtor(&deps[0]);
-        zval_ptr_dtor(&deps[1]);
     }
     
-    /* Cache if singleton */
-    if (factory->is_singleton) {
-        zval copy;
-        ZVAL_COPY(&copy, result);
-        zend_hash_update(&c->instances, factory->class_name, &copy);
+    /* Unbound - autowire the class itself (transient) */
+    if (!ce || (ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT))) {
+        return -1;
     }
     
-    return SUCCESS;
+    int step = sf_plan_build_class(b, key, key, ce, 0, depth);
+    return step >= 0 ? step : (int)sf_plan_emit_make(b, key, requester);
 }
 
-/* Generic factory for 3-8 dependencies using a loop */
-static int factory_template_ndeps(sf_container *c, HashTable *params, zval *result, void *factory_data)
+/*
+ * Build the plan for service `abstract` into `factory`.
+ * Returns FAILURE if the service itself can't be planned.
+ */
+static int sf_compiler_build_plan(sf_container *c, sf_factory *factory)
 {
-    sf_factory *factory = (sf_factory *)factory_data;
-    zval deps[SF_MAX_COMPILED_DEPS];
-    uint32_t resolved_count = 0;
-    
-    /* Resolve all dependencies */
-    for (uint32_t i = 0; i < factory->dep_count; i++) {
-        if (sf_resolve_dep_fast(c, factory->dep_names[i], &deps[i]) != SUCCESS) {
-            /* Cleanup already resolved */
-            for (uint32_t j = 0; j < resolved_count; j++) {
-                zval_ptr_dtor(&deps[j]);
-            }
+    zend_string *abstract = factory->abstract;
+    zend_string *class_name = abstract;
+    uint8_t is_singleton = 0;
+    
+    sf_factory_clear_plan(factory);
+    factory->ce = NULL;
+    factory->epoch = c->epoch;
+    factory->generation = c->generation;
+    
+    sf_binding *binding = zend_hash_find_ptr(&c->bindings, abstract);
+    if (binding) {
+        /* Only eager class bindings compile (not closures, instances, scoped services or lazy proxies) */
+        if (Z_TYPE(binding->concrete) != IS_STRING || binding->scope >= SF_SCOPE_INSTANCE || binding->lazy) {
             return FAILURE;
         }
-        resolved_count++;
+        class_name = Z_STR(binding->concrete);
+        is_singleton = binding->scope == SF_SCOPE_SINGLETON;
+    } else if (UNEXPECTED(sf_container_pruned(c, NULL, abstract))) {
+        return FAILURE;  /* Its closure may come back */
     }
     
-    /* Create the object */
-    if (object_init_ex(result, factory->ce) != SUCCESS) {
-        for (uint32_t i = 0; i < resolved_count; i++) {
-            zval_ptr_dtor(&deps[i]);
-        }
+    zend_class_entry *ce = sf_plan_lookup_class(class_name);
+    if (!ce) {
         return FAILURE;
     }
     
-    /* Call constructor */
-    if (factory->has_constructor) {
-        zval retval;
-        zend_fcall_info fci = {0};
-        zend_fcall_info_cache fcc = {0};
-        
-        fci.size = sizeof(fci);
-        fci.retval = &retval;
-        fci.object = Z_OBJ_P(result);
-        ZVAL_UNDEF(&fci.function_name);
-        fci.params = deps;
-        fci.param_count = factory->dep_count;
-        
-        fcc.function_handler = factory->ce->constructor;
-        fcc.called_scope = factory->ce;
-        fcc.object = Z_OBJ_P(result);
-        
-        int call_ret = zend_call_function(&fci, &fcc);
-        zval_ptr_dtor(&retval);
-        
-        for (uint32_t i = 0; i < resolved_count; i++) {
-            zval_ptr_dtor(&deps[i]);
-        }
-        
-        if (call_ret == FAILURE || EG(exception)) {
-            zval_ptr_dtor(result);
-            return FAILURE;
-        }
-    } else {
-        for (uint32_t i = 0; i < resolved_count; i++) {
-            zval_ptr_dtor(&deps[i]);
-        }
+    /* Unbound #[Singleton] class - compiled through its binding once make() registered it */
+    if (!binding && UNEXPECTED(ce->attributes) && sf_class_meta_binds(sf_container_get_meta(c, class_name, ce))) {
+        return FAILURE;
     }
     
-    /* Cache if singleton */
-    if (factory->is_singleton) {
-        zval copy;
-        ZVAL_COPY(&copy, result);
-        zend_hash_update(&c->instances, factory->class_name, &copy);
+    sf_plan_builder b;
+    sf_plan_builder_init(&b, c);
+    
+    int root = sf_plan_build_class(&b, abstract, class_name, ce, is_singleton, 0);
+    if (root < 0 || UNEXPECTED(EG(exception))) {  /* An attribute argument threw */
+        sf_plan_builder_destroy(&b);
+        return FAILURE;
     }
     
+    zend_hash_add_empty_element(&b.consulted, abstract);
+    sf_factory_set_plan(factory, b.steps, b.step_count, b.arg_slots, b.arg_props, b.arg_slot_count);
+    sf_factory_set_deps(factory, &b.consulted);
+    sf_factory_set_params(factory, sf_container_get_meta(c, class_name, ce));
+    sf_plan_builder_destroy(&b);
+    
+    factory->ce = ce;
+    factory->is_singleton = is_singleton;
+    if (!zend_string_equals(factory->class_name, class_name)) {
+        zend_string_release(factory->class_name);
+        factory->class_name = sf_string_copy_ex(class_name, factory->persistent);
+    }
     return SUCCESS;
 }
 
@@ -296,17 +422,12 @@ int sf_compiler_can_compile(sf_class_meta *meta)
         return 0;
     }
     
-    /* Can't compile classes with too many dependencies */
-    if (meta->param_count > SF_MAX_COMPILED_DEPS) {
-        return 0;
-    }
-    
-    /* Check that all dependencies have type hints (required for compilation) */
+    /* Check that all dependencies have type hints or #[Inject] keys (required for compilation) */
     for (uint32_t i = 0; i < meta->param_count; i++) {
-        if (!meta->params[i].type_hint) {
+        if (!sf_class_meta_dep(meta, i)) {
             /* Parameter without type hint - can't compile */
             /* (unless it has a default, in which case we'd need more complex logic) */
-            if (!meta->params[i].has_default) {
+            if (!(meta->param_flags[i] & SF_PARAM_DEFAULT)) {
                 return 0;
             }
         }
@@ -315,63 +436,122 @@ int sf_compiler_can_compile(sf_class_meta *meta)
     return 1;
 }
 
-sf_factory *sf_compiler_compile_class(sf_class_meta *meta, zend_class_entry *ce, uint8_t is_singleton)
+sf_factory *sf_compiler_compile_service(sf_container *c, zend_string *abstract)
 {
-    if (!sf_compiler_can_compile(meta)) {
-        return NULL;
-    }
+    /* Factories live as long as the graph they were built from */
+    sf_factory *factory = sf_factory_create(abstract, abstract, NULL, c->persistent);
     
-    /* Create factory */
-    sf_factory *factory = sf_factory_create(meta->class_name, ce);
-    if (!factory) {
+    if (sf_compiler_build_plan(c, factory) != SUCCESS) {
+        sf_factory_release(factory);
         return NULL;
     }
     
-    factory->is_singleton = is_singleton;
+    return factory;
+}
+
+/*
+ * Did the graph change for anything the plan consulted since it was built?
+ * Plans without a dependency list (loaded from a snapshot) assume it did.
+ */
+static zend_bool sf_plan_reshaped(sf_container *c, sf_factory *factory)
+{
+    if (!factory->deps || factory->generation < c->rebuild_generation) {
+        return 1;
+    }
     
-    /* Count type-hinted dependencies (skip those with defaults but no type hint) */
-    uint32_t dep_count = 0;
-    for (uint32_t i = 0; i < meta->param_count; i++) {
-        if (meta->params[i].type_hint) {
-            dep_count++;
-        } else if (!meta->params[i].has_default) {
-            /* Required param without type hint - can't compile */
-            sf_factory_release(factory);
-            return NULL;
-        } else {
-            /* Has default, no type hint - stop here, PHP will use defaults */
-            break;
+    for (uint32_t i = 0; i < factory->dep_count; i++) {
+        zval *changed = zend_hash_find(&c->reshaped, factory->deps[i]);
+        if (changed && (uint32_t)Z_LVAL_P(changed) > factory->generation) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Re-check a factory whose plan may be stale.
+ *
+ * A new graph generation means bindings changed; the plan is rebuilt if the
+ * change touched a name it consulted, and otherwise carried over to the new
+ * generation as it is. A new epoch only means cached class entries may be gone (persistent mode): they
+ * are never dereferenced here, we look every class up again and patch the
+ * steps, rebuilding if any constructor signature changed. A factory that can't
+ * be revived is disabled (steps = NULL) and resolution takes the regular path.
+ */
+int sf_compiler_revalidate(sf_container *c, sf_factory *factory)
+{
+    if (factory->generation != c->generation && factory->steps && !sf_plan_reshaped(c, factory)) {
+        factory->generation = c->generation;
+        if (factory->epoch == c->epoch) {
+            return SUCCESS;
         }
     }
     
-    /* Set up dependency names */
-    if (dep_count > 0) {
-        zend_string **deps = emalloc(sizeof(zend_string *) * dep_count);
-        for (uint32_t i = 0; i < dep_count; i++) {
-            deps[i] = meta->params[i].type_hint;
+    if (factory->generation == c->generation && factory->steps) {
+        zend_bool valid = 1;
+        
+        for (uint32_t i = 0; i < factory->step_count && valid; i++) {
+            sf_plan_step *step = &factory->steps[i];
+            if (step->op != SF_PLAN_CONSTRUCT) {
+                continue;
+            }
+            
+            zend_class_entry *ce = zend_lookup_class(step->class_name);
+            sf_class_meta *meta = ce ? sf_cache_get(step->class_name, &c->reflection_cache) : NULL;
+            
+            if (!meta || !sf_cache_matches(meta, ce)) {
+                valid = 0;
+                break;
+            }
+            step->ce = ce;
+            step->has_constructor = ce->constructor ? 1 : 0;
+        }
+        
+        /* Class hierarchies may differ in the new request - decide elision again */
+        for (uint32_t i = 0; i < factory->step_count && valid; i++) {
+            sf_plan_step *step = &factory->steps[i];
+            if (step->op == SF_PLAN_CONSTRUCT) {
+                sf_class_meta *meta = sf_cache_get(step->class_name, &c->reflection_cache);
+                step->elide_constructor = step->has_constructor
+                    && sf_plan_can_elide(factory->steps, &factory->arg_slots[step->arg_start], step->arg_count, meta);
+            }
+        }
+        
+        if (valid) {
+            factory->ce = factory->steps[factory->step_count - 1].ce;
+            factory->epoch = c->epoch;
+            return SUCCESS;
+        }
+        
+        /* An attribute argument threw - a rebuild would throw it again */
+        if (UNEXPECTED(EG(exception))) {
+            sf_factory_clear_plan(factory);
+            return FAILURE;
         }
-        sf_factory_set_dependencies(factory, deps, dep_count);
-        efree(deps);
     }
     
-    /* Select appropriate template based on dependency count */
-    switch (dep_count) {
-        case 0:
-            factory->factory_fn = factory_template_0deps;
-            break;
-        case 1:
-            factory->factory_fn = factory_template_1dep;
-            break;
-        case 2:
-            factory->factory_fn = factory_template_2deps;
-            break;
-        default:
-            /* 3-8 dependencies use the generic template */
-            factory->factory_fn = factory_template_ndeps;
-            break;
+    SF_STAT(plans_rebuilt);
+    return sf_compiler_build_plan(c, factory);
+}
+
+void sf_compiler_promote(sf_container *c, zend_string *abstract)
+{
+    if (zend_hash_exists(&c->compiled_factories, abstract)) {
+        return;
     }
     
-    return factory;
+    /*
+     * A service that can't be planned keeps a disabled factory (steps NULL),
+     * so make() doesn't try again on every call; revalidation retries once
+     * the graph or the request changes.
+     */
+    sf_factory *factory = sf_factory_create(abstract, abstract, NULL, c->persistent);
+    if (sf_compiler_build_plan(c, factory) == SUCCESS) {
+        SF_STAT(plans_promoted);
+    } else {
+        SF_STAT(plans_failed);
+    }
+    zend_hash_update_ptr(&c->compiled_factories, factory->abstract, factory);
 }
 
 int sf_compiler_compile_all(sf_container *container)
@@ -387,39 +567,23 @@ int sf_compiler_compile_all(sf_container *container)
         if (Z_TYPE(binding->concrete) != IS_STRING) {
             continue;
         }
-        if (binding->scope == SF_SCOPE_INSTANCE) {
-            continue;
-        }
-        
-        zend_string *class_name = Z_STR(binding->concrete);
-        
-        /* Look up class entry */
-        zend_class_entry *ce = zend_lookup_class(class_name);
-        if (!ce) {
+        if (binding->scope == SF_SCOPE_INSTANCE || binding->scope == SF_SCOPE_SCOPED) {
             continue;
         }
         
-        /* Get or build metadata */
-        sf_class_meta *meta = sf_cache_get(class_name, &container->reflection_cache);
-        if (!meta) {
-            meta = sf_cache_build(class_name, ce);
-            if (meta) {
-                sf_cache_put(class_name, meta, &container->reflection_cache);
-            }
-        }
-        
-        if (!meta || !meta->is_instantiable) {
-            continue;
-        }
-        
-        /* Compile the factory */
-        uint8_t is_singleton = (binding->scope == SF_SCOPE_SINGLETON) ? 1 : 0;
-        sf_factory *factory = sf_compiler_compile_class(meta, ce, is_singleton);
+        /* Flatten the service and everything it depends on */
+        sf_factory *factory = sf_compiler_compile_service(container, abstract);
         
         if (factory) {
-            /* Store under the abstract name */
+            /* Store under the abstract name, replacing an earlier compile */
+            sf_factory *old = zend_hash_find_ptr(&container->compiled_factories, abstract);
+            if (old) {
+                sf_factory_release(old);
+            }
             zend_hash_update_ptr(&container->compiled_factories, abstract, factory);
             compiled_count++;
+        } else if (UNEXPECTED(EG(exception))) {
+            break;  /* An attribute argument threw */
         }
     } ZEND_HASH_FOREACH_END();
     
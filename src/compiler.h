@@ -16,10 +16,11 @@
 struct _sf_container;
 
 /*
- * Compile a factory for a class based on its metadata.
- * Returns NULL if the class cannot be compiled (e.g., too many deps).
+ * Compile a factory for a service (binding abstract or autowired class) by
+ * flattening its whole dependency graph into a resolution plan.
+ * Returns NULL if the service cannot be compiled (closure, non-instantiable...).
  */
-sf_factory *sf_compiler_compile_class(sf_class_meta *meta, zend_class_entry *ce, uint8_t is_singleton);
+sf_factory *sf_compiler_compile_service(struct _sf_container *container, zend_string *abstract);
 
 /*
  * Compile all registered bindings in the container.
@@ -33,4 +34,25 @@ int sf_compiler_compile_all(struct _sf_container *container);
  */
 int sf_compiler_can_compile(sf_class_meta *meta);
 
+/*
+ * Tiered compilation: services resolved compile_threshold times through the
+ * regular path get a plan, without compile(). Counted per binding
+ * (sf_binding.hotness) and per autowired class (sf_class_meta.resolutions),
+ * across requests in persistent mode; stats resets leave both alone.
+ */
+static zend_always_inline zend_bool sf_compile_due(uint32_t resolutions)
+{
+    zend_long threshold = SF_CONTAINER_G(compile_threshold);
+    return threshold > 0 && resolutions == (zend_ulong)threshold;
+}
+
+/* Compile `abstract` unless it already has a factory */
+void sf_compiler_promote(struct _sf_container *container, zend_string *abstract);
+
+/*
+ * Re-check a factory against the current graph generation and class entries.
+ * Returns SUCCESS if it can still be used.
+ */
+int sf_compiler_revalidate(struct _sf_container *container, sf_factory *factory);
+
 #endif /* SF_COMPILER_H */
@@ -9,7 +9,7 @@
  * Resolution order (checked from top to bottom):
  * 1. Existing singleton instance (instant return, no creation)
  * 2. Contextual binding (when A needs B, give C)
- * 3. Explicit binding (registered via bind/singleton)
+ * 3. Explicit binding (registered via bind/singleton, or declared with #[Singleton]/#[Bind])
  * 4. Autowiring (analyze constructor, resolve dependencies)
  */
 
@@ -19,20 +19,117 @@
 #include "autowire.h"
 #include "reflection_cache.h"
 #include "factory.h"
+#include "compiler.h"
 #include "simd.h"
 #include "cache_file.h"
+#include "lazy.h"
+#include "tag.h"
+#include "scope.h"
 
+#include "zend_hrtime.h"
+#include "zend_fibers.h"
+#include "zend_observer.h"
+
+extern zend_class_entry *sf_container_exception_ce;
 extern zend_class_entry *sf_not_found_exception_ce;
 extern zend_class_entry *sf_circular_dependency_exception_ce;
 
+static void sf_container_flush_deferred_cache(sf_container *c);
+
+/*
+ * Something a make() may resolve differently changed: call-site slots and
+ * cached tag lists go stale. Cached lists are dropped right away so they
+ * don't keep forgotten singletons alive.
+ */
+static zend_always_inline void sf_container_touch(sf_container *c)
+{
+    c->site_generation++;
+    if (UNEXPECTED(c->tag_cache)) {
+        zend_hash_clean(c->tag_cache);
+    }
+}
+
+/*
+ * The graph changed for `key` (its binding, alias or a contextual rule for
+ * it). Plans remember every name they consulted, so only those that
+ * consulted `key` are rebuilt when they next run - see sf_compiler_revalidate().
+ */
+static void sf_container_reshape(sf_container *c, zend_string *key)
+{
+    zval zv;
+    zend_string *copy = sf_string_copy_ex(key, c->persistent);
+    
+    ZVAL_LONG(&zv, ++c->generation);
+    zend_hash_update(&c->reshaped, copy, &zv);
+    zend_string_release(copy);
+}
+
+/* Tombstone key of a pruned contextual rule - class names never contain NUL */
+static zend_string *sf_pruned_rule_key(zend_string *concrete, zend_string *abstract, zend_bool persistent)
+{
+    size_t len = ZSTR_LEN(concrete);
+    zend_string *key = zend_string_alloc(len + 1 + ZSTR_LEN(abstract), persistent);
+    
+    memcpy(ZSTR_VAL(key), ZSTR_VAL(concrete), len);
+    ZSTR_VAL(key)[len] = '\0';
+    memcpy(ZSTR_VAL(key) + len + 1, ZSTR_VAL(abstract), ZSTR_LEN(abstract) + 1);
+    return key;
+}
+
+/*
+ * Was `abstract` (for `concrete`, when given) pruned at the end of a request
+ * and not bound again since? Plans leave such keys to make().
+ */
+zend_bool sf_container_pruned(sf_container *c, zend_string *concrete, zend_string *abstract)
+{
+    if (EXPECTED(zend_hash_num_elements(&c->pruned) == 0)) {
+        return 0;
+    }
+    if (zend_hash_exists(&c->pruned, abstract)) {
+        return 1;
+    }
+    if (!concrete) {
+        return 0;
+    }
+    
+    zend_string *key = sf_pruned_rule_key(concrete, abstract, 0);
+    zend_bool found = zend_hash_exists(&c->pruned, key);
+    zend_string_release(key);
+    return found;
+}
+
+/* Drop the tombstone a binding (concrete NULL) or rule is registered over; returns whether there was one */
+static zend_bool sf_container_unprune(sf_container *c, zend_string *concrete, zend_string *abstract)
+{
+    if (EXPECTED(zend_hash_num_elements(&c->pruned) == 0)) {
+        return 0;
+    }
+    if (!concrete) {
+        return zend_hash_del(&c->pruned, abstract) == SUCCESS;
+    }
+    
+    zend_string *key = sf_pruned_rule_key(concrete, abstract, 0);
+    zend_bool found = zend_hash_del(&c->pruned, key) == SUCCESS;
+    zend_string_release(key);
+    return found;
+}
+
 /* ============================================================================
  * Resolution Context (Circular Dependency Detection)
  *
  * Tracks what we're currently resolving. If we see the same abstract twice
  * in the stack, we have a circular dependency (A needs B, B needs A).
  *
- * Uses a simple array stack - linear search is fine since dependency chains
- * are typically <10 deep. A hash set would be overkill.
+ * Each entry stamps a mark - the `resolving` field of the abstract's binding
+ * or class metadata - with its depth + 1. An abstract is on the stack when
+ * its mark points at an entry that stamped that same mark, so the common
+ * check is O(1) however deep the graph is. Marks are never cleared: a stale
+ * stamp fails the back-pointer check, which also keeps them safe across
+ * aborted requests and shared persistent bindings.
+ *
+ * Abstracts with neither (classes resolved for the first time, contextual
+ * targets, unknown names) go on the stack unmarked. While any are on it, the
+ * hash scan below runs as well - it is only ever needed on a cold path.
  * ============================================================================ */
 
 sf_resolution_context *sf_resolution_context_create(void)
@@ -40,11 +137,16 @@ sf_resolution_context *sf_resolution_context_create(void)
     sf_resolution_context *ctx = emalloc(sizeof(sf_resolution_context));
     ctx->capacity = 8;  /* Enough for typical dependency chains */
     ctx->depth = 0;
+    ctx->unmarked = 0;
     ctx->stack = emalloc(sizeof(zend_string *) * ctx->capacity);
     /* Allocate hash array - use emalloc for all platforms to ensure
      * consistent allocation/deallocation via efree. SIMD operations
      * can handle unaligned loads on modern CPUs, just slightly slower. */
     ctx->hashes = emalloc(sizeof(uint32_t) * ctx->capacity);
+    ctx->marks = emalloc(sizeof(uint32_t *) * ctx->capacity);
+    ctx->suspended = 0;
+    ctx->trace_open = 0;
+    ctx->next = NULL;
     return ctx;
 }
 
@@ -66,83 +168,321 @@ void sf_resolution_context_destroy(sf_resolution_context *ctx)
         efree(ctx->hashes);
     }
     
+    if (ctx->marks) {
+        efree(ctx->marks);
+    }
+    
     efree(ctx);
 }
 
-int sf_resolution_context_push(sf_resolution_context *ctx, zend_string *abstract)
+int sf_resolution_context_push(sf_resolution_context *ctx, zend_string *abstract, uint32_t *mark)
 {
     /* Before pushing, check if this would create a cycle */
-    if (sf_resolution_context_has(ctx, abstract)) {
+    if (sf_resolution_context_has(ctx, abstract, mark)) {
         return FAILURE;
     }
     
     /* Grow stack on demand (doubling strategy) */
-    if (ctx->depth >= ctx->capacity) {
+    if (UNEXPECTED(ctx->depth >= ctx->capacity)) {
         uint32_t new_capacity = ctx->capacity * 2;
         ctx->stack = erealloc(ctx->stack, sizeof(zend_string *) * new_capacity);
         ctx->hashes = erealloc(ctx->hashes, sizeof(uint32_t) * new_capacity);
+        ctx->marks = erealloc(ctx->marks, sizeof(uint32_t *) * new_capacity);
         ctx->capacity = new_capacity;
     }
     
     ctx->stack[ctx->depth] = zend_string_copy(abstract);
     ctx->hashes[ctx->depth] = ZSTR_H(abstract);
+    ctx->marks[ctx->depth] = mark;
     ctx->depth++;
+    
+    if (EXPECTED(mark)) {
+        *mark = ctx->depth;
+    } else {
+        ctx->unmarked++;
+    }
     return SUCCESS;
 }
 
 void sf_resolution_context_pop(sf_resolution_context *ctx)
 {
     if (ctx->depth > 0) {
-        zend_string_release(ctx->stack[--ctx->depth]);
+        ctx->depth--;
+        if (UNEXPECTED(!ctx->marks[ctx->depth])) {
+            ctx->unmarked--;
+        }
+        if (UNEXPECTED(ctx->suspended > ctx->depth)) {
+            ctx->suspended = ctx->depth;
+        }
+        zend_string_release(ctx->stack[ctx->depth]);
+    }
+}
+
+/* Linear hash scan - only needed while unmarked entries are on the stack */
+static int sf_resolution_context_scan(sf_resolution_context *ctx, zend_string *abstract)
+{
+    /* Stored hashes are truncated to 32 bits - compare against the same */
+    uint32_t h = (uint32_t)ZSTR_H(abstract);
+    uint32_t depth = ctx->depth;
+    
+    /* The dispatched kernel compares 4-16 hashes at once; verify each candidate */
+    for (uint32_t i = sf_simd_active.find_u32(ctx->hashes, depth, h, 0); i < depth;
+            i = sf_simd_active.find_u32(ctx->hashes, depth, h, i + 1)) {
+        if (zend_string_equals(ctx->stack[i], abstract)) {
+            return 1;
+        }
     }
+    
+    return 0;
 }
 
-int sf_resolution_context_has(sf_resolution_context *ctx, zend_string *abstract)
+int sf_resolution_context_has(sf_resolution_context *ctx, zend_string *abstract, uint32_t *mark)
 {
     if (UNEXPECTED(ctx->depth == 0)) {
         return 0;
     }
     
-    zend_ulong h = ZSTR_H(abstract);
-    uint32_t depth = ctx->depth;
+    /* O(1): the mark's stamp names the entry that set it, if it still stands */
+    if (EXPECTED(mark)) {
+        uint32_t at = *mark;
+        if (at > 0 && at <= ctx->depth && ctx->marks[at - 1] == mark) {
+            return 1;
+        }
+        if (EXPECTED((ctx->unmarked | ctx->suspended) == 0)) {
+            return 0;
+        }
+    }
+    
+    /* An unmarked or restamped entry may name the same abstract (uncommon) */
+    return sf_resolution_context_scan(ctx, abstract);
+}
+
+/* ============================================================================
+ * Fibers
+ *
+ * A constructor may suspend its fiber (an async connect under Revolt/AMPHP)
+ * while other fibers resolve from the same container. Each of them needs its
+ * own resolution stack, or they see each other's entries as cycles.
+ *
+ * An empty stack holds no state, so a switch normally changes nothing. Only
+ * a fiber that suspends mid-resolution parks its stack, keyed by its fiber
+ * context, and the fiber switched to gets its own parked stack back or a
+ * spare one. Marks are shared by all stacks: one restamped by another fiber
+ * would hide an entry, so a stack parked with entries scans for them until
+ * they are popped.
+ * ============================================================================ */
+
+/* Spares kept for reuse - enough for a few fibers suspended at once */
+#define SF_SPARE_CONTEXTS 4
+
+static zend_always_inline zend_ulong sf_fiber_key(zend_fiber_context *fiber)
+{
+    return (zend_ulong)(uintptr_t)fiber;
+}
+
+static sf_resolution_context *sf_container_acquire_context(sf_container *c)
+{
+    sf_resolution_context *ctx = c->spare_contexts;
+    if (EXPECTED(ctx)) {
+        c->spare_contexts = ctx->next;
+        c->spare_count--;
+        return ctx;
+    }
+    return sf_resolution_context_create();
+}
+
+static void sf_container_release_context(sf_container *c, sf_resolution_context *ctx)
+{
+    if (c->spare_count < SF_SPARE_CONTEXTS) {
+        ctx->suspended = 0;
+        ctx->next = c->spare_contexts;
+        c->spare_contexts = ctx;
+        c->spare_count++;
+        return;
+    }
+    sf_resolution_context_destroy(ctx);
+}
+
+static void sf_container_fiber_switch(sf_container *c, zend_fiber_context *from, zend_fiber_context *to)
+{
+    sf_resolution_context *ctx = c->context;
     
-#if SF_HAS_SIMD
-    /* SIMD path: compare 4 hashes at once */
-    sf_simd_i32x4 target_hash = sf_simd_set1_i32((uint32_t)h);
-    uint32_t i = 0;
+    /* Nothing in flight and nothing parked - any stack will do (common) */
+    if (EXPECTED(ctx->depth == 0) && EXPECTED(!c->fiber_contexts || zend_hash_num_elements(c->fiber_contexts) == 0)) {
+        return;
+    }
     
-    /* Process 4 hashes at a time */
-    for (; i + 3 < depth; i += 4) {
-        sf_simd_i32x4 stack_hashes = sf_simd_loadu_i32x4(&ctx->hashes[i]);
-        sf_simd_i32x4 cmp = sf_simd_cmpeq_i32(stack_hashes, target_hash);
-        
-        if (UNEXPECTED(sf_simd_any_match_i32(cmp))) {
-            /* At least one hash matched - check which one(s) */
-            uint32_t mask = sf_simd_movemask_i32(cmp);
-            for (uint32_t j = 0; j < 4 && (i + j) < depth; j++) {
-                if ((mask & (0xF << (j * 4))) && zend_string_equals(ctx->stack[i + j], abstract)) {
-                    return 1;
-                }
-            }
-        }
+    sf_resolution_context *resumed = c->fiber_contexts
+        ? zend_hash_index_find_ptr(c->fiber_contexts, sf_fiber_key(to)) : NULL;
+    if (ctx->depth == 0 && !resumed) {
+        return;
     }
     
-    /* Handle remaining elements (0-3) */
-    for (; i < depth; i++) {
-        if (ctx->hashes[i] == h && zend_string_equals(ctx->stack[i], abstract)) {
-            return 1;
+    if (ctx->depth > 0) {
+        if (!c->fiber_contexts) {
+            ALLOC_HASHTABLE(c->fiber_contexts);
+            zend_hash_init(c->fiber_contexts, 8, NULL, NULL, 0);
         }
+        ctx->suspended = ctx->depth;
+        zend_hash_index_update_ptr(c->fiber_contexts, sf_fiber_key(from), ctx);
+    } else {
+        sf_container_release_context(c, ctx);
     }
-#else
-    /* Scalar fallback: original implementation */
-    for (uint32_t i = 0; i < depth; i++) {
-        if (ctx->hashes[i] == h && zend_string_equals(ctx->stack[i], abstract)) {
-            return 1;
-        }
+    
+    if (resumed) {
+        zend_hash_index_del(c->fiber_contexts, sf_fiber_key(to));
+        c->context = resumed;
+    } else {
+        c->context = sf_container_acquire_context(c);
+    }
+}
+
+/* A fiber destroyed while suspended mid-resolution never gets its stack back */
+static void sf_container_fiber_destroy(sf_container *c, zend_fiber_context *fiber)
+{
+    sf_resolution_context *ctx = c->fiber_contexts
+        ? zend_hash_index_find_ptr(c->fiber_contexts, sf_fiber_key(fiber)) : NULL;
+    if (ctx) {
+        zend_hash_index_del(c->fiber_contexts, sf_fiber_key(fiber));
+        sf_resolution_context_destroy(ctx);
+    }
+}
+
+static void sf_container_destroy_fiber_contexts(sf_container *c)
+{
+    if (c->fiber_contexts) {
+        sf_resolution_context *ctx;
+        ZEND_HASH_FOREACH_PTR(c->fiber_contexts, ctx) {
+            sf_resolution_context_destroy(ctx);
+        } ZEND_HASH_FOREACH_END();
+        zend_hash_destroy(c->fiber_contexts);
+        FREE_HASHTABLE(c->fiber_contexts);
+        c->fiber_contexts = NULL;
     }
-#endif
     
-    return 0;
+    while (c->spare_contexts) {
+        sf_resolution_context *next = c->spare_contexts->next;
+        sf_resolution_context_destroy(c->spare_contexts);
+        c->spare_contexts = next;
+    }
+    c->spare_count = 0;
+}
+
+static void sf_fiber_switch_observer(zend_fiber_context *from, zend_fiber_context *to)
+{
+    sf_container *c = SF_CONTAINER_G(global_container);
+    if (c && c->request_active) {
+        sf_container_fiber_switch(c, from, to);
+    }
+}
+
+static void sf_fiber_destroy_observer(zend_fiber_context *fiber)
+{
+    sf_container *c = SF_CONTAINER_G(global_container);
+    if (c && c->request_active) {
+        sf_container_fiber_destroy(c, fiber);
+    }
+}
+
+void sf_container_fiber_startup(void)
+{
+    zend_observer_fiber_switch_register(sf_fiber_switch_observer);
+    zend_observer_fiber_destroy_register(sf_fiber_destroy_observer);
+}
+
+/* ============================================================================
+ * Class Lookup
+ *
+ * has() and autowiring look up names that are not bound, and a miss runs the
+ * whole autoloader chain - with a non-authoritative classmap that means
+ * filesystem checks, for every call. Names that failed are remembered per
+ * request together with the state that made them fail: the class table size
+ * (declaring a class or alias grows it, nothing shrinks it mid-request) and
+ * an epoch bumped by spl_autoload_register()/unregister(). When either moved,
+ * the remembered misses are dropped and the next lookup asks the autoloaders
+ * again.
+ * ============================================================================ */
+
+static zif_handler sf_spl_autoload_register;
+static zif_handler sf_spl_autoload_unregister;
+
+static ZEND_NAMED_FUNCTION(sf_autoload_register_hook)
+{
+    SF_CONTAINER_G(autoload_epoch)++;
+    sf_spl_autoload_register(INTERNAL_FUNCTION_PARAM_PASSTHRU);
+}
+
+static ZEND_NAMED_FUNCTION(sf_autoload_unregister_hook)
+{
+    SF_CONTAINER_G(autoload_epoch)++;
+    sf_spl_autoload_unregister(INTERNAL_FUNCTION_PARAM_PASSTHRU);
+}
+
+static void sf_wrap_function(const char *name, size_t len, zif_handler *orig, zif_handler hook)
+{
+    zend_function *fn = zend_hash_str_find_ptr(CG(function_table), name, len);
+    if (fn && fn->type == ZEND_INTERNAL_FUNCTION) {
+        *orig = fn->internal_function.handler;
+        fn->internal_function.handler = hook;
+    }
+}
+
+void sf_container_autoload_startup(void)
+{
+    sf_wrap_function("spl_autoload_register", sizeof("spl_autoload_register") - 1,
+        &sf_spl_autoload_register, sf_autoload_register_hook);
+    sf_wrap_function("spl_autoload_unregister", sizeof("spl_autoload_unregister") - 1,
+        &sf_spl_autoload_unregister, sf_autoload_unregister_hook);
+}
+
+static zend_always_inline zend_bool sf_missing_classes_current(sf_container *c)
+{
+    return c->missing_class_count == zend_hash_num_elements(EG(class_table))
+        && c->missing_autoload_epoch == SF_CONTAINER_G(autoload_epoch);
+}
+
+static void sf_remember_missing_class(sf_container *c, zend_string *class_name)
+{
+    if (!c->missing_classes) {
+        ALLOC_HASHTABLE(c->missing_classes);
+        zend_hash_init(c->missing_classes, 8, NULL, NULL, 0);
+    } else if (!sf_missing_classes_current(c)) {
+        zend_hash_clean(c->missing_classes);
+    }
+    
+    /* The state after the lookup - a failing autoloader may have declared other classes */
+    c->missing_class_count = zend_hash_num_elements(EG(class_table));
+    c->missing_autoload_epoch = SF_CONTAINER_G(autoload_epoch);
+    
+    /* Copied key: the name may be a persistent graph string */
+    zend_hash_str_add_empty_element(c->missing_classes, ZSTR_VAL(class_name), ZSTR_LEN(class_name));
+}
+
+static void sf_forget_missing_classes(sf_container *c)
+{
+    if (c->missing_classes) {
+        zend_hash_destroy(c->missing_classes);
+        FREE_HASHTABLE(c->missing_classes);
+        c->missing_classes = NULL;
+    }
+}
+
+zend_class_entry *sf_container_lookup_class(sf_container *c, zend_string *class_name)
+{
+    HashTable *missing = c->missing_classes;
+    
+    if (UNEXPECTED(missing) && sf_missing_classes_current(c)
+        && zend_hash_exists(missing, class_name)) {
+        return NULL;
+    }
+    
+    zend_class_entry *ce = zend_lookup_class(class_name);
+    
+    /* An autoloader that threw did not get to say whether the class exists */
+    if (UNEXPECTED(!ce) && !EG(exception)) {
+        sf_remember_missing_class(c, class_name);
+    }
+    return ce;
 }
 
 /* ============================================================================
@@ -150,96 +490,273 @@ int sf_resolution_context_has(sf_resolution_context *ctx, zend_string *abstract)
  *
  * Reference counting lets multiple PHP objects share one container without
  * worrying about who cleans up. When refcount hits 0, we free everything.
+ *
+ * A container is split into two lifetimes:
+ * - The graph (bindings, aliases, tags, contextual bindings, reflection cache,
+ *   compiled factories). Normally per-request; in persistent mode it lives in
+ *   process memory and survives until the worker exits.
+ * - Request state (singleton store, resolution context). Always
+ *   per-request, set up by sf_container_request_startup().
  * ============================================================================ */
 
+/* Aliases store a zend_string target */
+static void sf_alias_dtor(zval *zv)
+{
+    zend_string_release(Z_STR_P(zv));
+}
+
+/* Tags store an sf_tag* (persistent in persistent mode) */
+static void sf_tag_list_dtor(zval *zv)
+{
+    sf_tag_release((sf_tag *)Z_PTR_P(zv));
+}
+
+/* Contextual rules of one requesting class: abstract => sf_contextual_binding* */
+static void sf_contextual_binding_dtor(zval *zv)
+{
+    sf_contextual_binding_release((sf_contextual_binding *)Z_PTR_P(zv));
+}
+
+static void sf_contextual_rules_dtor(zval *zv)
+{
+    HashTable *rules = (HashTable *)Z_PTR_P(zv);
+    zend_bool persistent = (GC_FLAGS(rules) & IS_ARRAY_PERSISTENT) != 0;
+    
+    zend_hash_destroy(rules);
+    pefree(rules, persistent);
+}
+
 sf_container *sf_container_create(void)
 {
-    sf_container *c = emalloc(sizeof(sf_container));
+    return sf_container_create_ex(0);
+}
+
+sf_container *sf_container_create_ex(zend_bool persistent)
+{
+    sf_container *c = pemalloc(sizeof(sf_container), persistent);
     
     /*
      * Hash table sizes are tuned for typical usage:
      * - bindings: most apps have 10-50, start at 8
-     * - instances: similar count to bindings
      * - cache: might cache many classes, start larger
      * - aliases/tags/contextual: rarely used, keep small
      *
      * NULL destructors because we manage memory ourselves via sf_binding_release.
-     * ZVAL_PTR_DTOR on instances because PHP objects need proper cleanup.
      */
-    zend_hash_init(&c->bindings, 8, NULL, NULL, 0);
-    zend_hash_init(&c->instances, 8, NULL, ZVAL_PTR_DTOR, 0);
-    c->fast_cache = sf_fast_lookup_create(4);  /* 64 slots for hot singletons */
-    zend_hash_init(&c->reflection_cache, 16, NULL, NULL, 0);
-    zend_hash_init(&c->aliases, 4, NULL, NULL, 0);
-    zend_hash_init(&c->tags, 2, NULL, ZVAL_PTR_DTOR, 0);
-    zend_hash_init(&c->contextual_bindings, 2, NULL, NULL, 0);
-    zend_hash_init(&c->compiled_factories, 8, NULL, NULL, 0);
+    zend_hash_init(&c->bindings, 8, NULL, NULL, persistent);
+    zend_hash_init(&c->reflection_cache, 16, NULL, NULL, persistent);
+    zend_hash_init(&c->aliases, 4, NULL, sf_alias_dtor, persistent);
+    zend_hash_init(&c->alias_index, 4, NULL, NULL, persistent);
+    zend_hash_init(&c->tags, 2, NULL, sf_tag_list_dtor, persistent);
+    zend_hash_init(&c->contextual_bindings, 2, NULL, sf_contextual_rules_dtor, persistent);
+    zend_hash_init(&c->compiled_factories, 8, NULL, NULL, persistent);
+    zend_hash_init(&c->reshaped, 8, NULL, NULL, persistent);
+    zend_hash_init(&c->pruned, 0, NULL, NULL, persistent);
+    sf_arena_init(&c->arena, persistent);  /* Bindings and class metadata */
     
-    c->context = sf_resolution_context_create();
     c->refcount = 1;
     c->compilation_enabled = 0;
+    c->epoch = 0;
+    c->generation = 0;
+    c->rebuild_generation = 0;
+    c->site_generation = 0;
+    c->sites = NULL;
+    c->tag_cache = NULL;
+    c->scope = NULL;
+    c->handle = NULL;
+    c->fiber_contexts = NULL;
+    c->spare_contexts = NULL;
+    c->spare_count = 0;
+    c->missing_classes = NULL;
+    c->missing_class_count = 0;
+    c->missing_autoload_epoch = 0;
+    c->tag_scan_position = 0;
+    c->tag_scan_pending = NULL;
+    c->tag_scan_pending_count = 0;
+    c->aliases_flat = 1;
+    c->persistent = persistent;
+    c->warm = 0;
+    c->request_active = 0;
+    c->instances = NULL;
+    c->context = NULL;
+    
+    /* No snapshot save pending */
+    c->snapshot_path = NULL;
+    c->snapshot_deferred = 0;
+    
+    sf_container_request_startup(c);
+    return c;
+}
+
+void sf_container_request_startup(sf_container *c)
+{
+    if (c->request_active) return;
+    
+    c->instances = sf_fast_lookup_create(SF_DEFAULT_SLOTS);  /* Grows with the singleton count */
+    c->context = sf_resolution_context_create();
+    
+    /* Class entries cached last request may be gone - re-check lazily */
+    c->epoch++;
+    c->site_generation++;  /* Tag members may point at bindings pruned last request */
+    c->tag_scan_position = 0;  /* A new class table */
+    c->tag_scan_pending_count = 0;
+    c->warm = zend_hash_num_elements(&c->bindings) > 0;
+    c->request_active = 1;
+}
+
+/*
+ * Closures and objects die with the request - drop bindings that hold them.
+ *
+ * Plans already leave closures and instances to make(), so this doesn't
+ * reshape the graph: a tombstone keeps plans built before the next request
+ * binds the key again doing the same, and a closure rebound over it changes
+ * nothing. A class binding that only held an instance is a reshape.
+ */
+static int sf_prune_request_binding(zval *zv, void *arg)
+{
+    sf_container *c = (sf_container *)arg;
+    sf_binding *binding = (sf_binding *)Z_PTR_P(zv);
+    
+    if (!sf_binding_is_request_bound(binding)) {
+        return ZEND_HASH_APPLY_KEEP;
+    }
     
-    /* Binary cache initialization */
-    c->cache_path = NULL;
-    c->cache_loaded = 0;
-    c->cache_dirty = 0;
+    if (Z_TYPE(binding->concrete) == IS_STRING) {
+        sf_container_reshape(c, binding->abstract);
+    } else {
+        zend_string *key = sf_string_copy_ex(binding->abstract, c->persistent);
+        zend_hash_add_empty_element(&c->pruned, key);
+        zend_string_release(key);
+    }
+    sf_binding_release(binding);
+    return ZEND_HASH_APPLY_REMOVE;
+}
+
+static int sf_prune_request_contextual_binding(zval *zv, void *arg)
+{
+    sf_container *c = (sf_container *)arg;
+    sf_contextual_binding *binding = (sf_contextual_binding *)Z_PTR_P(zv);
     
-    /* Note: Cache loading is deferred to first make() call to avoid issues
-     * with empty containers or containers that are immediately flushed */
+    if (!sf_contextual_binding_is_request_bound(binding)) {
+        return ZEND_HASH_APPLY_KEEP;
+    }
     
-    return c;
+    /* The rules table's destructor releases it */
+    zend_string *key = sf_pruned_rule_key(binding->concrete, binding->abstract, c->persistent);
+    zend_hash_add_empty_element(&c->pruned, key);
+    zend_string_release(key);
+    return ZEND_HASH_APPLY_REMOVE;
+}
+
+/* Prune one requester's rules, dropping the requester once it has none left */
+static int sf_prune_request_contextual_rules(zval *zv, void *arg)
+{
+    HashTable *rules = (HashTable *)Z_PTR_P(zv);
+    
+    zend_hash_apply_with_argument(rules, sf_prune_request_contextual_binding, arg);
+    
+    return zend_hash_num_elements(rules) == 0 ? ZEND_HASH_APPLY_REMOVE : ZEND_HASH_APPLY_KEEP;
+}
+
+/*
+ * The Container object closure factories receive. One per container and
+ * request: it only borrows the container (the global one, which the object's
+ * free handler never releases), and is detached at request shutdown in case
+ * a factory kept it.
+ */
+static zend_always_inline zend_object *sf_container_get_handle(sf_container *c)
+{
+    if (UNEXPECTED(!c->handle)) {
+        zval obj;
+        object_init_ex(&obj, sf_container_ce);
+        Z_CONTAINER_OBJ_P(&obj)->container = c;
+        c->handle = Z_OBJ(obj);
+    }
+    return c->handle;
+}
+
+static void sf_container_release_handle(sf_container *c)
+{
+    if (!c->handle) return;
+    
+    zend_object *handle = c->handle;
+    c->handle = NULL;
+    ((sf_container_object *)((char *)handle - XtOffsetOf(sf_container_object, std)))->container = NULL;
+    OBJ_RELEASE(handle);
+}
+
+void sf_container_request_shutdown(sf_container *c)
+{
+    if (!c->request_active) return;
+    
+    /* Deferred snapshot save - the graph is complete now */
+    sf_container_flush_deferred_cache(c);
+    
+    /* Scopes the request left open, innermost first */
+    sf_scope_end_all(c);
+    sf_call_sites_destroy(c);
+    if (c->tag_cache) {
+        zend_hash_destroy(c->tag_cache);
+        FREE_HASHTABLE(c->tag_cache);
+        c->tag_cache = NULL;
+    }
+    if (c->tag_scan_pending) {
+        efree(c->tag_scan_pending);
+        c->tag_scan_pending = NULL;
+    }
+    sf_fast_lookup_destroy(c->instances);
+    c->instances = NULL;
+    sf_resolution_context_destroy(c->context);
+    c->context = NULL;
+    sf_container_destroy_fiber_contexts(c);
+    sf_container_release_handle(c);
+    sf_forget_missing_classes(c);
+    
+    if (c->persistent) {
+        /* Tombstoned rather than reshaped - see sf_prune_request_binding() */
+        zend_hash_apply_with_argument(&c->bindings, sf_prune_request_binding, c);
+        zend_hash_apply_with_argument(&c->contextual_bindings, sf_prune_request_contextual_rules, c);
+    }
+    
+    c->request_active = 0;
 }
 
 void sf_container_destroy(sf_container *c)
 {
     if (!c) return;
     
+    /* Instances, fast cache and resolution context (if a request is live) */
+    sf_container_request_shutdown(c);
+    
     /* Release all bindings (they're refcounted too) */
     zval *val;
     ZEND_HASH_FOREACH_VAL(&c->bindings, val) {
         sf_binding_release((sf_binding *)Z_PTR_P(val));
     } ZEND_HASH_FOREACH_END();
     zend_hash_destroy(&c->bindings);
-    
-    ZEND_HASH_FOREACH_VAL(&c->contextual_bindings, val) {
-        sf_contextual_binding_release((sf_contextual_binding *)Z_PTR_P(val));
-    } ZEND_HASH_FOREACH_END();
-    zend_hash_destroy(&c->contextual_bindings);
+    zend_hash_destroy(&c->contextual_bindings);  /* Rules tables release their bindings */
     
     /* Release compiled factories */
     ZEND_HASH_FOREACH_VAL(&c->compiled_factories, val) {
         sf_factory_release((sf_factory *)Z_PTR_P(val));
     } ZEND_HASH_FOREACH_END();
     zend_hash_destroy(&c->compiled_factories);
+    zend_hash_destroy(&c->reshaped);
+    zend_hash_destroy(&c->pruned);
     
     /* Cache entries are also refcounted */
     sf_cache_clear(&c->reflection_cache);
     zend_hash_destroy(&c->reflection_cache);
     
-    /* Save binary cache BEFORE destroying instances (unless disabled) */
-    /* TEMPORARILY DISABLED - causes segfaults in tests
-    if (c->cache_dirty && c->cache_path && zend_hash_num_elements(&c->instances) > 0 && !getenv("SIGNALFORGE_NO_CACHE")) {
-        if (getenv("SIGNALFORGE_DEBUG")) {
-            php_printf("[Signalforge] Saving binary cache to: %s\n", ZSTR_VAL(c->cache_path));
-            php_printf("[Signalforge] Caching %d singletons\n", 
-                      zend_hash_num_elements(&c->instances));
-        }
-        sf_cache_save(ZSTR_VAL(c->cache_path), &c->instances);
-    }
-    */
-    
-    /* These use ZVAL_PTR_DTOR or store zend_strings that need releasing */
-    zend_hash_destroy(&c->instances);
-    sf_fast_lookup_destroy(c->fast_cache);
+    /* These release their zend_strings via table destructors */
+    zend_hash_destroy(&c->alias_index);
     zend_hash_destroy(&c->aliases);
     zend_hash_destroy(&c->tags);
     
-    if (c->cache_path) {
-        zend_string_release(c->cache_path);
-    }
+    /* Everything allocated from the arena is released by now */
+    sf_arena_destroy(&c->arena);
     
-    sf_resolution_context_destroy(c->context);
-    efree(c);
+    pefree(c, c->persistent);
 }
 
 void sf_container_addref(sf_container *c)
@@ -264,15 +781,54 @@ void sf_container_release(sf_container *c)
  * to prevent infinite loops from misconfiguration.
  * ============================================================================ */
 
-static inline zend_string *sf_resolve_alias(sf_container *c, zend_string *abstract)
+/*
+ * alias_index maps every alias straight to the name its chain ends at, so
+ * resolving is one probe whatever the chain length. It is rebuilt on the
+ * first resolution after alias() calls - a bootstrap registering hundreds of
+ * aliases flattens them once.
+ */
+static void sf_container_flatten_aliases(sf_container *c)
+{
+    uint32_t limit = zend_hash_num_elements(&c->aliases);
+    zend_string *alias;
+    zval *target;
+    
+    zend_hash_clean(&c->alias_index);
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->aliases, alias, target) {
+        zend_string *name = Z_STR_P(target);
+        zval *next;
+        
+        /* A loop gives up once it has taken every alias */
+        for (uint32_t hops = 0; hops < limit && (next = zend_hash_find(&c->aliases, name)); hops++) {
+            name = Z_STR_P(next);
+        }
+        
+        zval end;
+        ZVAL_STR(&end, name);  /* Borrowed from c->aliases */
+        zend_hash_add_new(&c->alias_index, alias, &end);
+    } ZEND_HASH_FOREACH_END();
+    
+    c->aliases_flat = 1;
+}
+
+static zend_always_inline zend_string *sf_resolve_alias(sf_container *c, zend_string *abstract)
 {
-    zval *alias;
-    int depth = 0;
+    if (UNEXPECTED(!c->aliases_flat)) {
+        sf_container_flatten_aliases(c);
+    }
     
-    while ((alias = zend_hash_find(&c->aliases, abstract)) && depth++ < 10) {
-        abstract = Z_STR_P(alias);
+    /* Most graphs have no aliases at all */
+    if (EXPECTED(zend_hash_num_elements(&c->alias_index) == 0)) {
+        return abstract;
     }
-    return abstract;
+    
+    zval *target = zend_hash_find(&c->alias_index, abstract);
+    return target ? Z_STR_P(target) : abstract;
+}
+
+zend_string *sf_container_resolve_alias(sf_container *c, zend_string *abstract)
+{
+    return sf_resolve_alias(c, abstract);
 }
 
 /* ============================================================================
@@ -283,21 +839,40 @@ static inline zend_string *sf_resolve_alias(sf_container *c, zend_string *abstra
  * - TRANSIENT: new instance every time
  * - SINGLETON: cached after first creation
  * - INSTANCE: user-provided object, stored directly
+ * - SCOPED: one instance per open scope
  * ============================================================================ */
 
 int sf_container_bind(sf_container *c, zend_string *abstract, zval *concrete, uint8_t scope)
 {
     abstract = sf_resolve_alias(c, abstract);
     
-    sf_binding *binding = sf_binding_create(abstract, concrete, scope);
+    sf_binding *binding = sf_binding_create(abstract, concrete, scope, &c->arena);
+    
+    /*
+     * Compiled plans resolve closures and instances dynamically, so swapping
+     * one for another (e.g. instance() every request) keeps them valid.
+     * Anything else changes the graph shape.
+     */
+    zend_bool reshapes = 1;
     
     /* Release old binding if replacing (clean rebind) */
-    zval *old = zend_hash_find(&c->bindings, abstract);
+    sf_binding *old = zend_hash_find_ptr(&c->bindings, abstract);
     if (old) {
-        sf_binding_release((sf_binding *)Z_PTR_P(old));
+        reshapes = Z_TYPE(old->concrete) == IS_STRING || Z_TYPE_P(concrete) == IS_STRING;
+        sf_binding_release(old);
+    } else if (sf_container_unprune(c, NULL, abstract)) {
+        reshapes = Z_TYPE_P(concrete) == IS_STRING;  /* Pruned at the end of the last request */
     }
     
-    zend_hash_update_ptr(&c->bindings, abstract, binding);
+    /* Key with the binding's own copy - it's persistent when the table is */
+    zend_hash_update_ptr(&c->bindings, binding->abstract, binding);
+    if (UNEXPECTED(c->scope)) {
+        sf_scope_forget(c, abstract);  /* Instances of the old binding */
+    }
+    if (reshapes) {
+        sf_container_reshape(c, binding->abstract);
+    }
+    sf_container_touch(c);
     return SUCCESS;
 }
 
@@ -305,25 +880,50 @@ int sf_container_instance(sf_container *c, zend_string *abstract, zval *instance
 {
     abstract = sf_resolve_alias(c, abstract);
     
-    /* Store in instances hash for fast lookup */
-    zval copy;
-    ZVAL_COPY(&copy, instance);
-    zend_hash_update(&c->instances, abstract, &copy);
-    /* Also add to fast cache */
-    sf_fast_lookup_insert(c->fast_cache, abstract, instance);
+    /* Inside a scope a scoped service is overridden for that scope only - the graph stays as is */
+    if (UNEXPECTED(c->scope)) {
+        sf_binding *binding = zend_hash_find_ptr(&c->bindings, abstract);
+        if (binding && binding->scope == SF_SCOPE_SCOPED) {
+            return sf_scope_store(c, binding->abstract, instance);
+        }
+    }
     
-    /* Mark cache as dirty since we added a new singleton */
-    c->cache_dirty = 1;
+    /* Store in the singleton store for fast lookup */
+    sf_fast_lookup_insert(c->instances, abstract, instance);
     
     /* Also create a binding so bound() returns true */
     return sf_container_bind(c, abstract, instance, SF_SCOPE_INSTANCE);
 }
 
+/*
+ * Register a lazy singleton: cached like singleton(), but make() hands out a
+ * proxy and the class (with its dependencies) is only built on first use.
+ */
+int sf_container_lazy(sf_container *c, zend_string *abstract, zend_string *class_name)
+{
+    zval concrete;
+    ZVAL_STR(&concrete, class_name);
+    
+    if (sf_container_bind(c, abstract, &concrete, SF_SCOPE_SINGLETON) != SUCCESS) {
+        return FAILURE;
+    }
+    
+    sf_binding *binding = zend_hash_find_ptr(&c->bindings, sf_resolve_alias(c, abstract));
+    binding->lazy = 1;
+    return SUCCESS;
+}
+
 int sf_container_alias(sf_container *c, zend_string *abstract, zend_string *alias)
 {
     zval zv;
-    ZVAL_STR(&zv, zend_string_copy(abstract));
-    zend_hash_update(&c->aliases, alias, &zv);
+    zend_string *key = sf_string_intern_ex(alias, c->persistent);
+    
+    ZVAL_STR(&zv, sf_string_intern_ex(abstract, c->persistent));
+    zend_hash_update(&c->aliases, key, &zv);
+    zend_string_release(key);
+    c->aliases_flat = 0;
+    sf_container_reshape(c, alias);
+    sf_container_touch(c);
     return SUCCESS;
 }
 
@@ -331,45 +931,51 @@ int sf_container_alias(sf_container *c, zend_string *abstract, zend_string *alia
  * Contextual Bindings
  *
  * "When UserController needs LoggerInterface, give it FileLogger"
- * Key format: "UserController:LoggerInterface" -> FileLogger
+ * Two-level index: UserController -> { LoggerInterface -> FileLogger }
  *
  * This lets you inject different implementations based on who's asking.
+ * The lookup runs for every dependency of a class with rules, so it is two
+ * hash probes on names whose hashes are already cached - a requester without
+ * rules costs one miss, and nothing is allocated either way.
  * ============================================================================ */
 
 sf_contextual_binding *sf_container_get_contextual_binding(sf_container *c, zend_string *concrete, zend_string *abstract)
 {
     if (!concrete) return NULL;
     
-    /* Build composite key - smart_str handles dynamic sizing */
-    smart_str key = {0};
-    smart_str_append(&key, concrete);
-    smart_str_appendc(&key, ':');
-    smart_str_append(&key, abstract);
-    smart_str_0(&key);
-    
-    zval *found = zend_hash_find(&c->contextual_bindings, key.s);
-    smart_str_free(&key);
-    
-    return found ? (sf_contextual_binding *)Z_PTR_P(found) : NULL;
+    HashTable *rules = zend_hash_find_ptr(&c->contextual_bindings, concrete);
+    return rules ? (sf_contextual_binding *)zend_hash_find_ptr(rules, abstract) : NULL;
 }
 
 int sf_container_add_contextual_binding(sf_container *c, zend_string *concrete, zend_string *abstract, zval *impl)
 {
-    smart_str key = {0};
-    smart_str_append(&key, concrete);
-    smart_str_appendc(&key, ':');
-    smart_str_append(&key, abstract);
-    smart_str_0(&key);
-    
-    sf_contextual_binding *binding = sf_contextual_binding_create(concrete, abstract, impl);
+    HashTable *rules = zend_hash_find_ptr(&c->contextual_bindings, concrete);
+    if (!rules) {
+        rules = pemalloc(sizeof(HashTable), c->persistent);
+        zend_hash_init(rules, 2, NULL, sf_contextual_binding_dtor, c->persistent);
+        
+        zend_string *key = sf_string_copy_ex(concrete, c->persistent);
+        zend_hash_add_new_ptr(&c->contextual_bindings, key, rules);
+        zend_string_release(key);
+    }
     
-    zval *old = zend_hash_find(&c->contextual_bindings, key.s);
+    /* As with bindings, closure for closure keeps plans valid */
+    zend_bool reshapes = 1;
+    sf_contextual_binding *old = zend_hash_find_ptr(rules, abstract);
     if (old) {
-        sf_contextual_binding_release((sf_contextual_binding *)Z_PTR_P(old));
+        reshapes = Z_TYPE(old->implementation) == IS_STRING || Z_TYPE_P(impl) == IS_STRING;
+    } else if (sf_container_unprune(c, concrete, abstract)) {
+        reshapes = Z_TYPE_P(impl) == IS_STRING;
     }
     
-    zend_hash_update_ptr(&c->contextual_bindings, key.s, binding);
-    smart_str_free(&key);
+    /* Keyed with the binding's own copy - it's persistent when the table is.
+     * A previous rule for the same abstract is released by the table. */
+    sf_contextual_binding *binding = sf_contextual_binding_create(concrete, abstract, impl, &c->arena);
+    zend_hash_update_ptr(rules, binding->abstract, binding);
+    if (reshapes) {
+        sf_container_reshape(c, binding->abstract);
+    }
+    sf_container_touch(c);
     
     return SUCCESS;
 }
@@ -383,44 +989,66 @@ int sf_container_add_contextual_binding(sf_container *c, zend_string *concrete,
  * - Object/scalar? Return as-is
  * ============================================================================ */
 
-static ZEND_HOT int sf_resolve_concrete(sf_container *c, zend_string *abstract, zval *concrete, HashTable *params, zval *result, zend_string *requester)
+/*
+ * Call a closure factory with ($container, $params) - matches Laravel's
+ * signature - or as many of them as it declares. `closure` is the binding's
+ * call cache; without one the call info is derived from the closure.
+ */
+static int sf_call_closure(sf_container *c, zval *concrete, sf_closure_cache *closure, HashTable *params, zval *result)
 {
-    /* Closure binding - call the factory function (less common) */
-    if (UNEXPECTED(Z_TYPE_P(concrete) == IS_OBJECT) && UNEXPECTED(instanceof_function(Z_OBJCE_P(concrete), zend_ce_closure))) {
-        zend_fcall_info fci;
-        zend_fcall_info_cache fcc;
-        
-        if (zend_fcall_info_init(concrete, 0, &fci, &fcc, NULL, NULL) == FAILURE) {
-            return FAILURE;
-        }
-        
-        /* Factory receives ($container, $params) - matches Laravel's signature */
-        zval args[2];
-        object_init_ex(&args[0], sf_container_ce);
-        sf_container_object *cont_obj = Z_CONTAINER_OBJ_P(&args[0]);
-        cont_obj->container = c;
-        sf_container_addref(c);
-        
-        if (params) {
+    zend_fcall_info fci;
+    zend_fcall_info_cache fcc;
+    uint32_t arity = 2;
+    
+    if (EXPECTED(closure)) {
+        fcc = closure->fcc;  /* The call may update its copy */
+        arity = closure->arity;
+        fci.size = sizeof(fci);
+        ZVAL_UNDEF(&fci.function_name);
+        fci.object = fcc.object;
+        fci.named_params = NULL;
+    } else if (zend_fcall_info_init(concrete, 0, &fci, &fcc, NULL, NULL) == FAILURE) {
+        return FAILURE;
+    }
+    
+    zval args[2];
+    if (EXPECTED(arity > 0)) {
+        ZVAL_OBJ_COPY(&args[0], sf_container_get_handle(c));
+    }
+    if (arity > 1) {
+        if (params && zend_hash_num_elements(params) > 0) {
             ZVAL_ARR(&args[1], zend_array_dup(params));
         } else {
-            array_init(&args[1]);
+            ZVAL_EMPTY_ARRAY(&args[1]);
         }
-        
-        fci.retval = result;
-        fci.params = args;
-        fci.param_count = 2;
-        
-        int ret = zend_call_function(&fci, &fcc);
-        
-        zval_ptr_dtor(&args[0]);
-        zval_ptr_dtor(&args[1]);
-        
-        return ret == SUCCESS ? SUCCESS : FAILURE;
+    }
+    
+    fci.retval = result;
+    fci.params = args;
+    fci.param_count = arity;
+    
+    SF_STAT(closures);
+    SF_TRACE_PATH(c, CLOSURE);
+    int ret = zend_call_function(&fci, &fcc);
+    
+    for (uint32_t i = 0; i < arity; i++) {
+        zval_ptr_dtor(&args[i]);
+    }
+    
+    return ret == SUCCESS ? SUCCESS : FAILURE;
+}
+
+static ZEND_HOT int sf_resolve_concrete(sf_container *c, zend_string *abstract, zval *concrete, sf_closure_cache *closure, HashTable *params, zval *result, zend_string *requester)
+{
+    /* Closure binding - call the factory function (less common) */
+    if (UNEXPECTED(closure) || (UNEXPECTED(Z_TYPE_P(concrete) == IS_OBJECT) && UNEXPECTED(instanceof_function(Z_OBJCE_P(concrete), zend_ce_closure)))) {
+        return sf_call_closure(c, concrete, closure, params, result);
     }
     
     /* Class name - autowire it (most common case) */
     if (EXPECTED(Z_TYPE_P(concrete) == IS_STRING)) {
+        SF_STAT(autowired);
+        SF_TRACE_PATH(c, AUTOWIRE);
         return sf_autowire_resolve(Z_STR_P(concrete), result, params, c);
     }
     
@@ -429,118 +1057,215 @@ static ZEND_HOT int sf_resolve_concrete(sf_container *c, zend_string *abstract,
     return SUCCESS;
 }
 
+/* The cycle mark for an abstract: its binding's, else its class metadata's */
+static zend_always_inline uint32_t *sf_container_mark(sf_container *c, sf_binding *binding, zend_string *abstract)
+{
+    if (EXPECTED(binding)) {
+        return &binding->resolving;
+    }
+    
+    sf_class_meta *meta = zend_hash_find_ptr(&c->reflection_cache, abstract);
+    return meta ? &meta->resolving : NULL;
+}
+
 /*
- * sf_container_make - Main resolution entry point
- *
- * Resolution priority:
- * 1. Check circular dependency (fail fast)
- * 2. Return cached singleton if exists
- * 3. Check contextual binding (A needs B -> give C)
- * 4. Check explicit binding (bind/singleton calls)
- * 5. Fall back to autowiring (analyze constructor)
+ * An unbound name whose class says #[Singleton] or #[Bind]: register the
+ * binding the attributes describe, as bind()/singleton() would, so this and
+ * every later resolution takes the regular binding path. NULL for anything
+ * else - it is autowired as it is.
  */
-ZEND_HOT int sf_container_make(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+static sf_binding *sf_container_bind_declared(sf_container *c, zend_string *abstract)
 {
-    /* Auto-load binary cache on first access (if bindings exist and not disabled) */
-    /* TEMPORARILY DISABLED - causes segfaults in tests
-    if (UNEXPECTED(!c->cache_loaded && zend_hash_num_elements(&c->bindings) > 0 && !getenv("SIGNALFORGE_NO_CACHE"))) {
-        if (sf_container_has_cache(c)) {
-            if (getenv("SIGNALFORGE_DEBUG")) {
-                php_printf("[Signalforge] Loading binary cache from: %s\n", ZSTR_VAL(c->cache_path));
-            }
-            sf_container_load_cache(c);
-            if (getenv("SIGNALFORGE_DEBUG")) {
-                php_printf("[Signalforge] Loaded %d singletons from cache\n", 
-                          zend_hash_num_elements(&c->instances));
-            }
-        }
-        c->cache_loaded = 1;
+    sf_class_meta *meta = zend_hash_find_ptr(&c->reflection_cache, abstract);
+    
+    /* Current metadata without binding attributes - the common case */
+    if (EXPECTED(meta) && EXPECTED(meta->epoch == c->epoch) && EXPECTED(!sf_class_meta_binds(meta))) {
+        return NULL;
     }
-    */
-    c->cache_loaded = 1; /* Mark as loaded to prevent checks */
     
-    abstract = sf_resolve_alias(c, abstract);
+    /* Built here rather than in autowiring, which finds it cached (a missing class is reported there) */
+    zend_class_entry *ce = sf_container_lookup_class(c, abstract);
+    meta = ce ? sf_container_get_meta(c, abstract, ce) : NULL;
+    if (!meta || !sf_class_meta_binds(meta)) {
+        return NULL;
+    }
     
-    /* Ultra-fast path: SIMD-accelerated singleton cache lookup */
-    zval *cached = sf_fast_lookup_find(c->fast_cache, abstract);
-    if (EXPECTED(cached)) {
-        ZVAL_COPY(result, cached);
+    zval concrete;
+    ZVAL_STR(&concrete, meta->bind_to ? meta->bind_to : abstract);
+    sf_container_bind(c, abstract, &concrete, (meta->attributes & SF_ATTR_SINGLETON) ? SF_SCOPE_SINGLETON : SF_SCOPE_TRANSIENT);
+    
+    return zend_hash_find_ptr(&c->bindings, abstract);
+}
+
+/*
+ * Push an abstract onto the resolution stack, throwing if it is already there.
+ */
+static int sf_container_enter_ex(sf_container *c, zend_string *abstract, sf_binding *binding)
+{
+    if (EXPECTED(sf_resolution_context_push(c->context, abstract, sf_container_mark(c, binding, abstract)) == SUCCESS)) {
         return SUCCESS;
     }
     
-    /* Fast path: check regular instance cache */
-    cached = zend_hash_find(&c->instances, abstract);
-    if (EXPECTED(cached)) {
-        ZVAL_COPY(result, cached);
-        return SUCCESS;
+    /* Build helpful error message showing the cycle */
+    smart_str msg = {0};
+    smart_str_appends(&msg, "Circular dependency detected: ");
+    for (uint32_t i = 0; i < c->context->depth; i++) {
+        if (i > 0) smart_str_appends(&msg, " -> ");
+        smart_str_append(&msg, c->context->stack[i]);
     }
+    smart_str_appends(&msg, " -> ");
+    smart_str_append(&msg, abstract);
+    smart_str_0(&msg);
     
-    /* Fast path: use compiled factory if available (no context needed for direct call) */
-    if (EXPECTED(c->compilation_enabled) && EXPECTED(!requester)) {
-        sf_factory *factory = zend_hash_find_ptr(&c->compiled_factories, abstract);
-        if (EXPECTED(factory) && EXPECTED(factory->factory_fn)) {
-            return sf_factory_call(factory, c, params, result);
-        }
+    zend_throw_exception(sf_circular_dependency_exception_ce, ZSTR_VAL(msg.s), 0);
+    smart_str_free(&msg);
+    return FAILURE;
+}
+
+int sf_container_enter(sf_container *c, zend_string *abstract)
+{
+    return sf_container_enter_ex(c, abstract, zend_hash_find_ptr(&c->bindings, abstract));
+}
+
+void sf_container_leave(sf_container *c)
+{
+    sf_resolution_context_pop(c->context);
+}
+
+/*
+ * A scoped binding: the instance of the innermost scope that has one, else a
+ * new one stored in the innermost scope. Resolving one with no scope open is
+ * an error - it would have to live as long as the process.
+ */
+static int sf_container_resolve_scoped(sf_container *c, sf_binding *binding, HashTable *params, zval *result, zend_string *requester)
+{
+    if (UNEXPECTED(!c->scope)) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "Scoped service '%s' can only be resolved inside a scope (see Container::beginScope())", ZSTR_VAL(binding->abstract));
+        return FAILURE;
     }
     
-    /* Push onto resolution stack to detect cycles */
-    if (UNEXPECTED(sf_resolution_context_push(c->context, abstract) == FAILURE)) {
-        /* Build helpful error message showing the cycle */
-        smart_str msg = {0};
-        smart_str_appends(&msg, "Circular dependency detected: ");
-        for (uint32_t i = 0; i < c->context->depth; i++) {
-            if (i > 0) smart_str_appends(&msg, " -> ");
-            smart_str_append(&msg, c->context->stack[i]);
-        }
-        smart_str_appends(&msg, " -> ");
-        smart_str_append(&msg, abstract);
-        smart_str_0(&msg);
-        
-        zend_throw_exception(sf_circular_dependency_exception_ce, ZSTR_VAL(msg.s), 0);
-        smart_str_free(&msg);
+    /* Traced as scoped whether it is found or built */
+    SF_TRACE_PATH(c, SCOPED);
+    zval *found = sf_scope_find(c, binding->abstract);
+    if (EXPECTED(found)) {
+        SF_STAT(scoped);
+        ZVAL_COPY(result, found);
+        return SUCCESS;
+    }
+    
+    if (UNEXPECTED(sf_resolve_concrete(c, binding->abstract, &binding->concrete, binding->closure, params, result, requester) == FAILURE)) {
         return FAILURE;
     }
     
+    /* The constructor may have ended the scope it was created for */
+    if (EXPECTED(c->scope) && UNEXPECTED(sf_scope_store(c, binding->abstract, result) == FAILURE)) {
+        SF_STAT(lookup_insert_failures);
+    }
+    return SUCCESS;
+}
+
+/*
+ * Everything after a singleton store miss:
+ * 1. Check contextual binding (A needs B -> give C)
+ * 2. Run the compiled plan if there is one
+ * 3. Check circular dependency (fail fast)
+ * 4. Check explicit binding (bind/singleton calls)
+ * 5. Fall back to autowiring (analyze constructor)
+ */
+static ZEND_HOT int sf_container_resolve(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+{
     /* Check for context-specific binding - skip if no contextual bindings exist (uncommon) */
     sf_contextual_binding *ctx_binding = NULL;
     if (UNEXPECTED(requester) && UNEXPECTED(zend_hash_num_elements(&c->contextual_bindings) > 0)) {
         ctx_binding = sf_container_get_contextual_binding(c, requester, abstract);
-        if (UNEXPECTED(ctx_binding)) {
-            int ret = sf_resolve_concrete(c, abstract, &ctx_binding->implementation, params, result, requester);
-            sf_resolution_context_pop(c->context);
-            return ret;
+    }
+    
+    /* Fast path: run the compiled plan if available (it manages the resolution stack itself) */
+    if (zend_hash_num_elements(&c->compiled_factories) && EXPECTED(!ctx_binding)) {
+        sf_factory *factory = zend_hash_find_ptr(&c->compiled_factories, abstract);
+        /* Plan built from an older graph or class entries from an earlier request (uncommon) */
+        if (EXPECTED(factory) && UNEXPECTED(factory->epoch != c->epoch || factory->generation != c->generation)
+            && sf_compiler_revalidate(c, factory) == FAILURE && UNEXPECTED(EG(exception))) {
+            return FAILURE;
+        }
+        if (EXPECTED(factory) && EXPECTED(factory->steps)) {
+            SF_STAT(compiled);
+            SF_TRACE_PATH(c, COMPILED);
+            return sf_factory_call(factory, c, params, result);
         }
     }
     
+    /* Push onto resolution stack to detect cycles */
+    sf_binding *binding = zend_hash_find_ptr(&c->bindings, abstract);
+    if (!binding) {
+        binding = sf_container_bind_declared(c, abstract);
+    }
+    if (UNEXPECTED(sf_container_enter_ex(c, abstract, binding) == FAILURE)) {
+        return FAILURE;
+    }
+    
+    /* Context-specific binding wins over the regular one */
+    if (UNEXPECTED(ctx_binding)) {
+        SF_STAT(contextual);
+        SF_TRACE_PATH(c, CONTEXTUAL);
+        int ret = sf_resolve_concrete(c, abstract, &ctx_binding->implementation, ctx_binding->closure, params, result, requester);
+        sf_resolution_context_pop(c->context);
+        return ret;
+    }
+    
     /* Check for explicit binding */
-    zval *binding_val = zend_hash_find(&c->bindings, abstract);
-    if (EXPECTED(binding_val)) {
-        sf_binding *binding = (sf_binding *)Z_PTR_P(binding_val);
+    if (EXPECTED(binding)) {
+        binding->resolutions++;
+        
+        /* Resolved often enough through the regular path - compile it for next time */
+        if (UNEXPECTED(sf_compile_due(++binding->hotness))) {
+            sf_compiler_promote(c, abstract);
+            if (UNEXPECTED(EG(exception))) {
+                sf_resolution_context_pop(c->context);
+                return FAILURE;
+            }
+        }
+        
+        /* Scoped - one instance per open scope (uncommon) */
+        if (UNEXPECTED(binding->scope == SF_SCOPE_SCOPED)) {
+            int ret = sf_container_resolve_scoped(c, binding, params, result, requester);
+            sf_resolution_context_pop(c->context);
+            return ret;
+        }
         
         /* Instance scope returns the stored object directly (uncommon) */
         if (UNEXPECTED(binding->scope == SF_SCOPE_INSTANCE) && EXPECTED(!Z_ISUNDEF(binding->instance))) {
+            SF_STAT(instances);
+            SF_TRACE_PATH(c, INSTANCE);
             ZVAL_COPY(result, &binding->instance);
             sf_resolution_context_pop(c->context);
             return SUCCESS;
         }
         
-        /* Resolve the binding's concrete value */
-        int ret = sf_resolve_concrete(c, abstract, &binding->concrete, params, result, requester);
+        /* Lazy singleton - a proxy now, the real object on first use (uncommon) */
+        int ret = FAILURE;
+        if (UNEXPECTED(binding->lazy) && EXPECTED(!params || zend_hash_num_elements(params) == 0)) {
+            ret = sf_lazy_create(c, Z_STR(binding->concrete), result);
+            if (EXPECTED(ret == SUCCESS)) {
+                SF_STAT(lazy);
+                SF_TRACE_PATH(c, LAZY);
+            }
+        }
+        
+        /* Resolve the binding's concrete value (also when the class can't be proxied) */
+        if (EXPECTED(ret == FAILURE)) {
+            ret = sf_resolve_concrete(c, abstract, &binding->concrete, binding->closure, params, result, requester);
+        }
         if (UNEXPECTED(ret == FAILURE)) {
             sf_resolution_context_pop(c->context);
             return FAILURE;
         }
         
         /* Singleton? Cache it for next time (common for services) */
-        if (EXPECTED(binding->scope == SF_SCOPE_SINGLETON)) {
-            zval copy;
-            ZVAL_COPY(&copy, result);
-            zend_hash_update(&c->instances, abstract, &copy);
-            /* Also try to add to fast cache for SIMD lookup */
-            sf_fast_lookup_insert(c->fast_cache, abstract, result);
-            /* Mark cache as dirty since we resolved a new singleton */
-            c->cache_dirty = 1;
-            binding->resolved = 1;
+        if (EXPECTED(binding->scope == SF_SCOPE_SINGLETON)
+            && UNEXPECTED(sf_fast_lookup_insert(c->instances, abstract, result) == FAILURE)) {
+            SF_STAT(lookup_insert_failures);
         }
         
         sf_resolution_context_pop(c->context);
@@ -548,11 +1273,89 @@ ZEND_HOT int sf_container_make(sf_container *c, zend_string *abstract, HashTable
     }
     
     /* No binding - try autowiring (implicit resolution) */
+    SF_STAT(autowired);
+    SF_TRACE_PATH(c, AUTOWIRE);
     int ret = sf_autowire_resolve(abstract, result, params, c);
     sf_resolution_context_pop(c->context);
     return ret;
 }
 
+/* stats_timing=1: time an outermost resolution that missed the singleton store */
+static zend_never_inline int sf_container_resolve_timed(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+{
+    zend_hrtime_t start = zend_hrtime();
+    int ret = sf_container_resolve(c, abstract, params, result, requester);
+    uint64_t elapsed = zend_hrtime() - start;
+    
+    sf_stats *stats = &SF_CONTAINER_G(stats);
+    stats->timed++;
+    stats->time_ns += elapsed;
+    if (elapsed > stats->max_ns) {
+        stats->max_ns = elapsed;
+    }
+    
+    return ret;
+}
+
+/* Singleton store, then everything else - `abstract` is alias-free */
+static zend_always_inline int sf_container_make_resolved(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+{
+    /* Ultra-fast path: SIMD-accelerated singleton store lookup */
+    zval *cached = sf_fast_lookup_find(c->instances, abstract);
+    if (EXPECTED(cached)) {
+        SF_STAT(singleton_hits);
+        SF_TRACE_PATH(c, SINGLETON);
+        ZVAL_COPY(result, cached);
+        return SUCCESS;
+    }
+    
+    int ret;
+    if (UNEXPECTED(SF_CONTAINER_G(stats_timing)) && c->context->depth == 0) {
+        ret = sf_container_resolve_timed(c, abstract, params, result, requester);
+    } else {
+        ret = sf_container_resolve(c, abstract, params, result, requester);
+    }
+    
+    if (UNEXPECTED(ret == FAILURE)) {
+        SF_STAT(failures);
+    }
+    return ret;
+}
+
+/*
+ * trace=1: record the resolution, dependencies included (see src/trace.c).
+ * The stack may be parked and resumed in between if a fiber suspends inside.
+ */
+static zend_never_inline int sf_container_make_traced(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+{
+    uint32_t outer = c->context->trace_open;
+    uint32_t open = sf_trace_begin(abstract, requester, c->context->depth);
+    
+    c->context->trace_open = open;
+    int ret = sf_container_make_resolved(c, abstract, params, result, requester);
+    c->context->trace_open = outer;
+    sf_trace_end(open, ret == FAILURE);
+    
+    return ret;
+}
+
+/*
+ * sf_container_make - Main resolution entry point
+ *
+ * Resolves aliases and returns a cached singleton if one exists; everything
+ * else is sf_container_resolve().
+ */
+ZEND_HOT int sf_container_make(sf_container *c, zend_string *abstract, HashTable *params, zval *result, zend_string *requester)
+{
+    SF_STAT(make);
+    abstract = sf_resolve_alias(c, abstract);
+    
+    if (UNEXPECTED(SF_CONTAINER_G(tracing))) {
+        return sf_container_make_traced(c, abstract, params, result, requester);
+    }
+    return sf_container_make_resolved(c, abstract, params, result, requester);
+}
+
 /* ============================================================================
  * Query Operations
  * ============================================================================ */
@@ -566,8 +1369,26 @@ int sf_container_has(sf_container *c, zend_string *abstract)
     }
     
     /* Check if it's an instantiable class (allows autowiring) */
-    zend_class_entry *ce = zend_lookup_class(abstract);
-    return ce && !(ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT));
+    zend_class_entry *ce;
+    sf_class_meta *meta;
+    if (EXPECTED(SF_CONTAINER_G(has_autoload))) {
+        ce = sf_container_lookup_class(c, abstract);
+    } else if ((meta = zend_hash_find_ptr(&c->reflection_cache, abstract)) != NULL) {
+        /* Interfaces and abstract classes are cached too - only #[Bind] makes those resolvable */
+        return meta->is_instantiable || meta->bind_to;
+    } else {
+        ce = zend_lookup_class_ex(abstract, NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD);
+    }
+    if (!ce) {
+        return 0;
+    }
+    if (!(ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT))) {
+        return 1;
+    }
+    
+    /* An interface or abstract class naming its implementation with #[Bind] */
+    meta = sf_container_get_meta(c, abstract, ce);
+    return meta && meta->bind_to;
 }
 
 int sf_container_bound(sf_container *c, zend_string *abstract)
@@ -580,15 +1401,52 @@ int sf_container_resolved(sf_container *c, zend_string *abstract)
 {
     abstract = sf_resolve_alias(c, abstract);
     
-    if (zend_hash_exists(&c->instances, abstract)) {
-        return 1;
+    /* The singleton store is authoritative - anything resolved lives there, or in a scope */
+    return sf_fast_lookup_find(c->instances, abstract) != NULL
+        || (UNEXPECTED(c->scope) && sf_scope_find(c, abstract) != NULL);
+}
+
+/* ============================================================================
+ * Reflection Metadata
+ *
+ * Get-or-build for sf_class_meta. Within one request (epoch) a hit is returned
+ * as-is. On the first hit of a new request the entry is compared against the
+ * live class entry and rebuilt if the constructor signature changed - this is
+ * what keeps persistent metadata correct across opcache resets and edits.
+ * ============================================================================ */
+
+sf_class_meta *sf_container_get_meta(sf_container *c, zend_string *class_name, zend_class_entry *ce)
+{
+    sf_class_meta *meta = sf_cache_get(class_name, &c->reflection_cache);
+    
+    if (EXPECTED(meta) && EXPECTED(meta->epoch == c->epoch)) {
+        return meta;
     }
     
-    zval *binding_val = zend_hash_find(&c->bindings, abstract);
-    if (binding_val) {
-        return ((sf_binding *)Z_PTR_P(binding_val))->resolved;
+    if (meta && sf_cache_matches(meta, ce)) {
+        meta->epoch = c->epoch;
+        return meta;
     }
-    return 0;
+    if (UNEXPECTED(EG(exception))) {
+        return NULL;  /* An attribute argument threw - building it again would too */
+    }
+    
+    sf_class_meta *fresh = sf_cache_build(class_name, ce, &c->arena);
+    if (UNEXPECTED(!fresh)) {
+        return NULL;
+    }
+    SF_STAT(meta_builds);
+    fresh->epoch = c->epoch;
+    
+    /* The cache takes over the build reference; a stale entry is dropped */
+    if (meta) {
+        sf_class_meta_release(meta);
+        zend_hash_update_ptr(&c->reflection_cache, fresh->class_name, fresh);
+    } else {
+        zend_hash_add_new_ptr(&c->reflection_cache, fresh->class_name, fresh);
+    }
+    
+    return fresh;
 }
 
 /* ============================================================================
@@ -599,43 +1457,230 @@ int sf_container_resolved(sf_container *c, zend_string *abstract)
  * Container::tagged('handlers'); // returns [new A, new B]
  * ============================================================================ */
 
-int sf_container_tag(sf_container *c, HashTable *abstracts, zend_string *tag)
+static sf_tag *sf_container_tag_get(sf_container *c, zend_string *name)
 {
-    zval *tag_array = zend_hash_find(&c->tags, tag);
+    sf_tag *tag = zend_hash_find_ptr(&c->tags, name);
     
-    if (!tag_array) {
-        zval new_array;
-        array_init(&new_array);
-        tag_array = zend_hash_update(&c->tags, tag, &new_array);
+    if (!tag) {
+        tag = sf_tag_create(c->persistent);
+        
+        zend_string *key = sf_string_copy_ex(name, c->persistent);
+        zend_hash_update_ptr(&c->tags, key, tag);
+        zend_string_release(key);
     }
-    
+    return tag;
+}
+
+int sf_container_tag(sf_container *c, HashTable *abstracts, zend_string *name)
+{
+    sf_tag *tag = sf_container_tag_get(c, name);
     zval *item;
+    
+    sf_tag_reserve(tag, zend_hash_num_elements(abstracts));
     ZEND_HASH_FOREACH_VAL(abstracts, item) {
         if (Z_TYPE_P(item) == IS_STRING) {
-            zval copy;
-            ZVAL_COPY(&copy, item);
-            add_next_index_zval(tag_array, &copy);
+            sf_tag_append(tag, Z_STR_P(item));
         }
     } ZEND_HASH_FOREACH_END();
     
+    if (UNEXPECTED(c->tag_cache)) {
+        zend_hash_del(c->tag_cache, name);
+    }
     return SUCCESS;
 }
 
-int sf_container_tagged(sf_container *c, zend_string *tag, zval *result)
+/*
+ * #[Tag('name')] puts a class in a tag without a tag() call. The class table
+ * is walked from where the last walk stopped, so a tag lookup only looks at
+ * classes declared since - usually none. Members are appended in declaration
+ * order, after those tagged explicitly, and only once.
+ *
+ * A class compiled but not declared yet sits under a runtime definition key
+ * until it is declared in that same slot, which doesn't grow the table. The
+ * walk moves past such slots and keeps them aside; only they are looked at
+ * again while the table stays the same size.
+ */
+static void sf_container_join_declared_tag(sf_container *c, zend_string *name, zend_string *class_name)
+{
+    sf_tag *tag = sf_container_tag_get(c, name);
+    
+    for (uint32_t i = 0; i < tag->count; i++) {
+        if (zend_string_equals_ci(tag->members[i].abstract, class_name)) {
+            return;
+        }
+    }
+    sf_tag_append(tag, class_name);
+    
+    if (UNEXPECTED(c->tag_cache)) {
+        zend_hash_del(c->tag_cache, name);
+    }
+}
+
+/* Join the tags of the class in class table slot `p`; returns 0 if it is not declared yet */
+static zend_bool sf_container_scan_declared_slot(sf_container *c, Bucket *p)
 {
-    array_init(result);
+    /* Deleted slots and class_alias() entries */
+    if (Z_TYPE(p->val) != IS_PTR) {
+        return 1;
+    }
     
-    zval *tag_array = zend_hash_find(&c->tags, tag);
-    if (!tag_array) return SUCCESS;
+    /* Runtime definition key */
+    if (UNEXPECTED(ZSTR_VAL(p->key)[0] == '\0')) {
+        return 0;
+    }
     
-    /* Resolve each tagged abstract */
+    zend_class_entry *ce = Z_PTR(p->val);
+    if (EXPECTED(!ce->attributes) || ce->type != ZEND_USER_CLASS
+        || (ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT | ZEND_ACC_ENUM))) {
+        return 1;
+    }
+    
+    zend_attribute *attribute;
+    ZEND_HASH_FOREACH_PTR(ce->attributes, attribute) {
+        if (attribute->offset != 0 || !zend_string_equals_literal(attribute->lcname, SF_ATTR_NAME_TAG)) {
+            continue;
+        }
+        zend_string *name = sf_attribute_string(attribute, ce);
+        if (name) {
+            sf_container_join_declared_tag(c, name, ce->name);
+            zend_string_release(name);
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    return 1;
+}
+
+static void sf_container_scan_declared_tags(sf_container *c)
+{
+    HashTable *classes = EG(class_table);
+    
+    if (EXPECTED(c->tag_scan_position == classes->nNumUsed) && EXPECTED(!c->tag_scan_pending_count)) {
+        return;
+    }
+    /* Compacted by a rehash - walk it again (members are not added twice) */
+    if (UNEXPECTED(c->tag_scan_position > classes->nNumUsed)) {
+        c->tag_scan_position = 0;
+        c->tag_scan_pending_count = 0;
+    }
+    
+    /* Slots passed before - keep those still waiting for their class */
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < c->tag_scan_pending_count; i++) {
+        uint32_t slot = c->tag_scan_pending[i];
+        if (!sf_container_scan_declared_slot(c, classes->arData + slot)) {
+            c->tag_scan_pending[kept++] = slot;
+        }
+    }
+    c->tag_scan_pending_count = kept;
+    
+    for (uint32_t i = c->tag_scan_position; i < classes->nNumUsed; i++) {
+        if (EXPECTED(sf_container_scan_declared_slot(c, classes->arData + i))) {
+            continue;
+        }
+        
+        /* Grown in powers of two, from 4 */
+        uint32_t count = c->tag_scan_pending_count;
+        if (count == 0 || (count >= 4 && !(count & (count - 1)))) {
+            c->tag_scan_pending = safe_erealloc(c->tag_scan_pending, count ? count * 2 : 4, sizeof(uint32_t), 0);
+        }
+        c->tag_scan_pending[c->tag_scan_pending_count++] = i;
+    }
+    
+    c->tag_scan_position = classes->nNumUsed;
+}
+
+sf_tag *sf_container_find_tag(sf_container *c, zend_string *name)
+{
+    sf_container_scan_declared_tags(c);
+    return zend_hash_find_ptr(&c->tags, name);
+}
+
+/*
+ * Resolve every member of a tag, in tagging order. Fails (with the member's
+ * exception) as soon as one can't be resolved.
+ *
+ * Lists made only of singletons and instances come out the same every time
+ * until the graph changes, so the finished array is kept for the request and
+ * later calls return it with a refcount bump - copy-on-write keeps callers
+ * from modifying the shared copy.
+ */
+int sf_container_tagged(sf_container *c, zend_string *name, zval *result)
+{
+    sf_container_scan_declared_tags(c);
+    
+    if (EXPECTED(c->tag_cache)) {
+        zval *cached = zend_hash_find(c->tag_cache, name);
+        if (EXPECTED(cached)) {
+            ZVAL_COPY(result, cached);
+            return SUCCESS;
+        }
+    }
+    
+    sf_tag *tag = zend_hash_find_ptr(&c->tags, name);
+    if (!tag) {
+        array_init(result);
+        return SUCCESS;
+    }
+    
+    sf_tag_prepare(c, tag);
+    uint32_t generation = c->site_generation;
+    zend_bool shared = tag->shared;
+    
+    array_init_size(result, tag->count);
+    for (uint32_t i = 0; i < tag->count; i++) {
+        zval resolved;
+        if (UNEXPECTED(sf_tag_make(c, tag, i, &resolved) == FAILURE)) {
+            zval_ptr_dtor(result);
+            ZVAL_UNDEF(result);
+            return FAILURE;
+        }
+        add_next_index_zval(result, &resolved);
+    }
+    
+    /* Only if resolving didn't change the graph under us */
+    if (shared && c->site_generation == generation) {
+        if (!c->tag_cache) {
+            ALLOC_HASHTABLE(c->tag_cache);
+            zend_hash_init(c->tag_cache, 4, NULL, ZVAL_PTR_DTOR, 0);
+        }
+        Z_ADDREF_P(result);
+        zend_hash_update(c->tag_cache, name, result);
+    }
+    
+    return SUCCESS;
+}
+
+/*
+ * Resolve a list of abstracts in one call, keeping the list's keys.
+ * Fails (with the exception of the first one that can't be resolved) without
+ * returning partial results.
+ */
+int sf_container_make_many(sf_container *c, HashTable *abstracts, zval *result)
+{
+    zend_string *key;
+    zend_ulong index;
     zval *item;
-    ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(tag_array), item) {
-        if (Z_TYPE_P(item) == IS_STRING) {
-            zval resolved;
-            if (sf_container_make(c, Z_STR_P(item), NULL, &resolved, NULL) == SUCCESS) {
-                add_next_index_zval(result, &resolved);
-            }
+    
+    array_init_size(result, zend_hash_num_elements(abstracts));
+    ZEND_HASH_FOREACH_KEY_VAL(abstracts, index, key, item) {
+        if (UNEXPECTED(Z_TYPE_P(item) != IS_STRING)) {
+            zend_argument_type_error(1, "must contain only strings, %s given", zend_zval_type_name(item));
+            zval_ptr_dtor(result);
+            ZVAL_UNDEF(result);
+            return FAILURE;
+        }
+        
+        zval resolved;
+        if (UNEXPECTED(sf_container_make(c, Z_STR_P(item), NULL, &resolved, NULL) == FAILURE)) {
+            zval_ptr_dtor(result);
+            ZVAL_UNDEF(result);
+            return FAILURE;
+        }
+        
+        if (key) {
+            zend_hash_update(Z_ARRVAL_P(result), key, &resolved);
+        } else {
+            zend_hash_index_update(Z_ARRVAL_P(result), index, &resolved);
         }
     } ZEND_HASH_FOREACH_END();
     
@@ -652,14 +1697,14 @@ void sf_container_flush(sf_container *c)
 {
     zval *val;
     
+    /* Call sites borrow the objects released below - a destructor calling get() must miss them */
+    sf_container_touch(c);
+    
     ZEND_HASH_FOREACH_VAL(&c->bindings, val) {
         sf_binding_release((sf_binding *)Z_PTR_P(val));
     } ZEND_HASH_FOREACH_END();
     zend_hash_clean(&c->bindings);
     
-    ZEND_HASH_FOREACH_VAL(&c->contextual_bindings, val) {
-        sf_contextual_binding_release((sf_contextual_binding *)Z_PTR_P(val));
-    } ZEND_HASH_FOREACH_END();
     zend_hash_clean(&c->contextual_bindings);
     
     /* Clear compiled factories */
@@ -669,36 +1714,61 @@ void sf_container_flush(sf_container *c)
     zend_hash_clean(&c->compiled_factories);
     c->compilation_enabled = 0;
     
-    zend_hash_clean(&c->instances);
-    sf_fast_lookup_clear(c->fast_cache);
+    sf_fast_lookup_clear(c->instances);
+    sf_scope_forget_all(c);  /* Open scopes stay open, empty */
+    zend_hash_clean(&c->alias_index);
     zend_hash_clean(&c->aliases);
+    c->aliases_flat = 1;
     zend_hash_clean(&c->tags);
+    c->tag_scan_position = 0;  /* #[Tag] members come back */
+    c->tag_scan_pending_count = 0;
     
     sf_cache_clear(&c->reflection_cache);
+    
+    /* Nothing lives in the arena any more - return its chunks in one go */
+    sf_arena_reset(&c->arena);
+    
+    /* Every plan is rebuilt, whatever it consulted */
+    zend_hash_clean(&c->reshaped);
+    zend_hash_clean(&c->pruned);
+    c->rebuild_generation = ++c->generation;
+    sf_container_touch(c);
 }
 
 void sf_container_forget_instance(sf_container *c, zend_string *abstract)
 {
     abstract = sf_resolve_alias(c, abstract);
-    zend_hash_del(&c->instances, abstract);
-    sf_fast_lookup_remove(c->fast_cache, abstract);
-    
-    /* Mark binding as unresolved so next make() creates fresh instance */
-    zval *binding_val = zend_hash_find(&c->bindings, abstract);
-    if (binding_val) {
-        ((sf_binding *)Z_PTR_P(binding_val))->resolved = 0;
-    }
+    sf_container_touch(c);  /* Before destructors run, as in flush */
+    sf_fast_lookup_remove(c->instances, abstract);
+    sf_scope_forget(c, abstract);
 }
 
 void sf_container_forget_instances(sf_container *c)
 {
-    zend_hash_clean(&c->instances);
-    sf_fast_lookup_clear(c->fast_cache);
-    
-    zval *val;
-    ZEND_HASH_FOREACH_VAL(&c->bindings, val) {
-        ((sf_binding *)Z_PTR_P(val))->resolved = 0;
-    } ZEND_HASH_FOREACH_END();
+    sf_container_touch(c);
+    sf_fast_lookup_clear(c->instances);
+    sf_scope_forget_all(c);
+}
+
+/* ============================================================================
+ * Scopes
+ *
+ * Nothing else caches scoped instances (see scope.c), so neither opening nor
+ * closing a scope has to invalidate call-site slots, plans or tag lists.
+ * ============================================================================ */
+
+void sf_container_begin_scope(sf_container *c)
+{
+    sf_scope_begin(c);
+}
+
+int sf_container_end_scope(sf_container *c)
+{
+    if (UNEXPECTED(sf_scope_end(c) == FAILURE)) {
+        zend_throw_exception(sf_container_exception_ce, "No scope to end (Container::endScope() without beginScope())", 0);
+        return FAILURE;
+    }
+    return SUCCESS;
 }
 
 /* ============================================================================
@@ -721,120 +1791,108 @@ void sf_container_clear_compiled(sf_container *c)
     } ZEND_HASH_FOREACH_END();
     zend_hash_clean(&c->compiled_factories);
     c->compilation_enabled = 0;
+    sf_container_touch(c);  /* Call sites hold their own reference to the plans */
 }
 
-/*
- * Binary cache functions for instant loading of pre-resolved services
- */
+/* ============================================================================
+ * Metadata Snapshots
+ *
+ * A snapshot stores the graph and everything derived from it (metadata,
+ * plans), never objects. `path` NULL means the default path, named after a
+ * hash of the graph - computed on each use, since the graph keeps changing.
+ * ============================================================================ */
 
-int sf_container_load_cache(sf_container *c)
+static zend_string *sf_container_snapshot_path(sf_container *c, const char *path)
 {
-    if (c->cache_loaded) {
-        return SUCCESS;  /* Already loaded */
-    }
-    
-    /* Generate cache path if not set */
-    if (!c->cache_path) {
-        c->cache_path = sf_cache_get_path(&c->bindings);
-        if (!c->cache_path) {
-            return FAILURE;
-        }
+    if (path) {
+        return zend_string_init(path, strlen(path), 0);
     }
-    
-    /* Check if cache exists */
-    if (!sf_cache_exists(ZSTR_VAL(c->cache_path))) {
-        return FAILURE;  /* No cache file */
+    return sf_cache_get_path(c);
+}
+
+int sf_container_load_cache(sf_container *c, const char *path)
+{
+    zend_string *file = sf_container_snapshot_path(c, path);
+    if (!file) {
+        return FAILURE;
     }
     
-    /* Load cache */
-    if (sf_cache_load(ZSTR_VAL(c->cache_path), &c->instances) != SUCCESS) {
+    int ret = sf_cache_load(ZSTR_VAL(file), c);
+    zend_string_release(file);
+    return ret;
+}
+
+int sf_container_save_cache(sf_container *c, const char *path)
+{
+    zend_string *file = sf_container_snapshot_path(c, path);
+    if (!file) {
         return FAILURE;
     }
     
-    /* Populate fast cache with loaded instances */
-    zend_string *key;
-    zval *val;
-    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->instances, key, val) {
-        if (key) {
-            sf_fast_lookup_insert(c->fast_cache, key, val);
-        }
-    } ZEND_HASH_FOREACH_END();
-    
-    c->cache_loaded = 1;
-    c->cache_dirty = 0;
-    
-    return SUCCESS;
+    int ret = sf_cache_save(ZSTR_VAL(file), c, 0);
+    zend_string_release(file);
+    return ret;
 }
 
-int sf_container_save_cache(sf_container *c)
+/*
+ * Save at request shutdown instead of now, and only if no current snapshot
+ * exists by then. Calling it again replaces the path.
+ */
+void sf_container_defer_cache(sf_container *c, const char *path)
 {
-    /* Generate cache path if not set */
-    if (!c->cache_path) {
-        c->cache_path = sf_cache_get_path(&c->bindings);
-        if (!c->cache_path) {
-            return FAILURE;
-        }
+    if (c->snapshot_path) {
+        zend_string_release(c->snapshot_path);
     }
+    c->snapshot_path = path ? zend_string_init(path, strlen(path), 0) : NULL;
+    c->snapshot_deferred = 1;
+}
+
+static void sf_container_flush_deferred_cache(sf_container *c)
+{
+    if (EXPECTED(!c->snapshot_deferred)) return;
     
-    /* Don't save empty cache */
-    if (zend_hash_num_elements(&c->instances) == 0) {
-        return SUCCESS;
+    zend_string *file = c->snapshot_path ? zend_string_copy(c->snapshot_path) : sf_cache_get_path(c);
+    if (file) {
+        sf_cache_save(ZSTR_VAL(file), c, 1);
+        zend_string_release(file);
     }
     
-    /* Save all singleton instances */
-    if (sf_cache_save(ZSTR_VAL(c->cache_path), &c->instances) != SUCCESS) {
-        return FAILURE;
+    if (c->snapshot_path) {
+        zend_string_release(c->snapshot_path);
+        c->snapshot_path = NULL;
     }
-    
-    c->cache_dirty = 0;
-    return SUCCESS;
+    c->snapshot_deferred = 0;
 }
 
 int sf_container_has_cache(sf_container *c)
 {
-    /* Generate cache path if not set */
-    if (!c->cache_path) {
-        c->cache_path = sf_cache_get_path(&c->bindings);
-        if (!c->cache_path) {
-            return 0;
-        }
+    zend_string *file = sf_cache_get_path(c);
+    if (!file) {
+        return 0;
     }
     
-    return sf_cache_exists(ZSTR_VAL(c->cache_path));
+    int exists = sf_cache_exists(ZSTR_VAL(file));
+    zend_string_release(file);
+    return exists;
 }
 
 int sf_container_clear_cache(sf_container *c)
 {
-    /* Generate cache path if not set */
-    if (!c->cache_path) {
-        c->cache_path = sf_cache_get_path(&c->bindings);
-        if (!c->cache_path) {
-            return SUCCESS; /* No cache to clear */
-        }
+    zend_string *file = sf_cache_get_path(c);
+    if (!file) {
+        return SUCCESS; /* No cache to clear */
     }
     
     /* Delete cache file */
-    if (unlink(ZSTR_VAL(c->cache_path)) != 0 && errno != ENOENT) {
-        return FAILURE;
-    }
-    
-    /* Mark as not loaded and not dirty */
-    c->cache_loaded = 0;
-    c->cache_dirty = 0;
-    
-    return SUCCESS;
+    int ret = unlink(ZSTR_VAL(file)) != 0 && errno != ENOENT ? FAILURE : SUCCESS;
+    zend_string_release(file);
+    return ret;
 }
 
 zend_string *sf_container_get_cache_path(sf_container *c)
 {
-    /* Generate cache path if not set */
-    if (!c->cache_path) {
-        c->cache_path = sf_cache_get_path(&c->bindings);
-        if (!c->cache_path) {
-            return zend_string_init("", 0, 0);
-        }
-    }
+    zend_string *file = sf_cache_get_path(c);
     
-    /* Return a copy (caller must release) */
-    return zend_string_copy(c->cache_path);
+    /* Caller must release */
+    return file ? file : zend_string_init("", 0, 0);
 }
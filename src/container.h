@@ -9,50 +9,92 @@
 #include "binding.h"
 #include "reflection_cache.h"
 #include "fast_lookup.h"
+#include "call_site.h"
+#include "scope.h"
+#include "arena.h"
 
-/* Tracks what's being resolved to detect circular dependencies (A->B->A) */
+/* Tracks what's being resolved to detect circular dependencies (A->B->A).
+ * Entries with a mark (a binding's or class metadata's `resolving` field)
+ * are found in O(1); the stack itself only names the cycle in the error.
+ * Each fiber that suspends mid-resolution keeps its own (see container.c). */
 struct _sf_resolution_context {
     zend_string **stack;  /* Array of abstracts currently being resolved */
     uint32_t *hashes;     /* Pre-computed hashes for SIMD comparison (aligned) */
+    uint32_t **marks;     /* Mark each entry stamped (NULL = unmarked) */
     uint32_t depth;       /* Current stack depth */
     uint32_t capacity;    /* Allocated size (grows on demand) */
+    uint32_t unmarked;    /* Entries without a mark - scanned when non-zero */
+    uint32_t suspended;   /* Entries kept across a fiber switch - their marks may be restamped, scanned when non-zero */
+    uint32_t trace_open;  /* Open trace slot of the innermost traced make() on this stack (0 = none) */
+    struct _sf_resolution_context *next;  /* Spare list link */
 } __attribute__((aligned(16)));
 
 /* The main container - holds all bindings, instances, and caches
  * Layout optimized for cache line alignment (hot fields in first cache line) */
 struct _sf_container {
     /* Hot fields (accessed on every make() call) - first cache line (64 bytes) */
-    sf_fast_lookup *fast_cache;      /* SIMD-accelerated singleton cache for hot paths */
-    HashTable instances;             /* abstract => zval (cached singletons) */
+    sf_fast_lookup *instances;       /* abstract => zval (cached singletons, SIMD-probed) */
     HashTable bindings;              /* abstract => sf_binding* */
     sf_resolution_context *context;  /* Current resolution stack */
     
     /* Warm fields (accessed frequently but not every call) - second cache line */
     HashTable reflection_cache;      /* class_name => sf_class_meta* */
-    HashTable compiled_factories;    /* class_name => sf_factory* (compiled mode) */
+    HashTable compiled_factories;    /* class_name => sf_factory* (compile() and tiered compilation) */
+    HashTable reshaped;              /* abstract/alias => generation its binding, alias or rules last changed in */
+    HashTable alias_index;           /* alias => name its chain ends at (strings borrowed from aliases) */
+    zend_bool aliases_flat;          /* alias_index is up to date with aliases */
     zend_bool compilation_enabled;   /* Flag for compilation mode */
     uint32_t refcount;               /* Reference counting for safe sharing */
+    uint32_t epoch;                  /* Bumped every request; stale class entries are re-checked */
+    uint32_t generation;             /* Bumped whenever the binding graph changes; affected plans are rebuilt */
+    uint32_t rebuild_generation;     /* Plans built before this are rebuilt whatever they consulted (flush) */
+    uint32_t site_generation;        /* Bumped whenever a call site may resolve differently; stale slots are refilled */
+    sf_call_site *sites;             /* Per-call-site inline caches (request-allocated on first use) */
+    HashTable *tag_cache;            /* tag => finished array of an all-singleton tag (request-allocated) */
+    sf_scope *scope;                 /* Innermost open scope (NULL = none, request-allocated) */
+    zend_object *handle;             /* Container object passed to closure factories (NULL until first use) */
+    HashTable *fiber_contexts;       /* fiber context => resolution stack it suspended with (request-allocated) */
+    sf_resolution_context *spare_contexts;  /* Empty stacks for the next fiber to resolve */
+    uint32_t spare_count;
+    HashTable *missing_classes;      /* Class names zend_lookup_class() failed for (request-allocated) */
+    uint32_t missing_class_count;    /* Class table size when they were recorded */
+    uint32_t missing_autoload_epoch; /* Autoloader changes when they were recorded */
+    uint32_t tag_scan_position;      /* Class table slot the #[Tag] scan resumes at */
+    uint32_t *tag_scan_pending;      /* Runtime definition key slots it passed - declared in place later (request-allocated) */
+    uint32_t tag_scan_pending_count;
     
-    /* Binary cache fields */
-    zend_string *cache_path;         /* Path to binary cache file */
-    zend_bool cache_loaded;          /* Whether cache has been loaded */
-    zend_bool cache_dirty;           /* Whether cache needs to be saved */
+    /* Persistent mode (signalforge_container.persistent=1) */
+    zend_bool persistent;            /* Graph tables live in process memory */
+    zend_bool warm;                  /* Current request started with a carried-over graph */
+    zend_bool request_active;        /* instances/context are allocated */
+    
+    /* Metadata snapshot */
+    zend_string *snapshot_path;      /* Deferred save target (NULL = default path, request-allocated) */
+    zend_bool snapshot_deferred;     /* Save a snapshot at request shutdown */
     
     /* Cold fields (rarely accessed) - third cache line */
-    HashTable contextual_bindings;   /* "concrete:abstract" => sf_contextual_binding* */
+    HashTable contextual_bindings;   /* concrete => HashTable* (abstract => sf_contextual_binding*) */
+    HashTable pruned;                /* abstract or "concrete\0abstract" => request-bound binding/rule pruned at shutdown */
     HashTable aliases;               /* alias => abstract */
-    HashTable tags;                  /* tag => array of abstracts */
+    HashTable tags;                  /* tag => sf_tag* */
+    sf_arena arena;                  /* Bindings, contextual bindings and class metadata */
 } __attribute__((aligned(64)));
 
 /* Container lifecycle */
 sf_container *sf_container_create(void);
+sf_container *sf_container_create_ex(zend_bool persistent);
 void sf_container_destroy(sf_container *container);
 void sf_container_addref(sf_container *container);
 void sf_container_release(sf_container *container);
 
+/* Per-request state (persistent mode keeps everything else between requests) */
+void sf_container_request_startup(sf_container *container);
+void sf_container_request_shutdown(sf_container *container);
+
 /* Binding registration */
 int sf_container_bind(sf_container *container, zend_string *abstract, zval *concrete, uint8_t scope);
 int sf_container_instance(sf_container *container, zend_string *abstract, zval *instance);
+int sf_container_lazy(sf_container *container, zend_string *abstract, zend_string *class_name);
 int sf_container_alias(sf_container *container, zend_string *abstract, zend_string *alias);
 
 /* Resolution */
@@ -60,14 +102,31 @@ int sf_container_make(sf_container *container, zend_string *abstract, HashTable
 int sf_container_has(sf_container *container, zend_string *abstract);
 int sf_container_bound(sf_container *container, zend_string *abstract);
 int sf_container_resolved(sf_container *container, zend_string *abstract);
+zend_string *sf_container_resolve_alias(sf_container *container, zend_string *abstract);
+
+/* Resolution stack - enter() throws CircularDependencyException on a cycle */
+int sf_container_enter(sf_container *container, zend_string *abstract);
+void sf_container_leave(sf_container *container);
+
+/* Reflection metadata, validated against the live class entry */
+sf_class_meta *sf_container_get_meta(sf_container *container, zend_string *class_name, zend_class_entry *ce);
 
 /* Contextual bindings (when X needs Y, give Z) */
 int sf_container_add_contextual_binding(sf_container *container, zend_string *concrete, zend_string *abstract, zval *implementation);
 sf_contextual_binding *sf_container_get_contextual_binding(sf_container *container, zend_string *concrete, zend_string *abstract);
+zend_bool sf_container_pruned(sf_container *container, zend_string *concrete, zend_string *abstract);
 
 /* Tagging (group related services) */
 int sf_container_tag(sf_container *container, HashTable *abstracts, zend_string *tag);
 int sf_container_tagged(sf_container *container, zend_string *tag, zval *result);
+struct _sf_tag *sf_container_find_tag(sf_container *container, zend_string *tag);
+
+/* Batch resolution (Container::makeMany) */
+int sf_container_make_many(sf_container *container, HashTable *abstracts, zval *result);
+
+/* Scopes (Container::beginScope/endScope) */
+void sf_container_begin_scope(sf_container *container);
+int sf_container_end_scope(sf_container *container);
 
 /* State management */
 void sf_container_flush(sf_container *container);
@@ -79,9 +138,10 @@ int sf_container_compile(sf_container *container);
 int sf_container_is_compiled(sf_container *container);
 void sf_container_clear_compiled(sf_container *container);
 
-/* Binary cache (automatic performance optimization) */
-int sf_container_load_cache(sf_container *container);
-int sf_container_save_cache(sf_container *container);
+/* Metadata snapshots (graph, reflection metadata and plans; NULL path = default) */
+int sf_container_load_cache(sf_container *container, const char *path);
+int sf_container_save_cache(sf_container *container, const char *path);
+void sf_container_defer_cache(sf_container *container, const char *path);
 int sf_container_has_cache(sf_container *container);
 int sf_container_clear_cache(sf_container *container);
 zend_string *sf_container_get_cache_path(sf_container *container);
@@ -89,8 +149,15 @@ zend_string *sf_container_get_cache_path(sf_container *container);
 /* Resolution context (internal) */
 sf_resolution_context *sf_resolution_context_create(void);
 void sf_resolution_context_destroy(sf_resolution_context *context);
-int sf_resolution_context_push(sf_resolution_context *context, zend_string *abstract);
+int sf_resolution_context_push(sf_resolution_context *context, zend_string *abstract, uint32_t *mark);
 void sf_resolution_context_pop(sf_resolution_context *context);
-int sf_resolution_context_has(sf_resolution_context *context, zend_string *abstract);
+int sf_resolution_context_has(sf_resolution_context *context, zend_string *abstract, uint32_t *mark);
+
+/* Fiber switch/destroy observers for the global container (registered at MINIT) */
+void sf_container_fiber_startup(void);
+
+/* Class lookup through the negative cache (see container.c) */
+zend_class_entry *sf_container_lookup_class(sf_container *container, zend_string *class_name);
+void sf_container_autoload_startup(void);
 
 #endif /* SF_CONTAINER_H */
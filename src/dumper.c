@@ -0,0 +1,435 @@
+/*
+ * Signalforge Container Extension
+ * src/dumper.c - Compiled PHP containers
+ *
+ * A dump is generated from the same resolution plans compile() builds, so
+ * aliases, contextual class bindings and the singleton/transient split are
+ * already resolved: every CONSTRUCT step becomes a `new` expression with its
+ * arguments inlined, singletons are kept in typed properties, and whatever a
+ * plan defers to make() (closures, instances, scoped services, cycles) calls
+ * Container::make() from the generated code. For class App\CompiledContainer:
+ *
+ *   namespace App;
+ *
+ *   final class CompiledContainer
+ *   {
+ *       public const SERVICES = [
+ *           'App\\Mailer' => ['service0', 'App\\SmtpMailer', true],
+ *       ];
+ *
+ *       private ?\App\SmtpMailer $shared0 = null;
+ *
+ *       public function service0(): \App\SmtpMailer
+ *       {
+ *           return ($this->shared0 ??= new \App\SmtpMailer(new \App\Transport()));
+ *       }
+ *   }
+ *
+ *   return CompiledContainer::class;
+ *
+ * SERVICES maps each dumped binding to its method, concrete class and
+ * whether it is shared. loadCompiled() takes the class name the file returns
+ * and binds the methods as closure factories; unloadCompiled() puts the class
+ * bindings back from the same table.
+ *
+ * Services whose plan depends on a contextual closure can't be expressed
+ * without the requester, so they are left out and keep resolving natively.
+ */
+
+#include "../php_signalforge_container.h"
+#include "dumper.h"
+#include "container.h"
+#include "binding.h"
+#include "compiler.h"
+#include "factory.h"
+
+#include "zend_smart_str.h"
+#include "zend_closures.h"
+
+#include <errno.h>
+
+#define SF_DUMP_CONTAINER "\\Signalforge\\Container\\Container"
+
+/* ============================================================================
+ * Code Generation
+ * ============================================================================ */
+
+typedef struct {
+    sf_container *c;
+    smart_str services;   /* SERVICES entries */
+    smart_str props;      /* Singleton properties */
+    smart_str methods;    /* Service methods */
+    smart_str eager;      /* Constructor body (eager only) */
+    HashTable shared;     /* singleton key => property number */
+    uint32_t count;       /* Services dumped */
+} sf_dumper;
+
+/* A single-quoted PHP string literal */
+static void sf_dump_literal(smart_str *out, zend_string *s)
+{
+    smart_str_appendc(out, '\'');
+    for (size_t i = 0; i < ZSTR_LEN(s); i++) {
+        char ch = ZSTR_VAL(s)[i];
+        if (ch == '\\' || ch == '\'') {
+            smart_str_appendc(out, '\\');
+        }
+        smart_str_appendc(out, ch);
+    }
+    smart_str_appendc(out, '\'');
+}
+
+/* A fully qualified class reference */
+static zend_always_inline void sf_dump_class(smart_str *out, zend_class_entry *ce)
+{
+    smart_str_appendc(out, '\\');
+    smart_str_append(out, ce->name);
+}
+
+/*
+ * Can every step be written as PHP? Anonymous classes have no usable name,
+ * and a MAKE step whose requester has a contextual rule for it would lose
+ * the rule when called as plain Container::make().
+ */
+static zend_bool sf_dump_supported(sf_container *c, sf_factory *factory)
+{
+    for (uint32_t i = 0; i < factory->step_count; i++) {
+        sf_plan_step *step = &factory->steps[i];
+        
+        if (step->op == SF_PLAN_CONSTRUCT) {
+            if (step->ce->ce_flags & ZEND_ACC_ANON_CLASS) {
+                return 0;
+            }
+        } else if (step->requester && zend_hash_num_elements(&c->contextual_bindings) > 0
+            && sf_container_get_contextual_binding(c, step->requester, step->key)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Property number for singleton `key`, declaring the property on first use */
+static uint32_t sf_dump_shared(sf_dumper *d, sf_plan_step *step)
+{
+    zval *known = zend_hash_find(&d->shared, step->key);
+    if (known) {
+        return (uint32_t)Z_LVAL_P(known);
+    }
+    
+    uint32_t num = zend_hash_num_elements(&d->shared);
+    zval zv;
+    ZVAL_LONG(&zv, num);
+    zend_hash_add_new(&d->shared, step->key, &zv);
+    
+    smart_str_appends(&d->props, "    private ?");
+    sf_dump_class(&d->props, step->ce);
+    smart_str_append_printf(&d->props, " $shared%u = null;\n", num);
+    return num;
+}
+
+/* The expression producing slot `index` of the plan (arguments inlined) */
+static void sf_dump_step(sf_dumper *d, sf_factory *factory, uint32_t index, smart_str *out)
+{
+    sf_plan_step *step = &factory->steps[index];
+    
+    if (step->op == SF_PLAN_MAKE) {
+        smart_str_appends(out, SF_DUMP_CONTAINER "::make(");
+        sf_dump_literal(out, step->key);
+        smart_str_appendc(out, ')');
+        return;
+    }
+    
+    if (step->is_singleton) {
+        smart_str_append_printf(out, "($this->shared%u ?\?= ", sf_dump_shared(d, step));
+    }
+    
+    smart_str_appends(out, "new ");
+    sf_dump_class(out, step->ce);
+    smart_str_appendc(out, '(');
+    for (uint32_t i = 0; i < step->arg_count; i++) {
+        if (i > 0) {
+            smart_str_appends(out, ", ");
+        }
+        sf_dump_step(d, factory, factory->arg_slots[step->arg_start + i], out);
+    }
+    smart_str_appendc(out, ')');
+    
+    if (step->is_singleton) {
+        smart_str_appendc(out, ')');
+    }
+}
+
+static void sf_dump_service(sf_dumper *d, zend_string *abstract, sf_factory *factory)
+{
+    uint32_t root = factory->step_count - 1;
+    zend_class_entry *ce = factory->steps[root].ce;
+    
+    smart_str_appends(&d->services, "        ");
+    sf_dump_literal(&d->services, abstract);
+    smart_str_append_printf(&d->services, " => ['service%u', ", d->count);
+    sf_dump_literal(&d->services, ce->name);
+    smart_str_appends(&d->services, factory->is_singleton ? ", true],\n" : ", false],\n");
+    
+    smart_str_append_printf(&d->methods, "\n    public function service%u(): ", d->count);
+    sf_dump_class(&d->methods, ce);
+    smart_str_appends(&d->methods, "\n    {\n        return ");
+    sf_dump_step(d, factory, root, &d->methods);
+    smart_str_appends(&d->methods, ";\n    }\n");
+    
+    if (factory->is_singleton) {
+        smart_str_append_printf(&d->eager, "        $this->service%u();\n", d->count);
+    }
+    d->count++;
+}
+
+static zend_string *sf_dump_source(sf_dumper *d, zend_string *class_name, zend_string *namespace, zend_bool eager)
+{
+    smart_str out = {0};
+    
+    smart_str_appends(&out,
+        "<?php\n"
+        "\n"
+        "/*\n"
+        " * Compiled container generated by " SF_DUMP_CONTAINER "::dump().\n"
+        " * Do not edit - dump the container again instead.\n"
+        " */\n"
+        "\n");
+    if (ZSTR_LEN(namespace) > 0) {
+        smart_str_appends(&out, "namespace ");
+        smart_str_append(&out, namespace);
+        smart_str_appends(&out, ";\n\n");
+    }
+    
+    smart_str_appends(&out, "final class ");
+    smart_str_append(&out, class_name);
+    smart_str_appends(&out, "\n{\n    public const SERVICES = [\n");
+    smart_str_append_smart_str(&out, &d->services);
+    smart_str_appends(&out, "    ];\n");
+    
+    if (d->props.s) {
+        smart_str_appendc(&out, '\n');
+        smart_str_append_smart_str(&out, &d->props);
+    }
+    if (eager && d->eager.s) {
+        smart_str_appends(&out, "\n    public function __construct()\n    {\n");
+        smart_str_append_smart_str(&out, &d->eager);
+        smart_str_appends(&out, "    }\n");
+    }
+    smart_str_append_smart_str(&out, &d->methods);
+    
+    smart_str_appends(&out, "}\n\nreturn ");
+    smart_str_append(&out, class_name);
+    smart_str_appends(&out, "::class;\n");
+    
+    smart_str_0(&out);
+    return out.s;
+}
+
+/* Write through a temporary file, so a worker including it never sees half a class */
+static int sf_dump_write(const char *path, zend_string *source)
+{
+    char tmp_path[MAXPATHLEN];
+    
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int)getpid()) >= (int)sizeof(tmp_path)) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0, "Path too long: %s", path);
+        return FAILURE;
+    }
+    
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "Failed to open %s for writing: %s", tmp_path, strerror(errno));
+        return FAILURE;
+    }
+    
+    zend_bool written = fwrite(ZSTR_VAL(source), ZSTR_LEN(source), 1, fp) == 1;
+    if (fclose(fp) != 0 || !written) {
+        unlink(tmp_path);
+        zend_throw_exception_ex(sf_container_exception_ce, 0, "Failed to write compiled container to: %s", path);
+        return FAILURE;
+    }
+    
+#ifdef _WIN32
+    zend_bool renamed = MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    zend_bool renamed = rename(tmp_path, path) == 0;
+#endif
+    if (!renamed) {
+        unlink(tmp_path);
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "Failed to move compiled container to %s: %s", path, strerror(errno));
+        return FAILURE;
+    }
+    
+    return SUCCESS;
+}
+
+/* A class or namespace name the generated file can declare */
+static zend_bool sf_dump_valid_name(zend_string *name, zend_bool qualified)
+{
+    const unsigned char *p = (const unsigned char *)ZSTR_VAL(name);
+    const unsigned char *end = p + ZSTR_LEN(name);
+    zend_bool segment_start = 1;
+    
+    for (; p < end; p++) {
+        if (*p == '\\' && qualified && !segment_start) {
+            segment_start = 1;
+            continue;
+        }
+        if (!(*p == '_' || *p >= 0x80 || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')
+            || (!segment_start && *p >= '0' && *p <= '9'))) {
+            return 0;
+        }
+        segment_start = 0;
+    }
+    return !segment_start;
+}
+
+int sf_dumper_dump(sf_container *c, const char *path, zend_string *class_name, zend_string *namespace, zend_bool eager)
+{
+    if (!sf_dump_valid_name(class_name, 0)
+        || (ZSTR_LEN(namespace) > 0 && !sf_dump_valid_name(namespace, 1))) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0, "Invalid compiled container name '%s%s%s'",
+            ZSTR_VAL(namespace), ZSTR_LEN(namespace) ? "\\" : "", ZSTR_VAL(class_name));
+        return -1;
+    }
+    
+    sf_dumper d = {0};
+    d.c = c;
+    zend_hash_init(&d.shared, 8, NULL, NULL, 0);
+    
+    zend_string *abstract;
+    zval *val;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->bindings, abstract, val) {
+        sf_binding *binding = (sf_binding *)Z_PTR_P(val);
+        
+        /* Closures, instances, scoped services and lazy proxies stay native */
+        if (Z_TYPE(binding->concrete) != IS_STRING || binding->scope >= SF_SCOPE_INSTANCE || binding->lazy) {
+            continue;
+        }
+        
+        sf_factory *factory = sf_compiler_compile_service(c, abstract);
+        if (factory && factory->steps && sf_dump_supported(c, factory)) {
+            sf_dump_service(&d, abstract, factory);
+        }
+        sf_factory_release(factory);
+        
+        if (UNEXPECTED(EG(exception))) {
+            break;  /* An autoloader threw while the graph was walked */
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    int ret = -1;
+    if (!EG(exception)) {
+        zend_string *source = sf_dump_source(&d, class_name, namespace, eager);
+        if (sf_dump_write(path, source) == SUCCESS) {
+            ret = (int)d.count;
+        }
+        zend_string_release(source);
+    }
+    
+    smart_str_free(&d.services);
+    smart_str_free(&d.props);
+    smart_str_free(&d.methods);
+    smart_str_free(&d.eager);
+    zend_hash_destroy(&d.shared);
+    return ret;
+}
+
+/* ============================================================================
+ * Loading
+ * ============================================================================ */
+
+/* The SERVICES table of a dumped class, or NULL */
+static HashTable *sf_dump_services(zend_class_entry *ce)
+{
+    zend_string *name = zend_string_init("SERVICES", sizeof("SERVICES") - 1, 0);
+    zval *services = zend_get_class_constant_ex(ce->name, name, ce, ZEND_FETCH_CLASS_SILENT);
+    zend_string_release(name);
+    
+    return services && Z_TYPE_P(services) == IS_ARRAY ? Z_ARRVAL_P(services) : NULL;
+}
+
+/* One SERVICES entry: [method, class, shared] */
+static zend_bool sf_dump_entry(zval *entry, zend_string **method, zend_string **concrete, zend_bool *shared)
+{
+    if (Z_TYPE_P(entry) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_P(entry)) != 3) {
+        return 0;
+    }
+    
+    zval *m = zend_hash_index_find(Z_ARRVAL_P(entry), 0);
+    zval *cls = zend_hash_index_find(Z_ARRVAL_P(entry), 1);
+    zval *s = zend_hash_index_find(Z_ARRVAL_P(entry), 2);
+    if (!m || Z_TYPE_P(m) != IS_STRING || !cls || Z_TYPE_P(cls) != IS_STRING || !s) {
+        return 0;
+    }
+    
+    *method = Z_STR_P(m);
+    *concrete = Z_STR_P(cls);
+    *shared = zend_is_true(s);
+    return 1;
+}
+
+int sf_dumper_load(sf_container *c, zval *object)
+{
+    zend_class_entry *ce = Z_OBJCE_P(object);
+    HashTable *services = sf_dump_services(ce);
+    
+    if (!services) {
+        zend_throw_exception_ex(sf_container_exception_ce, 0,
+            "Class '%s' is not a compiled container (no SERVICES table)", ZSTR_VAL(ce->name));
+        return FAILURE;
+    }
+    
+    zend_string *abstract, *method, *concrete;
+    zend_bool shared;
+    zval *entry;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(services, abstract, entry) {
+        zend_function *fn = NULL;
+        if (abstract && sf_dump_entry(entry, &method, &concrete, &shared)) {
+            fn = zend_hash_find_ptr_lc(&ce->function_table, method);
+        }
+        if (!fn) {
+            zend_throw_exception_ex(sf_container_exception_ce, 0,
+                "Compiled container '%s' has a broken SERVICES entry", ZSTR_VAL(ce->name));
+            return FAILURE;
+        }
+        
+        /* The method itself is the factory - no container round trip per call */
+        zval closure;
+        zend_create_fake_closure(&closure, fn, ce, ce, object);
+        sf_container_bind(c, abstract, &closure, shared ? SF_SCOPE_SINGLETON : SF_SCOPE_TRANSIENT);
+        zval_ptr_dtor(&closure);
+    } ZEND_HASH_FOREACH_END();
+    
+    return SUCCESS;
+}
+
+void sf_dumper_unload(sf_container *c, zval *object)
+{
+    HashTable *services = sf_dump_services(Z_OBJCE_P(object));
+    if (!services) return;
+    
+    zend_string *abstract, *method, *concrete;
+    zend_bool shared;
+    zval *entry;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(services, abstract, entry) {
+        if (!abstract || !sf_dump_entry(entry, &method, &concrete, &shared)) {
+            continue;
+        }
+        
+        /* Only bindings still pointing at this object - later rebinds win */
+        sf_binding *binding = zend_hash_find_ptr(&c->bindings, sf_container_resolve_alias(c, abstract));
+        if (!binding || Z_TYPE(binding->concrete) != IS_OBJECT
+            || Z_OBJCE(binding->concrete) != zend_ce_closure) {
+            continue;
+        }
+        zval *this_ptr = zend_get_closure_this_ptr(&binding->concrete);
+        if (!this_ptr || Z_TYPE_P(this_ptr) != IS_OBJECT || Z_OBJ_P(this_ptr) != Z_OBJ_P(object)) {
+            continue;
+        }
+        
+        zval zv;
+        ZVAL_STR(&zv, concrete);
+        sf_container_bind(c, abstract, &zv, shared ? SF_SCOPE_SINGLETON : SF_SCOPE_TRANSIENT);
+    } ZEND_HASH_FOREACH_END();
+}
@@ -0,0 +1,33 @@
+/*
+ * Signalforge Container Extension
+ * src/dumper.h - Compiled PHP containers
+ *
+ * Container::dump() writes the binding graph as a plain PHP class, one method
+ * per service, and Container::loadCompiled() binds those methods back as
+ * factories. The file is ordinary PHP, so opcache keeps it compiled.
+ */
+
+#ifndef SF_DUMPER_H
+#define SF_DUMPER_H
+
+/* Forward declarations */
+struct _sf_container;
+
+/*
+ * Write the compiled container class `class_name` (in `namespace`, may be
+ * empty) to `path`. With `eager`, constructing the class builds every
+ * singleton. Returns the number of services dumped, or -1 with an exception.
+ */
+int sf_dumper_dump(struct _sf_container *container, const char *path, zend_string *class_name, zend_string *namespace, zend_bool eager);
+
+/*
+ * Bind the services of a dumped class to `object`, an instance of it that is
+ * not constructed yet. Returns FAILURE with an exception if the class wasn't
+ * produced by sf_dumper_dump().
+ */
+int sf_dumper_load(struct _sf_container *container, zval *object);
+
+/* Give the services bound by sf_dumper_load() their class bindings back */
+void sf_dumper_unload(struct _sf_container *container, zval *object);
+
+#endif /* SF_DUMPER_H */
@@ -9,23 +9,44 @@
 #include "../php_signalforge_container.h"
 #include "factory.h"
 #include "container.h"
+#include "autowire.h"
+
+/* Plans up to this many steps run without heap allocation */
+#define SF_PLAN_STACK_SLOTS 32
+
+/* Parameter override lists up to this many entries live on the stack */
+#define SF_PLAN_STACK_ARGS 8
+
+/* Per-slot execution state */
+#define SF_SLOT_UNUSED 0  /* Not needed by this call */
+#define SF_SLOT_NEEDED 1  /* Must be produced in the forward pass */
+#define SF_SLOT_FILLED 2  /* Holds a reference that we own */
 
 /* ============================================================================
  * Factory Lifecycle
  * ============================================================================ */
 
-sf_factory *sf_factory_create(zend_string *class_name, zend_class_entry *ce)
+sf_factory *sf_factory_create(zend_string *abstract, zend_string *class_name, zend_class_entry *ce, zend_bool persistent)
 {
-    sf_factory *factory = ecalloc(1, sizeof(sf_factory));
+    sf_factory *factory = pecalloc(1, sizeof(sf_factory), persistent);
     
-    factory->class_name = zend_string_copy(class_name);
+    factory->abstract = sf_string_intern_ex(abstract, persistent);
+    factory->class_name = sf_string_copy_ex(class_name, persistent);
     factory->ce = ce;
-    factory->factory_fn = NULL;
-    factory->dep_names = NULL;
-    factory->dep_hashes = NULL;
+    factory->steps = NULL;
+    factory->arg_slots = NULL;
+    factory->arg_props = NULL;
+    factory->step_count = 0;
+    factory->arg_slot_count = 0;
+    factory->deps = NULL;
     factory->dep_count = 0;
+    factory->param_map = NULL;
+    factory->param_count = 0;
     factory->is_singleton = 0;
-    factory->has_constructor = (ce && ce->constructor) ? 1 : 0;
+    factory->persistent = persistent;
+    factory->acyclic = 0;
+    factory->epoch = 0;
+    factory->generation = 0;
     factory->refcount = 1;
     
     return factory;
@@ -35,25 +56,16 @@ void sf_factory_destroy(sf_factory *factory)
 {
     if (!factory) return;
     
-    if (factory->class_name) {
-        zend_string_release(factory->class_name);
-    }
+    sf_factory_clear_plan(factory);
     
-    /* Release dependency names */
-    if (factory->dep_names) {
-        for (uint32_t i = 0; i < factory->dep_count; i++) {
-            if (factory->dep_names[i]) {
-                zend_string_release(factory->dep_names[i]);
-            }
-        }
-        efree(factory->dep_names);
+    if (factory->abstract) {
+        zend_string_release(factory->abstract);
     }
-    
-    if (factory->dep_hashes) {
-        efree(factory->dep_hashes);
+    if (factory->class_name) {
+        zend_string_release(factory->class_name);
     }
     
-    efree(factory);
+    pefree(factory, factory->persistent);
 }
 
 void sf_factory_addref(sf_factory *factory)
@@ -72,37 +84,129 @@ void sf_factory_release(sf_factory *factory)
  * Factory Configuration
  * ============================================================================ */
 
-void sf_factory_set_dependencies(sf_factory *factory, zend_string **deps, uint32_t count)
+void sf_factory_clear_plan(sf_factory *factory)
 {
     if (!factory) return;
     
-    /* Free existing */
-    if (factory->dep_names) {
+    if (factory->param_map) {
+        zend_hash_destroy(factory->param_map);
+        pefree(factory->param_map, factory->persistent);
+        factory->param_map = NULL;
+        factory->param_count = 0;
+    }
+    
+    if (factory->deps) {
         for (uint32_t i = 0; i < factory->dep_count; i++) {
-            if (factory->dep_names[i]) {
-                zend_string_release(factory->dep_names[i]);
-            }
+            zend_string_release(factory->deps[i]);
+        }
+        pefree(factory->deps, factory->persistent);
+        factory->deps = NULL;
+        factory->dep_count = 0;
+    }
+    
+    if (!factory->steps) return;
+    
+    for (uint32_t i = 0; i < factory->step_count; i++) {
+        sf_plan_step *step = &factory->steps[i];
+        zend_string_release(step->key);
+        if (step->class_name) {
+            zend_string_release(step->class_name);
+        }
+        if (step->requester) {
+            zend_string_release(step->requester);
+        }
+    }
+    pefree(factory->steps, factory->persistent);
+    
+    if (factory->arg_slots) {
+        pefree(factory->arg_slots, factory->persistent);
+        pefree(factory->arg_props, factory->persistent);
+    }
+    
+    factory->steps = NULL;
+    factory->arg_slots = NULL;
+    factory->arg_props = NULL;
+    factory->step_count = 0;
+    factory->arg_slot_count = 0;
+    factory->acyclic = 0;
+}
+
+/*
+ * Copy a plan produced by the compiler into the factory. The compiler's steps
+ * borrow their strings; the factory keeps its own (persistent when needed).
+ */
+void sf_factory_set_plan(sf_factory *factory, const sf_plan_step *steps, uint32_t step_count, const uint32_t *arg_slots, const uint32_t *arg_props, uint32_t arg_slot_count)
+{
+    if (!factory) return;
+    
+    sf_factory_clear_plan(factory);
+    
+    if (step_count == 0) return;
+    
+    factory->steps = pemalloc(sizeof(sf_plan_step) * step_count, factory->persistent);
+    memcpy(factory->steps, steps, sizeof(sf_plan_step) * step_count);
+    
+    /* Every step constructs a class the compiler walked to, so nothing can loop back */
+    factory->acyclic = 1;
+    for (uint32_t i = 0; i < step_count; i++) {
+        sf_plan_step *step = &factory->steps[i];
+        if (step->op == SF_PLAN_MAKE) {
+            factory->acyclic = 0;
+        }
+        step->key = sf_string_copy_ex(step->key, factory->persistent);
+        if (step->class_name) {
+            step->class_name = sf_string_copy_ex(step->class_name, factory->persistent);
+        }
+        if (step->requester) {
+            step->requester = sf_string_copy_ex(step->requester, factory->persistent);
         }
-        efree(factory->dep_names);
-        factory->dep_names = NULL;
     }
-    if (factory->dep_hashes) {
-        efree(factory->dep_hashes);
-        factory->dep_hashes = NULL;
+    factory->step_count = step_count;
+    
+    if (arg_slot_count > 0) {
+        factory->arg_slots = pemalloc(sizeof(uint32_t) * arg_slot_count, factory->persistent);
+        memcpy(factory->arg_slots, arg_slots, sizeof(uint32_t) * arg_slot_count);
+        factory->arg_props = pemalloc(sizeof(uint32_t) * arg_slot_count, factory->persistent);
+        memcpy(factory->arg_props, arg_props, sizeof(uint32_t) * arg_slot_count);
     }
+    factory->arg_slot_count = arg_slot_count;
+}
+
+/* Keep the names the compiler consulted (keys of `names`) to tell which graph changes concern the plan */
+void sf_factory_set_deps(sf_factory *factory, HashTable *names)
+{
+    zend_string *name;
+    uint32_t i = 0;
     
-    factory->dep_count = count;
+    if (!factory || zend_hash_num_elements(names) == 0) return;
     
-    if (count == 0) return;
+    factory->deps = pemalloc(sizeof(zend_string *) * zend_hash_num_elements(names), factory->persistent);
+    ZEND_HASH_FOREACH_STR_KEY(names, name) {
+        factory->deps[i++] = sf_string_copy_ex(name, factory->persistent);
+    } ZEND_HASH_FOREACH_END();
+    factory->dep_count = i;
+}
+
+/*
+ * Precompute the root constructor's parameter names, so make() overrides are
+ * matched with one lookup per provided parameter instead of one per
+ * constructor parameter.
+ */
+void sf_factory_set_params(sf_factory *factory, sf_class_meta *meta)
+{
+    if (!factory || !meta || meta->param_count == 0) return;
     
-    /* Allocate and copy */
-    factory->dep_names = emalloc(sizeof(zend_string *) * count);
-    factory->dep_hashes = emalloc(sizeof(zend_ulong) * count);
+    factory->param_map = pemalloc(sizeof(HashTable), factory->persistent);
+    zend_hash_init(factory->param_map, meta->param_count, NULL, NULL, factory->persistent);
     
-    for (uint32_t i = 0; i < count; i++) {
-        factory->dep_names[i] = zend_string_copy(deps[i]);
-        factory->dep_hashes[i] = ZSTR_H(deps[i]);
+    for (uint32_t i = 0; i < meta->param_count; i++) {
+        zval pos;
+        ZVAL_LONG(&pos, i);
+        zend_string *name = sf_string_copy_ex(meta->param_names[i], factory->persistent);
+        zend_hash_add(factory->param_map, name, &pos);
+        zend_string_release(name);
     }
+    factory->param_count = meta->param_count;
 }
 
 void sf_factory_set_singleton(sf_factory *factory, uint8_t is_singleton)
@@ -110,18 +214,301 @@ void sf_factory_set_singleton(sf_factory *factory, uint8_t is_singleton)
     if (factory) factory->is_singleton = is_singleton;
 }
 
+/*
+ * Copy of a factory's plan for another container (Container::warmup() seeds).
+ * Class entries are not carried over: the copy looks them up again on first
+ * use, as a plan loaded from a snapshot does.
+ */
+sf_factory *sf_factory_clone(const sf_factory *factory, zend_bool persistent)
+{
+    sf_factory *copy = sf_factory_create(factory->abstract, factory->class_name, NULL, persistent);
+    
+    sf_factory_set_plan(copy, factory->steps, factory->step_count, factory->arg_slots, factory->arg_props, factory->arg_slot_count);
+    for (uint32_t i = 0; i < copy->step_count; i++) {
+        copy->steps[i].ce = NULL;
+    }
+    
+    if (factory->deps) {
+        copy->deps = pemalloc(sizeof(zend_string *) * factory->dep_count, persistent);
+        for (uint32_t i = 0; i < factory->dep_count; i++) {
+            copy->deps[i] = sf_string_copy_ex(factory->deps[i], persistent);
+        }
+        copy->dep_count = factory->dep_count;
+    }
+    
+    if (factory->param_map) {
+        zend_string *name;
+        zval *pos;
+        
+        copy->param_map = pemalloc(sizeof(HashTable), persistent);
+        zend_hash_init(copy->param_map, factory->param_count, NULL, NULL, persistent);
+        ZEND_HASH_FOREACH_STR_KEY_VAL(factory->param_map, name, pos) {
+            zend_string *key = sf_string_copy_ex(name, persistent);
+            zend_hash_add(copy->param_map, key, pos);
+            zend_string_release(key);
+        } ZEND_HASH_FOREACH_END();
+        copy->param_count = factory->param_count;
+    }
+    
+    copy->is_singleton = factory->is_singleton;
+    return copy;
+}
+
 /* ============================================================================
  * Factory Execution
  *
- * This is the fast path - when a factory exists, we call it directly
+ * This is the fast path - when a factory exists, we run its plan directly
  * instead of going through the full autowiring logic.
+ *
+ * Execution is two linear passes over the steps:
+ * 1. Backward: starting from the root, mark the slots that are actually
+ *    needed. A singleton that is already in the store fills its slot right
+ *    away and its own dependencies are never marked, so warm graphs cost a
+ *    handful of probes.
+ * 2. Forward: produce every needed slot in order. Arguments are always in
+ *    earlier slots, so they are ready by the time a constructor runs.
  * ============================================================================ */
 
+/*
+ * Map make() parameters onto root constructor positions. Returns NULL when
+ * none of them name a constructor parameter (the plan then runs unchanged).
+ */
+static zval **sf_plan_map_overrides(sf_factory *factory, HashTable *params, zval **overrides_stack)
+{
+    zval **overrides = overrides_stack;
+    zend_string *name;
+    zval *value;
+    uint32_t matched = 0;
+    
+    if (UNEXPECTED(factory->param_count > SF_PLAN_STACK_ARGS)) {
+        overrides = emalloc(sizeof(zval *) * factory->param_count);
+    }
+    memset(overrides, 0, sizeof(zval *) * factory->param_count);
+    
+    ZEND_HASH_FOREACH_STR_KEY_VAL(params, name, value) {
+        if (!name) {
+            continue;
+        }
+        zval *pos = zend_hash_find(factory->param_map, name);
+        if (pos) {
+            overrides[Z_LVAL_P(pos)] = value;
+            matched++;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    if (matched == 0) {
+        if (overrides != overrides_stack) {
+            efree(overrides);
+        }
+        return NULL;
+    }
+    return overrides;
+}
+
+/*
+ * Elision was decided for the classes the plan constructs; make sure each
+ * argument really is one (a cached singleton could be anything in theory),
+ * so skipping the constructor's parameter type checks stays invisible.
+ */
+static zend_always_inline zend_bool sf_plan_args_fit(sf_factory *factory, sf_plan_step *step, zval *slots)
+{
+    const uint32_t *arg_slots = &factory->arg_slots[step->arg_start];
+    
+    for (uint32_t i = 0; i < step->arg_count; i++) {
+        zval *arg = &slots[arg_slots[i]];
+        if (UNEXPECTED(Z_TYPE_P(arg) != IS_OBJECT) || UNEXPECTED(Z_OBJCE_P(arg) != factory->steps[arg_slots[i]].ce)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Instantiate one CONSTRUCT step into `result`.
+ *
+ * With `overrides` (root step only), a provided parameter replaces the planned
+ * argument at its position, and may extend the list past the planned
+ * arguments exactly as far as autowiring would: up to the first position
+ * that has neither.
+ */
+static ZEND_HOT int sf_plan_construct(sf_factory *factory, sf_plan_step *step, zval *slots, zval **overrides, zval *result)
+{
+    if (UNEXPECTED(object_init_ex(result, step->ce) != SUCCESS)) {
+        return FAILURE;
+    }
+    
+    /* Constructor only assigns promoted properties - do it ourselves (common for services) */
+    if (EXPECTED(step->elide_constructor) && EXPECTED(!overrides)
+        && EXPECTED(sf_plan_args_fit(factory, step, slots))) {
+        zend_object *obj = Z_OBJ_P(result);
+        const uint32_t *arg_slots = &factory->arg_slots[step->arg_start];
+        const uint32_t *arg_props = &factory->arg_props[step->arg_start];
+        
+        /* Promoted properties have no default, so the slots are still UNDEF (or NULL) */
+        for (uint32_t i = 0; i < step->arg_count; i++) {
+            if (arg_props[i] != SF_PROP_NONE) {
+                ZVAL_COPY(OBJ_PROP_NUM(obj, arg_props[i]), &slots[arg_slots[i]]);
+            }
+        }
+        SF_STAT(ctor_elided);
+        return SUCCESS;
+    }
+    
+    if (EXPECTED(step->has_constructor)) {
+        uint32_t max_args = UNEXPECTED(overrides) ? factory->param_count : step->arg_count;
+        zend_execute_data *call = sf_ctor_frame_push(Z_OBJ_P(result), max_args);
+        zval *args = SF_CTOR_FRAME_ARGS(call);
+        uint32_t arg_count = 0;
+        
+        /* Slots and params keep their references - the frame takes its own */
+        const uint32_t *arg_slots = &factory->arg_slots[step->arg_start];
+        for (uint32_t i = 0; i < max_args; i++) {
+            if (UNEXPECTED(overrides) && overrides[i]) {
+                ZVAL_COPY(&args[arg_count++], overrides[i]);
+                continue;
+            }
+            if (i >= step->arg_count) {
+                break;
+            }
+            ZVAL_COPY(&args[arg_count++], &slots[arg_slots[i]]);
+        }
+        
+        if (UNEXPECTED(sf_ctor_frame_call(call, arg_count) == FAILURE)) {
+            zval_ptr_dtor(result);
+            return FAILURE;
+        }
+    }
+    
+    return SUCCESS;
+}
+
 int sf_factory_call(sf_factory *factory, sf_container *c, HashTable *params, zval *result)
 {
-    if (!factory || !factory->factory_fn) {
+    if (!factory || !factory->steps) {
         return FAILURE;
     }
     
-    return factory->factory_fn(c, params, result, factory);
+    /* The root is "being resolved" for the whole plan, so a closure or
+     * fallback step that loops back to it is reported as a cycle. Plans
+     * without MAKE steps can't reach one and skip the bookkeeping. */
+    zend_bool tracked = !factory->acyclic;
+    if (UNEXPECTED(tracked) && UNEXPECTED(sf_container_enter(c, factory->abstract) == FAILURE)) {
+        return FAILURE;
+    }
+    
+    uint32_t n = factory->step_count;
+    zval slots_stack[SF_PLAN_STACK_SLOTS];
+    uint8_t state_stack[SF_PLAN_STACK_SLOTS];
+    zval *slots = slots_stack;
+    uint8_t *state = state_stack;
+    int ret = SUCCESS;
+    
+    if (UNEXPECTED(n > SF_PLAN_STACK_SLOTS)) {
+        slots = emalloc(sizeof(zval) * n);
+        state = emalloc(n);
+    }
+    memset(state, SF_SLOT_UNUSED, n);
+    
+    /* Overrides apply to the root constructor only, like autowiring (uncommon) */
+    zval *overrides_stack[SF_PLAN_STACK_ARGS];
+    zval **overrides = NULL;
+    if (UNEXPECTED(params) && factory->param_map && zend_hash_num_elements(params) > 0) {
+        overrides = sf_plan_map_overrides(factory, params, overrides_stack);
+    }
+    
+    /* Pass 1: mark what this call needs, short-circuiting cached singletons */
+    state[n - 1] = SF_SLOT_NEEDED;
+    for (uint32_t i = n; i-- > 0; ) {
+        if (state[i] != SF_SLOT_NEEDED) {
+            continue;
+        }
+        
+        sf_plan_step *step = &factory->steps[i];
+        if (step->op != SF_PLAN_CONSTRUCT) {
+            continue;
+        }
+        
+        if (step->is_singleton) {
+            zval *cached = sf_fast_lookup_find(c->instances, step->key);
+            if (cached) {
+                ZVAL_COPY(&slots[i], cached);
+                state[i] = SF_SLOT_FILLED;
+                continue;
+            }
+        }
+        
+        /* An overridden argument is never resolved, so its subtree isn't either */
+        zval **skip = i == n - 1 ? overrides : NULL;
+        const uint32_t *arg_slots = &factory->arg_slots[step->arg_start];
+        for (uint32_t a = 0; a < step->arg_count; a++) {
+            if (UNEXPECTED(skip) && skip[a]) {
+                continue;
+            }
+            if (state[arg_slots[a]] == SF_SLOT_UNUSED) {
+                state[arg_slots[a]] = SF_SLOT_NEEDED;
+            }
+        }
+    }
+    
+    /* Pass 2: produce needed slots in dependency order */
+    for (uint32_t i = 0; i < n; i++) {
+        if (state[i] != SF_SLOT_NEEDED) {
+            continue;
+        }
+        
+        sf_plan_step *step = &factory->steps[i];
+        
+        if (UNEXPECTED(step->op == SF_PLAN_MAKE)) {
+            if (sf_container_make(c, step->key, NULL, &slots[i], step->requester) != SUCCESS) {
+                ret = FAILURE;
+                break;
+            }
+            state[i] = SF_SLOT_FILLED;
+            continue;
+        }
+        
+        /* A fallback step may have created this singleton in the meantime (uncommon) */
+        if (step->is_singleton) {
+            zval *cached = sf_fast_lookup_find(c->instances, step->key);
+            if (UNEXPECTED(cached)) {
+                ZVAL_COPY(&slots[i], cached);
+                state[i] = SF_SLOT_FILLED;
+                continue;
+            }
+        }
+        
+        if (sf_plan_construct(factory, step, slots, i == n - 1 ? overrides : NULL, &slots[i]) != SUCCESS) {
+            ret = FAILURE;
+            break;
+        }
+        state[i] = SF_SLOT_FILLED;
+        
+        if (step->is_singleton) {
+            sf_fast_lookup_insert(c->instances, step->key, &slots[i]);
+        }
+    }
+    
+    /* Hand the root to the caller, drop everything else */
+    if (EXPECTED(ret == SUCCESS)) {
+        ZVAL_COPY_VALUE(result, &slots[n - 1]);
+        state[n - 1] = SF_SLOT_UNUSED;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (state[i] == SF_SLOT_FILLED) {
+            zval_ptr_dtor(&slots[i]);
+        }
+    }
+    
+    if (UNEXPECTED(slots != slots_stack)) {
+        efree(slots);
+        efree(state);
+    }
+    if (UNEXPECTED(overrides) && overrides != overrides_stack) {
+        efree(overrides);
+    }
+    
+    if (UNEXPECTED(tracked)) {
+        sf_container_leave(c);
+    }
+    return ret;
 }
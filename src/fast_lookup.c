@@ -7,33 +7,312 @@
 #include "fast_lookup.h"
 #include "simd.h"
 
+/* Keep load (live + tombstones) below 7/8 so EMPTY slots stay common */
+#define SF_MAX_LOAD(capacity) ((capacity) - ((capacity) >> 3))
+
 /* ============================================================================
- * Lifecycle
+ * Group Kernels
+ *
+ * One set per sf_simd_level, each hard-wired to its group width. EMPTY and
+ * DELETED are the only control bytes with the high bit set, so free slots are
+ * just the sign bits of a group.
  * ============================================================================ */
 
-sf_fast_lookup *sf_fast_lookup_create(uint32_t num_groups)
+/* Stats for a lookup that left its home group (only reached off the fast path) */
+static zend_always_inline void sf_fast_lookup_count_probe(uint32_t probe)
+{
+    sf_stats *stats = &SF_CONTAINER_G(stats);
+    
+    stats->lookup_probes++;
+    if (probe > stats->lookup_max_probe) {
+        stats->lookup_max_probe = probe;
+    }
+}
+
+/*
+ * Keys are interned, so a hit is usually the same pointer. Otherwise the
+ * cached full hash rules out fingerprint collisions before any bytes are
+ * compared.
+ */
+static zend_always_inline zend_bool sf_fast_lookup_key_equals(zend_string *stored, zend_string *key, zend_ulong h)
 {
-    if (num_groups == 0 || num_groups > SF_MAX_GROUPS) {
-        num_groups = 4;  /* Default: 64 slots */
+    return stored == key || (ZSTR_H(stored) == h && zend_string_equal_content(stored, key));
+}
+
+/*
+ * Groups are probed triangularly (offsets 1, 2, 3, ...), which visits every
+ * group exactly once for power-of-two sizes. A key can only live after a group
+ * that was full when it was inserted, so a group with an EMPTY slot ends the
+ * search. Expands to, for `isa`:
+ *
+ *   find:      slot value for key (hash h), or NULL
+ *   free_slot: first EMPTY or DELETED slot along h's probe sequence
+ *   has_empty: whether group `group_idx` still has an EMPTY slot
+ */
+#define SF_LOOKUP_KERNELS(isa, width, target) \
+    static target zval *sf_lookup_find_##isa(const sf_fast_lookup *lookup, zend_string *key, zend_ulong h) \
+    { \
+        uint8_t fingerprint = SF_HASH_FINGERPRINT(h); \
+        uint32_t group_idx = (uint32_t)(h >> 7) & lookup->group_mask; \
+        \
+        for (uint32_t probe = 0; probe < lookup->num_groups; ) { \
+            const uint8_t *ctrl = lookup->ctrl + (size_t)group_idx * (width); \
+            uint64_t mask = sf_ctrl_match_##isa(ctrl, fingerprint); \
+            \
+            /* Check each matching slot */ \
+            while (mask != 0) { \
+                uint32_t slot = group_idx * (width) + (uint32_t)sf_simd_ctz64(mask); \
+                mask &= mask - 1;  /* Clear lowest bit */ \
+                \
+                if (EXPECTED(sf_fast_lookup_key_equals(lookup->keys[slot], key, h))) { \
+                    return &lookup->values[slot]; \
+                } \
+            } \
+            \
+            /* EXPECTED: the home group still has room, so the key is absent */ \
+            if (EXPECTED(sf_ctrl_match_##isa(ctrl, SF_CTRL_EMPTY) != 0)) { \
+                return NULL; \
+            } \
+            \
+            group_idx = (group_idx + ++probe) & lookup->group_mask; \
+            sf_fast_lookup_count_probe(probe); \
+        } \
+        \
+        return NULL; \
+    } \
+    \
+    static target uint32_t sf_lookup_free_slot_##isa(const sf_fast_lookup *lookup, zend_ulong h) \
+    { \
+        uint32_t group_idx = (uint32_t)(h >> 7) & lookup->group_mask; \
+        uint32_t probe = 0; \
+        uint64_t free_mask; \
+        \
+        /* Load factor guarantees a free slot somewhere along the probe sequence */ \
+        while ((free_mask = sf_ctrl_free_##isa(lookup->ctrl + (size_t)group_idx * (width))) == 0) { \
+            group_idx = (group_idx + ++probe) & lookup->group_mask; \
+        } \
+        \
+        return group_idx * (width) + (uint32_t)sf_simd_ctz64(free_mask); \
+    } \
+    \
+    static target zend_bool sf_lookup_has_empty_##isa(const sf_fast_lookup *lookup, uint32_t group_idx) \
+    { \
+        return sf_ctrl_match_##isa(lookup->ctrl + (size_t)group_idx * (width), SF_CTRL_EMPTY) != 0; \
     }
     
-    sf_fast_lookup *lookup = emalloc(sizeof(sf_fast_lookup));
+/* Scalar: 16 slots, one byte at a time */
+static zend_always_inline uint64_t sf_ctrl_match_scalar(const uint8_t *ctrl, uint8_t byte)
+{
+    uint64_t mask = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        if (ctrl[i] == byte) {
+            mask |= (1ULL << i);
+        }
+    }
+    return mask;
+}
+
+static zend_always_inline uint64_t sf_ctrl_free_scalar(const uint8_t *ctrl)
+{
+    return sf_ctrl_match_scalar(ctrl, SF_CTRL_EMPTY) | sf_ctrl_match_scalar(ctrl, SF_CTRL_DELETED);
+}
+
+SF_LOOKUP_KERNELS(scalar, 16, )
+
+#if SF_HAS_SIMD
+/* SSE2 / NEON: 16 slots per compare (groups are 16-byte aligned) */
+static zend_always_inline uint64_t sf_ctrl_match_native(const uint8_t *ctrl, uint8_t byte)
+{
+    sf_simd_i8x16 ctrl_vec = sf_simd_load_i8x16(ctrl);
+    return sf_simd_movemask_i8(sf_simd_cmpeq_i8(ctrl_vec, sf_simd_set1_i8(byte)));
+}
+
+static zend_always_inline uint64_t sf_ctrl_free_native(const uint8_t *ctrl)
+{
+    return sf_simd_movemask_i8(sf_simd_load_i8x16(ctrl));
+}
+
+SF_LOOKUP_KERNELS(native, 16, )
+#endif
+
+#if SF_SIMD_DISPATCH
+/* AVX2: 32 slots per compare */
+static SF_TARGET_AVX2 zend_always_inline uint64_t sf_ctrl_match_avx2(const uint8_t *ctrl, uint8_t byte)
+{
+    __m256i ctrl_vec = _mm256_load_si256((const __m256i *)ctrl);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl_vec, _mm256_set1_epi8((char)byte)));
+}
+
+static SF_TARGET_AVX2 zend_always_inline uint64_t sf_ctrl_free_avx2(const uint8_t *ctrl)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_load_si256((const __m256i *)ctrl));
+}
+
+SF_LOOKUP_KERNELS(avx2, 32, SF_TARGET_AVX2)
+
+/* AVX-512BW: 64 slots per compare */
+static SF_TARGET_AVX512 zend_always_inline uint64_t sf_ctrl_match_avx512(const uint8_t *ctrl, uint8_t byte)
+{
+    __m512i ctrl_vec = _mm512_load_si512((const void *)ctrl);
+    return (uint64_t)_mm512_cmpeq_epi8_mask(ctrl_vec, _mm512_set1_epi8((char)byte));
+}
+
+static SF_TARGET_AVX512 zend_always_inline uint64_t sf_ctrl_free_avx512(const uint8_t *ctrl)
+{
+    return (uint64_t)_mm512_movepi8_mask(_mm512_load_si512((const void *)ctrl));
+}
+
+SF_LOOKUP_KERNELS(avx512, 64, SF_TARGET_AVX512)
+#endif
+
+typedef struct {
+    zval *(*find)(const sf_fast_lookup *lookup, zend_string *key, zend_ulong h);
+    uint32_t (*free_slot)(const sf_fast_lookup *lookup, zend_ulong h);
+    zend_bool (*has_empty)(const sf_fast_lookup *lookup, uint32_t group_idx);
+} sf_lookup_kernels;
+
+#define SF_LOOKUP_KERNEL_SET(isa) \
+    { sf_lookup_find_##isa, sf_lookup_free_slot_##isa, sf_lookup_has_empty_##isa }
+    
+/* Matches the scalar default of sf_simd_active until MINIT */
+static sf_lookup_kernels sf_lookup = SF_LOOKUP_KERNEL_SET(scalar);
+
+void sf_fast_lookup_startup(void)
+{
+    static const sf_lookup_kernels scalar = SF_LOOKUP_KERNEL_SET(scalar);
+#if SF_HAS_SIMD
+    static const sf_lookup_kernels native = SF_LOOKUP_KERNEL_SET(native);
+#endif
+#if SF_SIMD_DISPATCH
+    static const sf_lookup_kernels avx2 = SF_LOOKUP_KERNEL_SET(avx2);
+    static const sf_lookup_kernels avx512 = SF_LOOKUP_KERNEL_SET(avx512);
+#endif
+    
+    switch (sf_simd_active.level) {
+#if SF_SIMD_DISPATCH
+        case SF_SIMD_AVX512:
+            sf_lookup = avx512;
+            break;
+        case SF_SIMD_AVX2:
+            sf_lookup = avx2;
+            break;
+#endif
+#if SF_HAS_SIMD
+        case SF_SIMD_NATIVE:
+            sf_lookup = native;
+            break;
+#endif
+        default:
+            sf_lookup = scalar;
+            break;
+    }
+}
+
+/* ============================================================================
+ * Storage
+ * ============================================================================ */
+
+/*
+ * Allocate `num_groups` empty groups. emalloc only guarantees 8-byte alignment,
+ * but the control bytes are read with aligned loads up to 64 bytes wide, so we
+ * over-allocate and align the control array by hand. Keys and values follow
+ * in the same block.
+ */
+static void sf_fast_lookup_alloc_groups(sf_fast_lookup *lookup, uint32_t num_groups)
+{
+    uint32_t capacity = num_groups * sf_simd_active.group_size;
+    size_t ctrl_size = ZEND_MM_ALIGNED_SIZE_EX(capacity, 64);
+    
+    lookup->allocation = emalloc(ctrl_size + (sizeof(zend_string *) + sizeof(zval)) * capacity + 63);
+    lookup->ctrl = (uint8_t *)(((uintptr_t)lookup->allocation + 63) & ~(uintptr_t)63);
+    lookup->keys = (zend_string **)(lookup->ctrl + ctrl_size);
+    lookup->values = (zval *)(lookup->keys + capacity);
     lookup->num_groups = num_groups;
-    lookup->capacity = num_groups * SF_GROUP_SIZE;
+    lookup->group_mask = num_groups - 1;
+    lookup->capacity = capacity;
     lookup->count = 0;
-    
-    /* Allocate groups - use emalloc for consistent allocation/deallocation.
-     * SIMD operations can handle unaligned loads on modern CPUs. */
-    lookup->groups = emalloc(sizeof(sf_lookup_group) * num_groups);
+    lookup->deleted = 0;
     
     /* Initialize all control bytes to EMPTY */
-    for (uint32_t g = 0; g < num_groups; g++) {
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            lookup->groups[g].ctrl[i] = SF_CTRL_EMPTY;
-            lookup->groups[g].keys[i] = NULL;
-            ZVAL_UNDEF(&lookup->groups[g].values[i]);
+    memset(lookup->ctrl, SF_CTRL_EMPTY, capacity);
+    for (uint32_t i = 0; i < capacity; i++) {
+        lookup->keys[i] = NULL;
+        ZVAL_UNDEF(&lookup->values[i]);
+    }
+}
+
+/*
+ * Move every entry into `old`, leaving `lookup` an empty table of
+ * `num_groups` groups. Destructors run by releasing them may call back into
+ * the container, so they must find a consistent table that no longer has
+ * the entries - as zend_hash unlinks a bucket before destroying it.
+ */
+static void sf_fast_lookup_detach(sf_fast_lookup *lookup, sf_fast_lookup *old, uint32_t num_groups)
+{
+    *old = *lookup;
+    sf_fast_lookup_alloc_groups(lookup, num_groups);
+}
+
+/*
+ * Release every live entry of a detached table, and the table. Valid
+ * fingerprints are 0x00-0x7F (< SF_CTRL_EMPTY); SF_CTRL_EMPTY (0x80) and
+ * SF_CTRL_DELETED (0xFE) are special markers.
+ */
+static void sf_fast_lookup_release_detached(sf_fast_lookup *old)
+{
+    for (uint32_t i = 0; i < old->capacity; i++) {
+        if (old->ctrl[i] < SF_CTRL_EMPTY) {
+            zend_string_release(old->keys[i]);
+            zval_ptr_dtor(&old->values[i]);
         }
     }
+    efree(old->allocation);
+}
+
+/*
+ * Rebuild the table with `num_groups` groups, moving entries without touching
+ * their refcounts. Also drops all tombstones.
+ */
+static void sf_fast_lookup_rehash(sf_fast_lookup *lookup, uint32_t num_groups)
+{
+    sf_fast_lookup old = *lookup;
+    
+    sf_fast_lookup_alloc_groups(lookup, num_groups);
+    
+    for (uint32_t i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] >= SF_CTRL_EMPTY) {
+            continue;
+        }
+        
+        /* Fresh table has no tombstones and no duplicates - first free slot is EMPTY */
+        uint32_t slot = sf_lookup.free_slot(lookup, ZSTR_H(old.keys[i]));
+        lookup->ctrl[slot] = old.ctrl[i];
+        lookup->keys[slot] = old.keys[i];
+        ZVAL_COPY_VALUE(&lookup->values[slot], &old.values[i]);
+    }
+    
+    lookup->count = old.count;
+    efree(old.allocation);
+}
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+sf_fast_lookup *sf_fast_lookup_create(uint32_t slots)
+{
+    if (slots == 0) {
+        slots = SF_DEFAULT_SLOTS;
+    }
+    
+    /* Round up to a power of two so probing can mask instead of divide */
+    uint32_t size = 1;
+    while (size * sf_simd_active.group_size < slots) {
+        size <<= 1;
+    }
+    
+    sf_fast_lookup *lookup = emalloc(sizeof(sf_fast_lookup));
+    sf_fast_lookup_alloc_groups(lookup, size);
     
     return lookup;
 }
@@ -42,24 +321,14 @@ void sf_fast_lookup_destroy(sf_fast_lookup *lookup)
 {
     if (!lookup) return;
     
-    /* Release all stored keys and values 
-     * Valid fingerprints are 0x00-0x7F (< SF_CTRL_EMPTY)
-     * SF_CTRL_EMPTY (0x80) and SF_CTRL_DELETED (0xFE) are special markers */
-    for (uint32_t g = 0; g < lookup->num_groups; g++) {
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            if (lookup->groups[g].ctrl[i] < SF_CTRL_EMPTY) {
-                if (lookup->groups[g].keys[i]) {
-                    zend_string_release(lookup->groups[g].keys[i]);
-                }
-                if (!Z_ISUNDEF(lookup->groups[g].values[i])) {
-                    zval_ptr_dtor(&lookup->groups[g].values[i]);
-                }
-            }
-        }
-    }
-    
-    efree(lookup->groups);
+    /* Until destructors stop storing new instances */
+    do {
+        sf_fast_lookup old;
+        sf_fast_lookup_detach(lookup, &old, 1);
+        sf_fast_lookup_release_detached(&old);
+    } while (lookup->count);
     
+    efree(lookup->allocation);
     efree(lookup);
 }
 
@@ -67,26 +336,10 @@ void sf_fast_lookup_clear(sf_fast_lookup *lookup)
 {
     if (!lookup) return;
     
-    /* Release all entries and reset control bytes
-     * Valid fingerprints are 0x00-0x7F (< SF_CTRL_EMPTY)
-     * Only process slots that actually have data */
-    for (uint32_t g = 0; g < lookup->num_groups; g++) {
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            if (lookup->groups[g].ctrl[i] < SF_CTRL_EMPTY) {
-                if (lookup->groups[g].keys[i]) {
-                    zend_string_release(lookup->groups[g].keys[i]);
-                    lookup->groups[g].keys[i] = NULL;
-                }
-                if (!Z_ISUNDEF(lookup->groups[g].values[i])) {
-                    zval_ptr_dtor(&lookup->groups[g].values[i]);
-                    ZVAL_UNDEF(&lookup->groups[g].values[i]);
-                }
-            }
-            lookup->groups[g].ctrl[i] = SF_CTRL_EMPTY;
-        }
-    }
-    
-    lookup->count = 0;
+    /* Same size - it is usually filled again */
+    sf_fast_lookup old;
+    sf_fast_lookup_detach(lookup, &old, lookup->num_groups);
+    sf_fast_lookup_release_detached(&old);
 }
 
 /* ============================================================================
@@ -97,147 +350,75 @@ zval *sf_fast_lookup_find(sf_fast_lookup *lookup, zend_string *key)
 {
     if (!lookup || !key) return NULL;
     
-    zend_ulong h = ZSTR_H(key);
-    uint8_t fingerprint = SF_HASH_FINGERPRINT(h);
-    uint32_t group_idx = (h >> 7) % lookup->num_groups;
-    
-#if SF_HAS_SIMD
-    /* SIMD path: compare all 16 control bytes at once */
-    sf_lookup_group *group = &lookup->groups[group_idx];
-    sf_simd_i8x16 ctrl_vec = sf_simd_load_i8x16(group->ctrl);
-    sf_simd_i8x16 target = sf_simd_set1_i8(fingerprint);
-    sf_simd_i8x16 cmp = sf_simd_cmpeq_i8(ctrl_vec, target);
-    
-    uint32_t mask = sf_simd_movemask_i8(cmp);
-    
-    /* Check each matching slot */
-    while (mask != 0) {
-        int slot = sf_simd_ctz(mask);
-        mask &= mask - 1;  /* Clear lowest bit */
-        
-        if (group->keys[slot] && zend_string_equals(group->keys[slot], key)) {
-            return &group->values[slot];
-        }
-    }
-#else
-    /* Scalar fallback */
-    sf_lookup_group *group = &lookup->groups[group_idx];
-    for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-        if (group->ctrl[i] == fingerprint) {
-            if (group->keys[i] && zend_string_equals(group->keys[i], key)) {
-                return &group->values[i];
-            }
-        }
-    }
-#endif
-    
-    /* Try next group (linear probing) */
-    uint32_t probes = 1;
-    while (probes < lookup->num_groups) {
-        group_idx = (group_idx + 1) % lookup->num_groups;
-        
-#if SF_HAS_SIMD
-        group = &lookup->groups[group_idx];
-        ctrl_vec = sf_simd_load_i8x16(group->ctrl);
-        cmp = sf_simd_cmpeq_i8(ctrl_vec, target);
-        mask = sf_simd_movemask_i8(cmp);
-        
-        while (mask != 0) {
-            int slot = sf_simd_ctz(mask);
-            mask &= mask - 1;
-            
-            if (group->keys[slot] && zend_string_equals(group->keys[slot], key)) {
-                return &group->values[slot];
-            }
-        }
-#else
-        group = &lookup->groups[group_idx];
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            if (group->ctrl[i] == fingerprint) {
-                if (group->keys[i] && zend_string_equals(group->keys[i], key)) {
-                    return &group->values[i];
-                }
-            }
-        }
-#endif
-        
-        probes++;
-    }
-    
-    return NULL;
+    SF_STAT(lookup_finds);
+    return sf_lookup.find(lookup, key, zend_string_hash_val(key));
 }
 
 int sf_fast_lookup_insert(sf_fast_lookup *lookup, zend_string *key, zval *value)
 {
     if (!lookup || !key || !value) return FAILURE;
     
-    /* Don't overfill - maintain load factor < 0.875 (14/16) */
-    if (lookup->count >= (lookup->capacity * 7 / 8)) {
-        return FAILURE;  /* Table too full */
+    /* Update existing entry */
+    zval *existing = sf_fast_lookup_find(lookup, key);
+    if (existing) {
+        zval old;
+        ZVAL_COPY_VALUE(&old, existing);
+        ZVAL_COPY(existing, value);
+        zval_ptr_dtor(&old);
+        return SUCCESS;
     }
     
-    zend_ulong h = ZSTR_H(key);
-    uint8_t fingerprint = SF_HASH_FINGERPRINT(h);
-    uint32_t group_idx = (h >> 7) % lookup->num_groups;
-    
-    /* Find first empty or matching slot */
-    uint32_t probes = 0;
-    while (probes < lookup->num_groups) {
-        sf_lookup_group *group = &lookup->groups[group_idx];
-        
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            /* Empty or deleted slot - use it */
-            if (group->ctrl[i] >= SF_CTRL_DELETED) {
-                group->ctrl[i] = fingerprint;
-                group->keys[i] = zend_string_copy(key);
-                ZVAL_COPY(&group->values[i], value);
-                lookup->count++;
-                return SUCCESS;
-            }
-            
-            /* Update existing entry */
-            if (group->ctrl[i] == fingerprint && group->keys[i] && 
-                zend_string_equals(group->keys[i], key)) {
-                zval_ptr_dtor(&group->values[i]);
-                ZVAL_COPY(&group->values[i], value);
-                return SUCCESS;
-            }
+    /* Make room: drop tombstones if they dominate, otherwise double */
+    if (UNEXPECTED(lookup->count + lookup->deleted >= SF_MAX_LOAD(lookup->capacity))) {
+        SF_STAT(lookup_grows);
+        if (lookup->deleted > lookup->count) {
+            sf_fast_lookup_rehash(lookup, lookup->num_groups);
+        } else {
+            sf_fast_lookup_rehash(lookup, lookup->num_groups << 1);
         }
-        
-        group_idx = (group_idx + 1) % lookup->num_groups;
-        probes++;
     }
     
-    return FAILURE;  /* No space found */
+    zend_ulong h = ZSTR_H(key);  /* Computed by the find above */
+    uint32_t slot = sf_lookup.free_slot(lookup, h);
+    
+    if (lookup->ctrl[slot] == SF_CTRL_DELETED) {
+        lookup->deleted--;
+    }
+    lookup->ctrl[slot] = SF_HASH_FINGERPRINT(h);
+    lookup->keys[slot] = sf_string_intern_ex(key, 0);
+    ZVAL_COPY(&lookup->values[slot], value);
+    lookup->count++;
+    
+    return SUCCESS;
 }
 
 void sf_fast_lookup_remove(sf_fast_lookup *lookup, zend_string *key)
 {
     if (!lookup || !key) return;
     
-    zend_ulong h = ZSTR_H(key);
-    uint8_t fingerprint = SF_HASH_FINGERPRINT(h);
-    uint32_t group_idx = (h >> 7) % lookup->num_groups;
+    zval *value = sf_fast_lookup_find(lookup, key);
+    if (!value) return;
     
-    uint32_t probes = 0;
-    while (probes < lookup->num_groups) {
-        sf_lookup_group *group = &lookup->groups[group_idx];
-        
-        for (uint32_t i = 0; i < SF_GROUP_SIZE; i++) {
-            if (group->ctrl[i] == fingerprint && group->keys[i] && 
-                zend_string_equals(group->keys[i], key)) {
-                /* Found it - mark as deleted */
-                group->ctrl[i] = SF_CTRL_DELETED;
-                zend_string_release(group->keys[i]);
-                group->keys[i] = NULL;
-                zval_ptr_dtor(&group->values[i]);
-                ZVAL_UNDEF(&group->values[i]);
-                lookup->count--;
-                return;
-            }
-        }
-        
-        group_idx = (group_idx + 1) % lookup->num_groups;
-        probes++;
+    /* Recover the slot from the value pointer */
+    uint32_t slot = (uint32_t)(value - lookup->values);
+    zend_string *stored = lookup->keys[slot];
+    zval removed;
+    
+    ZVAL_COPY_VALUE(&removed, value);
+    lookup->keys[slot] = NULL;
+    ZVAL_UNDEF(&lookup->values[slot]);
+    lookup->count--;
+    
+    /* A group that already has an EMPTY slot never continues a probe chain,
+     * so the slot can go straight back to EMPTY without a tombstone */
+    if (sf_lookup.has_empty(lookup, slot / sf_simd_active.group_size)) {
+        lookup->ctrl[slot] = SF_CTRL_EMPTY;
+    } else {
+        lookup->ctrl[slot] = SF_CTRL_DELETED;
+        lookup->deleted++;
     }
+    
+    /* Unlinked first - a destructor may call back into the container */
+    zend_string_release(stored);
+    zval_ptr_dtor(&removed);
 }
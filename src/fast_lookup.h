@@ -2,9 +2,17 @@
  * Signalforge Container Extension
  * src/fast_lookup.h - Swiss Table-inspired fast lookup for hot paths
  *
- * Implements a SIMD-accelerated lookup structure for frequently accessed
- * singleton instances. Uses control bytes (hash fingerprints) for quick
+ * Implements a SIMD-accelerated lookup structure used as the container's one
+ * and only singleton store. Uses control bytes (hash fingerprints) for quick
  * filtering before full key comparison.
+ *
+ * The table is a power-of-two number of groups, each as wide as the control
+ * bytes one compare of the selected SIMD kernel covers: 16 slots for scalar,
+ * SSE2 and NEON, 32 for AVX2, 64 for AVX-512 (see sf_simd_startup()). It grows
+ * by doubling once live entries plus tombstones exceed 7/8 of the slots, and
+ * rehashes in place when most of that load is tombstones. A probe stops at the
+ * first group that still has an EMPTY slot, so misses usually cost a single
+ * group scan.
  */
 
 #ifndef SF_FAST_LOOKUP_H
@@ -13,11 +21,8 @@
 #include "php.h"
 #include "simd.h"
 
-/* Group size matches SIMD register width (16 bytes) */
-#define SF_GROUP_SIZE 16
-
-/* Maximum number of groups in fast lookup (256 entries total) */
-#define SF_MAX_GROUPS 16
+/* Initial number of slots - grows on demand */
+#define SF_DEFAULT_SLOTS 64
 
 /* Control byte states */
 #define SF_CTRL_EMPTY    0x80  /* Slot is empty */
@@ -27,23 +32,28 @@
 /* Extract 7-bit hash fingerprint for control byte */
 #define SF_HASH_FINGERPRINT(h) ((uint8_t)((h) & 0x7F))
 
-/* A group of 16 slots with control bytes */
-typedef struct {
-    uint8_t ctrl[SF_GROUP_SIZE] __attribute__((aligned(16)));  /* Control bytes */
-    zend_string *keys[SF_GROUP_SIZE];                          /* Key pointers */
-    zval values[SF_GROUP_SIZE];                                /* Cached values */
-} sf_lookup_group;
-
-/* Fast lookup table for hot-path singleton cache */
+/*
+ * Fast lookup table for hot-path singleton cache. Slots are stored as parallel
+ * arrays so a group's control bytes are contiguous whatever the group width;
+ * slot `i` of group `g` is index g * sf_simd_active.group_size + i everywhere.
+ */
 typedef struct {
-    sf_lookup_group *groups;     /* Array of groups */
-    uint32_t num_groups;         /* Number of allocated groups */
+    uint8_t *ctrl;               /* Control bytes (64-byte aligned) */
+    zend_string **keys;          /* Key pointers */
+    zval *values;                /* Cached values */
+    void *allocation;            /* Raw block backing all three arrays */
+    uint32_t num_groups;         /* Number of allocated groups (power of two) */
+    uint32_t group_mask;         /* num_groups - 1 */
     uint32_t count;              /* Number of entries */
-    uint32_t capacity;           /* Total capacity (num_groups * SF_GROUP_SIZE) */
+    uint32_t deleted;            /* Number of tombstones */
+    uint32_t capacity;           /* Total capacity (num_groups * group size) */
 } sf_fast_lookup;
 
-/* Initialize fast lookup table */
-sf_fast_lookup *sf_fast_lookup_create(uint32_t num_groups);
+/* Pick the group kernels for sf_simd_active (called by sf_simd_startup()) */
+void sf_fast_lookup_startup(void);
+
+/* Initialize fast lookup table with room for at least `slots` (rounded up to a power-of-two number of groups) */
+sf_fast_lookup *sf_fast_lookup_create(uint32_t slots);
 
 /* Destroy fast lookup table */
 void sf_fast_lookup_destroy(sf_fast_lookup *lookup);
@@ -51,13 +61,39 @@ void sf_fast_lookup_destroy(sf_fast_lookup *lookup);
 /* Find an entry (returns NULL if not found) */
 zval *sf_fast_lookup_find(sf_fast_lookup *lookup, zend_string *key);
 
-/* Insert or update an entry (returns SUCCESS/FAILURE) */
+/* Insert or update an entry, growing the table as needed (returns SUCCESS/FAILURE) */
 int sf_fast_lookup_insert(sf_fast_lookup *lookup, zend_string *key, zval *value);
 
 /* Remove an entry */
 void sf_fast_lookup_remove(sf_fast_lookup *lookup, zend_string *key);
 
-/* Clear all entries */
+/* Clear all entries (keeps the allocated groups) */
 void sf_fast_lookup_clear(sf_fast_lookup *lookup);
 
+/* Number of live entries */
+static zend_always_inline uint32_t sf_fast_lookup_count(const sf_fast_lookup *lookup)
+{
+    return lookup->count;
+}
+
+/*
+ * Iterate live entries in slot order:
+ *
+ *   SF_FAST_LOOKUP_FOREACH(lookup, key, val) {
+ *       ...
+ *   } SF_FAST_LOOKUP_FOREACH_END();
+ *
+ * The table must not be modified inside the loop.
+ */
+#define SF_FAST_LOOKUP_FOREACH(_lookup, _key, _val) do { \
+        sf_fast_lookup *__lookup = (_lookup); \
+        for (uint32_t __i = 0; __i < __lookup->capacity; __i++) { \
+            if (__lookup->ctrl[__i] >= SF_CTRL_EMPTY) continue; \
+            _key = __lookup->keys[__i]; \
+            _val = &__lookup->values[__i];
+            
+#define SF_FAST_LOOKUP_FOREACH_END() \
+        } \
+    } while (0)
+    
 #endif /* SF_FAST_LOOKUP_H */
@@ -0,0 +1,333 @@
+/*
+ * Signalforge Container Extension
+ * src/graph.c - Dependency graph export
+ *
+ * The graph starts from every binding, every class in the reflection cache and
+ * every class with contextual rules, and follows dependencies breadth-first,
+ * one node per container key:
+ *
+ * - A binding to another class is an edge to that class (no parameter); its
+ *   constructor is the concrete class's node's business.
+ * - A class - bound to itself or autowired - has an edge per constructor
+ *   parameter the container resolves: its #[Inject] key or class type, or
+ *   what a contextual rule for the class gives instead.
+ * - Closures and instances are leaves: what a factory resolves is only known
+ *   once it runs.
+ *
+ * Building it reads bindings and metadata only; missing metadata is built
+ * (and cached) as make() would, which may autoload a class.
+ */
+
+#include "../php_signalforge_container.h"
+#include "graph.h"
+#include "container.h"
+#include "binding.h"
+
+typedef struct {
+    sf_container *c;
+    zval nodes;     /* name => node info */
+    zval edges;     /* List of edges, in discovery order */
+    zval queue;     /* Names still to expand, in discovery order */
+} sf_graph;
+
+/* ============================================================================
+ * Nodes
+ * ============================================================================ */
+
+static const char *sf_graph_scope_name(uint8_t scope)
+{
+    switch (scope) {
+        case SF_SCOPE_SINGLETON: return "singleton";
+        case SF_SCOPE_INSTANCE: return "instance";
+        case SF_SCOPE_SCOPED: return "scoped";
+        default: return "transient";
+    }
+}
+
+/* Metadata for an unbound name, or NULL if it names no class */
+static sf_class_meta *sf_graph_meta(sf_container *c, zend_string *name)
+{
+    zend_class_entry *ce = sf_container_lookup_class(c, name);
+    return ce ? sf_container_get_meta(c, name, ce) : NULL;
+}
+
+static zend_bool sf_graph_is_closure(sf_binding *binding)
+{
+    return binding->closure
+        || (Z_TYPE(binding->concrete) == IS_OBJECT && instanceof_function(Z_OBJCE(binding->concrete), zend_ce_closure));
+}
+
+/* Node for `name`, queued for expansion the first time it is seen */
+static zval *sf_graph_node(sf_graph *g, zend_string *name)
+{
+    zval *node = zend_hash_find(Z_ARRVAL(g->nodes), name);
+    if (node) {
+        return node;
+    }
+    
+    zval info;
+    array_init_size(&info, 6);
+    
+    sf_binding *binding = zend_hash_find_ptr(&g->c->bindings, name);
+    if (binding) {
+        add_assoc_string(&info, "scope", sf_graph_scope_name(binding->scope));
+        add_assoc_bool(&info, "bound", 1);
+        add_assoc_bool(&info, "lazy", binding->lazy);
+        add_assoc_bool(&info, "closure", sf_graph_is_closure(binding));
+    } else {
+        /* Autowired: #[Singleton] decides the scope; nothing builds an unbound interface */
+        sf_class_meta *meta = sf_graph_meta(g->c, name);
+        if (meta && (meta->attributes & SF_ATTR_SINGLETON)) {
+            add_assoc_string(&info, "scope", "singleton");
+        } else if (meta && (meta->is_instantiable || meta->bind_to)) {
+            add_assoc_string(&info, "scope", "transient");
+        } else {
+            add_assoc_null(&info, "scope");
+        }
+        add_assoc_bool(&info, "bound", 0);
+        add_assoc_bool(&info, "lazy", 0);
+        add_assoc_bool(&info, "closure", 0);
+    }
+    add_assoc_long(&info, "fanIn", 0);
+    add_assoc_long(&info, "fanOut", 0);
+    
+    /* Request copy - persistent graph strings must not end up in request arrays */
+    zend_string *key = sf_string_export(name);
+    node = zend_hash_add_new(Z_ARRVAL(g->nodes), key, &info);
+    add_next_index_str(&g->queue, key);
+    
+    return node;
+}
+
+static void sf_graph_count(zval *node, const char *field)
+{
+    zval *count = zend_hash_str_find(Z_ARRVAL_P(node), field, strlen(field));
+    Z_LVAL_P(count)++;
+}
+
+/* ============================================================================
+ * Edges
+ * ============================================================================ */
+
+static void sf_graph_edge(sf_graph *g, zend_string *from, zend_string *to, zend_string *param, zend_bool contextual)
+{
+    to = sf_container_resolve_alias(g->c, to);
+    
+    zval *target = sf_graph_node(g, to);
+    sf_graph_count(target, "fanIn");
+    sf_graph_count(zend_hash_find(Z_ARRVAL(g->nodes), from), "fanOut");
+    
+    zval edge;
+    array_init_size(&edge, 4);
+    add_assoc_str(&edge, "from", zend_string_copy(from));
+    add_assoc_str(&edge, "to", sf_string_export(to));
+    if (param) {
+        add_assoc_str(&edge, "param", sf_string_export(param));
+    } else {
+        add_assoc_null(&edge, "param");
+    }
+    add_assoc_bool(&edge, "contextual", contextual);
+    add_next_index_zval(&g->edges, &edge);
+}
+
+/* One edge per constructor parameter the container resolves for `name` */
+static void sf_graph_expand_class(sf_graph *g, zend_string *name, sf_class_meta *meta)
+{
+    zend_bool has_rules = zend_hash_num_elements(&g->c->contextual_bindings) > 0;
+    
+    for (uint32_t i = 0; i < meta->param_count; i++) {
+        zend_string *dep = sf_class_meta_dep(meta, i);
+        if (!dep) {
+            continue;
+        }
+        
+        sf_contextual_binding *rule = has_rules ? sf_container_get_contextual_binding(g->c, name, dep) : NULL;
+        if (UNEXPECTED(rule)) {
+            /* A class name is followed; a closure or value stands in for the dependency */
+            zend_string *given = Z_TYPE(rule->implementation) == IS_STRING ? Z_STR(rule->implementation) : dep;
+            sf_graph_edge(g, name, given, meta->param_names[i], 1);
+        } else {
+            sf_graph_edge(g, name, dep, meta->param_names[i], 0);
+        }
+        
+        if (UNEXPECTED(EG(exception))) {
+            return;
+        }
+    }
+}
+
+static void sf_graph_expand(sf_graph *g, zend_string *name)
+{
+    sf_binding *binding = zend_hash_find_ptr(&g->c->bindings, name);
+    zend_string *concrete;
+    
+    if (binding) {
+        /* Closures and instances are leaves */
+        if (Z_TYPE(binding->concrete) != IS_STRING || binding->closure) {
+            return;
+        }
+        concrete = Z_STR(binding->concrete);
+    } else {
+        sf_class_meta *meta = sf_graph_meta(g->c, name);
+        if (!meta) {
+            return;
+        }
+        if (!meta->bind_to) {
+            if (meta->is_instantiable) {
+                sf_graph_expand_class(g, name, meta);
+            }
+            return;
+        }
+        concrete = meta->bind_to;
+    }
+    
+    if (!zend_string_equals(concrete, name)) {
+        sf_graph_edge(g, name, concrete, NULL, 0);
+        return;
+    }
+    
+    /* Bound to itself */
+    sf_class_meta *meta = sf_graph_meta(g->c, name);
+    if (meta && meta->is_instantiable) {
+        sf_graph_expand_class(g, name, meta);
+    }
+}
+
+/* ============================================================================
+ * Export
+ * ============================================================================ */
+
+int sf_graph_export(sf_container *c, zval *result)
+{
+    sf_graph g;
+    zval roots, *name;
+    zend_string *key;
+    
+    g.c = c;
+    array_init(&g.nodes);
+    array_init(&g.edges);
+    array_init(&g.queue);
+    
+    /* Collected first: expanding may add metadata to the cache being walked */
+    array_init(&roots);
+    ZEND_HASH_FOREACH_STR_KEY(&c->bindings, key) {
+        add_next_index_str(&roots, sf_string_export(key));
+    } ZEND_HASH_FOREACH_END();
+    ZEND_HASH_FOREACH_STR_KEY(&c->reflection_cache, key) {
+        add_next_index_str(&roots, sf_string_export(key));
+    } ZEND_HASH_FOREACH_END();
+    ZEND_HASH_FOREACH_STR_KEY(&c->contextual_bindings, key) {
+        add_next_index_str(&roots, sf_string_export(key));
+    } ZEND_HASH_FOREACH_END();
+    
+    ZEND_HASH_FOREACH_VAL(Z_ARRVAL(roots), name) {
+        sf_graph_node(&g, Z_STR_P(name));
+        if (UNEXPECTED(EG(exception))) {
+            break;
+        }
+    } ZEND_HASH_FOREACH_END();
+    zval_ptr_dtor(&roots);
+    
+    /* The queue grows while it is walked - index it rather than iterate it */
+    for (zend_ulong i = 0; !EG(exception) && i < zend_hash_num_elements(Z_ARRVAL(g.queue)); i++) {
+        sf_graph_expand(&g, Z_STR_P(zend_hash_index_find(Z_ARRVAL(g.queue), i)));
+    }
+    zval_ptr_dtor(&g.queue);
+    
+    if (UNEXPECTED(EG(exception))) {
+        zval_ptr_dtor(&g.nodes);
+        zval_ptr_dtor(&g.edges);
+        return FAILURE;
+    }
+    
+    array_init_size(result, 2);
+    add_assoc_zval(result, "nodes", &g.nodes);
+    add_assoc_zval(result, "edges", &g.edges);
+    return SUCCESS;
+}
+
+/* A DOT quoted string - namespace separators would otherwise read as escapes */
+static void sf_graph_dot_quote(smart_str *out, zend_string *s)
+{
+    smart_str_appendc(out, '"');
+    for (size_t i = 0; i < ZSTR_LEN(s); i++) {
+        char ch = ZSTR_VAL(s)[i];
+        if (ch == '\n') {
+            smart_str_appends(out, "\\n");
+            continue;
+        }
+        if (ch == '"' || ch == '\\') {
+            smart_str_appendc(out, '\\');
+        }
+        smart_str_appendc(out, ch);
+    }
+    smart_str_appendc(out, '"');
+}
+
+zend_string *sf_graph_dot(zval *graph)
+{
+    smart_str out = {0};
+    zend_string *name;
+    zval *info, *edge;
+    
+    smart_str_appends(&out, "digraph container {\n");
+    smart_str_appends(&out, "    node [shape=box];\n");
+    
+    /* Bound names are solid boxes, autowired classes rounded, unresolvable ones dashed */
+    ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(zend_hash_str_find(Z_ARRVAL_P(graph), "nodes", sizeof("nodes") - 1)), name, info) {
+        zval *scope = zend_hash_str_find(Z_ARRVAL_P(info), "scope", sizeof("scope") - 1);
+        zend_bool bound = Z_TYPE_P(zend_hash_str_find(Z_ARRVAL_P(info), "bound", sizeof("bound") - 1)) == IS_TRUE;
+        zend_long fan_in = Z_LVAL_P(zend_hash_str_find(Z_ARRVAL_P(info), "fanIn", sizeof("fanIn") - 1));
+        
+        smart_str_appends(&out, "    ");
+        sf_graph_dot_quote(&out, name);
+        smart_str_appends(&out, " [label=");
+        
+        /* Label: the name, then scope and fan-in */
+        smart_str label = {0};
+        smart_str_append(&label, name);
+        smart_str_appendc(&label, '\n');
+        smart_str_appends(&label, Z_TYPE_P(scope) == IS_STRING ? Z_STRVAL_P(scope) : "unresolvable");
+        smart_str_appends(&label, ", fan-in ");
+        smart_str_append_long(&label, fan_in);
+        smart_str_0(&label);
+        
+        sf_graph_dot_quote(&out, label.s);
+        smart_str_free(&label);
+        
+        if (Z_TYPE_P(scope) != IS_STRING) {
+            smart_str_appends(&out, ", style=dashed");
+        } else if (!bound) {
+            smart_str_appends(&out, ", style=rounded");
+        }
+        smart_str_appends(&out, "];\n");
+    } ZEND_HASH_FOREACH_END();
+    
+    /* Edges are labelled with the parameter; contextual ones are dashed */
+    ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(zend_hash_str_find(Z_ARRVAL_P(graph), "edges", sizeof("edges") - 1)), edge) {
+        zval *param = zend_hash_str_find(Z_ARRVAL_P(edge), "param", sizeof("param") - 1);
+        zend_bool contextual = Z_TYPE_P(zend_hash_str_find(Z_ARRVAL_P(edge), "contextual", sizeof("contextual") - 1)) == IS_TRUE;
+        
+        smart_str_appends(&out, "    ");
+        sf_graph_dot_quote(&out, Z_STR_P(zend_hash_str_find(Z_ARRVAL_P(edge), "from", sizeof("from") - 1)));
+        smart_str_appends(&out, " -> ");
+        sf_graph_dot_quote(&out, Z_STR_P(zend_hash_str_find(Z_ARRVAL_P(edge), "to", sizeof("to") - 1)));
+        if (Z_TYPE_P(param) == IS_STRING || contextual) {
+            smart_str_appends(&out, " [");
+            if (Z_TYPE_P(param) == IS_STRING) {
+                smart_str_appends(&out, "label=\"$");
+                smart_str_append(&out, Z_STR_P(param));
+                smart_str_appendc(&out, '"');
+            }
+            if (contextual) {
+                smart_str_appends(&out, Z_TYPE_P(param) == IS_STRING ? ", style=dashed" : "style=dashed");
+            }
+            smart_str_appendc(&out, ']');
+        }
+        smart_str_appends(&out, ";\n");
+    } ZEND_HASH_FOREACH_END();
+    
+    smart_str_appends(&out, "}\n");
+    smart_str_0(&out);
+    return out.s;
+}
@@ -0,0 +1,29 @@
+/*
+ * Signalforge Container Extension
+ * src/graph.h - Dependency graph export
+ *
+ * Container::graph() describes what make() would build without building
+ * anything: every bound name, every class with cached metadata or contextual
+ * rules, and what each one depends on through its binding and constructor, as
+ * the container would resolve it - aliases followed, contextual rules and
+ * #[Inject] applied.
+ * Nodes carry their scope and fan-in, so widely shared transients and
+ * singletons pulled in by one consumer stand out.
+ */
+
+#ifndef SF_GRAPH_H
+#define SF_GRAPH_H
+
+/* Forward declaration */
+struct _sf_container;
+
+/*
+ * Graph as ['nodes' => [name => info], 'edges' => [[from, to, param,
+ * contextual], ...]]. Returns SUCCESS, or FAILURE if an autoloader threw.
+ */
+int sf_graph_export(struct _sf_container *container, zval *result);
+
+/* The same graph in Graphviz DOT (array from sf_graph_export()) */
+zend_string *sf_graph_dot(zval *graph);
+
+#endif /* SF_GRAPH_H */
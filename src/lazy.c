@@ -0,0 +1,347 @@
+/*
+ * Signalforge Container Extension
+ * src/lazy.c - Lazy singleton proxies
+ *
+ * Services like mailers or API clients are often injected everywhere but
+ * used on few requests. A lazy singleton hands out a stand-in object right
+ * away and defers building the real one (and its dependency subtree) until a
+ * method or property is first used:
+ *
+ *   Container::lazy(Mailer::class);
+ *   $controller = Container::make(Controller::class); // Mailer not built yet
+ *
+ * On PHP 8.4+ the stand-in is a native lazy proxy (the engine's lazy object
+ * API), which is fully transparent. On older versions we generate a subclass
+ * once per class that forwards every public and protected method to the real
+ * instance. Classes a generated proxy can't cover faithfully (final classes,
+ * public properties, magic methods, by-reference parameters...) are simply
+ * resolved eagerly.
+ */
+
+#include "../php_signalforge_container.h"
+#include "lazy.h"
+#include "container.h"
+#include "autowire.h"
+
+#if PHP_VERSION_ID >= 80400
+#include "zend_lazy_objects.h"
+#endif
+
+/* Container::resolveLazy() - the callback every proxy initializes through */
+static zend_function *sf_lazy_initializer_fn = NULL;
+
+void sf_lazy_startup(void)
+{
+    sf_lazy_initializer_fn = zend_hash_str_find_ptr(&sf_container_ce->function_table,
+        "resolvelazy", sizeof("resolvelazy") - 1);
+}
+
+/* A closure over the private initializer, callable from the engine and from proxies */
+static void sf_lazy_initializer(zval *closure)
+{
+    zend_create_fake_closure(closure, sf_lazy_initializer_fn, sf_container_ce, sf_container_ce, NULL);
+}
+
+#if PHP_VERSION_ID < 80400
+
+/* ============================================================================
+ * Generated Proxies (PHP < 8.4)
+ *
+ * For class App\Mailer we eval:
+ *
+ *   class SignalforgeLazyProxy__App__Mailer extends \App\Mailer {
+ *       private $signalforgeLazyInstance = null;
+ *       private $signalforgeLazyInitializer = null;
+ *       public function send(...$args): bool {
+ *           return $this->signalforgeLazyInstance()->send(...$args);
+ *       }
+ *       ...
+ *   }
+ *
+ * The class lives in the global namespace, so type names taken from the
+ * parent's signatures (always fully qualified) resolve as written. A
+ * variadic parameter list is compatible with any by-value signature and
+ * keeps named arguments working.
+ * ============================================================================ */
+
+static zend_string *sf_lazy_proxy_name(zend_string *class_name)
+{
+    smart_str name = {0};
+    
+    smart_str_appends(&name, SF_LAZY_PROXY_PREFIX);
+    for (size_t i = 0; i < ZSTR_LEN(class_name); i++) {
+        if (ZSTR_VAL(class_name)[i] == '\\') {
+            smart_str_appends(&name, "__");
+        } else {
+            smart_str_appendc(&name, ZSTR_VAL(class_name)[i]);
+        }
+    }
+    smart_str_0(&name);
+    
+    return name.s;
+}
+
+/* Can every method call on `fn` be forwarded by a generated override? */
+static zend_bool sf_lazy_can_forward(zend_function *fn)
+{
+    if (fn->type != ZEND_USER_FUNCTION
+        || (fn->common.fn_flags & (ZEND_ACC_FINAL | ZEND_ACC_RETURN_REFERENCE))) {
+        return 0;
+    }
+    
+    /* Magic methods have fixed signatures; only __invoke forwards as-is */
+    zend_string *name = fn->common.function_name;
+    if (ZSTR_LEN(name) >= 2 && ZSTR_VAL(name)[0] == '_' && ZSTR_VAL(name)[1] == '_'
+        && !zend_string_equals_literal_ci(name, "__invoke")) {
+        return 0;
+    }
+    
+    /* `static` can't be satisfied by the real instance */
+    if (fn->common.fn_flags & ZEND_ACC_HAS_RETURN_TYPE) {
+        zend_string *type = zend_type_to_string((fn->common.arg_info - 1)->type);
+        zend_bool has_static = strstr(ZSTR_VAL(type), "static") != NULL;
+        zend_string_release(type);
+        if (has_static) {
+            return 0;
+        }
+    }
+    
+    uint32_t num_args = fn->common.num_args + ((fn->common.fn_flags & ZEND_ACC_VARIADIC) ? 1 : 0);
+    for (uint32_t i = 0; i < num_args; i++) {
+        if (ZEND_ARG_SEND_MODE(&fn->common.arg_info[i])) {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+static zend_bool sf_lazy_can_proxy(zend_class_entry *ce)
+{
+    if (ce->type != ZEND_USER_CLASS || ce->create_object
+        || (ce->ce_flags & (ZEND_ACC_FINAL | ZEND_ACC_READONLY_CLASS | ZEND_ACC_ENUM))) {
+        return 0;
+    }
+    
+    /* Our own members must not collide with the class's */
+    if (zend_hash_str_exists(&ce->function_table, "signalforgelazyinstance", sizeof("signalforgelazyinstance") - 1)) {
+        return 0;
+    }
+    
+    /* Public properties would be read from the empty proxy */
+    zend_property_info *prop;
+    ZEND_HASH_FOREACH_PTR(&ce->properties_info, prop) {
+        if ((prop->flags & ZEND_ACC_PUBLIC) && !(prop->flags & ZEND_ACC_STATIC)) {
+            return 0;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    zend_function *fn;
+    ZEND_HASH_FOREACH_PTR(&ce->function_table, fn) {
+        if ((fn->common.fn_flags & (ZEND_ACC_STATIC | ZEND_ACC_PRIVATE)) || fn == ce->constructor) {
+            continue;
+        }
+        /* The proxy's destructor is replaced by an empty one */
+        if (fn == ce->destructor) {
+            if (fn->common.fn_flags & ZEND_ACC_FINAL) {
+                return 0;
+            }
+            continue;
+        }
+        if (!sf_lazy_can_forward(fn)) {
+            return 0;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    return 1;
+}
+
+/* Append the return type of `fn`, with `self` pinned to the proxied class */
+static void sf_lazy_append_return_type(smart_str *code, zend_function *fn)
+{
+    zend_string *type = zend_type_to_string((fn->common.arg_info - 1)->type);
+    const char *p = ZSTR_VAL(type);
+    const char *end = p + ZSTR_LEN(type);
+    
+    smart_str_appends(code, ": ");
+    while (p < end) {
+        const char *word = p;
+        while (p < end && *p != '|' && *p != '&' && *p != '(' && *p != ')' && *p != '?') {
+            p++;
+        }
+        if (p - word == 4 && strncasecmp(word, "self", 4) == 0) {
+            smart_str_appends(code, "parent");
+        } else {
+            /* Class names are fully qualified, so they resolve from the global namespace */
+            smart_str_appendl(code, word, p - word);
+        }
+        if (p < end) {
+            smart_str_appendc(code, *p++);
+        }
+    }
+    zend_string_release(type);
+}
+
+static void sf_lazy_append_method(smart_str *code, zend_function *fn)
+{
+    zend_bool returns = 1;
+    
+    if (!(fn->common.fn_flags & ZEND_ACC_HAS_RETURN_TYPE)) {
+        smart_str_appends(code, "    #[\\ReturnTypeWillChange]\n");
+    }
+    smart_str_appends(code, (fn->common.fn_flags & ZEND_ACC_PROTECTED) ? "    protected" : "    public");
+    smart_str_appends(code, " function ");
+    smart_str_append(code, fn->common.function_name);
+    smart_str_appends(code, "(...$args)");
+    
+    if (fn->common.fn_flags & ZEND_ACC_HAS_RETURN_TYPE) {
+        zend_type rt = (fn->common.arg_info - 1)->type;
+        returns = !ZEND_TYPE_CONTAINS_CODE(rt, IS_VOID) && !ZEND_TYPE_CONTAINS_CODE(rt, IS_NEVER);
+        sf_lazy_append_return_type(code, fn);
+    }
+    
+    smart_str_appends(code, " {\n        ");
+    if (returns) {
+        smart_str_appends(code, "return ");
+    }
+    smart_str_appends(code, "$this->signalforgeLazyInstance()->");
+    smart_str_append(code, fn->common.function_name);
+    smart_str_appends(code, "(...$args);\n    }\n");
+}
+
+/* Get (or generate) the proxy class for `ce`, or NULL if it can't be proxied */
+static zend_class_entry *sf_lazy_proxy_class(zend_class_entry *ce)
+{
+    zend_string *name = sf_lazy_proxy_name(ce->name);
+    zend_class_entry *proxy = zend_lookup_class_ex(name, NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD);
+    
+    if (proxy || !sf_lazy_can_proxy(ce)) {
+        zend_string_release(name);
+        return proxy && proxy->parent == ce ? proxy : NULL;
+    }
+    
+    smart_str code = {0};
+    smart_str_appends(&code, "class ");
+    smart_str_append(&code, name);
+    smart_str_appends(&code, " extends \\");
+    smart_str_append(&code, ce->name);
+    smart_str_appends(&code, " {\n"
+        "    private $signalforgeLazyInstance = null;\n"
+        "    private $signalforgeLazyInitializer = null;\n"
+        "    private function signalforgeLazyInstance(): object {\n"
+        "        if ($this->signalforgeLazyInstance === null) {\n"
+        "            $this->signalforgeLazyInstance = ($this->signalforgeLazyInitializer)(parent::class);\n"
+        "            $this->signalforgeLazyInitializer = null;\n"
+        "        }\n"
+        "        return $this->signalforgeLazyInstance;\n"
+        "    }\n");
+    
+    /* The real instance runs its own destructor */
+    if (ce->destructor) {
+        smart_str_appends(&code, "    public function __destruct() {}\n");
+    }
+    
+    zend_function *fn;
+    ZEND_HASH_FOREACH_PTR(&ce->function_table, fn) {
+        if ((fn->common.fn_flags & (ZEND_ACC_STATIC | ZEND_ACC_PRIVATE))
+            || fn == ce->constructor || fn == ce->destructor) {
+            continue;
+        }
+        sf_lazy_append_method(&code, fn);
+    } ZEND_HASH_FOREACH_END();
+    
+    smart_str_appends(&code, "}\n");
+    smart_str_0(&code);
+    
+    if (zend_eval_stringl(ZSTR_VAL(code.s), ZSTR_LEN(code.s), NULL, "signalforge lazy proxy") == SUCCESS) {
+        proxy = zend_lookup_class_ex(name, NULL, ZEND_FETCH_CLASS_NO_AUTOLOAD);
+    }
+    
+    smart_str_free(&code);
+    zend_string_release(name);
+    return proxy;
+}
+
+#endif /* PHP_VERSION_ID < 80400 */
+
+/* ============================================================================
+ * Lazy Proxy API
+ * ============================================================================ */
+
+int sf_lazy_create(sf_container *c, zend_string *class_name, zval *result)
+{
+    (void)c;
+    
+    zend_class_entry *ce = zend_lookup_class(class_name);
+    if (!ce || !sf_lazy_initializer_fn
+        || (ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT))) {
+        return FAILURE;
+    }
+    
+    zval initializer;
+    sf_lazy_initializer(&initializer);
+    
+#if PHP_VERSION_ID >= 80400
+    if (!zend_class_can_be_lazy(ce)) {
+        zval_ptr_dtor(&initializer);
+        return FAILURE;
+    }
+    
+    zend_fcall_info fci;
+    zend_fcall_info_cache fcc;
+    if (zend_fcall_info_init(&initializer, 0, &fci, &fcc, NULL, NULL) == FAILURE) {
+        zval_ptr_dtor(&initializer);
+        return FAILURE;
+    }
+    
+    /* The engine keeps its own reference to the initializer */
+    zend_object *proxy = zend_object_make_lazy(NULL, ce, &initializer, &fcc, ZEND_LAZY_OBJECT_STRATEGY_PROXY);
+    zval_ptr_dtor(&initializer);
+    if (!proxy) {
+        return FAILURE;
+    }
+    ZVAL_OBJ(result, proxy);
+#else
+    zend_class_entry *proxy_ce = sf_lazy_proxy_class(ce);
+    if (!proxy_ce || object_init_ex(result, proxy_ce) != SUCCESS) {
+        zval_ptr_dtor(&initializer);
+        return FAILURE;
+    }
+    
+    zend_update_property(proxy_ce, Z_OBJ_P(result), "signalforgeLazyInitializer",
+        sizeof("signalforgeLazyInitializer") - 1, &initializer);
+    zval_ptr_dtor(&initializer);
+#endif
+    
+    return SUCCESS;
+}
+
+int sf_lazy_initialize(sf_container *c, zval *target, zval *result)
+{
+    zend_string *class_name;
+    
+    if (Z_TYPE_P(target) == IS_OBJECT) {
+        class_name = Z_OBJCE_P(target)->name;
+    } else if (Z_TYPE_P(target) == IS_STRING) {
+        class_name = Z_STR_P(target);
+    } else {
+        return FAILURE;  /* Reflection can reach resolveLazy() with anything */
+    }
+    
+    /* The concrete class itself, exactly like a regular singleton resolution */
+    return sf_autowire_resolve(class_name, result, NULL, c);
+}
+
+zend_bool sf_lazy_is_proxy(zval *value)
+{
+    if (Z_TYPE_P(value) != IS_OBJECT) {
+        return 0;
+    }
+    
+#if PHP_VERSION_ID >= 80400
+    return zend_object_is_lazy(Z_OBJ_P(value)) && !zend_lazy_object_initialized(Z_OBJ_P(value));
+#else
+    /* Generated classes don't exist in the next request, initialized or not */
+    return zend_string_starts_with_literal(Z_OBJCE_P(value)->name, SF_LAZY_PROXY_PREFIX);
+#endif
+}
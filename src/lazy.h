@@ -0,0 +1,37 @@
+/*
+ * Signalforge Container Extension
+ * src/lazy.h - Lazy singleton proxies
+ *
+ * Container::lazy() singletons are handed out as proxies; the real object is
+ * only built when the proxy is first used.
+ */
+
+#ifndef SF_LAZY_H
+#define SF_LAZY_H
+
+/* Forward declarations */
+struct _sf_container;
+
+/* Class name prefix of generated proxy classes (PHP < 8.4) */
+#define SF_LAZY_PROXY_PREFIX "SignalforgeLazyProxy__"
+
+/* Find the initializer method the proxies call back into (MINIT) */
+void sf_lazy_startup(void);
+
+/*
+ * Create a lazy proxy for `class_name` into `result`.
+ * Returns FAILURE (without an exception) if the class can't be proxied; the
+ * caller then resolves it eagerly.
+ */
+int sf_lazy_create(struct _sf_container *container, zend_string *class_name, zval *result);
+
+/*
+ * Build the real instance behind a proxy. `target` is the proxy object
+ * (PHP 8.4+) or the proxied class name (generated proxies).
+ */
+int sf_lazy_initialize(struct _sf_container *container, zval *target, zval *result);
+
+/* Is this a proxy whose real instance hasn't been built yet? */
+zend_bool sf_lazy_is_proxy(zval *value);
+
+#endif /* SF_LAZY_H */
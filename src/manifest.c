@@ -0,0 +1,299 @@
+/*
+ * Signalforge Container Extension
+ * src/manifest.c - Bulk registration from a bindings manifest
+ *
+ * A manifest is the bootstrap as one array, keyed by the method each section
+ * stands for:
+ *
+ *   [
+ *       'bind'      => [Abstract::class => Concrete::class, Standalone::class, ...],
+ *       'singleton' => [...],
+ *       'scoped'    => [...],
+ *       'lazy'      => [...],
+ *       'alias'     => ['alias' => Abstract::class, ...],
+ *       'tag'       => ['tag' => [Abstract::class, ...], ...],
+ *       'when'      => [Requester::class => [Dependency::class => implementation, ...], ...],
+ *   ]
+ *
+ * Binding sections take any concrete bind() takes; a list entry or a null
+ * concrete binds the class to itself. Sections apply in the order they appear,
+ * exactly as the equivalent sequence of method calls would.
+ *
+ * The manifest is walked in place - nothing is separated or duplicated, so an
+ * opcache-cached `return [...]` file is read straight from shared memory, and
+ * its strings are already interned. The container tables are presized from a
+ * first, validating pass.
+ */
+
+#include "../php_signalforge_container.h"
+#include "manifest.h"
+#include "container.h"
+
+/* Sections, in the order of sf_manifest_section_names */
+enum {
+    SF_SECTION_BIND,
+    SF_SECTION_SINGLETON,
+    SF_SECTION_SCOPED,
+    SF_SECTION_LAZY,
+    SF_SECTION_ALIAS,
+    SF_SECTION_TAG,
+    SF_SECTION_WHEN,
+    SF_SECTION_COUNT
+};
+
+static const char *sf_manifest_section_names[SF_SECTION_COUNT] = {
+    "bind", "singleton", "scoped", "lazy", "alias", "tag", "when"
+};
+
+/* What a valid entry looks like, for error messages */
+static const char *sf_manifest_section_expects[SF_SECTION_COUNT] = {
+    "abstract => concrete, or a class name",
+    "abstract => concrete, or a class name",
+    "abstract => concrete, or a class name",
+    "abstract => class name, or a class name",
+    "alias => abstract",
+    "tag => list of abstracts",
+    "requester => [dependency => implementation]"
+};
+
+/* Totals from the validating pass, used to presize the container tables */
+typedef struct {
+    uint32_t bindings;
+    uint32_t aliases;
+    uint32_t requesters;
+    uint32_t rules;
+} sf_manifest_counts;
+
+/* ============================================================================
+ * Validation
+ * ============================================================================ */
+
+static int sf_manifest_section(zend_string *name)
+{
+    for (int i = 0; i < SF_SECTION_COUNT; i++) {
+        if (zend_string_equals_cstr(name, sf_manifest_section_names[i], strlen(sf_manifest_section_names[i]))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static zend_bool sf_manifest_entry_valid(int section, zend_string *key, zval *entry)
+{
+    switch (section) {
+        case SF_SECTION_BIND:
+        case SF_SECTION_SINGLETON:
+        case SF_SECTION_SCOPED:
+            /* Keyed entries take anything bind() does */
+            return key || Z_TYPE_P(entry) == IS_STRING;
+        
+        case SF_SECTION_LAZY:
+            return Z_TYPE_P(entry) == IS_STRING || (key && Z_TYPE_P(entry) == IS_NULL);
+        
+        case SF_SECTION_ALIAS:
+            return key && Z_TYPE_P(entry) == IS_STRING;
+        
+        case SF_SECTION_TAG:
+            return key && Z_TYPE_P(entry) == IS_ARRAY;
+        
+        case SF_SECTION_WHEN: {
+            if (!key || Z_TYPE_P(entry) != IS_ARRAY) {
+                return 0;
+            }
+            zend_string *dependency;
+            ZEND_HASH_FOREACH_STR_KEY(Z_ARRVAL_P(entry), dependency) {
+                if (!dependency) {
+                    return 0;
+                }
+            } ZEND_HASH_FOREACH_END();
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+static int sf_manifest_check(HashTable *manifest, sf_manifest_counts *counts)
+{
+    zend_ulong section_index;
+    zend_string *name;
+    zval *section;
+    
+    memset(counts, 0, sizeof(*counts));
+    
+    ZEND_HASH_FOREACH_KEY_VAL(manifest, section_index, name, section) {
+        int kind = name ? sf_manifest_section(name) : -1;
+        if (kind < 0) {
+            if (name) {
+                zend_throw_exception_ex(sf_container_exception_ce, 0, "Unknown manifest section '%s'", ZSTR_VAL(name));
+            } else {
+                zend_throw_exception_ex(sf_container_exception_ce, 0, "Unknown manifest section #" ZEND_ULONG_FMT, section_index);
+            }
+            return FAILURE;
+        }
+        
+        ZVAL_DEREF(section);
+        if (Z_TYPE_P(section) != IS_ARRAY) {
+            zend_throw_exception_ex(sf_container_exception_ce, 0, "Manifest section '%s' must be an array", ZSTR_VAL(name));
+            return FAILURE;
+        }
+        
+        zend_ulong index;
+        zend_string *key;
+        zval *entry;
+        ZEND_HASH_FOREACH_KEY_VAL(Z_ARRVAL_P(section), index, key, entry) {
+            ZVAL_DEREF(entry);
+            if (UNEXPECTED(!sf_manifest_entry_valid(kind, key, entry))) {
+                if (key) {
+                    zend_throw_exception_ex(sf_container_exception_ce, 0,
+                        "Invalid manifest entry '%s' in '%s': expected %s",
+                        ZSTR_VAL(key), ZSTR_VAL(name), sf_manifest_section_expects[kind]);
+                } else {
+                    zend_throw_exception_ex(sf_container_exception_ce, 0,
+                        "Invalid manifest entry #" ZEND_ULONG_FMT " in '%s': expected %s",
+                        index, ZSTR_VAL(name), sf_manifest_section_expects[kind]);
+                }
+                return FAILURE;
+            }
+            if (kind == SF_SECTION_WHEN) {
+                counts->rules += zend_hash_num_elements(Z_ARRVAL_P(entry));
+            }
+        } ZEND_HASH_FOREACH_END();
+        
+        uint32_t entries = zend_hash_num_elements(Z_ARRVAL_P(section));
+        if (kind <= SF_SECTION_LAZY) {
+            counts->bindings += entries;
+        } else if (kind == SF_SECTION_ALIAS) {
+            counts->aliases += entries;
+        } else if (kind == SF_SECTION_WHEN) {
+            counts->requesters += entries;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * Application
+ * ============================================================================ */
+
+/* Room for `extra` more entries (upper bound - some may replace existing ones) */
+static void sf_manifest_reserve(HashTable *ht, uint32_t extra)
+{
+    if (extra > 0) {
+        zend_hash_extend(ht, zend_hash_num_elements(ht) + extra, 0);
+    }
+}
+
+static void sf_manifest_apply_bindings(sf_container *c, HashTable *entries, uint8_t scope)
+{
+    zend_string *key;
+    zval *entry;
+    
+    ZEND_HASH_FOREACH_STR_KEY_VAL(entries, key, entry) {
+        ZVAL_DEREF(entry);
+        if (!key) {
+            /* List entry: the class is its own concrete */
+            sf_container_bind(c, Z_STR_P(entry), entry, scope);
+        } else if (Z_TYPE_P(entry) == IS_NULL) {
+            zval self;
+            ZVAL_STR(&self, key);
+            sf_container_bind(c, key, &self, scope);
+        } else {
+            sf_container_bind(c, key, entry, scope);
+        }
+    } ZEND_HASH_FOREACH_END();
+}
+
+static void sf_manifest_apply_lazy(sf_container *c, HashTable *entries)
+{
+    zend_string *key;
+    zval *entry;
+    
+    ZEND_HASH_FOREACH_STR_KEY_VAL(entries, key, entry) {
+        ZVAL_DEREF(entry);
+        if (!key) {
+            sf_container_lazy(c, Z_STR_P(entry), Z_STR_P(entry));
+        } else {
+            sf_container_lazy(c, key, Z_TYPE_P(entry) == IS_STRING ? Z_STR_P(entry) : key);
+        }
+    } ZEND_HASH_FOREACH_END();
+}
+
+static void sf_manifest_apply_section(sf_container *c, int kind, HashTable *entries)
+{
+    zend_string *key;
+    zval *entry;
+    
+    switch (kind) {
+        case SF_SECTION_BIND:
+            sf_manifest_apply_bindings(c, entries, SF_SCOPE_TRANSIENT);
+            break;
+        
+        case SF_SECTION_SINGLETON:
+            sf_manifest_apply_bindings(c, entries, SF_SCOPE_SINGLETON);
+            break;
+        
+        case SF_SECTION_SCOPED:
+            sf_manifest_apply_bindings(c, entries, SF_SCOPE_SCOPED);
+            break;
+        
+        case SF_SECTION_LAZY:
+            sf_manifest_apply_lazy(c, entries);
+            break;
+        
+        case SF_SECTION_ALIAS:
+            ZEND_HASH_FOREACH_STR_KEY_VAL(entries, key, entry) {
+                ZVAL_DEREF(entry);
+                sf_container_alias(c, Z_STR_P(entry), key);
+            } ZEND_HASH_FOREACH_END();
+            break;
+        
+        case SF_SECTION_TAG:
+            ZEND_HASH_FOREACH_STR_KEY_VAL(entries, key, entry) {
+                ZVAL_DEREF(entry);
+                sf_container_tag(c, Z_ARRVAL_P(entry), key);
+            } ZEND_HASH_FOREACH_END();
+            break;
+        
+        case SF_SECTION_WHEN:
+            ZEND_HASH_FOREACH_STR_KEY_VAL(entries, key, entry) {
+                zend_string *dependency;
+                zval *implementation;
+                
+                ZVAL_DEREF(entry);
+                ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(entry), dependency, implementation) {
+                    ZVAL_DEREF(implementation);
+                    sf_container_add_contextual_binding(c, key, dependency, implementation);
+                } ZEND_HASH_FOREACH_END();
+            } ZEND_HASH_FOREACH_END();
+            break;
+    }
+}
+
+int sf_manifest_register(sf_container *c, HashTable *manifest)
+{
+    sf_manifest_counts counts;
+    
+    if (sf_manifest_check(manifest, &counts) == FAILURE) {
+        return FAILURE;
+    }
+    
+    /* One resize per table instead of a doubling every few hundred entries */
+    sf_manifest_reserve(&c->bindings, counts.bindings);
+    sf_manifest_reserve(&c->aliases, counts.aliases);
+    sf_manifest_reserve(&c->contextual_bindings, counts.requesters);
+    sf_manifest_reserve(&c->reshaped, counts.bindings + counts.aliases + counts.rules);
+    
+    zend_string *name;
+    zval *section;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(manifest, name, section) {
+        ZVAL_DEREF(section);
+        sf_manifest_apply_section(c, sf_manifest_section(name), Z_ARRVAL_P(section));
+        if (UNEXPECTED(EG(exception))) {
+            return FAILURE;
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    return SUCCESS;
+}
@@ -0,0 +1,23 @@
+/*
+ * Signalforge Container Extension
+ * src/manifest.h - Bulk registration from a bindings manifest
+ *
+ * Container::register() and Container::loadManifest() apply a whole bootstrap
+ * - bindings, aliases, tags and contextual rules - in one native pass instead
+ * of one method call per entry.
+ */
+
+#ifndef SF_MANIFEST_H
+#define SF_MANIFEST_H
+
+/* Forward declarations */
+struct _sf_container;
+
+/*
+ * Apply `manifest` to the container. Every entry is checked before anything is
+ * registered, so an invalid manifest throws and leaves the container as it
+ * was. Returns SUCCESS, or FAILURE with an exception.
+ */
+int sf_manifest_register(struct _sf_container *container, HashTable *manifest);
+
+#endif /* SF_MANIFEST_H */
@@ -0,0 +1,223 @@
+/*
+ * Signalforge Container Extension
+ * src/preload.c - Warm-up from an opcache.preload script
+ *
+ * The first make() of a class pays for its constructor analysis
+ * (sf_cache_build) and, once it is hot, for its plan. Container::warmup() does
+ * both up front for a list of classes or a namespace.
+ *
+ * Without persistent mode the container dies with the request, preload's
+ * included. So when warmup() runs while opcache preloads, what it built is also
+ * copied to a process-lifetime template container. The template is written
+ * before any worker exists and only read afterwards: under FPM the forked
+ * workers share its pages copy-on-write, under ZTS the threads read it without
+ * locking (its strings are shared, so copying them never writes). Every
+ * container created later starts with a copy of its metadata and plans.
+ *
+ * Metadata built while preloading is flagged: as long as the live class is
+ * still the preloaded one, sf_cache_matches() accepts it without comparing the
+ * constructor again. Plans are checked like plans loaded from a snapshot -
+ * class entries are looked up on first use, and a plan is rebuilt if the
+ * request binds a name it consulted.
+ */
+
+#include "../php_signalforge_container.h"
+#include "preload.h"
+#include "container.h"
+#include "reflection_cache.h"
+#include "compiler.h"
+
+/* What the preload script warmed (NULL = nothing) */
+static sf_container *sf_preload_template = NULL;
+
+/* ============================================================================
+ * Warm-up
+ * ============================================================================ */
+
+static void sf_preload_warm_class(sf_container *c, zend_class_entry *ce, zend_long *warmed)
+{
+    sf_class_meta *meta = sf_container_get_meta(c, ce->name, ce);
+    if (!meta || UNEXPECTED(EG(exception))) {
+        return;
+    }
+    
+    /* Unbound interfaces have nothing to plan; #[Bind] and #[Singleton] plan once bound */
+    if (meta->is_instantiable && !sf_class_meta_binds(meta)) {
+        sf_compiler_promote(c, ce->name);
+    }
+    (*warmed)++;
+}
+
+/*
+ * User classes declared so far under `prefix`. Collected before anything is
+ * warmed: compiling may autoload, and the class table must not grow while it
+ * is walked.
+ */
+static void sf_preload_collect(zend_string *prefix, zend_array *found)
+{
+    const char *start = ZSTR_VAL(prefix);
+    size_t len = ZSTR_LEN(prefix);
+    
+    if (len && start[0] == '\\') {
+        start++;
+        len--;
+    }
+    zend_string *lc_prefix = zend_string_alloc(len, 0);
+    zend_str_tolower_copy(ZSTR_VAL(lc_prefix), start, len);
+    
+    zend_string *key;
+    zval *entry;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(EG(class_table), key, entry) {
+        /* class_alias() entries and runtime definition keys */
+        if (Z_TYPE_P(entry) != IS_PTR || !key || ZSTR_VAL(key)[0] == '\0') {
+            continue;
+        }
+        zend_class_entry *ce = Z_PTR_P(entry);
+        if (ce->type != ZEND_USER_CLASS || ZSTR_LEN(key) < len
+            || memcmp(ZSTR_VAL(key), ZSTR_VAL(lc_prefix), len) != 0) {
+            continue;
+        }
+        zend_hash_next_index_insert_ptr(found, ce);
+    } ZEND_HASH_FOREACH_END();
+    
+    zend_string_release(lc_prefix);
+}
+
+/*
+ * Was the plan built from nothing but autowiring? Requests register their own
+ * bindings, so a plan that consulted one made by the preload script would be
+ * wrong wherever the request doesn't make the same one.
+ */
+static zend_bool sf_preload_plan_portable(sf_container *c, sf_factory *factory)
+{
+    if (!factory->steps || !factory->deps) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < factory->dep_count; i++) {
+        zend_string *name = factory->deps[i];
+        if (zend_hash_exists(&c->bindings, name) || zend_hash_exists(&c->aliases, name)
+            || zend_hash_exists(&c->contextual_bindings, name)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Copy of everything built while preloading, for the containers created
+ * later. Names already in the template keep their first copy.
+ */
+static void sf_preload_keep(sf_container *c)
+{
+    if (!sf_preload_template) {
+        sf_preload_template = sf_container_create_ex(1);
+        /* Graph tables only - its request state would outlive the preload request */
+        sf_container_request_shutdown(sf_preload_template);
+    }
+    sf_container *t = sf_preload_template;
+    
+    sf_class_meta *meta;
+    ZEND_HASH_FOREACH_PTR(&c->reflection_cache, meta) {
+        if (meta->preloaded && !zend_hash_exists(&t->reflection_cache, meta->class_name)) {
+            sf_class_meta *copy = sf_class_meta_clone(meta, &t->arena);
+            zend_hash_add_new_ptr(&t->reflection_cache, copy->class_name, copy);
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    sf_factory *factory;
+    ZEND_HASH_FOREACH_PTR(&c->compiled_factories, factory) {
+        if (sf_preload_plan_portable(c, factory) && !zend_hash_exists(&t->compiled_factories, factory->abstract)) {
+            sf_factory *copy = sf_factory_clone(factory, 1);
+            zend_hash_add_new_ptr(&t->compiled_factories, copy->abstract, copy);
+        }
+    } ZEND_HASH_FOREACH_END();
+}
+
+zend_long sf_preload_warmup(sf_container *c, HashTable *classes, zend_string *prefix)
+{
+    zend_long warmed = 0;
+    
+    if (classes) {
+        zval *name;
+        ZEND_HASH_FOREACH_VAL(classes, name) {
+            ZVAL_DEREF(name);
+            if (UNEXPECTED(Z_TYPE_P(name) != IS_STRING)) {
+                zend_throw_exception(sf_container_exception_ce, "Container::warmup() expects a list of class names", 0);
+                return -1;
+            }
+            
+            zend_class_entry *ce = zend_lookup_class(Z_STR_P(name));
+            if (UNEXPECTED(!ce)) {
+                if (!EG(exception)) {
+                    zend_throw_exception_ex(sf_not_found_exception_ce, 0, "Cannot warm up '%s': class does not exist", Z_STRVAL_P(name));
+                }
+                return -1;
+            }
+            sf_preload_warm_class(c, ce, &warmed);
+            if (UNEXPECTED(EG(exception))) {
+                return -1;
+            }
+        } ZEND_HASH_FOREACH_END();
+    } else {
+        zend_array found;
+        zend_class_entry *ce;
+        
+        zend_hash_init(&found, 32, NULL, NULL, 0);
+        sf_preload_collect(prefix, &found);
+        ZEND_HASH_FOREACH_PTR(&found, ce) {
+            sf_preload_warm_class(c, ce, &warmed);
+            if (UNEXPECTED(EG(exception))) {
+                break;
+            }
+        } ZEND_HASH_FOREACH_END();
+        zend_hash_destroy(&found);
+        
+        if (UNEXPECTED(EG(exception))) {
+            return -1;
+        }
+    }
+    
+    if (sf_preloading()) {
+        sf_preload_keep(c);
+    }
+    return warmed;
+}
+
+/* ============================================================================
+ * Seeding
+ * ============================================================================ */
+
+void sf_preload_seed(sf_container *c)
+{
+    sf_container *t = sf_preload_template;
+    if (EXPECTED(!t) || c == t) {
+        return;
+    }
+    
+    /* Epoch 0: compared against the live class on first use */
+    sf_class_meta *meta;
+    ZEND_HASH_FOREACH_PTR(&t->reflection_cache, meta) {
+        if (!zend_hash_exists(&c->reflection_cache, meta->class_name)) {
+            sf_class_meta *copy = sf_class_meta_clone(meta, &c->arena);
+            zend_hash_add_new_ptr(&c->reflection_cache, copy->class_name, copy);
+        }
+    } ZEND_HASH_FOREACH_END();
+    
+    /* Autowired plans fit any graph until it binds a name they consulted */
+    sf_factory *factory;
+    ZEND_HASH_FOREACH_PTR(&t->compiled_factories, factory) {
+        if (!zend_hash_exists(&c->compiled_factories, factory->abstract)) {
+            sf_factory *copy = sf_factory_clone(factory, c->persistent);
+            copy->generation = c->generation;
+            zend_hash_add_new_ptr(&c->compiled_factories, copy->abstract, copy);
+        }
+    } ZEND_HASH_FOREACH_END();
+}
+
+void sf_preload_shutdown(void)
+{
+    if (sf_preload_template) {
+        sf_container_release(sf_preload_template);
+        sf_preload_template = NULL;
+    }
+}
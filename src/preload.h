@@ -0,0 +1,39 @@
+/*
+ * Signalforge Container Extension
+ * src/preload.h - Warm-up from an opcache.preload script
+ *
+ * Container::warmup() builds class metadata and compiled plans ahead of the
+ * first make(). Called while opcache preloads, it also keeps a copy in process
+ * memory that every container created afterwards starts from, so the analysis
+ * is paid once per server instead of once per request.
+ */
+
+#ifndef SF_PRELOAD_H
+#define SF_PRELOAD_H
+
+#include "php.h"
+
+/* Forward declarations */
+struct _sf_container;
+
+/* Is opcache running the preload script? */
+static zend_always_inline zend_bool sf_preloading(void)
+{
+    return (CG(compiler_options) & ZEND_COMPILE_PRELOAD) != 0;
+}
+
+/*
+ * Build metadata and plans for every class in `classes` (a list of names),
+ * or, if `classes` is NULL, for every user class declared so far whose name
+ * starts with `prefix`. Returns the number of classes warmed, or -1 with an
+ * exception.
+ */
+zend_long sf_preload_warmup(struct _sf_container *container, HashTable *classes, zend_string *prefix);
+
+/* Give a new container what the preload script warmed, if anything */
+void sf_preload_seed(struct _sf_container *container);
+
+/* MSHUTDOWN: free what the preload script warmed */
+void sf_preload_shutdown(void);
+
+#endif /* SF_PRELOAD_H */
@@ -10,37 +10,61 @@
  * Subsequent resolutions: ~nanoseconds (hash lookup)
  *
  * The cache is per-container, so it gets cleaned up when the container is
- * destroyed at request end.
+ * destroyed at request end. In persistent mode the container (and this cache)
+ * outlives the request; class entries are not, so entries are re-checked
+ * against the live class once per request (see sf_cache_matches).
  */
 
 #include "../php_signalforge_container.h"
 #include "reflection_cache.h"
+#include "preload.h"
 
-/* 
- * Create array of param_info structs.
- * Using ecalloc zeros memory, so we don't need explicit initialization.
+/*
+ * Parameter arrays, in one block: type hints and names (pointers first for
+ * alignment), then prop_nums, then the flag bytes.
  */
-sf_param_info *sf_param_info_create(uint32_t count)
+static zend_always_inline size_t sf_param_block_size(uint32_t count)
+{
+    return (size_t)count * (2 * sizeof(zend_string *) + sizeof(uint32_t) + sizeof(uint8_t));
+}
+
+void sf_class_meta_alloc_params(sf_class_meta *meta, uint32_t count)
+{
+    if (!count) return;
+    
+    char *block = sf_arena_calloc(meta->arena, sf_param_block_size(count));
+    
+    meta->param_count = count;
+    meta->param_types = (zend_string **)block;
+    meta->param_names = meta->param_types + count;
+    meta->prop_nums = (uint32_t *)(meta->param_names + count);
+    meta->param_flags = (uint8_t *)(meta->prop_nums + count);
+}
+
+void sf_class_meta_alloc_injects(sf_class_meta *meta)
 {
-    return count ? ecalloc(count, sizeof(sf_param_info)) : NULL;
+    meta->param_injects = sf_arena_calloc(meta->arena, sizeof(zend_string *) * meta->param_count);
 }
 
-void sf_param_info_destroy(sf_param_info *params, uint32_t count)
+static void sf_class_meta_free_params(sf_class_meta *meta)
 {
-    if (!params) return;
+    if (!meta->param_types) return;
     
-    for (uint32_t i = 0; i < count; i++) {
-        if (params[i].name) {
-            zend_string_release(params[i].name);
+    for (uint32_t i = 0; i < meta->param_count; i++) {
+        if (meta->param_names[i]) {
+            zend_string_release(meta->param_names[i]);
         }
-        if (params[i].type_hint) {
-            zend_string_release(params[i].type_hint);
+        if (meta->param_types[i]) {
+            zend_string_release(meta->param_types[i]);
         }
-        if (!Z_ISUNDEF(params[i].default_value)) {
-            zval_ptr_dtor(&params[i].default_value);
+        if (meta->param_injects && meta->param_injects[i]) {
+            zend_string_release(meta->param_injects[i]);
         }
     }
-    efree(params);
+    if (meta->param_injects) {
+        sf_arena_free(meta->arena, meta->param_injects, sizeof(zend_string *) * meta->param_count);
+    }
+    sf_arena_free(meta->arena, meta->param_types, sf_param_block_size(meta->param_count));
 }
 
 /* ============================================================================
@@ -50,15 +74,27 @@ void sf_param_info_destroy(sf_param_info *params, uint32_t count)
  * being used by autowiring simultaneously without copying or dangling pointers.
  * ============================================================================ */
 
-sf_class_meta *sf_class_meta_create(zend_string *class_name)
+sf_class_meta *sf_class_meta_create(zend_string *class_name, sf_arena *arena)
 {
-    sf_class_meta *meta = emalloc(sizeof(sf_class_meta));
+    sf_class_meta *meta = sf_arena_alloc(arena, sizeof(sf_class_meta));
     
-    meta->class_name = zend_string_copy(class_name);
+    meta->class_name = sf_string_intern_ex(class_name, arena->persistent);
     meta->param_count = 0;
-    meta->params = NULL;
+    meta->param_types = NULL;
+    meta->param_names = NULL;
+    meta->param_flags = NULL;
     meta->is_instantiable = 1;
+    meta->ctor_elidable = 0;
+    meta->epoch = 0;
+    meta->prop_nums = NULL;
+    meta->param_injects = NULL;
+    meta->bind_to = NULL;
+    meta->attributes = 0;
+    meta->preloaded = 0;
+    meta->arena = arena;
     meta->refcount = 1;
+    meta->resolving = 0;
+    meta->resolutions = 0;
     
     return meta;
 }
@@ -68,10 +104,47 @@ void sf_class_meta_destroy(sf_class_meta *meta)
     if (!meta) return;
     
     zend_string_release(meta->class_name);
-    if (meta->params) {
-        sf_param_info_destroy(meta->params, meta->param_count);
+    if (meta->bind_to) {
+        zend_string_release(meta->bind_to);
+    }
+    sf_class_meta_free_params(meta);
+    sf_arena_free(meta->arena, meta, sizeof(sf_class_meta));
+}
+
+sf_class_meta *sf_class_meta_clone(const sf_class_meta *meta, sf_arena *arena)
+{
+    zend_bool persistent = arena->persistent;
+    sf_class_meta *copy = sf_class_meta_create(meta->class_name, arena);
+    
+    copy->is_instantiable = meta->is_instantiable;
+    copy->ctor_elidable = meta->ctor_elidable;
+    copy->attributes = meta->attributes;
+    copy->preloaded = meta->preloaded;
+    if (meta->bind_to) {
+        copy->bind_to = sf_string_copy_ex(meta->bind_to, persistent);
+    }
+    
+    sf_class_meta_alloc_params(copy, meta->param_count);
+    if (!meta->prop_nums) {
+        copy->prop_nums = NULL;
     }
-    efree(meta);
+    if (meta->param_injects) {
+        sf_class_meta_alloc_injects(copy);
+    }
+    
+    for (uint32_t i = 0; i < meta->param_count; i++) {
+        copy->param_names[i] = sf_string_copy_ex(meta->param_names[i], persistent);
+        copy->param_types[i] = meta->param_types[i] ? sf_string_copy_ex(meta->param_types[i], persistent) : NULL;
+        copy->param_flags[i] = meta->param_flags[i];
+        if (copy->prop_nums) {
+            copy->prop_nums[i] = meta->prop_nums[i];
+        }
+        if (meta->param_injects && meta->param_injects[i]) {
+            copy->param_injects[i] = sf_string_copy_ex(meta->param_injects[i], persistent);
+        }
+    }
+    
+    return copy;
 }
 
 void sf_class_meta_addref(sf_class_meta *meta)
@@ -86,18 +159,196 @@ void sf_class_meta_release(sf_class_meta *meta)
     }
 }
 
+/* ============================================================================
+ * Constructor Elision
+ *
+ * A constructor like `__construct(private Logger $logger, private Db $db) {}`
+ * compiles to one RECV per parameter, one ASSIGN_OBJ per promoted property
+ * and a RETURN null. Calling it costs a VM frame per object for what amounts
+ * to a few property writes, so for such constructors we record where each
+ * parameter ends up and let the resolution paths write the properties
+ * directly after object_init_ex(). Anything else in the body - or anything
+ * we don't recognise - keeps the constructor call.
+ * ============================================================================ */
+
+static zend_always_inline zend_bool sf_ctor_is_filler(const zend_op *opline)
+{
+    return opline->opcode == ZEND_NOP || opline->opcode == ZEND_EXT_STMT || opline->opcode == ZEND_EXT_NOP;
+}
+
+/*
+ * Check the constructor of `ce` and fill `prop_nums` (one entry per
+ * parameter) with the property slot each parameter is assigned to.
+ * Returns 0 if the constructor must be called.
+ */
+static zend_bool sf_ctor_analyze(zend_class_entry *ce, zend_function *ctor, uint32_t *prop_nums)
+{
+    /* Declared in this class, so its promoted properties are ours */
+    if (ctor->type != ZEND_USER_FUNCTION || ctor->common.scope != ce
+        || (ctor->common.fn_flags & (ZEND_ACC_VARIADIC | ZEND_ACC_GENERATOR))) {
+        return 0;
+    }
+    
+    zend_op_array *op_array = &ctor->op_array;
+    uint32_t num_args = op_array->num_args;
+    const zend_op *opline = op_array->opcodes;
+    const zend_op *end = opline + op_array->last;
+    
+    for (uint32_t i = 0; i < num_args; i++) {
+        if (ZEND_ARG_SEND_MODE(&op_array->arg_info[i])) {
+            return 0;  /* By-reference parameter */
+        }
+        prop_nums[i] = SF_PROP_NONE;
+    }
+    
+    /* Parameter receives. A default that is an expression (e.g. `new Foo`) may have side effects */
+    while (opline < end && (opline->opcode == ZEND_RECV || opline->opcode == ZEND_RECV_INIT || sf_ctor_is_filler(opline))) {
+        if (opline->opcode == ZEND_RECV_INIT && Z_TYPE_P(RT_CONSTANT(opline, opline->op2)) == IS_CONSTANT_AST) {
+            return 0;
+        }
+        opline++;
+    }
+    
+    /* $this->param = $param for each promoted parameter */
+    while (opline < end && (opline->opcode == ZEND_ASSIGN_OBJ || sf_ctor_is_filler(opline))) {
+        if (sf_ctor_is_filler(opline)) {
+            opline++;
+            continue;
+        }
+        
+        const zend_op *data = opline + 1;
+        if (opline->op1_type != IS_UNUSED || opline->op2_type != IS_CONST
+            || data >= end || data->opcode != ZEND_OP_DATA || data->op1_type != IS_CV) {
+            return 0;
+        }
+        
+        uint32_t arg = EX_VAR_TO_NUM(data->op1.var);
+        zend_string *name = Z_STR_P(RT_CONSTANT(opline, opline->op2));
+        zend_property_info *prop = zend_hash_find_ptr(&ce->properties_info, name);
+        
+        if (arg >= num_args || !prop || prop->ce != ce
+            || !(prop->flags & ZEND_ACC_PROMOTED) || (prop->flags & ZEND_ACC_STATIC)
+            || !zend_string_equals(name, op_array->arg_info[arg].name)) {
+            return 0;
+        }
+#if PHP_VERSION_ID >= 80400
+        if (prop->hooks) {
+            return 0;
+        }
+#endif
+        
+        prop_nums[arg] = OBJ_PROP_TO_NUM(prop->offset);
+        opline += 2;
+    }
+    
+    while (opline < end && sf_ctor_is_filler(opline)) {
+        opline++;
+    }
+    
+    /* Nothing else but the implicit return */
+    return opline < end && opline->opcode == ZEND_RETURN && opline->op1_type == IS_CONST
+        && Z_TYPE_P(RT_CONSTANT(opline, opline->op1)) == IS_NULL;
+}
+
+/* ============================================================================
+ * Attributes
+ *
+ * #[Singleton] and #[Bind] on the class and #[Inject] on constructor
+ * parameters are read here, once, with the rest of the metadata - resolution
+ * tests a field instead of looking at attributes. Arguments that aren't
+ * strings are ignored, as PHP itself ignores attributes nobody instantiates.
+ * An argument that throws (an undefined constant, say) leaves the exception
+ * pending; the metadata build fails with it.
+ * ============================================================================ */
+
+zend_string *sf_attribute_string(zend_attribute *attribute, zend_class_entry *scope)
+{
+    zval value;
+    
+    if (!attribute || attribute->argc < 1 || zend_get_attribute_value(&value, attribute, 0, scope) == FAILURE) {
+        return NULL;
+    }
+    if (Z_TYPE(value) != IS_STRING) {
+        zval_ptr_dtor(&value);
+        return NULL;
+    }
+    return Z_STR(value);
+}
+
+static uint8_t sf_class_attributes(zend_class_entry *ce)
+{
+    return zend_get_attribute_str(ce->attributes, ZEND_STRL(SF_ATTR_NAME_SINGLETON)) ? SF_ATTR_SINGLETON : 0;
+}
+
+/* #[Bind] implementation of `ce` (new reference), or NULL. Binding a class to itself is no binding */
+static zend_string *sf_class_bind_to(zend_class_entry *ce)
+{
+    zend_string *bind_to = sf_attribute_string(zend_get_attribute_str(ce->attributes, ZEND_STRL(SF_ATTR_NAME_BIND)), ce);
+    
+    if (bind_to && zend_string_equals_ci(bind_to, ce->name)) {
+        zend_string_release(bind_to);
+        return NULL;
+    }
+    return bind_to;
+}
+
+/* #[Inject] key of constructor parameter `i` (new reference), or NULL */
+static zend_string *sf_param_inject(zend_function *ctor, uint32_t i)
+{
+    zend_attribute *inject = zend_get_parameter_attribute_str(ctor->common.attributes, ZEND_STRL(SF_ATTR_NAME_INJECT), i);
+    return sf_attribute_string(inject, ctor->common.scope);
+}
+
+static zend_bool sf_class_attributes_match(sf_class_meta *meta, zend_class_entry *ce)
+{
+    if (EXPECTED(!ce->attributes)) {
+        return meta->attributes == 0 && !meta->bind_to;
+    }
+    
+    zend_string *bind_to = sf_class_bind_to(ce);
+    if (UNEXPECTED(EG(exception))) {
+        return 0;
+    }
+    
+    zend_bool same = meta->attributes == sf_class_attributes(ce)
+        && (bind_to ? meta->bind_to && zend_string_equals(bind_to, meta->bind_to) : !meta->bind_to);
+    
+    if (bind_to) {
+        zend_string_release(bind_to);
+    }
+    return same;
+}
+
 /*
  * Build metadata by inspecting the class's constructor.
  *
  * We use Zend's internal structures directly (zend_function, zend_arg_info)
  * instead of PHP's Reflection classes. This is faster and avoids userland
- * object creation overhead.
+ * object creation overhead. Returns NULL, with the exception pending, if an
+ * attribute argument throws.
  */
-sf_class_meta *sf_cache_build(zend_string *class_name, zend_class_entry *ce)
+sf_class_meta *sf_cache_build(zend_string *class_name, zend_class_entry *ce, sf_arena *arena)
 {
     if (!ce) return NULL;
     
-    sf_class_meta *meta = sf_class_meta_create(class_name);
+    zend_bool persistent = arena->persistent;
+    sf_class_meta *meta = sf_class_meta_create(class_name, arena);
+    
+    meta->preloaded = sf_preloading();
+    
+    /* Before the instantiable check - #[Bind] mostly sits on interfaces */
+    if (UNEXPECTED(ce->attributes)) {
+        zend_string *bind_to = sf_class_bind_to(ce);
+        
+        meta->attributes = sf_class_attributes(ce);
+        if (bind_to) {
+            meta->bind_to = sf_string_copy_ex(bind_to, persistent);
+            zend_string_release(bind_to);
+        } else if (UNEXPECTED(EG(exception))) {
+            sf_class_meta_release(meta);
+            return NULL;
+        }
+    }
     
     /* Interfaces, abstract classes, and traits can't be instantiated */
     if (ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT)) {
@@ -112,49 +363,158 @@ sf_class_meta *sf_cache_build(zend_string *class_name, zend_class_entry *ce)
     uint32_t num_args = ctor->common.num_args;
     uint32_t required = ctor->common.required_num_args;
     
-    if (num_args == 0) return meta;
+    if (num_args == 0) {
+        uint32_t none;
+        meta->ctor_elidable = sf_ctor_analyze(ce, ctor, &none);
+        return meta;
+    }
     
-    meta->param_count = num_args;
-    meta->params = sf_param_info_create(num_args);
+    sf_class_meta_alloc_params(meta, num_args);
+    
+    meta->ctor_elidable = sf_ctor_analyze(ce, ctor, meta->prop_nums);
+    if (!meta->ctor_elidable) {
+        meta->prop_nums = NULL;
+    }
     
     /*
      * Walk through each parameter and extract:
      * - Name (for matching user-provided params)
      * - Type hint class name (for container resolution)
      * - Whether nullable or optional
+     *
+     * Optional parameters only get SF_PARAM_DEFAULT, not their value. The
+     * autowire code doesn't pass arguments for trailing optional parameters,
+     * allowing PHP to use its own defaults - cleaner than extracting them from
+     * op_array internals, which vary between PHP versions.
      */
     for (uint32_t i = 0; i < num_args; i++) {
         zend_arg_info *arg = &ctor->common.arg_info[i];
-        sf_param_info *p = &meta->params[i];
+        uint8_t flags = 0;
         
-        p->name = zend_string_copy(arg->name);
+        meta->param_names[i] = sf_string_copy_ex(arg->name, persistent);
         
         /* Extract class type hint if present */
         if (ZEND_TYPE_IS_SET(arg->type)) {
             if (ZEND_TYPE_HAS_NAME(arg->type)) {
-                p->type_hint = zend_string_copy(ZEND_TYPE_NAME(arg->type));
+                meta->param_types[i] = sf_string_copy_ex(ZEND_TYPE_NAME(arg->type), persistent);
+            }
+            if (ZEND_TYPE_ALLOW_NULL(arg->type)) {
+                flags |= SF_PARAM_NULLABLE;
             }
-            p->is_nullable = ZEND_TYPE_ALLOW_NULL(arg->type);
         }
         
         /* Optional parameters (those beyond required_num_args) have defaults */
-        p->has_default = (i >= required);
-        p->is_variadic = ZEND_ARG_IS_VARIADIC(arg);
+        if (i >= required) {
+            flags |= SF_PARAM_DEFAULT;
+        }
+        if (ZEND_ARG_IS_VARIADIC(arg)) {
+            flags |= SF_PARAM_VARIADIC;
+        }
+        meta->param_flags[i] = flags;
         
-        /*
-         * For default values: we mark has_default=true but leave default_value
-         * as UNDEF. The autowire code will handle this by not passing arguments
-         * for trailing optional parameters, allowing PHP to use its own defaults.
-         * 
-         * This is cleaner than trying to extract defaults from op_array internals
-         * which varies between PHP versions and involves parsing opcodes.
-         */
-        ZVAL_UNDEF(&p->default_value);
+        /* #[Inject('key')] - resolved by that key instead of the type */
+        zend_string *inject = UNEXPECTED(ctor->common.attributes) ? sf_param_inject(ctor, i) : NULL;
+        if (UNEXPECTED(inject)) {
+            if (!meta->param_injects) {
+                sf_class_meta_alloc_injects(meta);
+            }
+            meta->param_injects[i] = sf_string_copy_ex(inject, persistent);
+            zend_string_release(inject);
+        } else if (UNEXPECTED(EG(exception))) {
+            sf_class_meta_release(meta);
+            return NULL;
+        }
     }
     
     return meta;
 }
 
+/*
+ * Check that cached metadata still describes the given class entry.
+ *
+ * Persistent containers keep metadata across requests, but the class entry it
+ * was built from may be gone (opcache reset, file changed and recompiled, or
+ * simply a new request without opcache). We never dereference the old entry;
+ * instead the live one is compared field by field with what we cached. An
+ * attribute argument that throws is a mismatch, with the exception pending.
+ */
+zend_bool sf_cache_matches(sf_class_meta *meta, zend_class_entry *ce)
+{
+    /* Preloaded classes are immutable until the server restarts - and so is metadata built from them */
+    if (meta->preloaded && (ce->ce_flags & ZEND_ACC_PRELOADED)) {
+        return 1;
+    }
+    
+    zend_bool instantiable = !(ce->ce_flags & (ZEND_ACC_INTERFACE | ZEND_ACC_ABSTRACT | ZEND_ACC_TRAIT));
+    if (meta->is_instantiable != instantiable || !sf_class_attributes_match(meta, ce)) {
+        return 0;
+    }
+    if (!instantiable) {
+        return 1;
+    }
+    
+    zend_function *ctor = ce->constructor;
+    uint32_t num_args = ctor ? ctor->common.num_args : 0;
+    if (meta->param_count != num_args) {
+        return 0;
+    }
+    
+    uint32_t required = num_args ? ctor->common.required_num_args : 0;
+    for (uint32_t i = 0; i < num_args; i++) {
+        zend_arg_info *arg = &ctor->common.arg_info[i];
+        zend_string *cached = meta->param_types[i];
+        zend_string *type_hint = NULL;
+        uint8_t flags = 0;
+        
+        if (ZEND_TYPE_IS_SET(arg->type)) {
+            if (ZEND_TYPE_HAS_NAME(arg->type)) {
+                type_hint = ZEND_TYPE_NAME(arg->type);
+            }
+            if (ZEND_TYPE_ALLOW_NULL(arg->type)) {
+                flags |= SF_PARAM_NULLABLE;
+            }
+        }
+        if (i >= required) {
+            flags |= SF_PARAM_DEFAULT;
+        }
+        if (ZEND_ARG_IS_VARIADIC(arg)) {
+            flags |= SF_PARAM_VARIADIC;
+        }
+        
+        zend_string *inject = UNEXPECTED(ctor->common.attributes) ? sf_param_inject(ctor, i) : NULL;
+        zend_string *cached_inject = meta->param_injects ? meta->param_injects[i] : NULL;
+        zend_bool same_inject = inject ? cached_inject && zend_string_equals(inject, cached_inject) : !cached_inject;
+        if (inject) {
+            zend_string_release(inject);
+        } else if (UNEXPECTED(EG(exception))) {
+            return 0;
+        }
+        
+        if (!zend_string_equals(meta->param_names[i], arg->name)
+            || (cached == NULL) != (type_hint == NULL)
+            || (type_hint && !zend_string_equals(cached, type_hint))
+            || meta->param_flags[i] != flags || !same_inject) {
+            return 0;
+        }
+    }
+    
+    /* Same signature, but the body or the property layout may have changed */
+    if (ctor) {
+        uint32_t nums_stack[16];
+        uint32_t *nums = num_args > 16 ? emalloc(sizeof(uint32_t) * num_args) : nums_stack;
+        zend_bool elidable = sf_ctor_analyze(ce, ctor, nums);
+        zend_bool same = elidable == meta->ctor_elidable
+            && (!elidable || num_args == 0 || memcmp(nums, meta->prop_nums, sizeof(uint32_t) * num_args) == 0);
+        
+        if (nums != nums_stack) {
+            efree(nums);
+        }
+        return same;
+    }
+    
+    return !meta->ctor_elidable;
+}
+
 /* ============================================================================
  * Cache Operations
  *
@@ -175,8 +535,11 @@ void sf_cache_put(zend_string *class_name, sf_class_meta *meta, HashTable *cache
 {
     if (!meta) return;
     
+    /* Key with the meta's own copy - it's persistent when the cache is */
     sf_class_meta_addref(meta);  /* Cache holds a reference */
-    zend_hash_add_ptr(cache, class_name, meta);
+    if (!zend_hash_add_ptr(cache, meta->class_name, meta)) {
+        sf_class_meta_release(meta);
+    }
 }
 
 void sf_cache_clear(HashTable *cache)
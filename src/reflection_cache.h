@@ -6,49 +6,95 @@
 #ifndef SF_REFLECTION_CACHE_H
 #define SF_REFLECTION_CACHE_H
 
-/* Metadata about a single constructor parameter
- * Layout optimized for cache efficiency (hot fields first) */
-struct _sf_param_info {
-    /* Hot fields (accessed during autowiring) */
-    zend_string *type_hint;   /* Class/interface name (NULL for scalars) */
-    zend_string *name;        /* Parameter name (for matching user params) */
-    zval default_value;       /* The default value */
-    
-    /* Cold fields (flags checked less frequently) */
-    zend_bool is_nullable;    /* Accepts null? */
-    zend_bool has_default;    /* Has default value? */
-    zend_bool is_variadic;    /* Is ...$param? */
-    uint8_t _padding[5];      /* Align to 8 bytes */
-} __attribute__((aligned(8)));
+#include "arena.h"
+
+/* prop_nums entry for a parameter that isn't copied into a property */
+#define SF_PROP_NONE ((uint32_t)-1)
+
+/* Per-parameter flags (sf_class_meta.param_flags) */
+#define SF_PARAM_NULLABLE  0x01  /* Accepts null? */
+#define SF_PARAM_DEFAULT   0x02  /* Has default value? */
+#define SF_PARAM_VARIADIC  0x04  /* Is ...$param? */
+
+/* Class attributes (sf_class_meta.attributes) */
+#define SF_ATTR_SINGLETON  0x01  /* #[Singleton] */
+
+/* Lowercased attribute class names, as Zend stores them */
+#define SF_ATTR_NAME_SINGLETON "signalforge\\container\\attributes\\singleton"
+#define SF_ATTR_NAME_BIND      "signalforge\\container\\attributes\\bind"
+#define SF_ATTR_NAME_INJECT    "signalforge\\container\\attributes\\inject"
+#define SF_ATTR_NAME_TAG       "signalforge\\container\\attributes\\tag"
 
 /* Cached constructor metadata for a class
- * Layout optimized for cache line alignment (hot fields first) */
+ * Parameters are stored as parallel arrays carved from one arena block, so
+ * autowiring walks the type hints and flags without pulling the names (only
+ * needed for user-provided parameters and error messages) into cache. */
 struct _sf_class_meta {
-    /* Hot fields (accessed during every autowire) - first cache line */
+    /* Hot fields (accessed during every autowire) */
     zend_string *class_name;    /* FQCN */
-    sf_param_info *params;      /* Array of parameter metadata */
+    zend_string **param_types;  /* Class/interface name per param (NULL for scalars) */
+    uint8_t *param_flags;       /* SF_PARAM_* per param */
     uint32_t param_count;       /* Number of constructor params */
     zend_bool is_instantiable;  /* Can we new this? (not interface/abstract) */
+    zend_bool ctor_elidable;    /* Constructor only assigns promoted properties - no call needed */
+    uint32_t epoch;             /* Container epoch this was last validated in */
+    uint32_t *prop_nums;        /* Elidable: property slot each param is stored in (SF_PROP_NONE = dropped) */
+    zend_string **param_injects; /* #[Inject] key per param (NULL = by type); NULL if no param has one */
     
     /* Cold fields */
+    zend_string *bind_to;       /* #[Bind] implementation (NULL = none) */
+    uint8_t attributes;         /* SF_ATTR_* */
+    zend_bool preloaded;        /* Built while opcache preloaded the class - see sf_cache_matches */
+    zend_string **param_names;  /* Parameter name per param (for matching user params) */
     uint32_t refcount;
-    uint8_t _padding[3];        /* Align to 8 bytes */
-} __attribute__((aligned(64)));
+    uint32_t resolving;         /* Resolution stack depth + 1 when last entered (cycle detection) */
+    uint32_t resolutions;       /* Autowired outside a plan (tiered compilation) */
+    sf_arena *arena;            /* Owning container's arena */
+};
 
 /* Cache operations */
 sf_class_meta *sf_cache_get(zend_string *class_name, HashTable *cache);
 void sf_cache_put(zend_string *class_name, sf_class_meta *meta, HashTable *cache);
-sf_class_meta *sf_cache_build(zend_string *class_name, zend_class_entry *ce);
+sf_class_meta *sf_cache_build(zend_string *class_name, zend_class_entry *ce, sf_arena *arena);
+zend_bool sf_cache_matches(sf_class_meta *meta, zend_class_entry *ce);
 void sf_cache_clear(HashTable *cache);
 
 /* Class metadata lifecycle */
-sf_class_meta *sf_class_meta_create(zend_string *class_name);
+sf_class_meta *sf_class_meta_create(zend_string *class_name, sf_arena *arena);
 void sf_class_meta_destroy(sf_class_meta *meta);
 void sf_class_meta_addref(sf_class_meta *meta);
 void sf_class_meta_release(sf_class_meta *meta);
 
-/* Parameter info helpers */
-sf_param_info *sf_param_info_create(uint32_t count);
-void sf_param_info_destroy(sf_param_info *params, uint32_t count);
+/* Copy of `meta` allocated in `arena` (Container::warmup() seeds) */
+sf_class_meta *sf_class_meta_clone(const sf_class_meta *meta, sf_arena *arena);
+
+/* Allocate the (zeroed) parameter arrays of a fresh meta. prop_nums starts
+ * out pointing at its storage; clear it if the constructor isn't elidable. */
+void sf_class_meta_alloc_params(sf_class_meta *meta, uint32_t count);
+
+/* Allocate the (zeroed) param_injects array, once the params are allocated */
+void sf_class_meta_alloc_injects(sf_class_meta *meta);
+
+/* Container key parameter `i` resolves from: its #[Inject] key, else its class type */
+static zend_always_inline zend_string *sf_class_meta_dep(const sf_class_meta *meta, uint32_t i)
+{
+    if (UNEXPECTED(meta->param_injects) && meta->param_injects[i]) {
+        return meta->param_injects[i];
+    }
+    return meta->param_types[i];
+}
+
+/* Does make() of the unbound class register a binding first (#[Singleton], #[Bind])? */
+static zend_always_inline zend_bool sf_class_meta_binds(const sf_class_meta *meta)
+{
+    return meta->bind_to != NULL || (meta->attributes & SF_ATTR_SINGLETON);
+}
+
+/*
+ * First argument of an attribute as a string (new reference), or NULL if it
+ * has none or it isn't a string. Constant expressions are evaluated in
+ * `scope`; if that throws, the exception is left pending.
+ */
+zend_string *sf_attribute_string(zend_attribute *attribute, zend_class_entry *scope);
 
 #endif /* SF_REFLECTION_CACHE_H */
@@ -0,0 +1,95 @@
+/*
+ * Signalforge Container Extension
+ * src/scope.c - Child scopes for scoped services
+ *
+ * Long-running workers want one warm container for thousands of requests:
+ * bindings, reflection metadata, compiled plans and process-wide singletons
+ * stay, while everything that belongs to one request goes away when it ends.
+ * A scope is that request. It only holds the scoped instances created in it
+ * (in a small singleton-store style table), chained to its parent so nested
+ * scopes see the instances of the scopes around them.
+ *
+ * Scoped instances never enter the container's singleton store, and compiled
+ * plans and call-site slots always go through make() for scoped services, so
+ * opening and closing a scope invalidates nothing: ending one is just
+ * releasing its own table.
+ *
+ * Scopes are request state - any still open at request shutdown are closed.
+ */
+
+#include "../php_signalforge_container.h"
+#include "scope.h"
+#include "container.h"
+
+/* Scoped instances per request are usually few - start with one group */
+#define SF_SCOPE_SLOTS 16
+
+void sf_scope_begin(sf_container *c)
+{
+    sf_scope *scope = emalloc(sizeof(sf_scope));
+    
+    scope->parent = c->scope;
+    scope->instances = NULL;
+    c->scope = scope;
+}
+
+int sf_scope_end(sf_container *c)
+{
+    sf_scope *scope = c->scope;
+    if (!scope) {
+        return FAILURE;
+    }
+    
+    /* Unlink first - destructors of scoped instances may resolve services */
+    c->scope = scope->parent;
+    sf_fast_lookup_destroy(scope->instances);
+    efree(scope);
+    return SUCCESS;
+}
+
+void sf_scope_end_all(sf_container *c)
+{
+    while (sf_scope_end(c) == SUCCESS);
+}
+
+zval *sf_scope_find(sf_container *c, zend_string *abstract)
+{
+    for (sf_scope *scope = c->scope; scope; scope = scope->parent) {
+        zval *found = scope->instances ? sf_fast_lookup_find(scope->instances, abstract) : NULL;
+        if (found) {
+            return found;
+        }
+    }
+    return NULL;
+}
+
+int sf_scope_store(sf_container *c, zend_string *abstract, zval *value)
+{
+    sf_scope *scope = c->scope;
+    if (!scope) {
+        return FAILURE;
+    }
+    
+    if (!scope->instances) {
+        scope->instances = sf_fast_lookup_create(SF_SCOPE_SLOTS);
+    }
+    return sf_fast_lookup_insert(scope->instances, abstract, value);
+}
+
+void sf_scope_forget(sf_container *c, zend_string *abstract)
+{
+    for (sf_scope *scope = c->scope; scope; scope = scope->parent) {
+        if (scope->instances) {
+            sf_fast_lookup_remove(scope->instances, abstract);
+        }
+    }
+}
+
+void sf_scope_forget_all(sf_container *c)
+{
+    for (sf_scope *scope = c->scope; scope; scope = scope->parent) {
+        if (scope->instances) {
+            sf_fast_lookup_clear(scope->instances);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Signalforge Container Extension
+ * src/scope.h - Child scopes for scoped services
+ *
+ * Container::beginScope() opens a child scope over the container's graph.
+ * Services bound with Container::scoped() get one instance per scope, and
+ * instance() of a scoped abstract inside a scope overrides it for that scope
+ * only. The graph itself is never touched, so ending a scope costs only its
+ * own scoped instances.
+ */
+
+#ifndef SF_SCOPE_H
+#define SF_SCOPE_H
+
+#include "fast_lookup.h"
+
+/* Forward declarations */
+struct _sf_container;
+
+typedef struct _sf_scope {
+    struct _sf_scope *parent;         /* Enclosing scope (NULL = outermost) */
+    sf_fast_lookup *instances;        /* abstract => scoped instance (NULL until the first one) */
+} sf_scope;
+
+/* Open a scope inside the current one */
+void sf_scope_begin(struct _sf_container *container);
+
+/* Close the innermost scope, releasing its instances (FAILURE = no scope open) */
+int sf_scope_end(struct _sf_container *container);
+
+/* Close every open scope (request shutdown) */
+void sf_scope_end_all(struct _sf_container *container);
+
+/* Scoped instance of `abstract`, innermost scope first (NULL = none yet) */
+zval *sf_scope_find(struct _sf_container *container, zend_string *abstract);
+
+/* Store a scoped instance in the innermost scope */
+int sf_scope_store(struct _sf_container *container, zend_string *abstract, zval *value);
+
+/* Drop one scoped instance, or all of them, from every open scope */
+void sf_scope_forget(struct _sf_container *container, zend_string *abstract);
+void sf_scope_forget_all(struct _sf_container *container);
+
+#endif /* SF_SCOPE_H */
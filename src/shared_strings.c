@@ -0,0 +1,90 @@
+/*
+ * Signalforge Container Extension
+ * src/shared_strings.c - Process-wide immutable strings for persistent graphs
+ *
+ * A plain HashTable in process memory, keyed by the shared strings
+ * themselves. Lookups only happen when a graph copies a name it does not
+ * share yet (registration, metadata builds, snapshot imports), never on the
+ * resolution path, so under ZTS a single mutex is enough.
+ */
+
+#include "../php_signalforge_container.h"
+#include "shared_strings.h"
+
+static HashTable sf_shared_strings;
+static uint32_t sf_shared_strings_users = 0;
+
+#ifdef ZTS
+static MUTEX_T sf_shared_strings_mutex = NULL;
+#   define SF_STRINGS_LOCK()   tsrm_mutex_lock(sf_shared_strings_mutex)
+#   define SF_STRINGS_UNLOCK() tsrm_mutex_unlock(sf_shared_strings_mutex)
+#else
+#   define SF_STRINGS_LOCK()
+#   define SF_STRINGS_UNLOCK()
+#endif
+
+/*
+ * The first GINIT runs during module startup, before any other thread
+ * exists, so creating the mutex here is not racy.
+ */
+void sf_strings_acquire(void)
+{
+#ifdef ZTS
+    if (!sf_shared_strings_mutex) {
+        sf_shared_strings_mutex = tsrm_mutex_alloc();
+    }
+#endif
+    
+    SF_STRINGS_LOCK();
+    if (sf_shared_strings_users++ == 0) {
+        zend_hash_init(&sf_shared_strings, 64, NULL, NULL, 1);
+    }
+    SF_STRINGS_UNLOCK();
+}
+
+void sf_strings_release(void)
+{
+    SF_STRINGS_LOCK();
+    zend_bool last = --sf_shared_strings_users == 0;
+    if (last) {
+        zend_string *s;
+        ZEND_HASH_FOREACH_PTR(&sf_shared_strings, s) {
+            pefree(s, 1);
+        } ZEND_HASH_FOREACH_END();
+        zend_hash_destroy(&sf_shared_strings);
+    }
+    SF_STRINGS_UNLOCK();
+    
+#ifdef ZTS
+    if (last) {
+        tsrm_mutex_free(sf_shared_strings_mutex);
+        sf_shared_strings_mutex = NULL;
+    }
+#endif
+}
+
+zend_string *sf_string_share(const char *str, size_t len)
+{
+    SF_STRINGS_LOCK();
+    
+    zend_string *s = zend_hash_str_find_ptr(&sf_shared_strings, str, len);
+    if (!s) {
+        s = zend_string_init(str, len, 1);
+        zend_string_hash_val(s);
+        
+        /* Interned: refcounting is skipped, the table owns the memory */
+        GC_ADD_FLAGS(s, IS_STR_INTERNED | IS_STR_PERMANENT);
+        zend_hash_add_new_ptr(&sf_shared_strings, s, s);
+    }
+    
+    SF_STRINGS_UNLOCK();
+    return s;
+}
+
+uint32_t sf_strings_count(void)
+{
+    SF_STRINGS_LOCK();
+    uint32_t count = sf_shared_strings_users ? zend_hash_num_elements(&sf_shared_strings) : 0;
+    SF_STRINGS_UNLOCK();
+    return count;
+}
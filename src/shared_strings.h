@@ -0,0 +1,32 @@
+/*
+ * Signalforge Container Extension
+ * src/shared_strings.h - Process-wide immutable strings for persistent graphs
+ *
+ * Persistent container graphs are mostly names: abstracts, class names,
+ * parameter names and type hints, repeated across bindings, metadata and
+ * compiled plans. Instead of every graph (one per thread under ZTS) keeping
+ * its own copies, sf_string_share() hands out one immutable copy per distinct
+ * name for the whole process. Shared strings are flagged interned, so the
+ * engine never touches their refcount and threads can read them without
+ * synchronisation.
+ *
+ * The table lives as long as the last module globals that may reference it:
+ * it is created by the first GINIT and freed by the last GSHUTDOWN.
+ */
+
+#ifndef SF_SHARED_STRINGS_H
+#define SF_SHARED_STRINGS_H
+
+#include "php.h"
+
+/* Module globals lifecycle - one call per GINIT/GSHUTDOWN */
+void sf_strings_acquire(void);
+void sf_strings_release(void);
+
+/* The shared copy of `str` (hash precomputed, never freed before shutdown) */
+zend_string *sf_string_share(const char *str, size_t len);
+
+/* Distinct shared strings, for phpinfo() */
+uint32_t sf_strings_count(void);
+
+#endif /* SF_SHARED_STRINGS_H */
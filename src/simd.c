@@ -0,0 +1,158 @@
+/*
+ * Signalforge Container Extension
+ * src/simd.c - Runtime SIMD kernel selection
+ *
+ * Distro builds target baseline x86-64, so the compile-time helpers in simd.h
+ * stop at SSE2. The CPU is checked once at MINIT and the widest supported
+ * kernel set is published in sf_simd_active; the fast lookup table picks its
+ * matching group kernels in sf_fast_lookup_startup().
+ */
+
+#include "../php_signalforge_container.h"
+#include "simd.h"
+#include "fast_lookup.h"
+
+/* ============================================================================
+ * 32-bit Search Kernels (resolution-context hash scan)
+ * ============================================================================ */
+
+static uint32_t sf_find_u32_scalar(const uint32_t *values, uint32_t count, uint32_t needle, uint32_t from)
+{
+    for (; from < count; from++) {
+        if (values[from] == needle) {
+            break;
+        }
+    }
+    return from;
+}
+
+#if SF_HAS_SIMD
+/* 4 lanes per compare */
+static uint32_t sf_find_u32_native(const uint32_t *values, uint32_t count, uint32_t needle, uint32_t from)
+{
+    sf_simd_i32x4 target = sf_simd_set1_i32(needle);
+    
+    for (; from + 4 <= count; from += 4) {
+        uint32_t mask = sf_simd_movemask_i32(sf_simd_cmpeq_i32(sf_simd_loadu_i32x4(&values[from]), target));
+        if (UNEXPECTED(mask != 0)) {
+            /* 4 mask bits per lane */
+            return from + (uint32_t)(sf_simd_ctz(mask) >> 2);
+        }
+    }
+    
+    return sf_find_u32_scalar(values, count, needle, from);
+}
+#endif
+
+#if SF_SIMD_DISPATCH
+/* 8 lanes per compare */
+static SF_TARGET_AVX2 uint32_t sf_find_u32_avx2(const uint32_t *values, uint32_t count, uint32_t needle, uint32_t from)
+{
+    __m256i target = _mm256_set1_epi32((int)needle);
+    
+    for (; from + 8 <= count; from += 8) {
+        __m256i cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)&values[from]), target);
+        uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+        if (UNEXPECTED(mask != 0)) {
+            return from + (uint32_t)sf_simd_ctz(mask);
+        }
+    }
+    
+    return sf_find_u32_scalar(values, count, needle, from);
+}
+
+/* 16 lanes per compare; the tail is a masked load instead of a scalar loop */
+static SF_TARGET_AVX512 uint32_t sf_find_u32_avx512(const uint32_t *values, uint32_t count, uint32_t needle, uint32_t from)
+{
+    __m512i target = _mm512_set1_epi32((int)needle);
+    
+    while (from < count) {
+        uint32_t left = count - from;
+        __mmask16 lanes = left >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1U << left) - 1);
+        __m512i chunk = _mm512_maskz_loadu_epi32(lanes, &values[from]);
+        uint32_t mask = (uint32_t)_mm512_mask_cmpeq_epi32_mask(lanes, chunk, target);
+        if (UNEXPECTED(mask != 0)) {
+            return from + (uint32_t)sf_simd_ctz(mask);
+        }
+        from += 16;
+    }
+    
+    return count;
+}
+#endif
+
+/* ============================================================================
+ * Selection
+ * ============================================================================ */
+
+/* Scalar until MINIT has looked at the CPU - always safe to run */
+sf_simd_kernels sf_simd_active = { SF_SIMD_SCALAR, "Scalar", 16, sf_find_u32_scalar };
+
+static const sf_simd_kernels sf_simd_kernel_sets[] = {
+    { SF_SIMD_SCALAR, "Scalar", 16, sf_find_u32_scalar },
+#if SF_HAS_SIMD
+    { SF_SIMD_NATIVE, SF_SIMD_PLATFORM, 16, sf_find_u32_native },
+#endif
+#if SF_SIMD_DISPATCH
+    { SF_SIMD_AVX2, "AVX2", 32, sf_find_u32_avx2 },
+    { SF_SIMD_AVX512, "AVX-512", 64, sf_find_u32_avx512 },
+#endif
+};
+
+/* Widest level this CPU can run */
+static sf_simd_level sf_simd_detect(void)
+{
+#if SF_SIMD_DISPATCH
+    /* Checks CPUID and that the OS saves the wider registers (XGETBV) */
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SF_SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SF_SIMD_AVX2;
+    }
+#endif
+#if SF_HAS_SIMD
+    /* SSE2 is part of x86-64 and NEON of AArch64 - nothing to probe */
+    return SF_SIMD_NATIVE;
+#else
+    return SF_SIMD_SCALAR;
+#endif
+}
+
+/* Level named by the INI value; unknown names mean "auto" */
+static sf_simd_level sf_simd_requested(const char *request)
+{
+    if (!request || !*request || strcasecmp(request, "auto") == 0) {
+        return SF_SIMD_AVX512;
+    }
+    if (strcasecmp(request, "scalar") == 0) {
+        return SF_SIMD_SCALAR;
+    }
+    if (strcasecmp(request, SF_SIMD_PLATFORM) == 0) {
+        return SF_SIMD_NATIVE;
+    }
+    if (strcasecmp(request, "avx2") == 0) {
+        return SF_SIMD_AVX2;
+    }
+    return SF_SIMD_AVX512;
+}
+
+void sf_simd_startup(const char *request)
+{
+    sf_simd_level level = sf_simd_detect();
+    sf_simd_level cap = sf_simd_requested(request);
+    
+    if (cap < level) {
+        level = cap;
+    }
+    
+    /* Sets are in level order; the widest one not above the target wins */
+    for (size_t i = 0; i < sizeof(sf_simd_kernel_sets) / sizeof(sf_simd_kernel_sets[0]); i++) {
+        if (sf_simd_kernel_sets[i].level <= level) {
+            sf_simd_active = sf_simd_kernel_sets[i];
+        }
+    }
+    
+    sf_fast_lookup_startup();
+}
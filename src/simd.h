@@ -6,6 +6,11 @@
  * - x86_64: SSE2 (universally available since ~2003)
  * - ARM64: NEON (Apple Silicon, ARM servers)
  * - Fallback: Scalar implementation for unsupported platforms
+ *
+ * The 128-bit helpers below are fixed when the extension is compiled. On top
+ * of them, sf_simd_startup() picks a kernel set once at MINIT from what the CPU
+ * actually supports, so a baseline x86-64 build still uses AVX2 or AVX-512
+ * where the hardware has it.
  */
 
 #ifndef SF_SIMD_H
@@ -41,6 +46,19 @@
     #define SF_SIMD_PLATFORM "Scalar"
 #endif
 
+/*
+ * Wider x86 kernels are compiled per function with target attributes and only
+ * called after the CPU has been checked, so they don't need -mavx2 builds.
+ */
+#if SF_HAS_SIMD && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define SF_SIMD_DISPATCH 1
+    #define SF_TARGET_AVX2   __attribute__((target("avx2")))
+    #define SF_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+    #define SF_SIMD_DISPATCH 0
+#endif
+
 /* ============================================================================
  * SIMD Vector Types
  * ============================================================================ */
@@ -313,4 +331,58 @@ static inline int sf_simd_ctz(uint32_t mask)
 #endif
 }
 
+/**
+ * Count trailing zeros in a 64-bit bitmask (control-byte groups up to 64 wide)
+ */
+static inline int sf_simd_ctz64(uint64_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    int count = 0;
+    if (mask == 0) return 64;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/* ============================================================================
+ * Runtime Dispatch
+ * ============================================================================ */
+
+/* Kernel sets, narrowest first */
+typedef enum {
+    SF_SIMD_SCALAR = 0,
+    SF_SIMD_NATIVE,     /* The 128-bit helpers above (SF_SIMD_PLATFORM) */
+    SF_SIMD_AVX2,
+    SF_SIMD_AVX512
+} sf_simd_level;
+
+typedef struct {
+    sf_simd_level level;
+    const char *name;
+    uint32_t group_size;    /* Fast lookup slots per group - control bytes one compare covers */
+    
+    /* Index of the first values[i] == needle with from <= i < count, or count */
+    uint32_t (*find_u32)(const uint32_t *values, uint32_t count, uint32_t needle, uint32_t from);
+} sf_simd_kernels;
+
+/* Selected at MINIT, read-only afterwards (shared by all threads) */
+extern sf_simd_kernels sf_simd_active;
+
+/*
+ * Select the widest kernel set the CPU supports, capped by `request` (the
+ * signalforge_container.simd INI value: "auto", "avx512", "avx2", the native
+ * platform name or "scalar"). Must run before any fast lookup is created -
+ * tables are laid out in groups of the selected width.
+ */
+void sf_simd_startup(const char *request);
+
 #endif /* SF_SIMD_H */
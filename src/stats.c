@@ -0,0 +1,146 @@
+/*
+ * Signalforge Container Extension
+ * src/stats.c - Resolution statistics
+ *
+ * The counters themselves are bumped in place (SF_STAT); this file only
+ * resets them and turns them into the Container::stats() array and the
+ * phpinfo() table.
+ *
+ * Per-binding counts live on the bindings, so they survive with the graph in
+ * persistent mode - reset walks the binding table to zero them.
+ */
+
+#include "../php_signalforge_container.h"
+#include "stats.h"
+#include "container.h"
+#include "binding.h"
+
+#include <inttypes.h>  /* For PRIu64 */
+
+void sf_stats_reset(sf_container *c)
+{
+    memset(&SF_CONTAINER_G(stats), 0, sizeof(sf_stats));
+    
+    if (!c) return;
+    
+    zval *val;
+    ZEND_HASH_FOREACH_VAL(&c->bindings, val) {
+        ((sf_binding *)Z_PTR_P(val))->resolutions = 0;
+    } ZEND_HASH_FOREACH_END();
+}
+
+/* Counters are exported as PHP ints - saturate instead of wrapping negative */
+static zend_always_inline zend_long sf_stats_long(uint64_t value)
+{
+    return value > (uint64_t)ZEND_LONG_MAX ? ZEND_LONG_MAX : (zend_long)value;
+}
+
+void sf_stats_export(sf_container *c, zval *result)
+{
+    const sf_stats *stats = &SF_CONTAINER_G(stats);
+    zval section;
+    
+    array_init(result);
+    add_assoc_long(result, "make", sf_stats_long(stats->make));
+    add_assoc_long(result, "failures", sf_stats_long(stats->failures));
+    
+    /* Which way make() got its result */
+    array_init(&section);
+    add_assoc_long(&section, "callSite", sf_stats_long(stats->site_hits));
+    add_assoc_long(&section, "singleton", sf_stats_long(stats->singleton_hits));
+    add_assoc_long(&section, "compiled", sf_stats_long(stats->compiled));
+    add_assoc_long(&section, "contextual", sf_stats_long(stats->contextual));
+    add_assoc_long(&section, "instance", sf_stats_long(stats->instances));
+    add_assoc_long(&section, "scoped", sf_stats_long(stats->scoped));
+    add_assoc_long(&section, "lazy", sf_stats_long(stats->lazy));
+    add_assoc_long(&section, "closure", sf_stats_long(stats->closures));
+    add_assoc_long(&section, "autowire", sf_stats_long(stats->autowired));
+    add_assoc_zval(result, "paths", &section);
+    add_assoc_long(result, "callSiteMisses", sf_stats_long(stats->site_misses));
+    
+    array_init(&section);
+    add_assoc_long(&section, "finds", sf_stats_long(stats->lookup_finds));
+    add_assoc_long(&section, "probes", sf_stats_long(stats->lookup_probes));
+    add_assoc_long(&section, "maxProbe", sf_stats_long(stats->lookup_max_probe));
+    add_assoc_long(&section, "grows", sf_stats_long(stats->lookup_grows));
+    add_assoc_long(&section, "insertFailures", sf_stats_long(stats->lookup_insert_failures));
+    add_assoc_zval(result, "lookup", &section);
+    
+    add_assoc_long(result, "metadataBuilds", sf_stats_long(stats->meta_builds));
+    
+    array_init(&section);
+    add_assoc_long(&section, "called", sf_stats_long(stats->ctor_calls));
+    add_assoc_long(&section, "elided", sf_stats_long(stats->ctor_elided));
+    add_assoc_zval(result, "constructors", &section);
+    
+    array_init(&section);
+    add_assoc_long(&section, "promoted", sf_stats_long(stats->plans_promoted));
+    add_assoc_long(&section, "rebuilt", sf_stats_long(stats->plans_rebuilt));
+    add_assoc_long(&section, "failed", sf_stats_long(stats->plans_failed));
+    add_assoc_zval(result, "plans", &section);
+    
+    array_init(&section);
+    add_assoc_bool(&section, "enabled", SF_CONTAINER_G(stats_timing));
+    add_assoc_long(&section, "resolutions", sf_stats_long(stats->timed));
+    add_assoc_long(&section, "totalNs", sf_stats_long(stats->time_ns));
+    add_assoc_long(&section, "maxNs", sf_stats_long(stats->max_ns));
+    add_assoc_zval(result, "timing", &section);
+    
+    /* Bindings resolved the slow way, by abstract (fast-path hits don't count) */
+    array_init(&section);
+    zend_string *key;
+    zval *val;
+    ZEND_HASH_FOREACH_STR_KEY_VAL(&c->bindings, key, val) {
+        sf_binding *binding = (sf_binding *)Z_PTR_P(val);
+        if (binding->resolutions > 0) {
+            /* Copied key - persistent graph strings must not end up in request arrays */
+            add_assoc_long_ex(&section, ZSTR_VAL(key), ZSTR_LEN(key), binding->resolutions);
+        }
+    } ZEND_HASH_FOREACH_END();
+    add_assoc_zval(result, "bindings", &section);
+}
+
+static void sf_stats_info_row(const char *label, uint64_t value)
+{
+    char buf[24];
+    
+    snprintf(buf, sizeof(buf), "%" PRIu64, value);
+    php_info_print_table_row(2, label, buf);
+}
+
+void sf_stats_info(void)
+{
+    const sf_stats *stats = &SF_CONTAINER_G(stats);
+    
+    php_info_print_table_start();
+    php_info_print_table_colspan_header(2, "Resolution statistics (this request)");
+    sf_stats_info_row("make() calls", stats->make);
+    sf_stats_info_row("Call-site hits", stats->site_hits);
+    sf_stats_info_row("Call-site misses", stats->site_misses);
+    sf_stats_info_row("Singleton store hits", stats->singleton_hits);
+    sf_stats_info_row("Compiled plans", stats->compiled);
+    sf_stats_info_row("Contextual bindings", stats->contextual);
+    sf_stats_info_row("Instance bindings", stats->instances);
+    sf_stats_info_row("Scoped instances", stats->scoped);
+    sf_stats_info_row("Lazy proxies", stats->lazy);
+    sf_stats_info_row("Closure factories", stats->closures);
+    sf_stats_info_row("Autowired", stats->autowired);
+    sf_stats_info_row("Failures", stats->failures);
+    sf_stats_info_row("Store lookups", stats->lookup_finds);
+    sf_stats_info_row("Store extra probes", stats->lookup_probes);
+    sf_stats_info_row("Store longest probe", stats->lookup_max_probe);
+    sf_stats_info_row("Store rehashes", stats->lookup_grows);
+    sf_stats_info_row("Store insert failures", stats->lookup_insert_failures);
+    sf_stats_info_row("Metadata builds", stats->meta_builds);
+    sf_stats_info_row("Constructors called", stats->ctor_calls);
+    sf_stats_info_row("Constructors elided", stats->ctor_elided);
+    sf_stats_info_row("Plans promoted", stats->plans_promoted);
+    sf_stats_info_row("Plans rebuilt", stats->plans_rebuilt);
+    sf_stats_info_row("Plans failed", stats->plans_failed);
+    if (SF_CONTAINER_G(stats_timing)) {
+        sf_stats_info_row("Timed resolutions", stats->timed);
+        sf_stats_info_row("Resolution time (ns)", stats->time_ns);
+        sf_stats_info_row("Slowest resolution (ns)", stats->max_ns);
+    }
+    php_info_print_table_end();
+}
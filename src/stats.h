@@ -0,0 +1,73 @@
+/*
+ * Signalforge Container Extension
+ * src/stats.h - Resolution statistics
+ *
+ * Plain counters bumped on the paths make() can take, so a service that keeps
+ * falling off the singleton store, call-site slot or compiled plan shows up in
+ * Container::stats() and phpinfo(). Counting is a single increment of a module
+ * global; timing cold resolutions needs signalforge_container.stats_timing=1
+ * and costs nothing when it is off.
+ *
+ * Counters cover the current request: they are zeroed at request startup and
+ * by Container::resetStats().
+ */
+
+#ifndef SF_STATS_H
+#define SF_STATS_H
+
+#include <stdint.h>
+
+/* Forward declaration */
+struct _sf_container;
+
+typedef struct {
+    /* Resolution paths */
+    uint64_t make;              /* sf_container_make() calls, nested dependencies included */
+    uint64_t site_hits;         /* get()/make() served from the call-site slot */
+    uint64_t site_misses;       /* get()/make() that had to go through make() */
+    uint64_t singleton_hits;    /* Returned from the singleton store */
+    uint64_t compiled;          /* Built by a compiled plan */
+    uint64_t contextual;        /* Resolved through a contextual binding */
+    uint64_t instances;         /* Returned from an instance binding */
+    uint64_t scoped;            /* Returned from the current scope */
+    uint64_t lazy;              /* Lazy proxies handed out */
+    uint64_t closures;          /* Closure factories called */
+    uint64_t autowired;         /* Built by sf_autowire_resolve() */
+    uint64_t failures;          /* make() calls that returned FAILURE */
+    
+    /* Singleton store (sf_fast_lookup) */
+    uint64_t lookup_finds;      /* Lookups */
+    uint64_t lookup_probes;     /* Groups visited past the home group */
+    uint64_t lookup_max_probe;  /* Longest probe sequence seen */
+    uint64_t lookup_grows;      /* Rehashes (growth or tombstone cleanup) */
+    uint64_t lookup_insert_failures;
+    
+    /* Reflection cache and constructors */
+    uint64_t meta_builds;       /* sf_class_meta built (first use or stale entry) */
+    uint64_t ctor_calls;        /* Constructors run (autowiring and plans) */
+    uint64_t ctor_elided;       /* Constructors skipped - promoted properties written directly */
+    
+    /* Compiled plans */
+    uint64_t plans_promoted;    /* Plans built on the fly - tiered compilation, or autowiring after compile() */
+    uint64_t plans_rebuilt;     /* Plans rebuilt - the graph changed for a name they consulted, or a class changed */
+    uint64_t plans_failed;      /* Services promoted that couldn't be planned - not retried until the graph changes */
+    
+    /* Cold resolution timing (stats_timing=1 only, outermost make() calls) */
+    uint64_t timed;             /* Resolutions timed */
+    uint64_t time_ns;           /* Total wall time */
+    uint64_t max_ns;            /* Slowest single resolution */
+} sf_stats;
+
+/* Bump a counter (SF_STAT(make)) */
+#define SF_STAT(field) (SF_CONTAINER_G(stats).field++)
+
+/* Zero the counters, and the per-binding counts of `container` if given */
+void sf_stats_reset(struct _sf_container *container);
+
+/* Container::stats() array */
+void sf_stats_export(struct _sf_container *container, zval *result);
+
+/* phpinfo() table */
+void sf_stats_info(void);
+
+#endif /* SF_STATS_H */
@@ -0,0 +1,112 @@
+/*
+ * Signalforge Container Extension
+ * src/tag.c - Tagged service lists
+ *
+ * tagged() used to walk a PHP array of names and run a full make() per
+ * entry. Members now carry their alias-resolved key and binding, looked up
+ * once per graph generation; a singleton member is a single store probe.
+ * Tags made only of singletons and instances are additionally cached as a
+ * finished array by the container (see sf_container_tagged()).
+ */
+
+#include "../php_signalforge_container.h"
+#include "tag.h"
+#include "container.h"
+#include "binding.h"
+
+sf_tag *sf_tag_create(zend_bool persistent)
+{
+    sf_tag *tag = pemalloc(sizeof(sf_tag), persistent);
+    
+    tag->capacity = 4;
+    tag->count = 0;
+    tag->members = pemalloc(sizeof(sf_tag_member) * tag->capacity, persistent);
+    tag->generation = 0;
+    tag->refcount = 1;
+    tag->resolved = 0;
+    tag->shared = 0;
+    tag->persistent = persistent;
+    
+    return tag;
+}
+
+static void sf_tag_destroy(sf_tag *tag)
+{
+    for (uint32_t i = 0; i < tag->count; i++) {
+        zend_string_release(tag->members[i].abstract);
+    }
+    pefree(tag->members, tag->persistent);
+    pefree(tag, tag->persistent);
+}
+
+void sf_tag_addref(sf_tag *tag)
+{
+    if (tag) tag->refcount++;
+}
+
+void sf_tag_release(sf_tag *tag)
+{
+    if (tag && --tag->refcount == 0) {
+        sf_tag_destroy(tag);
+    }
+}
+
+void sf_tag_append(sf_tag *tag, zend_string *abstract)
+{
+    if (tag->count >= tag->capacity) {
+        tag->capacity *= 2;
+        tag->members = perealloc(tag->members, sizeof(sf_tag_member) * tag->capacity, tag->persistent);
+    }
+    
+    sf_tag_member *member = &tag->members[tag->count++];
+    member->abstract = sf_string_copy_ex(abstract, tag->persistent);
+    member->key = NULL;
+    member->binding = NULL;
+    tag->resolved = 0;
+}
+
+void sf_tag_reserve(sf_tag *tag, uint32_t extra)
+{
+    if (tag->count + extra > tag->capacity) {
+        tag->capacity = tag->count + extra;
+        tag->members = perealloc(tag->members, sizeof(sf_tag_member) * tag->capacity, tag->persistent);
+    }
+}
+
+void sf_tag_prepare(sf_container *c, sf_tag *tag)
+{
+    if (EXPECTED(tag->resolved) && EXPECTED(tag->generation == c->site_generation)) {
+        return;
+    }
+    
+    tag->shared = tag->count > 0;
+    for (uint32_t i = 0; i < tag->count; i++) {
+        sf_tag_member *member = &tag->members[i];
+        member->key = sf_container_resolve_alias(c, member->abstract);
+        member->binding = zend_hash_find_ptr(&c->bindings, member->key);
+        
+        if (!member->binding || member->binding->scope == SF_SCOPE_TRANSIENT || member->binding->scope == SF_SCOPE_SCOPED) {
+            tag->shared = 0;
+        }
+    }
+    
+    tag->generation = c->site_generation;
+    tag->resolved = 1;
+}
+
+int sf_tag_make(sf_container *c, sf_tag *tag, uint32_t index, zval *result)
+{
+    sf_tag_prepare(c, tag);
+    sf_tag_member *member = &tag->members[index];
+    
+    /* Singletons already built - one probe, no resolution (common) */
+    if (EXPECTED(member->binding) && (member->binding->scope == SF_SCOPE_SINGLETON || member->binding->scope == SF_SCOPE_INSTANCE)) {
+        zval *cached = sf_fast_lookup_find(c->instances, member->key);
+        if (EXPECTED(cached)) {
+            ZVAL_COPY(result, cached);
+            return SUCCESS;
+        }
+    }
+    
+    return sf_container_make(c, member->key, NULL, result, NULL);
+}
@@ -0,0 +1,50 @@
+/*
+ * Signalforge Container Extension
+ * src/tag.h - Tagged service lists
+ *
+ * A tag is a native array of its members. Each member keeps its alias
+ * resolved and its binding looked up, refreshed only when the graph changed
+ * since the last use, so tagged() goes straight to the singleton store or
+ * make() per member.
+ */
+
+#ifndef SF_TAG_H
+#define SF_TAG_H
+
+/* Forward declarations */
+struct _sf_container;
+
+typedef struct _sf_tag_member {
+    zend_string *abstract;            /* As tagged (owned) */
+    zend_string *key;                 /* After alias resolution (borrowed, valid for the tag's generation) */
+    sf_binding *binding;              /* Its binding (borrowed, NULL = autowired) */
+} sf_tag_member;
+
+typedef struct _sf_tag {
+    sf_tag_member *members;           /* In tagging order */
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t generation;              /* Container site generation keys/bindings were resolved in */
+    uint32_t refcount;                /* The tag table plus live TaggedIterators */
+    zend_bool resolved;               /* keys/bindings are filled in */
+    zend_bool shared;                 /* Every member is a singleton or instance - the list can be cached */
+    zend_bool persistent;             /* Allocated in process memory (persistent mode) */
+} sf_tag;
+
+/* Tag lifecycle */
+sf_tag *sf_tag_create(zend_bool persistent);
+void sf_tag_addref(sf_tag *tag);
+void sf_tag_release(sf_tag *tag);
+void sf_tag_append(sf_tag *tag, zend_string *abstract);
+void sf_tag_reserve(sf_tag *tag, uint32_t extra);  /* Room for `extra` more members */
+
+/*
+ * Resolve member `index` into `result` (the tag must have that many members).
+ * Throws and returns FAILURE like make() does.
+ */
+int sf_tag_make(struct _sf_container *container, sf_tag *tag, uint32_t index, zval *result);
+
+/* Refresh member keys and bindings if the graph changed since the last use */
+void sf_tag_prepare(struct _sf_container *container, sf_tag *tag);
+
+#endif /* SF_TAG_H */
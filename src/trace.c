@@ -0,0 +1,211 @@
+/*
+ * Signalforge Container Extension
+ * src/trace.c - Resolution tracing
+ *
+ * sf_container_make() brackets a traced resolution with sf_trace_begin() and
+ * sf_trace_end(). A resolution in progress holds a slot in the open list,
+ * where the path it takes is filled in (SF_TRACE_PATH); it moves to the ring
+ * buffer once it finishes, so dependencies are recorded before whatever
+ * needed them. Slots are closed by index rather than popped: a fiber that
+ * suspends mid-resolution lets other fibers open and close theirs meanwhile.
+ * Each resolution stack knows its innermost slot, so paths land in the
+ * current fiber's event.
+ *
+ * Both hold request strings (container-owned persistent names are copied), and
+ * are released by Container::resetTrace() and at request shutdown.
+ */
+
+#include "../php_signalforge_container.h"
+#include "trace.h"
+
+#include <unistd.h>  /* For getpid() */
+
+/* Bounds applied to signalforge_container.trace_size */
+#define SF_TRACE_MIN_SIZE 16
+#define SF_TRACE_MAX_SIZE (1 << 20)
+
+/* Category of each SF_TRACE_PATH_*, as in Container::stats()['paths'] */
+static const char *sf_trace_path_names[] = {
+    "none", "singleton", "compiled", "contextual", "instance", "scoped", "lazy", "closure", "autowire"
+};
+
+static void sf_trace_event_release(sf_trace_event *event)
+{
+    if (!event->abstract) {
+        return;  /* A closed slot */
+    }
+    zend_string_release(event->abstract);
+    if (event->requester) {
+        zend_string_release(event->requester);
+    }
+}
+
+/* Ring buffer size signalforge_container.trace_size asks for */
+static uint32_t sf_trace_capacity(void)
+{
+    zend_long size = SF_CONTAINER_G(trace_size);
+    
+    if (size < SF_TRACE_MIN_SIZE) {
+        return SF_TRACE_MIN_SIZE;
+    }
+    return size > SF_TRACE_MAX_SIZE ? SF_TRACE_MAX_SIZE : (uint32_t)size;
+}
+
+/* Index of the oldest event held */
+static zend_always_inline uint32_t sf_trace_first(const sf_trace *trace)
+{
+    return trace->count ? (trace->head + trace->capacity - trace->count) % trace->capacity : 0;
+}
+
+/* ============================================================================
+ * Recording
+ * ============================================================================ */
+
+uint32_t sf_trace_begin(zend_string *abstract, zend_string *requester, uint32_t depth)
+{
+    sf_trace *trace = &SF_CONTAINER_G(trace);
+    
+    if (UNEXPECTED(trace->open_count == trace->open_capacity)) {
+        trace->open_capacity = trace->open_capacity ? trace->open_capacity * 2 : 16;
+        trace->open = erealloc(trace->open, trace->open_capacity * sizeof(sf_trace_event));
+    }
+    
+    sf_trace_event *event = &trace->open[trace->open_count++];
+    event->abstract = sf_string_export(abstract);
+    event->requester = requester ? sf_string_export(requester) : NULL;
+    event->depth = depth;
+    event->path = SF_TRACE_PATH_NONE;
+    event->failed = 0;
+    event->start_ns = zend_hrtime();
+    return trace->open_count;
+}
+
+void sf_trace_end(uint32_t open, zend_bool failed)
+{
+    uint64_t now = zend_hrtime();
+    sf_trace *trace = &SF_CONTAINER_G(trace);
+    
+    sf_trace_event event = trace->open[open - 1];
+    event.duration_ns = now - event.start_ns;
+    event.failed = failed;
+    
+    /* Close the slot; the list shrinks once nothing above it is still open */
+    trace->open[open - 1].abstract = NULL;
+    while (trace->open_count && !trace->open[trace->open_count - 1].abstract) {
+        trace->open_count--;
+    }
+    
+    /* Sized on first use, so trace_size can be set at runtime before tracing starts */
+    if (UNEXPECTED(!trace->events)) {
+        trace->capacity = sf_trace_capacity();
+        trace->events = safe_emalloc(trace->capacity, sizeof(sf_trace_event), 0);
+    }
+    
+    /* Full: the oldest event makes room */
+    if (UNEXPECTED(trace->count == trace->capacity)) {
+        sf_trace_event_release(&trace->events[trace->head]);
+        trace->dropped++;
+    } else {
+        trace->count++;
+    }
+    
+    trace->events[trace->head] = event;
+    trace->head = (trace->head + 1) % trace->capacity;
+}
+
+void sf_trace_reset(void)
+{
+    sf_trace *trace = &SF_CONTAINER_G(trace);
+    uint32_t first = sf_trace_first(trace);
+    
+    for (uint32_t i = 0; i < trace->count; i++) {
+        sf_trace_event_release(&trace->events[(first + i) % trace->capacity]);
+    }
+    trace->head = 0;
+    trace->count = 0;
+    trace->dropped = 0;
+}
+
+void sf_trace_shutdown(void)
+{
+    sf_trace *trace = &SF_CONTAINER_G(trace);
+    
+    sf_trace_reset();
+    
+    /* Left open by a bailout */
+    for (uint32_t i = 0; i < trace->open_count; i++) {
+        sf_trace_event_release(&trace->open[i]);
+    }
+    
+    if (trace->events) {
+        efree(trace->events);
+    }
+    if (trace->open) {
+        efree(trace->open);
+    }
+    memset(trace, 0, sizeof(*trace));
+}
+
+/* ============================================================================
+ * Export
+ * ============================================================================ */
+
+/* Trace event times are in microseconds */
+static zend_always_inline double sf_trace_us(uint64_t ns)
+{
+    return (double)ns / 1000.0;
+}
+
+void sf_trace_export(zval *result)
+{
+    const sf_trace *trace = &SF_CONTAINER_G(trace);
+    uint32_t first = sf_trace_first(trace);
+    uint64_t origin = UINT64_MAX;
+    zend_long pid = (zend_long)getpid();
+    zval events, event, args;
+    
+    /* Timestamps are relative to the earliest event kept */
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const sf_trace_event *recorded = &trace->events[(first + i) % trace->capacity];
+        if (recorded->start_ns < origin) {
+            origin = recorded->start_ns;
+        }
+    }
+    
+    array_init(result);
+    array_init_size(&events, trace->count);
+    
+    /* Oldest first, in the order resolutions finished */
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const sf_trace_event *recorded = &trace->events[(first + i) % trace->capacity];
+        
+        array_init_size(&event, 8);
+        add_assoc_str(&event, "name", zend_string_copy(recorded->abstract));
+        add_assoc_string(&event, "cat", sf_trace_path_names[recorded->path]);
+        add_assoc_string(&event, "ph", "X");
+        add_assoc_double(&event, "ts", sf_trace_us(recorded->start_ns - origin));
+        add_assoc_double(&event, "dur", sf_trace_us(recorded->duration_ns));
+        add_assoc_long(&event, "pid", pid);
+        add_assoc_long(&event, "tid", pid);
+        
+        array_init_size(&args, 3);
+        add_assoc_long(&args, "depth", recorded->depth);
+        if (recorded->requester) {
+            add_assoc_str(&args, "requester", zend_string_copy(recorded->requester));
+        } else {
+            add_assoc_null(&args, "requester");
+        }
+        add_assoc_bool(&args, "failed", recorded->failed);
+        add_assoc_zval(&event, "args", &args);
+        
+        add_next_index_zval(&events, &event);
+    }
+    add_assoc_zval(result, "traceEvents", &events);
+    add_assoc_string(result, "displayTimeUnit", "ns");
+    
+    array_init(&args);
+    add_assoc_bool(&args, "enabled", SF_CONTAINER_G(tracing));
+    add_assoc_long(&args, "capacity", trace->capacity ? trace->capacity : sf_trace_capacity());
+    add_assoc_long(&args, "dropped", trace->dropped > (uint64_t)ZEND_LONG_MAX ? ZEND_LONG_MAX : (zend_long)trace->dropped);
+    add_assoc_zval(result, "otherData", &args);
+}
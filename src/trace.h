@@ -0,0 +1,94 @@
+/*
+ * Signalforge Container Extension
+ * src/trace.h - Resolution tracing
+ *
+ * With signalforge_container.trace=1 every make() that reaches the container
+ * records an event - what was resolved, for whom, how deep, which path
+ * produced it and how long it took, dependencies included. Events go to a
+ * ring buffer of signalforge_container.trace_size entries, so a long request
+ * keeps its most recent resolutions. Container::trace() exports them in the
+ * Chrome trace event format (chrome://tracing, Perfetto, speedscope), where
+ * nested resolutions stack up into a flame graph.
+ *
+ * Call-site hits never reach the container and are not traced; the steps a
+ * compiled plan builds inline are part of its event. Tracing costs one flag
+ * check per make() when it is off.
+ */
+
+#ifndef SF_TRACE_H
+#define SF_TRACE_H
+
+#include <stdint.h>
+
+/* Forward declaration */
+struct _sf_container;
+
+/* Resolution paths, as named in Container::stats()['paths'] */
+#define SF_TRACE_PATH_NONE       0   /* Failed before taking one */
+#define SF_TRACE_PATH_SINGLETON  1
+#define SF_TRACE_PATH_COMPILED   2
+#define SF_TRACE_PATH_CONTEXTUAL 3
+#define SF_TRACE_PATH_INSTANCE   4
+#define SF_TRACE_PATH_SCOPED     5
+#define SF_TRACE_PATH_LAZY       6
+#define SF_TRACE_PATH_CLOSURE    7
+#define SF_TRACE_PATH_AUTOWIRE   8
+
+typedef struct {
+    zend_string *abstract;      /* What was asked for (after aliases) */
+    zend_string *requester;     /* Class whose constructor needed it (NULL = top level) */
+    uint64_t start_ns;          /* zend_hrtime() when entered */
+    uint64_t duration_ns;       /* Dependencies included */
+    uint32_t depth;             /* Resolution stack depth when entered */
+    uint8_t path;               /* SF_TRACE_PATH_* */
+    zend_bool failed;
+} sf_trace_event;
+
+typedef struct {
+    sf_trace_event *events;     /* Ring buffer (request-allocated on first event) */
+    uint32_t capacity;
+    uint32_t head;              /* Next slot written */
+    uint32_t count;             /* Events held (<= capacity) */
+    uint64_t dropped;           /* Older events overwritten */
+    
+    /* Resolutions in progress, in the order they began - recorded once they
+     * finish (abstract NULL = closed, still below an open one) */
+    sf_trace_event *open;
+    uint32_t open_count;
+    uint32_t open_capacity;
+} sf_trace;
+
+/*
+ * Enter/leave one make() (signalforge_container.trace=1 only). Begin returns
+ * the event's open slot (index + 1), which end closes.
+ */
+uint32_t sf_trace_begin(zend_string *abstract, zend_string *requester, uint32_t depth);
+void sf_trace_end(uint32_t open, zend_bool failed);
+
+/*
+ * Record the path the resolution in open slot `open` took (0 = not traced).
+ * The first one sticks: a contextual binding that autowires its
+ * implementation is traced as contextual, as stats() counts it.
+ */
+static zend_always_inline void sf_trace_set_path(sf_trace *trace, uint32_t open, uint8_t path)
+{
+    if (UNEXPECTED(open) && trace->open[open - 1].path == SF_TRACE_PATH_NONE) {
+        trace->open[open - 1].path = path;
+    }
+}
+
+/* Path bookkeeping next to the matching SF_STAT() - a no-op unless the
+ * innermost make() on c's current resolution stack is traced */
+#define SF_TRACE_PATH(c, path) \
+    sf_trace_set_path(&SF_CONTAINER_G(trace), (c)->context->trace_open, SF_TRACE_PATH_##path)
+    
+/* Container::trace() array (Chrome trace event format) */
+void sf_trace_export(zval *result);
+
+/* Drop the recorded events (Container::resetTrace()) */
+void sf_trace_reset(void);
+
+/* Drop everything, open resolutions included, and free the buffers (request shutdown) */
+void sf_trace_shutdown(void);
+
+#endif /* SF_TRACE_H */
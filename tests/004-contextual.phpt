@@ -19,6 +19,14 @@ class AdminController {
     public function __construct(public LoggerInterface $logger) {}
 }
 
+interface CacheInterface {}
+class ArrayCache implements CacheInterface {}
+class RedisCache implements CacheInterface {}
+
+class ReportController {
+    public function __construct(public LoggerInterface $logger, public CacheInterface $cache) {}
+}
+
 // Contextual binding: UserController gets FileLogger
 Container::when(UserController::class)
     ->needs(LoggerInterface::class)
@@ -48,6 +56,13 @@ if ($adminCtrl->logger->type === 'database') {
     echo "DatabaseLogger works\n";
 }
 
+// Several rules for one requester, the last one for an abstract wins
+Container::when(ReportController::class)->needs(LoggerInterface::class)->give(FileLogger::class);
+Container::when(ReportController::class)->needs(CacheInterface::class)->give(ArrayCache::class);
+Container::when(ReportController::class)->needs(CacheInterface::class)->give(RedisCache::class);
+$report = Container::make(ReportController::class);
+echo get_class($report->logger), ' ', get_class($report->cache), "\n";
+
 echo "Done\n";
 
 ?>
@@ -56,5 +71,6 @@ UserController gets FileLogger
 AdminController gets DatabaseLogger
 FileLogger works
 DatabaseLogger works
+FileLogger RedisCache
 Done
 
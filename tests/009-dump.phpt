@@ -6,6 +6,7 @@ signalforge_container
 <?php
 
 use Signalforge\Container\Container;
+use Signalforge\Container\ContainerException;
 
 // Test fixtures
 class DumpLogger {
@@ -62,8 +63,42 @@ echo "\nTest 5: unloadCompiled() safe when empty\n";
 Container::unloadCompiled();
 var_dump(Container::hasCompiled() === false);
 
-// Note: Full dump/loadCompiled tests require container-php package
-// which provides ContainerDumper and CompiledContainer classes
+// Test 6: dump() writes the graph as PHP, arguments inlined
+echo "\nTest 6: dump()\n";
+$file = sys_get_temp_dir() . '/sf_dump_' . getmypid() . '.php';
+var_dump(Container::dump($file, 'DumpedContainer', 'App\Compiled'));
+$code = file_get_contents($file);
+var_dump(str_contains($code, "namespace App\\Compiled;"));
+var_dump(str_contains($code, 'final class DumpedContainer'));
+var_dump(str_contains($code, 'new \DumpUserService(new \DumpLogger(), ($this->shared0 ??= new \DumpDatabase()))'));
+var_dump(str_contains($code, 'private ?\DumpDatabase $shared0 = null;'));
+
+// Test 7: loadCompiled() binds the generated methods as factories
+echo "\nTest 7: loadCompiled()\n";
+var_dump(Container::loadCompiled($file));
+var_dump(Container::hasCompiled());
+$a = Container::make(DumpUserService::class);
+$b = Container::make(DumpUserService::class);
+var_dump($a !== $b, $a->database === $b->database);
+var_dump($a->database === Container::make(DumpDatabase::class));
+var_dump(Container::getBindings()[DumpUserService::class]['concrete'] instanceof Closure);
+
+// Test 8: unloadCompiled() restores the class bindings
+echo "\nTest 8: unloadCompiled()\n";
+Container::unloadCompiled();
+var_dump(Container::hasCompiled());
+var_dump(Container::getBindings()[DumpUserService::class]['concrete']);
+var_dump(Container::make(DumpUserService::class) instanceof DumpUserService);
+unlink($file);
+
+// Test 9: Invalid class name
+echo "\nTest 9: Invalid name\n";
+try {
+    Container::dump($file, 'Bad-Name');
+} catch (ContainerException $e) {
+    echo $e->getMessage(), "\n";
+}
+var_dump(file_exists($file));
 
 echo "\nDone!\n";
 ?>
@@ -90,4 +125,28 @@ bool(true)
 Test 5: unloadCompiled() safe when empty
 bool(true)
 
+Test 6: dump()
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+
+Test 7: loadCompiled()
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+
+Test 8: unloadCompiled()
+bool(false)
+string(15) "DumpUserService"
+bool(true)
+
+Test 9: Invalid name
+Invalid compiled container name 'Bad-Name'
+bool(false)
+
 Done!
@@ -0,0 +1,120 @@
+--TEST--
+Container: Persistent mode keeps the graph usable within a request
+--EXTENSIONS--
+signalforge_container
+--INI--
+signalforge_container.persistent=1
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+
+class FileLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class NullLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class Mailer {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class Clock {
+    public int $time = 42;
+}
+
+// Test 1: The first request starts cold
+echo "Test 1: Cold start\n";
+var_dump(Container::isWarm());
+
+// Test 2: Class bindings resolve as usual
+echo "\nTest 2: Class bindings\n";
+Container::bind(LoggerInterface::class, FileLogger::class);
+Container::singleton(Mailer::class);
+$mailer = Container::make(Mailer::class);
+var_dump($mailer->logger instanceof FileLogger);
+var_dump($mailer === Container::make(Mailer::class));
+
+// Test 3: Aliases and tags
+echo "\nTest 3: Aliases and tags\n";
+Container::alias(LoggerInterface::class, 'logger');
+var_dump(Container::make('logger') instanceof FileLogger);
+Container::tag([FileLogger::class, NullLogger::class], 'loggers');
+var_dump(count(Container::tagged('loggers')));
+
+// Test 4: Contextual bindings
+echo "\nTest 4: Contextual bindings\n";
+Container::forgetInstance(Mailer::class);
+Container::when(Mailer::class)->needs(LoggerInterface::class)->give(NullLogger::class);
+var_dump(Container::make(Mailer::class)->logger instanceof NullLogger);
+
+// Test 5: Closure and instance bindings
+echo "\nTest 5: Closure and instance bindings\n";
+Container::bind('clock', fn() => new Clock());
+var_dump(Container::make('clock')->time);
+$clock = new Clock();
+Container::instance(Clock::class, $clock);
+var_dump(Container::make(Clock::class) === $clock);
+
+// Test 6: Strings handed back to userland are usable
+echo "\nTest 6: Introspection\n";
+$bindings = Container::getBindings();
+var_dump($bindings[LoggerInterface::class]['concrete']);
+$meta = Container::getMetadata(Mailer::class);
+var_dump($meta['params'][0]['name']);
+var_dump($meta['params'][0]['type']);
+
+// Test 7: Compilation
+echo "\nTest 7: Compilation\n";
+Container::flush();
+Container::bind(LoggerInterface::class, FileLogger::class);
+Container::bind(Mailer::class);
+var_dump(Container::compile() > 0);
+var_dump(Container::make(Mailer::class)->logger instanceof FileLogger);
+
+// Test 8: Flush clears the graph
+echo "\nTest 8: Flush\n";
+Container::flush();
+var_dump(Container::bound(LoggerInterface::class));
+var_dump(Container::isCompiled());
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Cold start
+bool(false)
+
+Test 2: Class bindings
+bool(true)
+bool(true)
+
+Test 3: Aliases and tags
+bool(true)
+int(2)
+
+Test 4: Contextual bindings
+bool(true)
+
+Test 5: Closure and instance bindings
+int(42)
+bool(true)
+
+Test 6: Introspection
+string(10) "FileLogger"
+string(6) "logger"
+string(15) "LoggerInterface"
+
+Test 7: Compilation
+bool(true)
+bool(true)
+
+Test 8: Flush
+bool(false)
+bool(false)
+
+Done!
@@ -0,0 +1,101 @@
+--TEST--
+Container: Singleton fast cache grows past its initial size
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+class Service {
+    public function __construct() {}
+}
+
+class Reentrant {
+    public static array $seen = [];
+    
+    public function __destruct() {
+        // Probes its own (removed) slot, then stores enough to grow the table
+        self::$seen[] = Container::resolved(self::class);
+        for ($i = 0; $i < 40; $i++) {
+            Container::make("late.$i");
+        }
+    }
+}
+
+// Test 1: Hundreds of singletons resolve to stable instances
+echo "Test 1: Many singletons\n";
+$first = [];
+for ($i = 0; $i < 500; $i++) {
+    Container::singleton("service.$i", Service::class);
+    $first[$i] = Container::make("service.$i");
+}
+$same = true;
+for ($i = 0; $i < 500; $i++) {
+    $same = $same && Container::make("service.$i") === $first[$i];
+}
+var_dump($same);
+
+// Test 2: Forgetting instances leaves the rest intact
+echo "\nTest 2: Forget every other instance\n";
+for ($i = 0; $i < 500; $i += 2) {
+    Container::forgetInstance("service.$i");
+}
+$ok = true;
+for ($i = 0; $i < 500; $i++) {
+    $instance = Container::make("service.$i");
+    $ok = $ok && (($i % 2) ? $instance === $first[$i] : $instance !== $first[$i]);
+}
+var_dump($ok);
+
+// Test 3: Repeated forget/make churn keeps lookups correct
+echo "\nTest 3: Churn\n";
+for ($round = 0; $round < 20; $round++) {
+    for ($i = 0; $i < 50; $i++) {
+        Container::forgetInstance("service.$i");
+        Container::make("service.$i");
+    }
+}
+$a = Container::make('service.10');
+var_dump($a === Container::make('service.10'));
+var_dump(Container::make('service.499') === $first[499]);
+
+// Test 4: Destructors calling back find entries already unlinked
+echo "\nTest 4: Reentrant destructors\n";
+Container::singleton(Reentrant::class);
+for ($i = 0; $i < 40; $i++) {
+    Container::singleton("late.$i", Service::class);
+}
+Container::make(Reentrant::class);
+Container::forgetInstance(Reentrant::class);
+var_dump(Reentrant::$seen);
+var_dump(Container::resolved('late.39'));
+Container::make(Reentrant::class);
+Container::forgetInstances();
+var_dump(Container::resolved(Reentrant::class));
+var_dump(Container::resolved('late.39'));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Many singletons
+bool(true)
+
+Test 2: Forget every other instance
+bool(true)
+
+Test 3: Churn
+bool(true)
+bool(true)
+
+Test 4: Reentrant destructors
+array(1) {
+  [0]=>
+  bool(false)
+}
+bool(true)
+bool(false)
+bool(true)
+
+Done!
@@ -0,0 +1,154 @@
+--TEST--
+Container: Compiled resolution plans for whole dependency graphs
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\CircularDependencyException;
+
+// Test fixtures
+interface LoggerInterface {}
+
+class FileLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class Config {
+    public function __construct() {}
+}
+
+class Connection {
+    public function __construct(public Config $config, public LoggerInterface $logger) {}
+}
+
+class Repository {
+    public function __construct(public Connection $connection, public LoggerInterface $logger) {}
+}
+
+class Handler {
+    public function __construct(
+        public Repository $users,
+        public Repository $orders,
+        public LoggerInterface $logger,
+        public Config $config
+    ) {}
+}
+
+class Level0 { public function __construct() {} }
+class Level1 { public function __construct(public Level0 $next) {} }
+class Level2 { public function __construct(public Level1 $next) {} }
+class Level3 { public function __construct(public Level2 $next) {} }
+class Level4 { public function __construct(public Level3 $next) {} }
+class Level5 { public function __construct(public Level4 $next) {} }
+class Level6 { public function __construct(public Level5 $next) {} }
+class Level7 { public function __construct(public Level6 $next) {} }
+class Level8 { public function __construct(public Level7 $next) {} }
+class Level9 { public function __construct(public Level8 $next) {} }
+
+class Wide {
+    public function __construct(
+        public Level0 $a, public Level0 $b, public Level0 $c, public Level0 $d,
+        public Level0 $e, public Level0 $f, public Level0 $g, public Level0 $h,
+        public Level0 $i, public Level0 $j, public Config $k
+    ) {}
+}
+
+class Clock {
+    public function __construct(public int $now) {}
+}
+
+class Scheduler {
+    public function __construct(public Clock $clock, public Config $config) {}
+}
+
+class CycleA { public function __construct(public CycleB $b) {} }
+class CycleB { public function __construct(public CycleA $a) {} }
+
+Container::singleton(LoggerInterface::class, FileLogger::class);
+Container::singleton(Connection::class);
+Container::bind(Repository::class);
+Container::bind(Handler::class);
+Container::bind(Level9::class);
+Container::bind(Wide::class);
+Container::bind(Clock::class, fn() => new Clock(42));
+Container::bind(Scheduler::class);
+Container::bind(CycleA::class);
+Container::bind(CycleB::class);
+Container::compile();
+
+// Test 1: Singletons are shared across the graph, transients are not
+echo "Test 1: Shared singletons\n";
+$handler = Container::make(Handler::class);
+var_dump($handler->users !== $handler->orders);
+var_dump($handler->users->connection === $handler->orders->connection);
+var_dump($handler->logger === $handler->users->logger);
+var_dump($handler->config !== $handler->users->connection->config);
+
+// Test 2: Singletons behind interfaces stay singletons
+echo "\nTest 2: Interface singleton\n";
+var_dump(Container::make(LoggerInterface::class) === $handler->logger);
+var_dump(Container::make(LoggerInterface::class) === Container::make(LoggerInterface::class));
+var_dump(Container::resolved(Connection::class));
+
+// Test 3: Deep graphs
+echo "\nTest 3: Deep graph\n";
+$deep = Container::make(Level9::class);
+var_dump($deep->next->next->next->next->next->next->next->next->next instanceof Level0);
+
+// Test 4: More than eight constructor dependencies
+echo "\nTest 4: Wide constructor\n";
+$wide = Container::make(Wide::class);
+var_dump($wide->a !== $wide->j);
+var_dump($wide->k instanceof Config);
+
+// Test 5: Closure bindings inside a plan
+echo "\nTest 5: Closure dependency\n";
+var_dump(Container::make(Scheduler::class)->clock->now);
+
+// Test 6: Rebinding after compile() is honoured
+echo "\nTest 6: Rebind after compile\n";
+Container::bind(Clock::class, fn() => new Clock(7));
+var_dump(Container::make(Scheduler::class)->clock->now);
+
+// Test 7: Cycles in compiled bindings are still detected
+echo "\nTest 7: Cycle\n";
+try {
+    Container::make(CycleA::class);
+    echo "Should have thrown exception\n";
+} catch (CircularDependencyException $e) {
+    echo "Circular dependency detected\n";
+}
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Shared singletons
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+
+Test 2: Interface singleton
+bool(true)
+bool(true)
+bool(true)
+
+Test 3: Deep graph
+bool(true)
+
+Test 4: Wide constructor
+bool(true)
+bool(true)
+
+Test 5: Closure dependency
+int(42)
+
+Test 6: Rebind after compile
+int(7)
+
+Test 7: Cycle
+Circular dependency detected
+
+Done!
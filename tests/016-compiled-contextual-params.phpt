@@ -0,0 +1,133 @@
+--TEST--
+Container: Compiled plans honour contextual bindings and make() parameters
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+
+class FileLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class DatabaseLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class NullLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class UserController {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class AdminController {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class ReportController {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class Dashboard {
+    public function __construct(public UserController $users, public AdminController $admins) {}
+}
+
+class Mailer {
+    public function __construct(public LoggerInterface $logger, public string $host = 'localhost', public int $port = 25) {}
+}
+
+Container::bind(LoggerInterface::class, FileLogger::class);
+Container::bind(UserController::class);
+Container::bind(AdminController::class);
+Container::bind(ReportController::class);
+Container::bind(Dashboard::class);
+Container::bind(Mailer::class);
+
+Container::when(AdminController::class)
+    ->needs(LoggerInterface::class)
+    ->give(DatabaseLogger::class);
+
+Container::when(ReportController::class)
+    ->needs(LoggerInterface::class)
+    ->give(fn() => new NullLogger());
+
+Container::compile();
+
+// Test 1: Contextual class bindings are baked into dependency slots
+echo "Test 1: Contextual class binding\n";
+var_dump(get_class(Container::make(UserController::class)->logger));
+var_dump(get_class(Container::make(AdminController::class)->logger));
+
+// Test 2: Nested resolutions see the requester's contextual binding
+echo "\nTest 2: Nested contextual binding\n";
+$dashboard = Container::make(Dashboard::class);
+var_dump(get_class($dashboard->users->logger));
+var_dump(get_class($dashboard->admins->logger));
+
+// Test 3: Contextual closures still run
+echo "\nTest 3: Contextual closure\n";
+var_dump(get_class(Container::make(ReportController::class)->logger));
+
+// Test 4: make() parameters override planned arguments
+echo "\nTest 4: Parameter override\n";
+$logger = new NullLogger();
+var_dump(Container::make(UserController::class, ['logger' => $logger])->logger === $logger);
+
+// Test 5: Parameters past the planned arguments are passed
+echo "\nTest 5: Scalar parameters\n";
+$mailer = Container::make(Mailer::class, ['host' => 'smtp.example.com', 'port' => 587]);
+var_dump($mailer->host, $mailer->port);
+$mailer = Container::make(Mailer::class, ['host' => 'smtp.example.com']);
+var_dump($mailer->host, $mailer->port);
+var_dump(get_class($mailer->logger));
+
+// Test 6: Unknown parameter names are ignored
+echo "\nTest 6: Unknown parameters\n";
+$mailer = Container::make(Mailer::class, ['timeout' => 5]);
+var_dump($mailer->host, $mailer->port);
+
+// Test 7: Contextual bindings added after compile() are honoured
+echo "\nTest 7: Contextual binding after compile\n";
+Container::when(UserController::class)
+    ->needs(LoggerInterface::class)
+    ->give(DatabaseLogger::class);
+var_dump(get_class(Container::make(UserController::class)->logger));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Contextual class binding
+string(10) "FileLogger"
+string(14) "DatabaseLogger"
+
+Test 2: Nested contextual binding
+string(10) "FileLogger"
+string(14) "DatabaseLogger"
+
+Test 3: Contextual closure
+string(10) "NullLogger"
+
+Test 4: Parameter override
+bool(true)
+
+Test 5: Scalar parameters
+string(16) "smtp.example.com"
+int(587)
+string(16) "smtp.example.com"
+int(25)
+string(10) "FileLogger"
+
+Test 6: Unknown parameters
+string(9) "localhost"
+int(25)
+
+Test 7: Contextual binding after compile
+string(14) "DatabaseLogger"
+
+Done!
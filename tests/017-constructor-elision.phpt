@@ -0,0 +1,123 @@
+--TEST--
+Container: Promoted-property constructors produce identical objects
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+
+class FileLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class Config {}
+
+class Database {
+    public function __construct(private Config $config, protected LoggerInterface $logger) {}
+    public function config(): Config { return $this->config; }
+    public function logger(): LoggerInterface { return $this->logger; }
+}
+
+class Repository {
+    public function __construct(public readonly Database $db, public readonly LoggerInterface $logger) {}
+}
+
+class Mixed {
+    public Config $plain;
+    public function __construct(public Database $db, Config $config) {
+        $this->plain = $config;
+        echo "Mixed constructor ran\n";
+    }
+}
+
+class WithDefault {
+    public function __construct(public Config $config, public string $name = 'default') {}
+}
+
+class NotALogger {}
+
+class Service {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+Container::bind(LoggerInterface::class, FileLogger::class);
+Container::singleton(Database::class);
+
+// Test 1: Private, protected and promoted properties are populated
+echo "Test 1: Promoted properties\n";
+$db = Container::make(Database::class);
+var_dump($db->config() instanceof Config);
+var_dump($db->logger() instanceof FileLogger);
+
+// Test 2: Readonly promoted properties are initialised and stay readonly
+echo "\nTest 2: Readonly properties\n";
+$repo = Container::make(Repository::class);
+var_dump($repo->db === $db);
+try {
+    $repo->db = $db;
+} catch (Error $e) {
+    echo "Readonly enforced\n";
+}
+
+// Test 3: Constructors with a body still run
+echo "\nTest 3: Constructor body\n";
+$mixed = Container::make(Mixed::class);
+var_dump($mixed->plain instanceof Config);
+
+// Test 4: Promoted parameters left to their default
+echo "\nTest 4: Promoted default\n";
+var_dump(Container::make(WithDefault::class)->name);
+var_dump(Container::make(WithDefault::class, ['name' => 'given'])->name);
+
+// Test 5: Same results once compiled
+echo "\nTest 5: Compiled\n";
+Container::bind(Repository::class);
+Container::bind(WithDefault::class);
+Container::compile();
+$repo = Container::make(Repository::class);
+var_dump($repo->db === $db);
+var_dump($repo->logger instanceof FileLogger);
+var_dump(Container::make(WithDefault::class)->name);
+
+// Test 6: Type errors are not swallowed
+echo "\nTest 6: Type mismatch\n";
+Container::bind(LoggerInterface::class, NotALogger::class);
+try {
+    Container::make(Service::class);
+    echo "Should have thrown\n";
+} catch (TypeError $e) {
+    echo "TypeError thrown\n";
+}
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Promoted properties
+bool(true)
+bool(true)
+
+Test 2: Readonly properties
+bool(true)
+Readonly enforced
+
+Test 3: Constructor body
+Mixed constructor ran
+bool(true)
+
+Test 4: Promoted default
+string(7) "default"
+string(5) "given"
+
+Test 5: Compiled
+bool(true)
+bool(true)
+string(7) "default"
+
+Test 6: Type mismatch
+TypeError thrown
+
+Done!
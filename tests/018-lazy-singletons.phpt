@@ -0,0 +1,107 @@
+--TEST--
+Container: Lazy singletons are built on first use
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+class Transport {
+    public function __construct() { echo "Transport built\n"; }
+    public function deliver(string $to): string { return "delivered to $to"; }
+}
+
+interface MailerInterface {
+    public function send(string $to): string;
+}
+
+class Mailer implements MailerInterface {
+    private int $sent = 0;
+    public function __construct(private Transport $transport) { echo "Mailer built\n"; }
+    public function send(string $to): string { $this->sent++; return $this->transport->deliver($to); }
+    public function sent(): int { return $this->sent; }
+}
+
+class Controller {
+    public function __construct(public MailerInterface $mailer) {}
+}
+
+class Settings {
+    public string $name = 'settings';
+}
+
+Container::lazy(MailerInterface::class, Mailer::class);
+Container::lazy(Settings::class);
+
+// Test 1: Injecting a lazy singleton doesn't build it
+echo "Test 1: Deferred construction\n";
+$controller = Container::make(Controller::class);
+var_dump($controller->mailer instanceof Mailer);
+var_dump(Container::resolved(MailerInterface::class));
+echo "Controller ready\n";
+
+// Test 2: First use builds the service and its dependencies
+echo "\nTest 2: First use\n";
+var_dump($controller->mailer->send('alice'));
+var_dump($controller->mailer->send('bob'));
+var_dump($controller->mailer->sent());
+
+// Test 3: Still a singleton
+echo "\nTest 3: Singleton\n";
+var_dump(Container::make(MailerInterface::class) === $controller->mailer);
+var_dump(Container::make(Controller::class)->mailer->sent());
+
+// Test 4: Classes with public properties work too
+echo "\nTest 4: Public properties\n";
+var_dump(Container::make(Settings::class)->name);
+
+// Test 5: Lazy flag is exported
+echo "\nTest 5: Bindings export\n";
+$bindings = Container::getBindings();
+var_dump($bindings[MailerInterface::class]['lazy']);
+var_dump($bindings[MailerInterface::class]['scope']);
+
+// Test 6: Same behaviour once compiled
+echo "\nTest 6: Compiled\n";
+Container::forgetInstances();
+Container::bind(Controller::class);
+Container::compile();
+$controller = Container::make(Controller::class);
+echo "Controller ready\n";
+var_dump($controller->mailer->send('carol'));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Deferred construction
+bool(true)
+bool(true)
+Controller ready
+
+Test 2: First use
+Transport built
+Mailer built
+string(18) "delivered to alice"
+string(16) "delivered to bob"
+int(2)
+
+Test 3: Singleton
+bool(true)
+int(2)
+
+Test 4: Public properties
+string(8) "settings"
+
+Test 5: Bindings export
+bool(true)
+string(9) "singleton"
+
+Test 6: Compiled
+Controller ready
+Transport built
+Mailer built
+string(18) "delivered to carol"
+
+Done!
@@ -0,0 +1,166 @@
+--TEST--
+Container: Metadata snapshots restore the graph, metadata and compiled plans
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+
+class FileLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class NullLogger implements LoggerInterface {
+    public function __construct() {}
+}
+
+class Database {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class UserRepository {
+    public function __construct(public Database $db, public int $limit = 10) {}
+}
+
+class AuditController {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class SmsChannel {}
+class MailChannel {}
+
+$snapshot = sys_get_temp_dir() . '/signalforge_snapshot_' . getmypid() . '.bin';
+
+function registerServices(): void {
+    Container::bind(LoggerInterface::class, FileLogger::class);
+    Container::singleton(Database::class);
+    Container::bind(UserRepository::class);
+    Container::bind(AuditController::class);
+    Container::when(AuditController::class)->needs(LoggerInterface::class)->give(NullLogger::class);
+    Container::alias(Database::class, 'db');
+    Container::tag([SmsChannel::class, MailChannel::class], 'channels');
+}
+
+// Test 1: Save a compiled graph
+echo "Test 1: Save\n";
+registerServices();
+Container::compile();
+Container::make(UserRepository::class);
+var_dump(Container::saveSnapshot($snapshot));
+var_dump(file_exists($snapshot));
+
+// Test 2: Load into an empty container
+echo "\nTest 2: Load\n";
+Container::flush();
+var_dump(Container::bound(Database::class));
+var_dump(Container::loadSnapshot($snapshot));
+var_dump(Container::bound(Database::class));
+var_dump(Container::isCompiled());
+
+$repo = Container::make(UserRepository::class);
+var_dump($repo->db->logger instanceof FileLogger);
+var_dump($repo->db === Container::make(Database::class));
+var_dump(Container::make('db') === $repo->db);
+var_dump(Container::make(UserRepository::class, ['limit' => 50])->limit);
+var_dump(Container::make(AuditController::class)->logger instanceof NullLogger);
+var_dump(count(Container::tagged('channels')));
+
+$bindings = Container::getBindings();
+var_dump($bindings[Database::class]['scope']);
+
+// Test 3: Imported metadata
+echo "\nTest 3: Metadata\n";
+$meta = Container::getMetadata(UserRepository::class);
+var_dump($meta['paramCount']);
+var_dump($meta['params'][0]['type']);
+var_dump($meta['params'][1]['hasDefault']);
+
+// Test 4: Closures and instances are not stored
+echo "\nTest 4: Closures and instances\n";
+Container::flush();
+Container::bind('factory', fn () => new FileLogger());
+Container::instance('config', new NullLogger());
+Container::bind(LoggerInterface::class, FileLogger::class);
+var_dump(Container::saveSnapshot($snapshot));
+Container::flush();
+var_dump(Container::loadSnapshot($snapshot));
+var_dump(Container::bound('factory'));
+var_dump(Container::bound('config'));
+var_dump(Container::bound(LoggerInterface::class));
+
+// Test 5: A changed class file makes the snapshot stale
+echo "\nTest 5: Stale snapshot\n";
+Container::flush();
+registerServices();
+Container::compile();
+Container::make(UserRepository::class);
+Container::saveSnapshot($snapshot);
+Container::flush();
+touch(__FILE__, time() + 10);
+clearstatcache();
+var_dump(Container::loadSnapshot($snapshot));
+var_dump(Container::bound(Database::class));
+
+// Test 6: Missing, corrupt and truncated files
+echo "\nTest 6: Invalid files\n";
+Container::flush();
+var_dump(Container::loadSnapshot($snapshot . '.missing'));
+
+$data = file_get_contents($snapshot);
+file_put_contents($snapshot, substr($data, 0, 64));
+var_dump(@Container::loadSnapshot($snapshot));
+
+file_put_contents($snapshot, 'SFSN' . str_repeat("\xff", strlen($data) - 4));
+var_dump(@Container::loadSnapshot($snapshot));
+var_dump(Container::bound(Database::class));
+
+unlink($snapshot);
+unlink($snapshot . '.lock');
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Save
+bool(true)
+bool(true)
+
+Test 2: Load
+bool(false)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+int(50)
+bool(true)
+int(2)
+string(9) "singleton"
+
+Test 3: Metadata
+int(2)
+string(8) "Database"
+bool(true)
+
+Test 4: Closures and instances
+bool(true)
+bool(true)
+bool(false)
+bool(false)
+bool(true)
+
+Test 5: Stale snapshot
+bool(false)
+bool(false)
+
+Test 6: Invalid files
+bool(false)
+bool(false)
+bool(false)
+bool(false)
+
+Done!
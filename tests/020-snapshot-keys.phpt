@@ -0,0 +1,125 @@
+--TEST--
+Container: Snapshot cache keys, atomic saves and the writer lock
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface CacheInterface {}
+class FileCache implements CacheInterface {}
+class RedisCache implements CacheInterface {}
+class Mailer {}
+class Queue {}
+
+// Test 1: Swapping a concrete changes the key
+echo "Test 1: Concrete changes the key\n";
+Container::bind(CacheInterface::class, FileCache::class);
+$file = Container::getCachePath();
+Container::bind(CacheInterface::class, RedisCache::class);
+$redis = Container::getCachePath();
+var_dump($file !== $redis);
+var_dump((bool)preg_match('/signalforge_cache_[0-9a-f]{40}\.bin$/', $redis));
+
+// Test 2: Scope and registration order are part of the key
+echo "\nTest 2: Scope and order\n";
+Container::flush();
+Container::bind(Mailer::class);
+$transient = Container::getCachePath();
+Container::singleton(Mailer::class);
+var_dump($transient !== Container::getCachePath());
+
+Container::flush();
+Container::bind(Mailer::class);
+Container::bind(Queue::class);
+$mailerFirst = Container::getCachePath();
+Container::flush();
+Container::bind(Queue::class);
+Container::bind(Mailer::class);
+var_dump($mailerFirst !== Container::getCachePath());
+
+// Test 3: The same graph gives the same key, closures by kind only
+echo "\nTest 3: Stable keys\n";
+Container::flush();
+Container::bind(Mailer::class);
+Container::bind('factory', fn () => new Queue());
+$first = Container::getCachePath();
+Container::flush();
+Container::bind(Mailer::class);
+Container::bind('factory', fn () => new Mailer());
+var_dump($first === Container::getCachePath());
+
+// Test 4: Default path round trip, without leftover temporary files
+echo "\nTest 4: Default path\n";
+Container::flush();
+Container::bind(CacheInterface::class, FileCache::class);
+Container::singleton(Mailer::class);
+$path = Container::getCachePath();
+@unlink($path);
+var_dump(Container::saveSnapshot());
+var_dump(file_exists($path));
+var_dump(glob($path . '.??????'));
+
+Container::flush();
+Container::bind(CacheInterface::class, FileCache::class);
+Container::singleton(Mailer::class);
+var_dump(Container::loadSnapshot());
+var_dump(Container::make(CacheInterface::class) instanceof FileCache);
+
+// Test 5: A save in progress elsewhere makes saveSnapshot() skip
+echo "\nTest 5: Writer lock\n";
+$lock = fopen($path . '.lock', 'c');
+var_dump(flock($lock, LOCK_EX | LOCK_NB));
+var_dump(Container::saveSnapshot());
+flock($lock, LOCK_UN);
+fclose($lock);
+var_dump(Container::saveSnapshot());
+
+// Test 6: Deferred saves don't write during the request
+echo "\nTest 6: Deferred save\n";
+$deferred = sys_get_temp_dir() . '/signalforge_deferred_020.bin';
+Container::deferSnapshot($deferred);
+var_dump(file_exists($deferred));
+
+unlink($path);
+unlink($path . '.lock');
+
+echo "\nDone!\n";
+?>
+--CLEAN--
+<?php
+$deferred = sys_get_temp_dir() . '/signalforge_deferred_020.bin';
+@unlink($deferred);
+@unlink($deferred . '.lock');
+?>
+--EXPECT--
+Test 1: Concrete changes the key
+bool(true)
+bool(true)
+
+Test 2: Scope and order
+bool(true)
+bool(true)
+
+Test 3: Stable keys
+bool(true)
+
+Test 4: Default path
+bool(true)
+bool(true)
+array(0) {
+}
+bool(true)
+bool(true)
+
+Test 5: Writer lock
+bool(true)
+bool(false)
+bool(true)
+
+Test 6: Deferred save
+bool(false)
+
+Done!
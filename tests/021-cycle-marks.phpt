@@ -0,0 +1,124 @@
+--TEST--
+Container: Cycle detection through binding and metadata marks
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\CircularDependencyException;
+
+// Test fixtures
+interface PaymentGateway {}
+
+class StripeGateway implements PaymentGateway {
+    public function __construct(public Checkout $checkout) {}
+}
+
+class Checkout {
+    public function __construct(public PaymentGateway $gateway) {}
+}
+
+class NodeA {
+    public function __construct(public NodeB $b) {}
+}
+
+class NodeB {
+    public function __construct(public NodeC $c) {}
+}
+
+class NodeC {
+    public function __construct(public NodeA $a) {}
+}
+
+interface Transport {}
+class SmtpTransport implements Transport {
+    public function __construct(public Mailer $mailer) {}
+}
+class Mailer {
+    public function __construct(public Transport $transport) {}
+}
+
+// A chain much deeper than the stack's initial capacity
+for ($i = 0; $i < 200; $i++) {
+    $next = $i > 0 ? 'public Chain' . ($i - 1) . ' $next' : '';
+    eval("class Chain$i { public function __construct($next) {} }");
+}
+
+function cycle(string $abstract): string {
+    try {
+        Container::make($abstract);
+        return "no exception";
+    } catch (CircularDependencyException $e) {
+        return $e->getMessage();
+    }
+}
+
+// Test 1: The message names the whole cycle, cold and with cached metadata
+echo "Test 1: Autowired cycle\n";
+echo cycle(NodeA::class), "\n";
+echo cycle(NodeA::class), "\n";
+echo cycle(NodeB::class), "\n";
+
+// Test 2: Cycles through bindings
+echo "\nTest 2: Bound cycle\n";
+Container::bind(PaymentGateway::class, StripeGateway::class);
+echo cycle(Checkout::class), "\n";
+echo cycle(PaymentGateway::class), "\n";
+
+// Test 3: A failed resolution leaves no marks behind
+echo "\nTest 3: Recovery\n";
+Container::bind(PaymentGateway::class, fn () => new class implements PaymentGateway {});
+var_dump(Container::make(Checkout::class)->gateway instanceof PaymentGateway);
+
+// Test 4: Deep acyclic graphs
+echo "\nTest 4: Deep chain\n";
+var_dump(Container::make('Chain199') instanceof Chain199);
+var_dump(Container::make('Chain199') !== Container::make('Chain199'));
+
+// Test 5: Compiled plans - acyclic ones and ones that defer to make()
+echo "\nTest 5: Compiled\n";
+Container::flush();
+Container::bind('Chain40');
+Container::bind(Transport::class, SmtpTransport::class);
+Container::compile();
+var_dump(Container::make('Chain40')->next instanceof Chain39);
+var_dump(str_starts_with(cycle(Mailer::class), 'Circular dependency detected: Mailer -> Transport'));
+echo cycle(NodeC::class), "\n";
+
+// Test 6: A closure that loops back to a compiled service
+echo "\nTest 6: Closure loop\n";
+Container::flush();
+Container::bind(PaymentGateway::class, fn () => Container::make(Checkout::class));
+Container::bind(Checkout::class);
+Container::compile();
+echo cycle(Checkout::class), "\n";
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Autowired cycle
+Circular dependency detected: NodeA -> NodeB -> NodeC -> NodeA
+Circular dependency detected: NodeA -> NodeB -> NodeC -> NodeA
+Circular dependency detected: NodeB -> NodeC -> NodeA -> NodeB
+
+Test 2: Bound cycle
+Circular dependency detected: Checkout -> PaymentGateway -> Checkout
+Circular dependency detected: PaymentGateway -> Checkout -> PaymentGateway
+
+Test 3: Recovery
+bool(true)
+
+Test 4: Deep chain
+bool(true)
+bool(true)
+
+Test 5: Compiled
+bool(true)
+bool(true)
+Circular dependency detected: NodeC -> NodeA -> NodeB -> NodeC
+
+Test 6: Closure loop
+Circular dependency detected: Checkout -> PaymentGateway -> Checkout
+
+Done!
@@ -0,0 +1,169 @@
+--TEST--
+Container: Call-site caches for get() and make()
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface CacheInterface {}
+class FileCache implements CacheInterface {}
+class RedisCache implements CacheInterface {}
+
+class Clock {}
+
+class Report {
+    public function __construct(public Clock $clock) {}
+}
+
+// One call site, called repeatedly
+function cache(): CacheInterface {
+    return Container::get(CacheInterface::class);
+}
+
+function report(): Report {
+    return Container::make(Report::class);
+}
+
+function byName(string $name): mixed {
+    return Container::get($name);
+}
+
+// Test 1: Repeat calls return the same singleton
+echo "Test 1: Singleton\n";
+Container::singleton(CacheInterface::class, FileCache::class);
+$first = cache();
+var_dump($first instanceof FileCache);
+var_dump(cache() === $first && cache() === $first);
+
+// Test 2: bind() invalidates the site
+echo "\nTest 2: Rebind\n";
+Container::forgetInstance(CacheInterface::class);
+Container::singleton(CacheInterface::class, RedisCache::class);
+var_dump(cache() instanceof RedisCache);
+var_dump(cache() === cache());
+
+// Test 3: forgetInstance() and flush() invalidate the site
+echo "\nTest 3: Forget and flush\n";
+$redis = cache();
+Container::forgetInstance(CacheInterface::class);
+var_dump(cache() !== $redis);
+Container::flush();
+Container::bind(CacheInterface::class, FileCache::class);
+var_dump(cache() instanceof FileCache);
+var_dump(cache() !== cache());
+
+// Test 4: Compiled transient plans still build a new object per call
+echo "\nTest 4: Compiled plan\n";
+Container::flush();
+Container::bind(Report::class);
+Container::singleton(Clock::class);
+Container::compile();
+$a = report();
+$b = report();
+var_dump($a !== $b);
+var_dump($a->clock === $b->clock);
+Container::clearCompiled();
+Container::resetStats();
+report();
+report();
+var_dump(Container::stats()['paths']['callSite']);
+
+// Test 5: One site asking for different names
+echo "\nTest 5: Dynamic names\n";
+Container::singleton('answer', fn () => 42);
+Container::instance('config', new ArrayObject(['debug' => true]));
+var_dump(byName('answer'));
+var_dump(byName('config')['debug']);
+var_dump(byName('ans' . 'wer'));
+var_dump(byName('con' . 'fig') === byName('config'));
+
+// Test 6: An alias added later is honoured
+echo "\nTest 6: Alias\n";
+Container::instance('primary', new FileCache());
+Container::instance('secondary', new RedisCache());
+Container::alias('primary', 'store');
+var_dump(byName('store') instanceof FileCache);
+Container::alias('secondary', 'store');
+var_dump(byName('store') instanceof RedisCache);
+
+// Test 7: Destructors are not delayed by a cached site
+echo "\nTest 7: Release\n";
+class Tracked {
+    public function __destruct() { echo "destroyed\n"; }
+}
+Container::singleton(Tracked::class);
+function tracked(): Tracked {
+    return Container::get(Tracked::class);
+}
+tracked();
+tracked();
+Container::forgetInstance(Tracked::class);
+echo "after forget\n";
+
+// Test 8: A destructor calling get() while the store is emptied misses the site
+echo "\nTest 8: Reentrant release\n";
+class Victim {
+    public static array $seen = [];
+    public function __destruct() {
+        if (count(self::$seen) < 2) {
+            self::$seen[] = victim() === $this;
+        }
+    }
+}
+function victim(): Victim {
+    return Container::get(Victim::class);
+}
+Container::singleton(Victim::class);
+victim();
+victim();
+Container::forgetInstance(Victim::class);
+Container::flush();
+var_dump(Victim::$seen);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Singleton
+bool(true)
+bool(true)
+
+Test 2: Rebind
+bool(true)
+bool(true)
+
+Test 3: Forget and flush
+bool(true)
+bool(true)
+bool(true)
+
+Test 4: Compiled plan
+bool(true)
+bool(true)
+int(0)
+
+Test 5: Dynamic names
+int(42)
+bool(true)
+int(42)
+bool(true)
+
+Test 6: Alias
+bool(true)
+bool(true)
+
+Test 7: Release
+destroyed
+after forget
+
+Test 8: Reentrant release
+array(2) {
+  [0]=>
+  bool(false)
+  [1]=>
+  bool(false)
+}
+
+Done!
@@ -0,0 +1,168 @@
+--TEST--
+Container: makeMany(), cached tag lists and lazyTagged()
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\NotFoundException;
+use Signalforge\Container\TaggedIterator;
+
+// Test fixtures
+interface CacheInterface {}
+class FileCache implements CacheInterface {}
+class Database {}
+
+class Listener {
+    public static int $built = 0;
+    public function __construct() { self::$built++; }
+}
+class AuditListener extends Listener {}
+class MailListener extends Listener {}
+class SlackListener extends Listener {}
+
+interface Missing {}
+
+// Test 1: makeMany() keeps keys and resolves like make()
+echo "Test 1: makeMany\n";
+Container::bind(CacheInterface::class, FileCache::class);
+Container::singleton(Database::class);
+$services = Container::makeMany(['cache' => CacheInterface::class, 'db' => Database::class, 5 => Database::class]);
+var_dump(array_keys($services));
+var_dump($services['cache'] instanceof FileCache);
+var_dump($services['db'] === $services[5]);
+var_dump(Container::makeMany([]));
+
+// Test 2: makeMany() fails as a whole
+echo "\nTest 2: makeMany failures\n";
+try {
+    Container::makeMany([Database::class, Missing::class]);
+} catch (NotFoundException $e) {
+    echo "NotFoundException\n";
+}
+try {
+    Container::makeMany([Database::class, 42]);
+} catch (TypeError $e) {
+    echo $e->getMessage(), "\n";
+}
+
+// Test 3: Singleton tags are cached until the graph changes
+echo "\nTest 3: Cached tags\n";
+Container::singleton(AuditListener::class);
+Container::singleton(MailListener::class);
+Container::tag([AuditListener::class, MailListener::class], 'listeners');
+$first = Container::tagged('listeners');
+$second = Container::tagged('listeners');
+var_dump($first === $second && $first[0] === $second[0]);
+var_dump(Listener::$built);
+
+$second[] = 'modified';
+var_dump(count(Container::tagged('listeners')));
+
+Container::forgetInstance(AuditListener::class);
+var_dump(Container::tagged('listeners')[0] !== $first[0]);
+var_dump(Listener::$built);
+
+// Test 4: Appending to a tag and transient members
+echo "\nTest 4: Changing tags\n";
+Container::tag([SlackListener::class], 'listeners');
+$all = Container::tagged('listeners');
+var_dump(count($all));
+var_dump(Container::tagged('listeners')[2] !== $all[2]);
+
+// Test 5: Unresolvable members throw
+echo "\nTest 5: Failing member\n";
+Container::tag([Missing::class], 'broken');
+try {
+    Container::tagged('broken');
+    echo "Should have thrown exception\n";
+} catch (NotFoundException $e) {
+    echo "NotFoundException\n";
+}
+
+// Test 6: lazyTagged() resolves on demand
+echo "\nTest 6: Lazy iteration\n";
+Listener::$built = 0;
+Container::flush();
+Container::bind(AuditListener::class);
+Container::bind(MailListener::class);
+Container::bind(SlackListener::class);
+Container::tag([AuditListener::class, MailListener::class, SlackListener::class], 'listeners');
+
+$iterator = Container::lazyTagged('listeners');
+var_dump($iterator instanceof TaggedIterator);
+var_dump(count($iterator));
+var_dump(Listener::$built);
+foreach ($iterator as $i => $listener) {
+    echo $i, ": ", get_class($listener), "\n";
+    if ($listener instanceof MailListener) {
+        break;
+    }
+}
+var_dump(Listener::$built);
+
+// current() returns the same object until next()
+$iterator->rewind();
+var_dump($iterator->current() === $iterator->current());
+
+// Test 7: Unknown tags and flush() mid-iteration
+echo "\nTest 7: Edge cases\n";
+var_dump(iterator_to_array(Container::lazyTagged('nothing')));
+$iterator = Container::lazyTagged('listeners');
+$iterator->rewind();
+Container::flush();
+var_dump(count($iterator));
+var_dump($iterator->current() instanceof AuditListener);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: makeMany
+array(3) {
+  [0]=>
+  string(5) "cache"
+  [1]=>
+  string(2) "db"
+  [2]=>
+  int(5)
+}
+bool(true)
+bool(true)
+array(0) {
+}
+
+Test 2: makeMany failures
+NotFoundException
+Signalforge\Container\Container::makeMany(): Argument #1 ($abstracts) must contain only strings, int given
+
+Test 3: Cached tags
+bool(true)
+int(2)
+int(2)
+bool(true)
+int(3)
+
+Test 4: Changing tags
+int(3)
+bool(true)
+
+Test 5: Failing member
+NotFoundException
+
+Test 6: Lazy iteration
+bool(true)
+int(3)
+int(0)
+0: AuditListener
+1: MailListener
+int(2)
+bool(true)
+
+Test 7: Edge cases
+array(0) {
+}
+int(3)
+bool(true)
+
+Done!
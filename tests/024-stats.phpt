@@ -0,0 +1,182 @@
+--TEST--
+Container: Resolution statistics
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+class FileLogger implements LoggerInterface {}
+interface Missing {}
+
+class Database {}
+class Clock {}
+
+class Report {
+    public function __construct(public Database $db) {}
+}
+
+class Controller {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class Wide {
+    public function __construct(
+        int $a = 1, int $b = 2, int $c = 3, int $d = 4, int $e = 5,
+        int $f = 6, int $g = 7, int $h = 8, int $i = 9,
+    ) {}
+}
+
+class Greeter {
+    public string $greeting;
+    public function __construct(Clock $clock) { $this->greeting = 'hello'; }
+}
+
+// One call site, called repeatedly
+function service(string $id): mixed {
+    return Container::get($id);
+}
+
+// Test 1: Call-site slots and per-binding counts
+echo "Test 1: Call site\n";
+Container::singleton(Database::class);
+Container::resetStats();
+service(Database::class);
+service(Database::class);
+$stats = Container::stats();
+var_dump($stats['make'], $stats['callSiteMisses'], $stats['paths']['callSite'], $stats['paths']['autowire']);
+var_dump($stats['bindings']);
+var_dump($stats['metadataBuilds']);
+var_dump($stats['lookup']['finds'] > 0);
+
+// Test 2: Dependencies from the singleton store
+echo "\nTest 2: Singleton store\n";
+Container::resetStats();
+Container::make(Report::class);
+$stats = Container::stats();
+var_dump($stats['make'], $stats['paths']['singleton'], $stats['paths']['autowire']);
+var_dump($stats['bindings']);
+
+// Test 3: Closures, contextual bindings and failures
+echo "\nTest 3: Slow paths\n";
+Container::bind('clock', fn () => new Clock());
+Container::when(Controller::class)->needs(LoggerInterface::class)->give(FileLogger::class);
+Container::resetStats();
+service('clock');
+service('clock');
+Container::make(Controller::class);
+try {
+    Container::make(Missing::class);
+} catch (Exception $e) {
+}
+$stats = Container::stats();
+var_dump($stats['paths']['closure'], $stats['paths']['contextual'], $stats['failures']);
+var_dump($stats['bindings']['clock']);
+
+// Test 4: Compiled plans
+echo "\nTest 4: Compiled\n";
+Container::flush();
+Container::bind(Report::class);
+Container::singleton(Database::class);
+Container::compile();
+Container::resetStats();
+service(Report::class);
+service(Report::class);
+$stats = Container::stats();
+var_dump($stats['paths']['compiled'], $stats['paths']['callSite']);
+var_dump($stats['bindings']);
+
+// Test 5: Constructors called and elided
+echo "\nTest 5: Constructors\n";
+Container::resetStats();
+Container::make(Wide::class);
+Container::make(Greeter::class);
+var_dump(Container::stats()['constructors']);
+
+// Test 6: Timing is opt-in and only covers outermost resolutions
+echo "\nTest 6: Timing\n";
+Container::flush();
+Container::resetStats();
+Container::make(Report::class);
+$timing = Container::stats()['timing'];
+var_dump($timing['enabled'], $timing['resolutions']);
+
+ini_set('signalforge_container.stats_timing', '1');
+Container::singleton(Database::class);
+Container::make(Report::class);
+Container::make(Database::class);
+$timing = Container::stats()['timing'];
+var_dump($timing['enabled'], $timing['resolutions']);
+var_dump($timing['totalNs'] >= $timing['maxNs']);
+ini_set('signalforge_container.stats_timing', '0');
+
+// Test 7: Reset and phpinfo()
+echo "\nTest 7: Reset\n";
+Container::resetStats();
+$stats = Container::stats();
+var_dump($stats['make'], $stats['lookup']['finds'], $stats['bindings']);
+
+ob_start();
+phpinfo(INFO_MODULES);
+var_dump(str_contains(ob_get_clean(), 'Resolution statistics'));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Call site
+int(1)
+int(1)
+int(1)
+int(1)
+array(1) {
+  ["Database"]=>
+  int(1)
+}
+int(1)
+bool(true)
+
+Test 2: Singleton store
+int(2)
+int(1)
+int(1)
+array(0) {
+}
+
+Test 3: Slow paths
+int(2)
+int(1)
+int(1)
+int(2)
+
+Test 4: Compiled
+int(1)
+int(1)
+array(0) {
+}
+
+Test 5: Constructors
+array(2) {
+  ["called"]=>
+  int(1)
+  ["elided"]=>
+  int(1)
+}
+
+Test 6: Timing
+bool(false)
+int(0)
+bool(true)
+int(1)
+bool(true)
+
+Test 7: Reset
+int(0)
+int(0)
+array(0) {
+}
+bool(true)
+
+Done!
@@ -0,0 +1,137 @@
+--TEST--
+Container: Scoped services with beginScope()/endScope()
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\ContainerException;
+
+// Test fixtures
+class Database {}
+
+class RequestContext {
+    public static int $destroyed = 0;
+    public function __destruct() { self::$destroyed++; }
+}
+
+class Handler {
+    public function __construct(public RequestContext $context, public Database $db) {}
+}
+
+class User {
+    public function __construct(public string $name = 'guest') {}
+}
+
+// Test 1: One instance per scope
+echo "Test 1: Per scope\n";
+Container::scoped(RequestContext::class);
+Container::singleton(Database::class);
+Container::beginScope();
+$a = Container::make(RequestContext::class);
+var_dump($a === Container::make(RequestContext::class));
+var_dump(Container::resolved(RequestContext::class));
+Container::endScope();
+Container::beginScope();
+$b = Container::make(RequestContext::class);
+var_dump($a === $b);
+Container::endScope();
+unset($a, $b);
+
+// Test 2: Outside a scope
+echo "\nTest 2: No scope\n";
+try {
+    Container::make(RequestContext::class);
+} catch (ContainerException $e) {
+    var_dump(str_contains($e->getMessage(), 'RequestContext'));
+}
+try {
+    Container::endScope();
+} catch (ContainerException $e) {
+    echo "No scope to end\n";
+}
+var_dump(Container::resolved(RequestContext::class));
+
+// Test 3: endScope() releases scoped instances, singletons stay
+echo "\nTest 3: Release\n";
+RequestContext::$destroyed = 0;
+Container::beginScope();
+$handler = Container::make(Handler::class);
+$db = $handler->db;
+unset($handler);
+var_dump(RequestContext::$destroyed);
+Container::endScope();
+var_dump(RequestContext::$destroyed);
+var_dump($db === Container::make(Database::class));
+
+// Test 4: Nested scopes see their parents' instances
+echo "\nTest 4: Nested\n";
+Container::beginScope();
+$outer = Container::make(RequestContext::class);
+Container::beginScope();
+var_dump($outer === Container::make(RequestContext::class));
+Container::endScope();
+var_dump($outer === Container::make(RequestContext::class));
+Container::endScope();
+unset($outer);
+
+// Test 5: instance() overrides a scoped binding for one scope
+echo "\nTest 5: Override\n";
+Container::scoped(User::class);
+Container::beginScope();
+Container::instance(User::class, new User('alice'));
+echo Container::make(User::class)->name, "\n";
+Container::endScope();
+Container::beginScope();
+echo Container::make(User::class)->name, "\n";
+Container::endScope();
+var_dump(Container::getBindings()[User::class]['scope']);
+
+// Test 6: Compiled plans resolve scoped dependencies per scope
+echo "\nTest 6: Compiled\n";
+Container::bind(Handler::class);
+Container::compile();
+Container::beginScope();
+$h1 = Container::make(Handler::class);
+$h2 = Container::make(Handler::class);
+var_dump($h1->context === $h2->context);
+Container::endScope();
+Container::beginScope();
+$h3 = Container::make(Handler::class);
+var_dump($h1->context === $h3->context, $h1->db === $h3->db);
+Container::endScope();
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Per scope
+bool(true)
+bool(true)
+bool(false)
+
+Test 2: No scope
+bool(true)
+No scope to end
+bool(false)
+
+Test 3: Release
+int(0)
+int(1)
+bool(true)
+
+Test 4: Nested
+bool(true)
+bool(true)
+
+Test 5: Override
+alice
+guest
+string(6) "scoped"
+
+Test 6: Compiled
+bool(true)
+bool(false)
+bool(true)
+
+Done!
@@ -0,0 +1,104 @@
+--TEST--
+Container: Resolution stacks are kept per fiber
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\CircularDependencyException;
+
+// Test fixtures
+class Connection {
+    public function __construct() { Fiber::suspend(); }
+}
+
+class Repository {
+    public function __construct(public Connection $connection) {}
+}
+
+class Outer {
+    public function __construct(Connection $connection, Back $back) {}
+}
+
+class Back {
+    public function __construct(Outer $outer) {}
+}
+
+class Wrapper {
+    public function __construct(Outer $outer) {}
+}
+
+class Plain {}
+
+Container::bind(Connection::class);
+Container::bind(Repository::class);
+
+// Test 1: Two fibers suspend while resolving the same class
+echo "Test 1: Concurrent fibers\n";
+$f1 = new Fiber(fn () => Container::make(Repository::class));
+$f2 = new Fiber(fn () => Container::make(Repository::class));
+$f1->start();
+$f2->start();
+$f1->resume();
+$f2->resume();
+var_dump($f1->getReturn() instanceof Repository, $f2->getReturn() instanceof Repository);
+var_dump($f1->getReturn() !== $f2->getReturn());
+
+// Test 2: The main fiber resolves while others are suspended mid-resolution
+echo "\nTest 2: Main fiber\n";
+$f1 = new Fiber(fn () => Container::make(Repository::class));
+$f1->start();
+var_dump(Container::make(Plain::class) instanceof Plain);
+$f1->resume();
+var_dump($f1->getReturn() instanceof Repository);
+
+// Test 3: A cycle is still found after another fiber reused the same bindings
+echo "\nTest 3: Cycle across a suspension\n";
+Container::bind(Outer::class);
+Container::bind(Back::class);
+Container::bind(Wrapper::class);
+$resolve = function (string $abstract) {
+    try {
+        Container::make($abstract);
+    } catch (CircularDependencyException $e) {
+        return $e->getMessage();
+    }
+    return 'no cycle';
+};
+$f1 = new Fiber(fn () => $resolve(Outer::class));
+$f2 = new Fiber(fn () => $resolve(Wrapper::class));
+$f1->start();
+$f2->start();
+$f2->resume();
+$f1->resume();
+echo $f2->getReturn(), "\n";
+echo $f1->getReturn(), "\n";
+
+// Test 4: A fiber destroyed while suspended mid-resolution
+echo "\nTest 4: Destroyed fiber\n";
+$f1 = new Fiber(fn () => Container::make(Repository::class));
+$f1->start();
+unset($f1);
+var_dump(Container::make(Plain::class) instanceof Plain);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Concurrent fibers
+bool(true)
+bool(true)
+bool(true)
+
+Test 2: Main fiber
+bool(true)
+bool(true)
+
+Test 3: Cycle across a suspension
+Circular dependency detected: Wrapper -> Outer -> Back -> Outer
+Circular dependency detected: Outer -> Back -> Outer
+
+Test 4: Destroyed fiber
+bool(true)
+
+Done!
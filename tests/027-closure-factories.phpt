@@ -0,0 +1,85 @@
+--TEST--
+Container: Closure factories get only the arguments they declare
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface LoggerInterface {}
+class FileLogger implements LoggerInterface {}
+class NullLogger implements LoggerInterface {}
+
+class Mailer {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+// Test 1: Declared arity
+echo "Test 1: Arity\n";
+Container::bind('none', fn () => func_num_args());
+Container::bind('one', fn (Container $c) => func_num_args());
+Container::bind('two', fn (Container $c, array $params) => func_num_args());
+Container::bind('rest', fn (...$args) => count($args));
+var_dump(Container::make('none'), Container::make('one'), Container::make('two'), Container::make('rest'));
+
+// Test 2: Parameters
+echo "\nTest 2: Parameters\n";
+Container::bind('greeting', fn (Container $c, array $params) => 'Hello ' . ($params['name'] ?? 'world'));
+echo Container::make('greeting'), "\n";
+echo Container::make('greeting', ['name' => 'Alice']), "\n";
+echo Container::make('greeting'), "\n";
+
+// Test 3: One container object per request
+echo "\nTest 3: Container object\n";
+$seen = [];
+Container::bind('probe', function (Container $c) use (&$seen) {
+    $seen[] = $c;
+    return $c->make(FileLogger::class);
+});
+var_dump(Container::make('probe') instanceof FileLogger);
+Container::make('probe');
+var_dump($seen[0] === $seen[1]);
+
+// Test 4: Closure given to a contextual binding
+echo "\nTest 4: Contextual\n";
+Container::when(Mailer::class)->needs(LoggerInterface::class)->give(fn (Container $c) => new NullLogger());
+var_dump(Container::make(Mailer::class)->logger instanceof NullLogger);
+
+// Test 5: Closure from a callable
+echo "\nTest 5: First-class callable\n";
+class Factory {
+    public function __call(string $name, array $args): string { return $name . ':' . count($args); }
+    public function build(Container $c): string { return 'built'; }
+}
+$factory = new Factory();
+Container::bind('built', $factory->build(...));
+Container::bind('magic', $factory->anything(...));
+echo Container::make('built'), "\n";
+echo Container::make('magic'), "\n";
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Arity
+int(0)
+int(1)
+int(2)
+int(2)
+
+Test 2: Parameters
+Hello world
+Hello Alice
+Hello world
+
+Test 3: Container object
+bool(true)
+bool(true)
+
+Test 4: Contextual
+bool(true)
+
+Test 5: First-class callable
+built
+magic:2
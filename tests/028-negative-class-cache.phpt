@@ -0,0 +1,97 @@
+--TEST--
+Container: Failed class lookups are remembered until classes or autoloaders change
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\NotFoundException;
+
+// Test fixtures
+$calls = [];
+spl_autoload_register(function (string $class) use (&$calls) {
+    $calls[$class] = ($calls[$class] ?? 0) + 1;
+});
+
+class Loaded {}
+interface Contract {}
+
+// Test 1: Repeated has() on a missing name runs the autoloader once
+echo "Test 1: has()\n";
+for ($i = 0; $i < 3; $i++) {
+    var_dump(Container::has('App\Missing'));
+}
+var_dump($calls['App\Missing']);
+
+// Test 2: make() shares the remembered miss
+echo "\nTest 2: make()\n";
+try {
+    Container::make('App\Missing');
+} catch (NotFoundException $e) {
+    echo $e->getMessage(), "\n";
+}
+var_dump($calls['App\Missing']);
+
+// Test 3: A newly declared class is not hidden
+echo "\nTest 3: New class\n";
+eval('namespace App; class Declared {}');
+var_dump(Container::has('App\Missing'));
+var_dump($calls['App\Missing']);
+
+// Test 4: A new autoloader gets asked
+echo "\nTest 4: New autoloader\n";
+spl_autoload_register(function (string $class) {
+    if ($class === 'App\Missing') {
+        eval('namespace App; class Missing {}');
+    }
+});
+var_dump(Container::has('App\Missing'));
+var_dump($calls['App\Missing']);
+
+// Test 5: has() without autoloading
+echo "\nTest 5: has_autoload=0\n";
+var_dump(Container::has(Contract::class));  // Caches its metadata
+ini_set('signalforge_container.has_autoload', '0');
+var_dump(Container::has(Contract::class));
+var_dump(Container::has('App\Other'));
+var_dump(isset($calls['App\Other']));
+var_dump(Container::has(Loaded::class));
+Container::bind('App\Bound', fn () => new Loaded());
+var_dump(Container::has('App\Bound'));
+ini_set('signalforge_container.has_autoload', '1');
+var_dump(Container::has('App\Other'));
+var_dump($calls['App\Other']);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: has()
+bool(false)
+bool(false)
+bool(false)
+int(1)
+
+Test 2: make()
+Class 'App\Missing' not found
+int(1)
+
+Test 3: New class
+bool(false)
+int(2)
+
+Test 4: New autoloader
+bool(true)
+int(3)
+
+Test 5: has_autoload=0
+bool(false)
+bool(false)
+bool(false)
+bool(false)
+bool(true)
+bool(true)
+bool(false)
+int(1)
+
+Done!
@@ -0,0 +1,136 @@
+--TEST--
+Container: Hot services are compiled without compile() and rebuilt only when their graph changes
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+class Clock {}
+
+class Mailer {
+    public function __construct(public Clock $clock) {}
+}
+
+class Report {
+    public function __construct(public Mailer $mailer) {}
+}
+
+interface Store {}
+class FileStore implements Store {}
+class RedisStore implements Store {}
+
+class Cart {
+    public function __construct(public Store $store) {}
+}
+
+class Fresh {}
+
+class Ledger {}
+
+class Collector {
+    public function __construct(...$items) {}
+}
+
+ini_set('signalforge_container.compile_threshold', '3');
+
+// Test 1: A class autowired often enough gets a plan
+echo "Test 1: Promotion\n";
+for ($i = 0; $i < 3; $i++) {
+    Container::make(Report::class);
+}
+var_dump(Container::stats()['plans']['promoted']);
+var_dump(Container::isCompiled());
+Container::resetStats();
+$report = Container::make(Report::class);
+var_dump($report->mailer->clock instanceof Clock);
+var_dump(Container::stats()['paths']['autowire']);
+
+// Test 2: Rebinding rebuilds only the plans that depend on the binding
+echo "\nTest 2: Rebind\n";
+Container::bind(Store::class, FileStore::class);
+for ($i = 0; $i < 3; $i++) {
+    Container::make(Cart::class);
+}
+Container::resetStats();
+Container::bind(Store::class, RedisStore::class);
+echo get_class(Container::make(Cart::class)->store), "\n";
+var_dump(Container::make(Report::class) instanceof Report);
+var_dump(Container::stats()['plans']['rebuilt']);
+
+// Test 3: A contextual rule reaches compiled plans
+echo "\nTest 3: Contextual\n";
+Container::when(Cart::class)->needs(Store::class)->give(FileStore::class);
+echo get_class(Container::make(Cart::class)->store), "\n";
+
+// Test 4: Threshold 0 leaves compilation to compile()
+echo "\nTest 4: Disabled\n";
+ini_set('signalforge_container.compile_threshold', '0');
+Container::resetStats();
+for ($i = 0; $i < 5; $i++) {
+    Container::make(Fresh::class);
+}
+var_dump(Container::stats()['plans']['promoted']);
+var_dump(Container::stats()['paths']['autowire']);
+
+// Test 5: A class that can't be planned is only tried once
+echo "\nTest 5: Unplannable\n";
+Container::compile();
+Container::resetStats();
+for ($i = 0; $i < 5; $i++) {
+    Container::make(Collector::class);
+}
+var_dump(Container::stats()['plans']);
+var_dump(Container::stats()['paths']['autowire']);
+
+// Test 6: resetStats() doesn't restart tiering
+echo "\nTest 6: Reset stats\n";
+Container::clearCompiled();
+ini_set('signalforge_container.compile_threshold', '3');
+Container::bind('ledger', Ledger::class);
+Container::make('ledger');
+Container::make('ledger');
+Container::resetStats();
+Container::make('ledger');
+Container::resetStats();
+Container::make('ledger');
+var_dump(Container::stats()['paths']['compiled']);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Promotion
+int(3)
+bool(false)
+bool(true)
+int(0)
+
+Test 2: Rebind
+RedisStore
+bool(true)
+int(1)
+
+Test 3: Contextual
+FileStore
+
+Test 4: Disabled
+int(0)
+int(5)
+
+Test 5: Unplannable
+array(3) {
+  ["promoted"]=>
+  int(0)
+  ["rebuilt"]=>
+  int(0)
+  ["failed"]=>
+  int(1)
+}
+int(5)
+
+Test 6: Reset stats
+int(1)
+
+Done!
@@ -0,0 +1,72 @@
+--TEST--
+Container: Scalar kernels selected through the simd INI cap
+--EXTENSIONS--
+signalforge_container
+--INI--
+signalforge_container.simd=scalar
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\CircularDependencyException;
+
+// Test fixtures
+class Service {
+    public function __construct() {}
+}
+
+class LoopA {
+    public function __construct(LoopB $b) {}
+}
+
+class LoopB {
+    public function __construct(LoopA $a) {}
+}
+
+// Test 1: phpinfo() reports the selected kernels
+echo "Test 1: phpinfo\n";
+ob_start();
+phpinfo(INFO_MODULES);
+$info = ob_get_clean();
+var_dump(str_contains($info, 'SIMD kernels => Scalar (16-slot groups)'));
+var_dump(ini_get('signalforge_container.simd'));
+
+// Test 2: The singleton store grows and forgets on the scalar kernels
+echo "\nTest 2: Many singletons\n";
+$first = [];
+for ($i = 0; $i < 300; $i++) {
+    Container::singleton("service.$i", Service::class);
+    $first[$i] = Container::make("service.$i");
+}
+for ($i = 0; $i < 300; $i += 3) {
+    Container::forgetInstance("service.$i");
+}
+$ok = true;
+for ($i = 0; $i < 300; $i++) {
+    $instance = Container::make("service.$i");
+    $ok = $ok && (($i % 3) ? $instance === $first[$i] : $instance !== $first[$i]);
+}
+var_dump($ok);
+
+// Test 3: Circular dependencies are still detected
+echo "\nTest 3: Circular dependency\n";
+try {
+    Container::make(LoopA::class);
+} catch (CircularDependencyException $e) {
+    echo "Circular dependency detected\n";
+}
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: phpinfo
+bool(true)
+string(6) "scalar"
+
+Test 2: Many singletons
+bool(true)
+
+Test 3: Circular dependency
+Circular dependency detected
+
+Done!
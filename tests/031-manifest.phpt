@@ -0,0 +1,139 @@
+--TEST--
+Container: Bulk registration with register() and loadManifest()
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\ContainerException;
+
+// Test fixtures
+interface LoggerInterface {}
+class FileLogger implements LoggerInterface {}
+class NullLogger implements LoggerInterface {}
+class Database {}
+class Mailer {}
+
+class ReportController {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class HandlerA {}
+class HandlerB {}
+
+// Test 1: Every section in one call
+echo "Test 1: register()\n";
+Container::register([
+    'singleton' => [
+        LoggerInterface::class => FileLogger::class,
+        Database::class,
+    ],
+    'bind' => [Mailer::class => fn() => new Mailer()],
+    'alias' => ['logger' => LoggerInterface::class],
+    'tag' => ['handlers' => [HandlerA::class, HandlerB::class]],
+    'when' => [ReportController::class => [LoggerInterface::class => NullLogger::class]],
+]);
+var_dump(Container::make('logger') === Container::make(LoggerInterface::class));
+var_dump(get_class(Container::make(LoggerInterface::class)));
+var_dump(Container::make(Database::class) === Container::make(Database::class));
+var_dump(Container::make(Mailer::class) !== Container::make(Mailer::class));
+var_dump(array_map('get_class', Container::tagged('handlers')));
+var_dump(get_class(Container::make(ReportController::class)->logger));
+
+// Test 2: Sections apply in order, later entries replace earlier ones
+echo "\nTest 2: Order\n";
+Container::register([
+    'singleton' => [Mailer::class => null],
+    'bind' => [Mailer::class],
+]);
+var_dump(Container::getBindings()[Mailer::class]['scope']);
+var_dump(Container::make(Mailer::class) !== Container::make(Mailer::class));
+
+// Test 3: loadManifest() applies the array a file returns
+echo "\nTest 3: loadManifest()\n";
+Container::flush();
+$file = sys_get_temp_dir() . '/sf_manifest_' . getmypid() . '.php';
+file_put_contents($file, '<?php return ' . var_export([
+    'singleton' => [LoggerInterface::class => FileLogger::class],
+    'lazy' => [Database::class],
+], true) . ';');
+Container::loadManifest($file);
+var_dump(get_class(Container::make(LoggerInterface::class)));
+var_dump(Container::getBindings()[Database::class]['lazy']);
+
+// Test 4: An invalid manifest registers nothing
+echo "\nTest 4: Invalid entries\n";
+Container::flush();
+try {
+    Container::register([
+        'singleton' => [Database::class],
+        'alias' => ['logger' => 42],
+    ]);
+} catch (ContainerException $e) {
+    echo $e->getMessage(), "\n";
+}
+var_dump(Container::bound(Database::class));
+
+try {
+    Container::register(['factories' => []]);
+} catch (ContainerException $e) {
+    echo $e->getMessage(), "\n";
+}
+
+try {
+    Container::register(['bind' => [42]]);
+} catch (ContainerException $e) {
+    echo $e->getMessage(), "\n";
+}
+
+// Test 5: Files that don't hold a manifest
+echo "\nTest 5: Bad files\n";
+file_put_contents($file, '<?php return 1;');
+try {
+    Container::loadManifest($file);
+} catch (ContainerException $e) {
+    echo str_replace($file, 'FILE', $e->getMessage()), "\n";
+}
+unlink($file);
+try {
+    Container::loadManifest($file);
+} catch (ContainerException $e) {
+    echo str_replace($file, 'FILE', $e->getMessage()), "\n";
+}
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: register()
+bool(true)
+string(10) "FileLogger"
+bool(true)
+bool(true)
+array(2) {
+  [0]=>
+  string(8) "HandlerA"
+  [1]=>
+  string(8) "HandlerB"
+}
+string(10) "NullLogger"
+
+Test 2: Order
+string(9) "transient"
+bool(true)
+
+Test 3: loadManifest()
+string(10) "FileLogger"
+bool(true)
+
+Test 4: Invalid entries
+Invalid manifest entry 'logger' in 'alias': expected alias => abstract
+bool(false)
+Unknown manifest section 'factories'
+Invalid manifest entry #0 in 'bind': expected abstract => concrete, or a class name
+
+Test 5: Bad files
+FILE does not return a manifest array
+Manifest file not found: FILE
+
+Done!
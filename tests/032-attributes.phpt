@@ -0,0 +1,225 @@
+--TEST--
+Container: #[Singleton], #[Bind], #[Inject] and #[Tag] attributes
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\Attributes\Bind;
+use Signalforge\Container\Attributes\Inject;
+use Signalforge\Container\Attributes\Singleton;
+use Signalforge\Container\Attributes\Tag;
+
+// Test fixtures
+#[Bind(FileLogger::class)]
+interface LoggerInterface {}
+class FileLogger implements LoggerInterface {}
+class NullLogger implements LoggerInterface {}
+
+#[Singleton]
+class Database {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+#[Singleton, Bind(SqlCache::class)]
+interface CacheInterface {}
+class SqlCache implements CacheInterface {}
+
+class Connection {
+    public function __construct(public string $dsn = 'default') {}
+}
+
+class Repository {
+    public function __construct(
+        #[Inject('db.primary')] public Connection $connection,
+        #[Inject('db.dsn')] public $dsn,
+    ) {}
+}
+
+#[Tag('handlers')]
+class OrderHandler {}
+
+#[Tag('handlers'), Tag('audit')]
+class RefundHandler {}
+
+class ManualHandler {}
+
+class Misconfigured {
+    public function __construct(#[Inject(MISSING_KEY)] public $dep) {}
+}
+
+// Test 1: #[Bind] on an interface
+echo "Test 1: Bind\n";
+var_dump(Container::has(LoggerInterface::class));
+var_dump(get_class(Container::make(LoggerInterface::class)));
+var_dump(Container::make(LoggerInterface::class) !== Container::make(LoggerInterface::class));
+var_dump(Container::bound(LoggerInterface::class));
+
+// Test 2: #[Singleton] without registration
+echo "\nTest 2: Singleton\n";
+$db = Container::make(Database::class);
+var_dump($db === Container::make(Database::class));
+var_dump($db->logger instanceof FileLogger);
+var_dump(Container::getBindings()[Database::class]['scope']);
+
+// Test 3: #[Singleton] with #[Bind]
+echo "\nTest 3: Singleton binding\n";
+var_dump(get_class(Container::make(CacheInterface::class)));
+var_dump(Container::make(CacheInterface::class) === Container::make(CacheInterface::class));
+
+// Test 4: #[Inject] resolves by key, typed or not
+echo "\nTest 4: Inject\n";
+Container::instance('db.primary', new Connection('mysql:primary'));
+Container::bind('db.dsn', fn() => 'mysql:replica');
+$repo = Container::make(Repository::class);
+var_dump($repo->connection->dsn);
+var_dump($repo->dsn);
+$meta = Container::getMetadata(Repository::class);
+var_dump($meta['params'][0]['inject']);
+var_dump($meta['params'][1]['type']);
+
+// Test 5: Compiled plans honour the attributes
+echo "\nTest 5: Compiled\n";
+Container::bind(Repository::class);
+Container::compile();
+var_dump(Container::make(Repository::class)->connection->dsn);
+var_dump(Container::make(Database::class) === $db);
+
+// Test 6: #[Tag] joins after explicit members, once
+echo "\nTest 6: Tag\n";
+Container::tag([ManualHandler::class], 'handlers');
+var_dump(array_map('get_class', Container::tagged('handlers')));
+var_dump(count(Container::tagged('handlers')));
+var_dump(array_map('get_class', Container::tagged('audit')));
+var_dump(count(Container::lazyTagged('audit')));
+
+// Test 7: Classes declared later join on the next lookup
+echo "\nTest 7: Later classes\n";
+eval('#[Signalforge\Container\Attributes\Tag("audit")] class LateHandler {}');
+var_dump(array_map('get_class', Container::tagged('audit')));
+$declare = true;
+if ($declare) {
+    // Declared in the class table slot compiled for it, after the lookups above passed it
+    #[Tag('audit')]
+    class ConditionalHandler {}
+}
+var_dump(array_map('get_class', Container::tagged('audit')));
+
+// Test 8: An explicit binding wins
+echo "\nTest 8: Explicit binding\n";
+Container::flush();
+Container::bind(LoggerInterface::class, NullLogger::class);
+Container::bind(Database::class);
+var_dump(get_class(Container::make(LoggerInterface::class)));
+var_dump(Container::make(Database::class) !== Container::make(Database::class));
+
+// Test 9: Metadata
+echo "\nTest 9: Metadata\n";
+$meta = Container::getMetadata(CacheInterface::class);
+var_dump($meta['singleton']);
+var_dump($meta['bind']);
+var_dump(Container::getMetadata(FileLogger::class)['bind']);
+
+// Test 10: Reflection can instantiate the attributes
+echo "\nTest 10: Reflection\n";
+$attribute = (new ReflectionClass(LoggerInterface::class))->getAttributes()[0]->newInstance();
+var_dump($attribute->concrete);
+$attribute = (new ReflectionClass(RefundHandler::class))->getAttributes()[1]->newInstance();
+var_dump($attribute->name);
+
+// Test 11: An attribute argument that throws fails the metadata build
+echo "\nTest 11: Throwing argument\n";
+for ($i = 0; $i < 2; $i++) {
+    try {
+        Container::make(Misconfigured::class);
+    } catch (Error $e) {
+        echo get_class($e), ': ', $e->getMessage(), "\n";
+        var_dump($e->getPrevious());
+    }
+}
+define('MISSING_KEY', 'db.dsn');
+Container::bind('db.dsn', fn () => 'sqlite::memory:');
+var_dump(Container::make(Misconfigured::class)->dep);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Bind
+bool(true)
+string(10) "FileLogger"
+bool(true)
+bool(true)
+
+Test 2: Singleton
+bool(true)
+bool(true)
+string(9) "singleton"
+
+Test 3: Singleton binding
+string(8) "SqlCache"
+bool(true)
+
+Test 4: Inject
+string(13) "mysql:primary"
+string(13) "mysql:replica"
+string(10) "db.primary"
+NULL
+
+Test 5: Compiled
+string(13) "mysql:primary"
+bool(true)
+
+Test 6: Tag
+array(3) {
+  [0]=>
+  string(13) "ManualHandler"
+  [1]=>
+  string(12) "OrderHandler"
+  [2]=>
+  string(13) "RefundHandler"
+}
+int(3)
+array(1) {
+  [0]=>
+  string(13) "RefundHandler"
+}
+int(1)
+
+Test 7: Later classes
+array(2) {
+  [0]=>
+  string(13) "RefundHandler"
+  [1]=>
+  string(11) "LateHandler"
+}
+array(3) {
+  [0]=>
+  string(13) "RefundHandler"
+  [1]=>
+  string(11) "LateHandler"
+  [2]=>
+  string(18) "ConditionalHandler"
+}
+
+Test 8: Explicit binding
+string(10) "NullLogger"
+bool(true)
+
+Test 9: Metadata
+bool(true)
+string(8) "SqlCache"
+NULL
+
+Test 10: Reflection
+string(10) "FileLogger"
+string(5) "audit"
+
+Test 11: Throwing argument
+Error: Undefined constant "MISSING_KEY"
+NULL
+Error: Undefined constant "MISSING_KEY"
+NULL
+string(15) "sqlite::memory:"
+
+Done!
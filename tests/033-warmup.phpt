@@ -0,0 +1,121 @@
+--TEST--
+Container: warmup() builds metadata and plans before the first make()
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+namespace App\Services {
+    class Clock {}
+
+    class Mailer {
+        public function __construct(public Clock $clock) {}
+    }
+
+    interface Transport {}
+
+    abstract class BaseJob {}
+}
+
+namespace {
+
+use Signalforge\Container\Container;
+use App\Services\Clock;
+use App\Services\Mailer;
+use App\Services\Transport;
+
+// Test fixtures
+class Report {
+    public function __construct(public Mailer $mailer) {}
+}
+
+class SmtpTransport implements Transport {}
+
+class Inbox {
+    public function __construct(public Transport $transport) {}
+}
+
+// Test 1: Every loaded class under a namespace prefix
+echo "Test 1: Prefix\n";
+Container::resetStats();
+var_dump(Container::warmup('App\\Services\\'));
+var_dump(Container::stats()['metadataBuilds']);
+var_dump(Container::stats()['plans']['promoted']);
+
+// Test 2: make() finds everything built
+echo "\nTest 2: Warm make\n";
+Container::resetStats();
+$mailer = Container::make(Mailer::class);
+var_dump($mailer->clock instanceof Clock);
+var_dump(Container::stats()['metadataBuilds']);
+var_dump(Container::stats()['paths']['autowire']);
+
+// Test 3: A list of class names, and a prefix with a leading backslash
+echo "\nTest 3: List\n";
+Container::resetStats();
+var_dump(Container::warmup([Report::class, Transport::class]));
+var_dump(Container::warmup('\\App\\Services\\'));
+var_dump(Container::stats()['metadataBuilds']);
+var_dump(Container::make(Report::class)->mailer instanceof Mailer);
+
+// Test 4: Warming registers nothing
+echo "\nTest 4: No bindings\n";
+var_dump(Container::bound(Mailer::class));
+var_dump(Container::getBindings());
+var_dump(Container::isCompiled());
+
+// Test 5: Bindings made afterwards still apply
+echo "\nTest 5: Later binding\n";
+var_dump(Container::warmup([Inbox::class]));
+Container::bind(Transport::class, SmtpTransport::class);
+echo get_class(Container::make(Inbox::class)->transport), "\n";
+
+// Test 6: Unknown classes and invalid entries throw
+echo "\nTest 6: Errors\n";
+try {
+    Container::warmup([Report::class, 'Missing\\Service']);
+} catch (Signalforge\Container\NotFoundException $e) {
+    echo get_class($e), ": ", $e->getMessage(), "\n";
+}
+try {
+    Container::warmup([42]);
+} catch (Signalforge\Container\ContainerException $e) {
+    echo get_class($e), ": ", $e->getMessage(), "\n";
+}
+
+echo "\nDone!\n";
+
+}
+?>
+--EXPECT--
+Test 1: Prefix
+int(4)
+int(4)
+int(2)
+
+Test 2: Warm make
+bool(true)
+int(0)
+int(0)
+
+Test 3: List
+int(2)
+int(4)
+int(1)
+bool(true)
+
+Test 4: No bindings
+bool(false)
+array(0) {
+}
+bool(false)
+
+Test 5: Later binding
+int(1)
+SmtpTransport
+
+Test 6: Errors
+Signalforge\Container\NotFoundException: Cannot warm up 'Missing\Service': class does not exist
+Signalforge\Container\ContainerException: Container::warmup() expects a list of class names
+
+Done!
@@ -0,0 +1,99 @@
+--TEST--
+Container: Alias chains resolve in one step, whatever order they were declared in
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+interface Cache {}
+class FileCache implements Cache {}
+class RedisCache implements Cache {}
+
+class Consumer {
+    public function __construct(public Cache $cache) {}
+}
+
+// Test 1: A chain declared from its far end
+echo "Test 1: Backwards chain\n";
+Container::alias('cache.default', 'cache');
+Container::alias('cache.store', 'cache.default');
+Container::alias(Cache::class, 'cache.store');
+Container::singleton(Cache::class, FileCache::class);
+var_dump(Container::make('cache') instanceof FileCache);
+var_dump(Container::make('cache') === Container::make(Cache::class));
+
+// Test 2: Re-pointing a link moves every alias behind it
+echo "\nTest 2: Re-pointed link\n";
+Container::singleton('redis', RedisCache::class);
+Container::alias('redis', 'cache.store');
+var_dump(get_class(Container::make('cache')));
+var_dump(get_class(Container::make('cache.default')));
+var_dump(get_class(Container::make(Cache::class)));
+
+// Test 3: Binding through an alias binds its target
+echo "\nTest 3: Bind through alias\n";
+Container::alias('mailer.default', 'mailer');
+Container::bind('mailer', FileCache::class);
+var_dump(Container::bound('mailer.default'));
+var_dump(get_class(Container::make('mailer.default')));
+
+// Test 4: A loop neither hangs nor crashes
+echo "\nTest 4: Loop\n";
+Container::alias('loop.a', 'loop.b');
+Container::alias('loop.b', 'loop.a');
+var_dump(Container::has('loop.a'));
+var_dump(Container::bound('loop.b'));
+
+// Test 5: flush() drops the chains
+echo "\nTest 5: Flush\n";
+Container::flush();
+var_dump(Container::has('cache'));
+Container::bind(Cache::class, RedisCache::class);
+Container::alias(Cache::class, 'cache');
+var_dump(get_class(Container::make('cache')));
+
+// Test 6: Compiled plans see a re-pointed link in the middle of a chain
+echo "\nTest 6: Compiled chain\n";
+Container::flush();
+Container::alias('mid', Cache::class);
+Container::alias('impl.a', 'mid');
+Container::bind('impl.a', FileCache::class);
+Container::bind('impl.b', RedisCache::class);
+Container::bind(Consumer::class);
+Container::compile();
+var_dump(get_class(Container::make(Consumer::class)->cache));
+Container::alias('impl.b', 'mid');
+var_dump(get_class(Container::make(Consumer::class)->cache));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Backwards chain
+bool(true)
+bool(true)
+
+Test 2: Re-pointed link
+string(10) "RedisCache"
+string(10) "RedisCache"
+string(9) "FileCache"
+
+Test 3: Bind through alias
+bool(true)
+string(9) "FileCache"
+
+Test 4: Loop
+bool(false)
+bool(false)
+
+Test 5: Flush
+bool(false)
+string(10) "RedisCache"
+
+Test 6: Compiled chain
+string(9) "FileCache"
+string(10) "RedisCache"
+
+Done!
@@ -0,0 +1,165 @@
+--TEST--
+Container: trace() records resolutions as Chrome trace events
+--EXTENSIONS--
+signalforge_container
+--INI--
+signalforge_container.trace=1
+signalforge_container.trace_size=16
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+class Logger {}
+
+class Mailer {
+    public function __construct(public Logger $logger) {}
+}
+
+class Service {
+    public function __construct(public Mailer $mailer, public Logger $logger) {}
+}
+
+interface LoggerInterface {}
+class FileLogger implements LoggerInterface {}
+class NullLogger implements LoggerInterface {}
+
+class Report {
+    public function __construct(public LoggerInterface $logger) {}
+}
+
+class Connection {
+    public function __construct() { Fiber::suspend(); }
+}
+
+class Repository {
+    public function __construct(public Connection $connection) {}
+}
+
+class Queue {
+    public function __construct(public Connection $connection) {}
+}
+
+function show(array $events): void {
+    foreach ($events as $event) {
+        printf("%s %s depth=%d requester=%s%s\n", $event['name'], $event['cat'], $event['args']['depth'],
+            $event['args']['requester'] ?? '-', $event['args']['failed'] ? ' failed' : '');
+    }
+}
+
+// Test 1: Dependencies finish before what needed them
+echo "Test 1: Nesting\n";
+Container::singleton(Logger::class);
+Container::make(Service::class);
+show(Container::trace()['traceEvents']);
+
+// Test 2: Event format
+echo "\nTest 2: Format\n";
+$trace = Container::trace();
+[, $mailer, , $service] = $trace['traceEvents'];
+var_dump($service['ph']);
+var_dump($service['pid'] === getmypid());
+var_dump(is_float($service['ts']) && is_float($service['dur']));
+var_dump($service['ts'] <= $mailer['ts']);
+var_dump($service['ts'] + $service['dur'] >= $mailer['ts'] + $mailer['dur']);
+var_dump($trace['displayTimeUnit']);
+var_dump(json_decode(json_encode($trace), true) == $trace);
+
+// Test 3: Closure, contextual and failed resolutions
+echo "\nTest 3: Paths\n";
+Container::resetTrace();
+Container::bind('clock', fn() => 'now');
+Container::bind(LoggerInterface::class, FileLogger::class);
+Container::when(Report::class)->needs(LoggerInterface::class)->give(NullLogger::class);
+Container::make('clock');
+Container::make(Report::class);
+try {
+    Container::make('Missing\Thing');
+} catch (Exception $e) {
+}
+show(Container::trace()['traceEvents']);
+
+// Test 4: The ring buffer keeps the latest events
+echo "\nTest 4: Ring buffer\n";
+Container::resetTrace();
+for ($i = 0; $i < 20; $i++) {
+    Container::bind("svc.$i", fn() => $i);
+}
+for ($i = 0; $i < 20; $i++) {
+    Container::make("svc.$i");
+}
+$trace = Container::trace();
+var_dump(count($trace['traceEvents']));
+var_dump($trace['traceEvents'][0]['name']);
+var_dump($trace['traceEvents'][15]['name']);
+var_dump($trace['otherData']);
+
+// Test 5: Fibers suspended mid-resolution finish their own events
+echo "\nTest 5: Fibers\n";
+Container::resetTrace();
+$f1 = new Fiber(fn () => Container::make(Repository::class));
+$f2 = new Fiber(fn () => Container::make(Queue::class));
+$f1->start();
+$f2->start();
+$f1->resume();
+$f2->resume();
+show(Container::trace()['traceEvents']);
+
+// Test 6: Nothing is recorded with tracing off
+echo "\nTest 6: Off\n";
+Container::resetTrace();
+ini_set('signalforge_container.trace', '0');
+Container::make(Service::class);
+$trace = Container::trace();
+var_dump(count($trace['traceEvents']));
+var_dump($trace['otherData']['enabled']);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Nesting
+Logger autowire depth=2 requester=Mailer
+Mailer autowire depth=1 requester=Service
+Logger singleton depth=1 requester=Service
+Service autowire depth=0 requester=-
+
+Test 2: Format
+string(1) "X"
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+string(2) "ns"
+bool(true)
+
+Test 3: Paths
+clock closure depth=0 requester=-
+LoggerInterface contextual depth=1 requester=Report
+Report autowire depth=0 requester=-
+Missing\Thing autowire depth=0 requester=- failed
+
+Test 4: Ring buffer
+int(16)
+string(5) "svc.4"
+string(6) "svc.19"
+array(3) {
+  ["enabled"]=>
+  bool(true)
+  ["capacity"]=>
+  int(16)
+  ["dropped"]=>
+  int(4)
+}
+
+Test 5: Fibers
+Connection autowire depth=1 requester=Repository
+Repository autowire depth=0 requester=-
+Connection autowire depth=1 requester=Queue
+Queue autowire depth=0 requester=-
+
+Test 6: Off
+int(0)
+bool(false)
+
+Done!
@@ -0,0 +1,133 @@
+--TEST--
+Container: graph() exports the static dependency graph
+--EXTENSIONS--
+signalforge_container
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+use Signalforge\Container\ContainerException;
+use Signalforge\Container\Attributes\Inject;
+use Signalforge\Container\Attributes\Singleton;
+
+// Test fixtures
+interface CacheInterface {}
+class RedisCache implements CacheInterface {}
+interface PaymentGateway {}
+class Logger {}
+
+#[Singleton]
+class Session {}
+
+class Repository {
+    public function __construct(public CacheInterface $cache, public Logger $logger, public Session $session) {}
+}
+
+class Controller {
+    public function __construct(
+        public Repository $repo,
+        public Logger $logger,
+        public ?PaymentGateway $gateway = null,
+        public string $name = 'home',
+    ) {}
+}
+
+class Notifier {
+    public function __construct(#[Inject('log')] public $logger) {}
+}
+
+class AuditController {
+    public function __construct(public CacheInterface $cache) {}
+}
+
+Container::singleton(CacheInterface::class, RedisCache::class);
+Container::singleton(Logger::class);
+Container::alias(Logger::class, 'log');
+Container::bind(Controller::class);
+Container::bind(Notifier::class);
+Container::bind('clock', fn() => time());
+Container::when(AuditController::class)->needs(CacheInterface::class)->give(fn() => new RedisCache());
+
+// Test 1: Nodes with scope and fan-in, edges by parameter
+echo "Test 1: Array\n";
+$graph = Container::graph();
+$nodes = $graph['nodes'];
+ksort($nodes);
+foreach ($nodes as $name => $node) {
+    printf("%s: %s%s%s in=%d out=%d\n", $name, $node['scope'] ?? 'unresolvable', $node['bound'] ? ' bound' : '',
+        $node['closure'] ? ' closure' : '', $node['fanIn'], $node['fanOut']);
+}
+$edges = array_map(fn($edge) => $edge['from'] . ' -> ' . $edge['to']
+    . ($edge['param'] !== null ? ' $' . $edge['param'] : '')
+    . ($edge['contextual'] ? ' (contextual)' : ''), $graph['edges']);
+sort($edges);
+echo implode("\n", $edges), "\n";
+
+// Test 2: DOT
+echo "\nTest 2: DOT\n";
+Container::bind('App\Mailer', fn() => null);
+$dot = Container::graph('dot');
+var_dump(str_starts_with($dot, "digraph container {\n"));
+var_dump(str_contains($dot, '"Logger" [label="Logger\nsingleton, fan-in 3"];'));
+var_dump(str_contains($dot, '"Repository" [label="Repository\ntransient, fan-in 1", style=rounded];'));
+var_dump(str_contains($dot, '"PaymentGateway" [label="PaymentGateway\nunresolvable, fan-in 1", style=dashed];'));
+var_dump(str_contains($dot, '"CacheInterface" -> "RedisCache";'));
+var_dump(str_contains($dot, '"AuditController" -> "CacheInterface" [label="$cache", style=dashed];'));
+var_dump(str_contains($dot, '"App\\\\Mailer" [label="App\\\\Mailer\ntransient, fan-in 0"];'));
+var_dump(str_ends_with($dot, "}\n"));
+
+// Test 3: Unknown format
+echo "\nTest 3: Unknown format\n";
+try {
+    Container::graph('svg');
+} catch (ContainerException $e) {
+    echo $e->getMessage(), "\n";
+}
+
+// Test 4: Nothing is built
+echo "\nTest 4: Nothing built\n";
+var_dump(Container::stats()['make']);
+var_dump(Container::resolved(Logger::class));
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Array
+AuditController: transient in=0 out=1
+CacheInterface: singleton bound in=2 out=1
+Controller: transient bound in=0 out=3
+Logger: singleton bound in=3 out=0
+Notifier: transient bound in=0 out=1
+PaymentGateway: unresolvable in=1 out=0
+RedisCache: transient in=1 out=0
+Repository: transient in=1 out=3
+Session: singleton in=1 out=0
+clock: transient bound closure in=0 out=0
+AuditController -> CacheInterface $cache (contextual)
+CacheInterface -> RedisCache
+Controller -> Logger $logger
+Controller -> PaymentGateway $gateway
+Controller -> Repository $repo
+Notifier -> Logger $logger
+Repository -> CacheInterface $cache
+Repository -> Logger $logger
+Repository -> Session $session
+
+Test 2: DOT
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+
+Test 3: Unknown format
+Unknown graph format 'svg' (expected 'array' or 'dot')
+
+Test 4: Nothing built
+int(0)
+bool(false)
+
+Done!
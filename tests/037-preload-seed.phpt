@@ -0,0 +1,77 @@
+--TEST--
+Container: metadata and plans warmed by opcache.preload seed later requests
+--EXTENSIONS--
+opcache
+signalforge_container
+--INI--
+opcache.enable=1
+opcache.enable_cli=1
+opcache.optimization_level=-1
+opcache.preload={PWD}/037-preload-seed.inc
+--SKIPIF--
+<?php
+if (PHP_OS_FAMILY == 'Windows') die('skip Preloading is not supported on Windows');
+?>
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test 1: The classes were preloaded
+echo "Test 1: Preloaded\n";
+var_dump(class_exists(Preloaded\Mailer::class, false));
+
+// Test 2: make() runs the seeded plan without building metadata
+echo "\nTest 2: Seeded make\n";
+$mailer = Container::make(Preloaded\Mailer::class);
+var_dump($mailer->clock instanceof Preloaded\Clock);
+$stats = Container::stats();
+var_dump($stats['metadataBuilds']);
+var_dump($stats['paths']['compiled']);
+var_dump($stats['paths']['autowire']);
+var_dump($stats['plans']);
+
+// Test 3: Seeding registers nothing
+echo "\nTest 3: No bindings\n";
+var_dump(Container::getBindings());
+var_dump(Container::getMetadata(Preloaded\Transport::class)['instantiable']);
+var_dump(Container::stats()['metadataBuilds']);
+
+// Test 4: A flush empties the seeded caches like any others
+echo "\nTest 4: Flush\n";
+Container::flush();
+Container::resetStats();
+var_dump(Container::make(Preloaded\Mailer::class) instanceof Preloaded\Mailer);
+var_dump(Container::stats()['metadataBuilds']);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Preloaded
+bool(true)
+
+Test 2: Seeded make
+bool(true)
+int(0)
+int(1)
+int(0)
+array(3) {
+  ["promoted"]=>
+  int(0)
+  ["rebuilt"]=>
+  int(0)
+  ["failed"]=>
+  int(0)
+}
+
+Test 3: No bindings
+array(0) {
+}
+bool(false)
+int(0)
+
+Test 4: Flush
+bool(true)
+int(2)
+
+Done!
@@ -0,0 +1,74 @@
+--TEST--
+Container: Snapshot files others could have planted or changed
+--EXTENSIONS--
+signalforge_container
+--SKIPIF--
+<?php
+if (PHP_OS_FAMILY == 'Windows') die('skip Symlinks need privileges on Windows');
+?>
+--FILE--
+<?php
+
+use Signalforge\Container\Container;
+
+// Test fixtures
+class Mailer {}
+
+$dir = sys_get_temp_dir() . '/signalforge_038_' . getmypid();
+@mkdir($dir);
+$snapshot = $dir . '/snapshot.bin';
+$victim = $dir . '/victim';
+
+// Test 1: A symlinked lock is not followed
+echo "\nTest 1: Symlinked lock\n";
+Container::bind(Mailer::class);
+symlink($victim, $snapshot . '.lock');
+var_dump(@Container::saveSnapshot($snapshot));
+var_dump(file_exists($victim));
+var_dump(file_exists($snapshot));
+unlink($snapshot . '.lock');
+
+// Test 2: The temporary file is private and doesn't stay behind
+echo "\nTest 2: Private file\n";
+$old = umask(0);
+var_dump(Container::saveSnapshot($snapshot));
+umask($old);
+printf("%o\n", fileperms($snapshot) & 0777);
+var_dump(glob($snapshot . '.??????'));
+
+// Test 3: Files writable by others are not loaded
+echo "\nTest 3: Writable by others\n";
+chmod($snapshot, 0666);
+Container::flush();
+var_dump(Container::loadSnapshot($snapshot));
+chmod($snapshot, 0620);
+var_dump(Container::loadSnapshot($snapshot));
+chmod($snapshot, 0600);
+var_dump(Container::loadSnapshot($snapshot));
+var_dump(Container::bound(Mailer::class));
+
+unlink($snapshot);
+unlink($snapshot . '.lock');
+rmdir($dir);
+
+echo "\nDone!\n";
+?>
+--EXPECT--
+Test 1: Symlinked lock
+bool(false)
+bool(false)
+bool(false)
+
+Test 2: Private file
+bool(true)
+600
+array(0) {
+}
+
+Test 3: Writable by others
+bool(false)
+bool(false)
+bool(true)
+bool(true)
+
+Done!